@@ -0,0 +1,568 @@
+/**
+ * HiNATA 访问计数 - C 语言实现
+ */
+
+#include "access_counters.h"
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_ACCESS_PROGRESS_SET (1ULL << 32)
+
+// 线程首次记录时分配的分片
+static atomic_uint hinata_access_next_shard;
+static _Thread_local uint32_t hinata_access_shard_id = UINT32_MAX;
+
+// ============================================================================
+// 物料字典
+// ============================================================================
+
+static const char *hinata_access_id_key(const void *owner, uint32_t entry)
+{
+    return ((const hinata_access_counters_t *)owner)->ids[entry - 1];
+}
+
+static uint32_t hinata_access_find_slot(const hinata_access_counters_t *counters, const char *id)
+{
+    return hinata_uuid_slot(counters->slots, counters->slot_capacity, id, hinata_access_id_key,
+                            counters);
+}
+
+/**
+ * 扩展每个分片的块指针数组，新位置为空
+ */
+static int hinata_access_grow_chunks(hinata_access_counters_t *counters, uint32_t needed)
+{
+    _Atomic(hinata_access_chunk_t *) *chunks;
+    uint32_t capacity = counters->chunk_capacity ? counters->chunk_capacity : 1;
+    uint32_t shard, i;
+
+    if (needed <= counters->chunk_capacity) {
+        return 0;
+    }
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        chunks = realloc(counters->shards[shard].chunks, capacity * sizeof(*chunks));
+        if (!chunks) {
+            return -ENOMEM;
+        }
+        for (i = counters->chunk_capacity; i < capacity; i++) {
+            atomic_init(&chunks[i], NULL);
+        }
+        counters->shards[shard].chunks = chunks;
+    }
+
+    // 所有分片都成功后才更新容量，失败时已扩展的数组多出的位置不会被使用
+    counters->chunk_capacity = capacity;
+    return 0;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_access_init(hinata_access_counters_t *counters)
+{
+    uint32_t shard;
+
+    memset(counters, 0, sizeof(*counters));
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        atomic_init(&counters->shards[shard].events, 0);
+    }
+}
+
+void hinata_access_free(hinata_access_counters_t *counters)
+{
+    uint32_t shard, i;
+
+    if (!counters) {
+        return;
+    }
+
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        for (i = 0; i < counters->chunk_capacity; i++) {
+            free(atomic_load_explicit(&counters->shards[shard].chunks[i], memory_order_relaxed));
+        }
+        free(counters->shards[shard].chunks);
+    }
+
+    free(counters->ids);
+    free(counters->slots);
+    free(counters->progress);
+    memset(counters, 0, sizeof(*counters));
+}
+
+// ============================================================================
+// 登记与查找
+// ============================================================================
+
+int hinata_access_register(hinata_access_counters_t *counters, const char *id, uint32_t *slot)
+{
+    uint32_t capacity, pos;
+    void *progress;
+    int ret;
+
+    if (!counters || !id || !*id || !slot) {
+        return -EINVAL;
+    }
+
+    if (counters->slot_capacity) {
+        pos = hinata_access_find_slot(counters, id);
+        if (counters->slots[pos]) {
+            *slot = counters->slots[pos] - 1;
+            return 0;
+        }
+    }
+
+    ret = hinata_uuid_slots_grow(&counters->slots, &counters->slot_capacity, counters->count,
+                                 counters->count, hinata_access_id_key, counters);
+    if (ret < 0) {
+        return ret;
+    }
+
+    capacity = counters->capacity;
+    ret = hinata_vec_reserve((void **)&counters->ids, &capacity, counters->count + 1,
+                             sizeof(*counters->ids));
+    if (ret < 0) {
+        return ret;
+    }
+    if (capacity != counters->capacity) {
+        progress = realloc(counters->progress, capacity * sizeof(*counters->progress));
+        if (!progress) {
+            return -ENOMEM;
+        }
+        counters->progress = progress;
+        counters->capacity = capacity;
+    }
+
+    ret = hinata_access_grow_chunks(counters, counters->count / HINATA_ACCESS_CHUNK + 1);
+    if (ret < 0) {
+        return ret;
+    }
+
+    *slot = counters->count++;
+    hinata_uuid_assign(counters->ids[*slot], id);
+    atomic_init(&counters->progress[*slot], 0);
+    counters->slots[hinata_access_find_slot(counters, id)] = *slot + 1;
+    return 0;
+}
+
+int hinata_access_lookup(const hinata_access_counters_t *counters, const char *id,
+                         uint32_t *slot)
+{
+    uint32_t entry;
+
+    if (!counters || !id || !*id || !slot) {
+        return -EINVAL;
+    }
+    if (!counters->slot_capacity) {
+        return -ENOENT;
+    }
+
+    entry = counters->slots[hinata_access_find_slot(counters, id)];
+    if (!entry) {
+        return -ENOENT;
+    }
+
+    *slot = entry - 1;
+    return 0;
+}
+
+// ============================================================================
+// 记录
+// ============================================================================
+
+/**
+ * 当前线程的分片
+ */
+static hinata_access_shard_t *hinata_access_shard(hinata_access_counters_t *counters)
+{
+    if (hinata_access_shard_id == UINT32_MAX) {
+        hinata_access_shard_id = atomic_fetch_add_explicit(&hinata_access_next_shard, 1,
+                                                           memory_order_relaxed) %
+                                 HINATA_ACCESS_SHARDS;
+    }
+
+    return &counters->shards[hinata_access_shard_id];
+}
+
+/**
+ * 当前线程的分片中 slot 所在的块，不存在时分配
+ */
+static hinata_access_chunk_t *hinata_access_chunk(hinata_access_counters_t *counters,
+                                                  uint32_t slot, hinata_access_shard_t **shard)
+{
+    _Atomic(hinata_access_chunk_t *) *ref;
+    hinata_access_chunk_t *chunk, *expected = NULL;
+
+    *shard = hinata_access_shard(counters);
+    ref = &(*shard)->chunks[slot / HINATA_ACCESS_CHUNK];
+    chunk = atomic_load_explicit(ref, memory_order_acquire);
+    if (!chunk) {
+        chunk = calloc(1, sizeof(*chunk));
+        if (!chunk) {
+            return NULL;
+        }
+        // 同一分片可能被多个线程共用，分配竞争失败时使用对方的块
+        if (!atomic_compare_exchange_strong_explicit(ref, &expected, chunk, memory_order_acq_rel,
+                                                     memory_order_acquire)) {
+            free(chunk);
+            chunk = expected;
+        }
+    }
+
+    return chunk;
+}
+
+static void hinata_access_touch(_Atomic int64_t *accessed, hinata_timestamp_t now)
+{
+    int64_t old = atomic_load_explicit(accessed, memory_order_relaxed);
+
+    while (now > old &&
+           !atomic_compare_exchange_weak_explicit(accessed, &old, now, memory_order_seq_cst,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+static int hinata_access_record(hinata_access_counters_t *counters, uint32_t slot,
+                                hinata_timestamp_t now, bool edit)
+{
+    hinata_access_shard_t *shard;
+    hinata_access_chunk_t *chunk;
+    hinata_access_delta_t *delta;
+
+    if (!counters || slot >= counters->count || now <= 0) {
+        return -EINVAL;
+    }
+
+    chunk = hinata_access_chunk(counters, slot, &shard);
+    if (!chunk) {
+        return -ENOMEM;
+    }
+
+    delta = &chunk->deltas[slot % HINATA_ACCESS_CHUNK];
+    atomic_fetch_add_explicit(edit ? &delta->edits : &delta->views, 1, memory_order_seq_cst);
+    hinata_access_touch(&delta->accessed, now);
+
+    // 先写增量再标记块，合并先清除标记再取走增量（都是 seq_cst）：
+    // 合并没有取走的增量，所在块的标记一定还在
+    if (!atomic_load_explicit(&chunk->touched, memory_order_seq_cst)) {
+        atomic_store_explicit(&chunk->touched, true, memory_order_seq_cst);
+    }
+    atomic_fetch_add_explicit(&shard->events, 1, memory_order_relaxed);
+    return 0;
+}
+
+int hinata_access_record_view(hinata_access_counters_t *counters, uint32_t slot,
+                              hinata_timestamp_t now)
+{
+    return hinata_access_record(counters, slot, now, false);
+}
+
+int hinata_access_record_edit(hinata_access_counters_t *counters, uint32_t slot,
+                              hinata_timestamp_t now)
+{
+    return hinata_access_record(counters, slot, now, true);
+}
+
+int hinata_access_set_progress(hinata_access_counters_t *counters, uint32_t slot,
+                               float progress)
+{
+    uint32_t bits;
+
+    if (!counters || slot >= counters->count || !(progress >= 0.0f && progress <= 1.0f)) {
+        return -EINVAL;
+    }
+
+    memcpy(&bits, &progress, sizeof(bits));
+    atomic_store_explicit(&counters->progress[slot], HINATA_ACCESS_PROGRESS_SET | bits,
+                          memory_order_relaxed);
+    atomic_fetch_add_explicit(&hinata_access_shard(counters)->events, 1, memory_order_relaxed);
+    return 0;
+}
+
+// ============================================================================
+// 读取
+// ============================================================================
+
+int hinata_access_pending(const hinata_access_counters_t *counters, uint32_t slot,
+                          hinata_access_update_t *update)
+{
+    hinata_access_chunk_t *chunk;
+    const hinata_access_delta_t *delta;
+    uint64_t views = 0, edits = 0, progress;
+    uint32_t bits, shard;
+    int64_t accessed;
+
+    if (!counters || slot >= counters->count || !update) {
+        return -EINVAL;
+    }
+
+    memset(update, 0, sizeof(*update));
+    hinata_uuid_assign(update->id, counters->ids[slot]);
+
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        chunk = atomic_load_explicit(&counters->shards[shard].chunks[slot / HINATA_ACCESS_CHUNK],
+                                     memory_order_acquire);
+        if (!chunk) {
+            continue;
+        }
+
+        delta = &chunk->deltas[slot % HINATA_ACCESS_CHUNK];
+        views += atomic_load_explicit(&delta->views, memory_order_relaxed);
+        edits += atomic_load_explicit(&delta->edits, memory_order_relaxed);
+        accessed = atomic_load_explicit(&delta->accessed, memory_order_relaxed);
+        if (accessed > update->last_accessed_at) {
+            update->last_accessed_at = accessed;
+        }
+    }
+
+    update->views = views > UINT32_MAX ? UINT32_MAX : (uint32_t)views;
+    update->edits = edits > UINT32_MAX ? UINT32_MAX : (uint32_t)edits;
+
+    progress = atomic_load_explicit(&counters->progress[slot], memory_order_relaxed);
+    if (progress & HINATA_ACCESS_PROGRESS_SET) {
+        bits = (uint32_t)progress;
+        memcpy(&update->reading_progress, &bits, sizeof(bits));
+        update->has_progress = true;
+    }
+
+    return 0;
+}
+
+void hinata_access_apply(const hinata_access_update_t *update, hinata_library_item_t *item)
+{
+    if (!update || !item) {
+        return;
+    }
+
+    item->view_count = update->views > UINT32_MAX - item->view_count ?
+                       UINT32_MAX : item->view_count + update->views;
+    item->edit_count = update->edits > UINT32_MAX - item->edit_count ?
+                       UINT32_MAX : item->edit_count + update->edits;
+    if (update->last_accessed_at > item->last_accessed_at) {
+        item->last_accessed_at = update->last_accessed_at;
+    }
+    if (update->has_progress) {
+        item->reading_progress = update->reading_progress;
+    }
+}
+
+void hinata_access_overlay(const hinata_access_counters_t *counters, hinata_library_item_t *item)
+{
+    hinata_access_update_t update;
+    uint32_t slot;
+
+    if (!item || hinata_access_lookup(counters, item->id, &slot) < 0) {
+        return;
+    }
+
+    if (hinata_access_pending(counters, slot, &update) == 0) {
+        hinata_access_apply(&update, item);
+    }
+}
+
+uint64_t hinata_access_event_count(const hinata_access_counters_t *counters)
+{
+    uint64_t events = 0;
+    uint32_t shard;
+
+    if (!counters) {
+        return 0;
+    }
+
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        events += atomic_load_explicit(&counters->shards[shard].events, memory_order_relaxed);
+    }
+    return events;
+}
+
+// ============================================================================
+// 合并
+// ============================================================================
+
+/**
+ * 标记有增量的槽位：只检查自上次合并以来被记录过的块，检查前清除块标记，
+ * 之后的记录会重新标记
+ */
+static void hinata_access_mark_dirty(hinata_access_counters_t *counters, uint8_t *dirty)
+{
+    hinata_access_chunk_t *chunk;
+    hinata_access_delta_t *delta;
+    uint32_t shard, c, i, base, end;
+
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        for (c = 0; c < counters->chunk_capacity; c++) {
+            chunk = atomic_load_explicit(&counters->shards[shard].chunks[c], memory_order_acquire);
+            if (!chunk || !atomic_exchange_explicit(&chunk->touched, false, memory_order_seq_cst)) {
+                continue;
+            }
+
+            base = c * HINATA_ACCESS_CHUNK;
+            end = counters->count - base < HINATA_ACCESS_CHUNK ? counters->count - base :
+                  HINATA_ACCESS_CHUNK;
+            // 记录可能只完成了一半，计数和访问时间任一非 0 都算有增量
+            for (i = 0; i < end; i++) {
+                delta = &chunk->deltas[i];
+                if (atomic_load_explicit(&delta->views, memory_order_seq_cst) ||
+                    atomic_load_explicit(&delta->edits, memory_order_seq_cst) ||
+                    atomic_load_explicit(&delta->accessed, memory_order_seq_cst)) {
+                    dirty[base + i] = 1;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < counters->count; i++) {
+        if (atomic_load_explicit(&counters->progress[i], memory_order_relaxed) &
+            HINATA_ACCESS_PROGRESS_SET) {
+            dirty[i] = 1;
+        }
+    }
+}
+
+/**
+ * 取走 slot 在所有分片中的增量和阅读进度
+ * 逐个交换为 0，与此同时的记录要么被这次取走，要么留给下次合并
+ */
+static void hinata_access_drain(hinata_access_counters_t *counters, uint32_t slot,
+                                hinata_access_update_t *update)
+{
+    hinata_access_chunk_t *chunk;
+    hinata_access_delta_t *delta;
+    uint64_t views = 0, edits = 0, progress;
+    uint32_t bits, shard;
+    int64_t accessed;
+
+    memset(update, 0, sizeof(*update));
+    hinata_uuid_assign(update->id, counters->ids[slot]);
+
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        chunk = atomic_load_explicit(&counters->shards[shard].chunks[slot / HINATA_ACCESS_CHUNK],
+                                     memory_order_acquire);
+        if (!chunk) {
+            continue;
+        }
+
+        delta = &chunk->deltas[slot % HINATA_ACCESS_CHUNK];
+        views += atomic_exchange_explicit(&delta->views, 0, memory_order_seq_cst);
+        edits += atomic_exchange_explicit(&delta->edits, 0, memory_order_seq_cst);
+        accessed = atomic_exchange_explicit(&delta->accessed, 0, memory_order_seq_cst);
+        if (accessed > update->last_accessed_at) {
+            update->last_accessed_at = accessed;
+        }
+    }
+
+    update->views = views > UINT32_MAX ? UINT32_MAX : (uint32_t)views;
+    update->edits = edits > UINT32_MAX ? UINT32_MAX : (uint32_t)edits;
+
+    progress = atomic_exchange_explicit(&counters->progress[slot], 0, memory_order_relaxed);
+    if (progress & HINATA_ACCESS_PROGRESS_SET) {
+        bits = (uint32_t)progress;
+        memcpy(&update->reading_progress, &bits, sizeof(bits));
+        update->has_progress = true;
+    }
+}
+
+/**
+ * 合并失败时把取走的增量放回，保留到下次合并
+ * 计数放回第一个已有的块，所有块重新标记（包括还没取走的）；
+ * 合并期间又设置过的阅读进度比取走的新，不覆盖
+ */
+static void hinata_access_restore(hinata_access_counters_t *counters, uint32_t slot,
+                                  const hinata_access_update_t *update)
+{
+    hinata_access_chunk_t *chunk;
+    hinata_access_delta_t *delta;
+    uint64_t expected = 0;
+    uint32_t bits, shard;
+    bool restored = false;
+
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        chunk = atomic_load_explicit(&counters->shards[shard].chunks[slot / HINATA_ACCESS_CHUNK],
+                                     memory_order_acquire);
+        if (!chunk) {
+            continue;
+        }
+
+        if (!restored) {
+            delta = &chunk->deltas[slot % HINATA_ACCESS_CHUNK];
+            atomic_fetch_add_explicit(&delta->views, update->views, memory_order_seq_cst);
+            atomic_fetch_add_explicit(&delta->edits, update->edits, memory_order_seq_cst);
+            hinata_access_touch(&delta->accessed, update->last_accessed_at);
+            restored = true;
+        }
+        atomic_store_explicit(&chunk->touched, true, memory_order_seq_cst);
+    }
+
+    if (update->has_progress) {
+        memcpy(&bits, &update->reading_progress, sizeof(bits));
+        atomic_compare_exchange_strong_explicit(&counters->progress[slot], &expected,
+                                                HINATA_ACCESS_PROGRESS_SET | bits,
+                                                memory_order_relaxed, memory_order_relaxed);
+    }
+}
+
+int hinata_access_merge(hinata_access_counters_t *counters, hinata_access_write_t write,
+                        void *ctx)
+{
+    static const hinata_access_update_t empty;
+    hinata_access_update_t *updates = NULL;
+    uint32_t events[HINATA_ACCESS_SHARDS];
+    uint32_t count = 0, capacity = 0, shard, i, j;
+    uint8_t *dirty;
+    int ret = 0;
+
+    if (!counters || !write) {
+        return -EINVAL;
+    }
+    if (!counters->count) {
+        return 0;
+    }
+
+    dirty = calloc(counters->count, 1);
+    if (!dirty) {
+        return -ENOMEM;
+    }
+
+    // 先清零事件数，合并期间的记录计入下一轮
+    for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+        events[shard] = atomic_exchange_explicit(&counters->shards[shard].events, 0,
+                                                 memory_order_relaxed);
+    }
+    hinata_access_mark_dirty(counters, dirty);
+
+    for (i = 0; i < counters->count && !ret; i++) {
+        if (!dirty[i]) {
+            continue;
+        }
+        ret = hinata_vec_reserve((void **)&updates, &capacity, count + 1, sizeof(*updates));
+        if (!ret) {
+            hinata_access_drain(counters, i, &updates[count++]);
+        }
+    }
+
+    if (!ret && count) {
+        ret = write(ctx, updates, count);
+    }
+    if (ret < 0) {
+        for (i = 0, j = 0; i < counters->count; i++) {
+            if (dirty[i]) {
+                hinata_access_restore(counters, i, j < count ? &updates[j++] : &empty);
+            }
+        }
+        for (shard = 0; shard < HINATA_ACCESS_SHARDS; shard++) {
+            atomic_fetch_add_explicit(&counters->shards[shard].events, events[shard],
+                                      memory_order_relaxed);
+        }
+    }
+
+    free(updates);
+    free(dirty);
+    return ret < 0 ? ret : (int)count;
+}
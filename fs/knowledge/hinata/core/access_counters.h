@@ -0,0 +1,147 @@
+/**
+ * HiNATA 访问计数 - C 语言定义
+ *
+ * 浏览次数、编辑次数、最近访问时间和阅读进度变化频繁，每次都写回存储
+ * 意味着为一次页面浏览重写整个物料。这里在内存中累积增量：计数按线程
+ * 分散到多个分片，热门物料的并发浏览不会争用同一缓存行；定期合并时把
+ * 所有物料的增量汇总成一次批量写入。读取时把未合并的增量叠加到存储值上。
+ *
+ * 并发约定：记录、叠加和合并可以并发调用，同一时间只有一个合并；登记新物料
+ * 需要独占访问。合并原子地取走增量，写入完成前这部分增量对叠加不可见。
+ */
+
+#ifndef _HINATA_ACCESS_COUNTERS_H
+#define _HINATA_ACCESS_COUNTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "models.h"
+
+// 分片数，线程首次记录时轮流分配
+#define HINATA_ACCESS_SHARDS 16
+
+// 每个分片按块分配增量，块内的物料数
+#define HINATA_ACCESS_CHUNK 4096
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 一个分片中单个物料的增量
+ */
+typedef struct {
+    atomic_uint views;
+    atomic_uint edits;
+    _Atomic int64_t accessed;       // 0 表示没有新的访问
+} hinata_access_delta_t;
+
+/**
+ * 增量块，touched 表示自上次合并以来有过记录
+ */
+typedef struct {
+    hinata_access_delta_t deltas[HINATA_ACCESS_CHUNK];
+    atomic_bool touched;
+} hinata_access_chunk_t;
+
+/**
+ * 分片：块在首次记录时分配，填充到一个缓存行避免分片之间伪共享
+ */
+typedef struct {
+    _Atomic(hinata_access_chunk_t *) *chunks;
+    atomic_uint events;
+    char padding[64 - sizeof(void *) - sizeof(atomic_uint)];
+} hinata_access_shard_t;
+
+/**
+ * 合并时交给存储层的一条更新
+ */
+typedef struct {
+    hinata_uuid_t id;
+    uint32_t views;
+    uint32_t edits;
+    hinata_timestamp_t last_accessed_at;    // 0 表示没有新的访问
+    float reading_progress;
+    bool has_progress;
+} hinata_access_update_t;
+
+/**
+ * 批量写入回调，返回 0 或负的 errno；失败时增量保留到下次合并
+ */
+typedef int (*hinata_access_write_t)(void *ctx, const hinata_access_update_t *updates,
+                                     uint32_t count);
+
+/**
+ * 访问计数
+ */
+typedef struct {
+    hinata_uuid_t *ids;
+    uint32_t count;
+    uint32_t capacity;
+
+    // 物料 ID -> 槽位 + 1
+    uint32_t *slots;
+    uint32_t slot_capacity;
+
+    // 阅读进度只保留最后一次设置的值：高 32 位为 1 表示有未合并的值，低 32 位为 float
+    _Atomic uint64_t *progress;
+
+    hinata_access_shard_t shards[HINATA_ACCESS_SHARDS];
+    uint32_t chunk_capacity;                // 每个分片的块指针数
+} hinata_access_counters_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_access_init(hinata_access_counters_t *counters);
+void hinata_access_free(hinata_access_counters_t *counters);
+
+/**
+ * 登记物料（独占），已登记时返回原槽位；lookup 未登记时返回 -ENOENT
+ */
+int hinata_access_register(hinata_access_counters_t *counters, const char *id, uint32_t *slot);
+int hinata_access_lookup(const hinata_access_counters_t *counters, const char *id,
+                         uint32_t *slot);
+
+/**
+ * 记录（可并发）
+ * view 和 edit 同时更新最近访问时间；progress 取值 [0, 1]
+ */
+int hinata_access_record_view(hinata_access_counters_t *counters, uint32_t slot,
+                              hinata_timestamp_t now);
+int hinata_access_record_edit(hinata_access_counters_t *counters, uint32_t slot,
+                              hinata_timestamp_t now);
+int hinata_access_set_progress(hinata_access_counters_t *counters, uint32_t slot,
+                               float progress);
+
+/**
+ * 读取（可并发）
+ * pending 汇总某个物料未合并的增量；overlay 把它叠加到 item 上，
+ * 未登记的物料保持不变
+ */
+int hinata_access_pending(const hinata_access_counters_t *counters, uint32_t slot,
+                          hinata_access_update_t *update);
+void hinata_access_overlay(const hinata_access_counters_t *counters, hinata_library_item_t *item);
+void hinata_access_apply(const hinata_access_update_t *update, hinata_library_item_t *item);
+
+/**
+ * 自上次合并以来记录的事件数，用于决定何时合并
+ */
+uint64_t hinata_access_event_count(const hinata_access_counters_t *counters);
+
+/**
+ * 合并（可与记录并发）：取走所有物料的增量，调用一次 write；
+ * 失败时放回增量，成功返回写入的条数
+ */
+int hinata_access_merge(hinata_access_counters_t *counters, hinata_access_write_t write,
+                        void *ctx);
+
+#endif /* _HINATA_ACCESS_COUNTERS_H */
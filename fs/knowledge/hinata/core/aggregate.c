@@ -0,0 +1,449 @@
+/**
+ * HiNATA 聚合 - C 语言实现
+ */
+
+#include "aggregate.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 跨分区聚合的最大线程数
+#define HINATA_AGGREGATE_MAX_THREADS 64
+
+/**
+ * 跨分区聚合的工作线程，从共享计数器领取分区
+ */
+typedef struct {
+    const hinata_partition_set_t *set;
+    const hinata_search_filters_t *filters;
+    hinata_timestamp_t time_width;
+    atomic_uint *next;
+    hinata_aggregate_t partial;
+    int ret;
+} hinata_aggregate_worker_t;
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_aggregate_init(hinata_aggregate_t *result)
+{
+    memset(result, 0, sizeof(*result));
+}
+
+void hinata_aggregate_free(hinata_aggregate_t *result)
+{
+    if (!result) {
+        return;
+    }
+
+    free(result->tags);
+    free(result->times);
+    hinata_aggregate_init(result);
+}
+
+/**
+ * 清空计数，保留已分配的行
+ */
+static void hinata_aggregate_reset(hinata_aggregate_t *result)
+{
+    result->total = 0;
+    memset(result->formats, 0, sizeof(result->formats));
+    result->no_format = 0;
+    memset(result->access, 0, sizeof(result->access));
+    result->with_attachments = 0;
+    result->tag_count = 0;
+    result->time_count = 0;
+}
+
+// ============================================================================
+// 行的追加与合并
+// ============================================================================
+
+static int hinata_aggregate_push_tag(hinata_aggregate_t *result, const char *tag, uint64_t count)
+{
+    hinata_aggregate_tag_t *row;
+    size_t len = strlen(tag);
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&result->tags, &result->tag_capacity,
+                             result->tag_count + 1, sizeof(*result->tags));
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (len > HINATA_MAX_TAG_LEN - 1) {
+        len = HINATA_MAX_TAG_LEN - 1;
+    }
+    row = &result->tags[result->tag_count++];
+    memcpy(row->tag, tag, len);
+    row->tag[len] = '\0';
+    row->count = count;
+    return 0;
+}
+
+static int hinata_aggregate_push_time(hinata_aggregate_t *result, hinata_timestamp_t start,
+                                      uint64_t count)
+{
+    int ret;
+
+    // 输入按时间升序，同一直方图桶的索引桶相邻
+    if (result->time_count && result->times[result->time_count - 1].start == start) {
+        result->times[result->time_count - 1].count += count;
+        return 0;
+    }
+
+    ret = hinata_vec_reserve((void **)&result->times, &result->time_capacity,
+                             result->time_count + 1, sizeof(*result->times));
+    if (ret < 0) {
+        return ret;
+    }
+
+    result->times[result->time_count].start = start;
+    result->times[result->time_count].count = count;
+    result->time_count++;
+    return 0;
+}
+
+/**
+ * 把 src 的计数和行追加到 dest，行在 hinata_aggregate_finish 中合并
+ */
+static int hinata_aggregate_append(hinata_aggregate_t *dest, const hinata_aggregate_t *src)
+{
+    uint32_t i;
+    int ret;
+
+    dest->total += src->total;
+    for (i = 0; i < 7; i++) {
+        dest->formats[i] += src->formats[i];
+    }
+    dest->no_format += src->no_format;
+    for (i = 0; i < 4; i++) {
+        dest->access[i] += src->access[i];
+    }
+    dest->with_attachments += src->with_attachments;
+
+    ret = hinata_vec_reserve((void **)&dest->tags, &dest->tag_capacity,
+                             dest->tag_count + src->tag_count, sizeof(*dest->tags));
+    if (!ret) {
+        ret = hinata_vec_reserve((void **)&dest->times, &dest->time_capacity,
+                                 dest->time_count + src->time_count, sizeof(*dest->times));
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (src->tag_count) {
+        memcpy(dest->tags + dest->tag_count, src->tags, src->tag_count * sizeof(*src->tags));
+        dest->tag_count += src->tag_count;
+    }
+    if (src->time_count) {
+        memcpy(dest->times + dest->time_count, src->times,
+               src->time_count * sizeof(*src->times));
+        dest->time_count += src->time_count;
+    }
+    return 0;
+}
+
+static int hinata_aggregate_tag_by_name(const void *a, const void *b)
+{
+    return strcmp(((const hinata_aggregate_tag_t *)a)->tag,
+                  ((const hinata_aggregate_tag_t *)b)->tag);
+}
+
+static int hinata_aggregate_tag_by_count(const void *a, const void *b)
+{
+    const hinata_aggregate_tag_t *x = a, *y = b;
+
+    if (x->count != y->count) {
+        return x->count > y->count ? -1 : 1;
+    }
+    return strcmp(x->tag, y->tag);
+}
+
+static int hinata_aggregate_time_by_start(const void *a, const void *b)
+{
+    const hinata_aggregate_time_t *x = a, *y = b;
+
+    if (x->start != y->start) {
+        return x->start < y->start ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * 合并同名标签和同一起点的时间行，排序并截断标签
+ */
+static void hinata_aggregate_finish(hinata_aggregate_t *result, uint32_t tag_limit)
+{
+    uint32_t i, n;
+
+    if (result->tag_count > 1) {
+        qsort(result->tags, result->tag_count, sizeof(*result->tags),
+              hinata_aggregate_tag_by_name);
+        for (i = 1, n = 0; i < result->tag_count; i++) {
+            if (strcmp(result->tags[n].tag, result->tags[i].tag) == 0) {
+                result->tags[n].count += result->tags[i].count;
+            } else {
+                result->tags[++n] = result->tags[i];
+            }
+        }
+        result->tag_count = n + 1;
+        qsort(result->tags, result->tag_count, sizeof(*result->tags),
+              hinata_aggregate_tag_by_count);
+    }
+    if (result->tag_count > tag_limit) {
+        result->tag_count = tag_limit;
+    }
+
+    if (result->time_count > 1) {
+        qsort(result->times, result->time_count, sizeof(*result->times),
+              hinata_aggregate_time_by_start);
+        for (i = 1, n = 0; i < result->time_count; i++) {
+            if (result->times[n].start == result->times[i].start) {
+                result->times[n].count += result->times[i].count;
+            } else {
+                result->times[++n] = result->times[i];
+            }
+        }
+        result->time_count = n + 1;
+    }
+}
+
+// ============================================================================
+// 单个索引
+// ============================================================================
+
+/**
+ * 向下取整到 width 的整数倍
+ */
+static hinata_timestamp_t hinata_aggregate_floor(hinata_timestamp_t ts, hinata_timestamp_t width)
+{
+    hinata_timestamp_t start = ts / width * width;
+
+    return start > ts ? start - width : start;
+}
+
+/**
+ * 把一个索引的聚合累加到 result，标签行不合并、不截断
+ */
+static int hinata_aggregate_collect(const hinata_filter_index_t *index,
+                                    const hinata_search_filters_t *filters,
+                                    hinata_timestamp_t time_width, hinata_aggregate_t *result)
+{
+    const hinata_filter_bucket_t *bucket;
+    hinata_bitmap_t set;
+    uint64_t total, count, formatted = 0;
+    const char *name;
+    uint32_t i;
+    int ret;
+
+    if (!time_width) {
+        time_width = index->bucket_width;
+    }
+
+    hinata_bitmap_init(&set);
+    ret = hinata_filter_index_evaluate(index, filters, &set);
+    total = hinata_bitmap_cardinality(&set);
+    if (ret < 0 || !total) {
+        hinata_bitmap_free(&set);
+        return ret;
+    }
+
+    result->total += total;
+    for (i = 0; i < 7; i++) {
+        count = hinata_bitmap_and_cardinality(&set, &index->formats[i]);
+        result->formats[i] += count;
+        formatted += count;
+    }
+    result->no_format += total - formatted;
+    for (i = 0; i < 4; i++) {
+        result->access[i] += hinata_bitmap_and_cardinality(&set, &index->access[i]);
+    }
+    result->with_attachments += hinata_bitmap_and_cardinality(&set, &index->attachments);
+
+    for (i = 0; i < index->tag_docs_capacity && !ret; i++) {
+        if (!index->tag_docs[i].count) {
+            continue;
+        }
+        count = hinata_bitmap_and_cardinality(&set, &index->tag_docs[i]);
+        name = hinata_tag_dict_name(&index->tags, i);
+        if (count && name) {
+            ret = hinata_aggregate_push_tag(result, name, count);
+        }
+    }
+
+    for (i = 0; i < index->bucket_count && !ret; i++) {
+        bucket = &index->buckets[i];
+        count = hinata_bitmap_and_cardinality(&set, &bucket->docs);
+        if (count) {
+            ret = hinata_aggregate_push_time(
+                result, hinata_aggregate_floor(bucket->bucket * index->bucket_width, time_width),
+                count);
+        }
+    }
+
+    hinata_bitmap_free(&set);
+    return ret;
+}
+
+/**
+ * 时间桶宽必须是索引桶宽的整数倍，否则一个索引桶会横跨两个结果桶
+ */
+static bool hinata_aggregate_width_valid(const hinata_aggregate_options_t *options,
+                                         hinata_timestamp_t bucket_width)
+{
+    if (!options || !options->time_width) {
+        return true;
+    }
+    if (bucket_width <= 0) {
+        bucket_width = HINATA_FILTER_BUCKET_WIDTH;
+    }
+
+    return options->time_width > 0 && options->time_width % bucket_width == 0;
+}
+
+static uint32_t hinata_aggregate_tag_limit(const hinata_aggregate_options_t *options)
+{
+    return options && options->tag_limit ? options->tag_limit : HINATA_AGGREGATE_TAG_LIMIT;
+}
+
+int hinata_aggregate_index(const hinata_filter_index_t *index,
+                           const hinata_search_filters_t *filters,
+                           const hinata_aggregate_options_t *options, hinata_aggregate_t *result)
+{
+    int ret;
+
+    if (!index || !result || !hinata_aggregate_width_valid(options, index->bucket_width)) {
+        return -EINVAL;
+    }
+
+    hinata_aggregate_reset(result);
+    ret = hinata_aggregate_collect(index, filters, options ? options->time_width : 0, result);
+    if (ret < 0) {
+        hinata_aggregate_reset(result);
+        return ret;
+    }
+
+    hinata_aggregate_finish(result, hinata_aggregate_tag_limit(options));
+    return 0;
+}
+
+// ============================================================================
+// 分区集合
+// ============================================================================
+
+static void *hinata_aggregate_worker(void *arg)
+{
+    hinata_aggregate_worker_t *worker = arg;
+    const hinata_partition_t *partition;
+    uint32_t i;
+
+    while (!worker->ret) {
+        i = atomic_fetch_add(worker->next, 1);
+        if (i >= worker->set->partition_count) {
+            break;
+        }
+        partition = worker->set->partitions[i];
+        if (partition) {
+            worker->ret = hinata_aggregate_collect(&partition->filters, worker->filters,
+                                                   worker->time_width, &worker->partial);
+        }
+    }
+
+    return NULL;
+}
+
+int hinata_aggregate_partitions(const hinata_partition_set_t *set,
+                                const hinata_search_filters_t *filters,
+                                const hinata_aggregate_options_t *options,
+                                hinata_aggregate_t *result)
+{
+    hinata_aggregate_worker_t *workers;
+    const hinata_partition_t *partition;
+    pthread_t threads[HINATA_AGGREGATE_MAX_THREADS];
+    bool started[HINATA_AGGREGATE_MAX_THREADS];
+    hinata_timestamp_t time_width;
+    atomic_uint next;
+    uint32_t count, i;
+    int ret = 0;
+
+    if (!set || !result || !hinata_aggregate_width_valid(options, set->bucket_width)) {
+        return -EINVAL;
+    }
+
+    hinata_aggregate_reset(result);
+    time_width = options ? options->time_width : 0;
+
+    // 带 user_id 的查询只涉及一个分区
+    if (filters && filters->has_user_id) {
+        partition = hinata_partition_set_user(set, filters->user_id);
+        if (partition) {
+            ret = hinata_aggregate_collect(&partition->filters, filters, time_width, result);
+        }
+        if (ret < 0) {
+            hinata_aggregate_reset(result);
+            return ret;
+        }
+        hinata_aggregate_finish(result, hinata_aggregate_tag_limit(options));
+        return 0;
+    }
+
+    count = options && options->threads ? options->threads : 1;
+    if (count > set->partition_count) {
+        count = set->partition_count;
+    }
+    if (count > HINATA_AGGREGATE_MAX_THREADS) {
+        count = HINATA_AGGREGATE_MAX_THREADS;
+    }
+    if (!count) {
+        return 0;
+    }
+
+    workers = calloc(count, sizeof(*workers));
+    if (!workers) {
+        return -ENOMEM;
+    }
+
+    atomic_init(&next, 0);
+    for (i = 0; i < count; i++) {
+        workers[i].set = set;
+        workers[i].filters = filters;
+        workers[i].time_width = time_width;
+        workers[i].next = &next;
+        hinata_aggregate_init(&workers[i].partial);
+    }
+
+    // 第 0 个在调用线程中运行；线程创建失败时剩下的分区由其他线程领取
+    for (i = 1; i < count; i++) {
+        started[i] = pthread_create(&threads[i], NULL, hinata_aggregate_worker, &workers[i]) == 0;
+    }
+    hinata_aggregate_worker(&workers[0]);
+    for (i = 1; i < count; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (!ret) {
+            ret = workers[i].ret;
+        }
+        if (!ret) {
+            ret = hinata_aggregate_append(result, &workers[i].partial);
+        }
+        hinata_aggregate_free(&workers[i].partial);
+    }
+    free(workers);
+
+    if (ret < 0) {
+        hinata_aggregate_reset(result);
+        return ret;
+    }
+
+    hinata_aggregate_finish(result, hinata_aggregate_tag_limit(options));
+    return 0;
+}
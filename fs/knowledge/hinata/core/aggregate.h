@@ -0,0 +1,106 @@
+/**
+ * HiNATA 聚合 - C 语言定义
+ *
+ * query.aggregate 需要按内容格式、访问级别、标签和时间统计查询结果的数量。
+ * 这里不取出结果本身：过滤条件先求成候选位图，再与过滤索引中每个格式、
+ * 访问级别、标签和时间桶的位图求交集基数，只返回聚合行。
+ *
+ * 跨分区聚合时各分区互不依赖，由多个线程分别计算后合并；
+ * 标签按名称、时间按桶起点合并，最后再排序和截断。
+ *
+ * 聚合只读取索引，调用期间由调用方保证索引不被修改。
+ */
+
+#ifndef _HINATA_AGGREGATE_H
+#define _HINATA_AGGREGATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "filter_index.h"
+#include "partition.h"
+
+// 默认返回的标签行数，与 query.aggregate 一致
+#define HINATA_AGGREGATE_TAG_LIMIT 20
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 聚合选项
+ */
+typedef struct {
+    hinata_timestamp_t time_width;  // 时间直方图的桶宽，须为索引桶宽的整数倍，0 表示使用索引的桶宽
+    uint32_t tag_limit;             // 0 表示使用 HINATA_AGGREGATE_TAG_LIMIT
+    uint32_t threads;               // 跨分区聚合的线程数，0 或 1 在调用线程中计算
+} hinata_aggregate_options_t;
+
+/**
+ * 标签行
+ */
+typedef struct {
+    char tag[HINATA_MAX_TAG_LEN];
+    uint64_t count;
+} hinata_aggregate_tag_t;
+
+/**
+ * 时间行：[start, start + time_width) 内的数量
+ */
+typedef struct {
+    hinata_timestamp_t start;
+    uint64_t count;
+} hinata_aggregate_time_t;
+
+/**
+ * 聚合结果
+ */
+typedef struct {
+    uint64_t total;
+    uint64_t formats[7];
+    uint64_t no_format;             // 没有内容格式的文档（如知识块）
+    uint64_t access[4];
+    uint64_t with_attachments;
+
+    // 按数量降序，数量相同时按名称升序
+    hinata_aggregate_tag_t *tags;
+    uint32_t tag_count;
+    uint32_t tag_capacity;
+
+    // 按时间升序，只包含非空的桶
+    hinata_aggregate_time_t *times;
+    uint32_t time_count;
+    uint32_t time_capacity;
+} hinata_aggregate_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_aggregate_init(hinata_aggregate_t *result);
+void hinata_aggregate_free(hinata_aggregate_t *result);
+
+/**
+ * 聚合单个过滤索引中满足 filters 的文档，结果覆盖写入 result
+ * filters 和 options 可为 NULL；time_width 不是索引桶宽的整数倍时返回 -EINVAL
+ */
+int hinata_aggregate_index(const hinata_filter_index_t *index,
+                           const hinata_search_filters_t *filters,
+                           const hinata_aggregate_options_t *options, hinata_aggregate_t *result);
+
+/**
+ * 聚合分区集合：filters 带 user_id 时只聚合该用户的分区，
+ * 否则按 options->threads 并行聚合所有分区
+ */
+int hinata_aggregate_partitions(const hinata_partition_set_t *set,
+                                const hinata_search_filters_t *filters,
+                                const hinata_aggregate_options_t *options,
+                                hinata_aggregate_t *result);
+
+#endif /* _HINATA_AGGREGATE_H */
@@ -0,0 +1,311 @@
+/**
+ * HiNATA 反向链接维护 - C 语言实现
+ */
+
+#include "backlinks.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// 内部工具函数
+// ============================================================================
+
+static int hinata_backlinks_edge_cmp(const void *a, const void *b)
+{
+    const hinata_graph_edge_t *x = a;
+    const hinata_graph_edge_t *y = b;
+
+    if (x->node != y->node) {
+        return x->node < y->node ? -1 : 1;
+    }
+    return 0;
+}
+
+static int hinata_backlinks_uuid_cmp(const void *a, const void *b)
+{
+    return strncmp(a, b, HINATA_UUID_LEN);
+}
+
+/**
+ * 收集指向 target 的来源节点，按节点 ID 去重（多种引用类型只算一次）
+ */
+static int hinata_backlinks_sources(hinata_backlink_store_t *store, const hinata_uuid_t target,
+                                    hinata_graph_edge_vec_t *edges)
+{
+    hinata_node_id_t id;
+    uint32_t i, n = 0;
+    int ret;
+
+    edges->count = 0;
+
+    ret = hinata_graph_node_id(&store->graph, target, false, &id);
+    if (ret == -ENOENT) {
+        return 0;
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = hinata_graph_neighbors(&store->graph, id, HINATA_EDGE_IN, HINATA_EDGE_TYPES_ALL, edges);
+    if (ret < 0 || edges->count < 2) {
+        return ret;
+    }
+
+    qsort(edges->items, edges->count, sizeof(*edges->items), hinata_backlinks_edge_cmp);
+    for (i = 1; i < edges->count; i++) {
+        if (edges->items[i].node != edges->items[n].node) {
+            edges->items[++n] = edges->items[i];
+        }
+    }
+    edges->count = n + 1;
+    return 0;
+}
+
+/**
+ * 复制块的引用列表，排序并去重
+ */
+static int hinata_backlinks_sorted_refs(const hinata_compact_block_t *block,
+                                        hinata_uuid_t **refs, uint32_t *count)
+{
+    uint32_t unique = 1;
+    uint32_t i;
+
+    *refs = NULL;
+    *count = block ? block->references.count : 0;
+    if (*count == 0) {
+        return 0;
+    }
+
+    *refs = malloc(*count * sizeof(**refs));
+    if (!*refs) {
+        return -ENOMEM;
+    }
+
+    memcpy(*refs, block->references.items, *count * sizeof(**refs));
+    qsort(*refs, *count, sizeof(**refs), hinata_backlinks_uuid_cmp);
+
+    // 去重，否则旧 [A,A] 与新 [A] 归并时会多出一次删除
+    for (i = 1; i < *count; i++) {
+        if (hinata_backlinks_uuid_cmp((*refs)[i], (*refs)[unique - 1]) != 0) {
+            hinata_uuid_assign((*refs)[unique++], (*refs)[i]);
+        }
+    }
+    *count = unique;
+    return 0;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_backlinks_init(hinata_backlink_store_t *store)
+{
+    memset(store, 0, sizeof(*store));
+    hinata_graph_init(&store->graph, 0);
+    store->merge_threshold = store->graph.merge_threshold;
+}
+
+void hinata_backlinks_free(hinata_backlink_store_t *store)
+{
+    if (!store) {
+        return;
+    }
+
+    hinata_graph_free(&store->graph);
+    hinata_backlinks_init(store);
+}
+
+// ============================================================================
+// 引用增删
+// ============================================================================
+
+int hinata_backlinks_insert(hinata_backlink_store_t *store, const hinata_uuid_t source,
+                            const hinata_uuid_t target, hinata_reference_type_t type)
+{
+    int ret;
+
+    if (!store) {
+        return -EINVAL;
+    }
+
+    // 批量导入时跳过存在性检查，避免每次扫描不断增长的日志
+    if (store->bulk) {
+        ret = hinata_graph_append_edge(&store->graph, source, target, type);
+    } else {
+        ret = hinata_graph_add_edge(&store->graph, source, target, type);
+    }
+    if (!ret) {
+        store->inserts++;
+    }
+
+    return ret;
+}
+
+int hinata_backlinks_delete(hinata_backlink_store_t *store, const hinata_uuid_t source,
+                            const hinata_uuid_t target, hinata_reference_type_t type)
+{
+    int ret;
+
+    if (!store) {
+        return -EINVAL;
+    }
+
+    ret = hinata_graph_remove_edge(&store->graph, source, target, type);
+    if (!ret) {
+        store->deletes++;
+    }
+
+    return ret;
+}
+
+int hinata_backlinks_update_block(hinata_backlink_store_t *store,
+                                  const hinata_compact_block_t *old_block,
+                                  const hinata_compact_block_t *new_block)
+{
+    const hinata_compact_block_t *block = new_block ? new_block : old_block;
+    hinata_uuid_t *old_refs = NULL;
+    hinata_uuid_t *new_refs = NULL;
+    uint32_t old_count, new_count;
+    uint32_t i = 0, j = 0;
+    int cmp;
+    int ret;
+
+    if (!store || !block) {
+        return -EINVAL;
+    }
+
+    ret = hinata_backlinks_sorted_refs(old_block, &old_refs, &old_count);
+    if (!ret) {
+        ret = hinata_backlinks_sorted_refs(new_block, &new_refs, &new_count);
+    }
+
+    // 两个有序列表归并，只为差异部分追加记录
+    while (!ret && (i < old_count || j < new_count)) {
+        if (i == old_count) {
+            cmp = 1;
+        } else if (j == new_count) {
+            cmp = -1;
+        } else {
+            cmp = hinata_backlinks_uuid_cmp(old_refs[i], new_refs[j]);
+        }
+
+        if (cmp < 0) {
+            ret = hinata_backlinks_delete(store, block->id, old_refs[i++], HINATA_REF_STRONG);
+            if (ret == -ENOENT) {
+                ret = 0;
+            }
+        } else if (cmp > 0) {
+            ret = hinata_backlinks_insert(store, block->id, new_refs[j++], HINATA_REF_STRONG);
+        } else {
+            i++;
+            j++;
+        }
+    }
+
+    free(old_refs);
+    free(new_refs);
+    return ret;
+}
+
+// ============================================================================
+// 批量导入与压缩
+// ============================================================================
+
+void hinata_backlinks_bulk_begin(hinata_backlink_store_t *store)
+{
+    if (store->bulk) {
+        return;
+    }
+
+    store->bulk = true;
+    store->merge_threshold = store->graph.merge_threshold;
+    store->graph.merge_threshold = UINT32_MAX;
+}
+
+int hinata_backlinks_bulk_end(hinata_backlink_store_t *store)
+{
+    if (!store->bulk) {
+        return 0;
+    }
+
+    store->bulk = false;
+    store->graph.merge_threshold = store->merge_threshold;
+    return hinata_backlinks_compact(store);
+}
+
+int hinata_backlinks_compact(hinata_backlink_store_t *store)
+{
+    int ret;
+
+    if (!store) {
+        return -EINVAL;
+    }
+    if (store->graph.delta_count == 0) {
+        return 0;
+    }
+
+    ret = hinata_graph_merge(&store->graph);
+    if (!ret) {
+        store->compactions++;
+    }
+
+    return ret;
+}
+
+// ============================================================================
+// 读取
+// ============================================================================
+
+uint32_t hinata_backlinks_count(hinata_backlink_store_t *store, const hinata_uuid_t target)
+{
+    hinata_graph_edge_vec_t edges = { 0 };
+    uint32_t count = 0;
+
+    if (store && target && hinata_backlinks_sources(store, target, &edges) == 0) {
+        count = edges.count;
+    }
+
+    hinata_graph_edge_vec_free(&edges);
+    return count;
+}
+
+int hinata_backlinks_get(hinata_backlink_store_t *store, const hinata_uuid_t target,
+                         hinata_uuid_vec_t *out)
+{
+    hinata_graph_edge_vec_t edges = { 0 };
+    uint32_t i;
+    int ret;
+
+    if (!store || !target || !out) {
+        return -EINVAL;
+    }
+
+    out->count = 0;
+
+    ret = hinata_backlinks_sources(store, target, &edges);
+    if (!ret) {
+        ret = hinata_vec_reserve((void **)&out->items, &out->capacity, edges.count,
+                                 sizeof(*out->items));
+    }
+    for (i = 0; !ret && i < edges.count; i++) {
+        hinata_uuid_assign(out->items[i],
+                           hinata_graph_node_uuid(&store->graph, edges.items[i].node));
+    }
+    if (!ret) {
+        out->count = edges.count;
+    }
+
+    hinata_graph_edge_vec_free(&edges);
+    return ret;
+}
+
+int hinata_backlinks_fill_block(hinata_backlink_store_t *store, hinata_compact_block_t *block)
+{
+    if (!block) {
+        return -EINVAL;
+    }
+
+    return hinata_backlinks_get(store, block->id, &block->backlinks);
+}
@@ -0,0 +1,85 @@
+/**
+ * HiNATA 反向链接维护 - C 语言定义
+ *
+ * 添加或删除引用只向关系图索引的 delta 日志追加一条边记录，
+ * 不再读改写目标块的 backlinks 数组。反向链接集合在读取时由反向 CSR
+ * 与日志合并得到，日志由后台压缩进 CSR，数量没有上限。
+ */
+
+#ifndef _HINATA_BACKLINKS_H
+#define _HINATA_BACKLINKS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+#include "graph_index.h"
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 反向链接存储
+ */
+typedef struct {
+    hinata_graph_index_t graph;
+    uint32_t merge_threshold;   // 批量导入期间保存的原阈值
+    bool bulk;
+
+    // 统计信息
+    uint64_t inserts;
+    uint64_t deletes;
+    uint64_t compactions;
+} hinata_backlink_store_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_backlinks_init(hinata_backlink_store_t *store);
+void hinata_backlinks_free(hinata_backlink_store_t *store);
+
+/**
+ * 记录引用的增删，只追加边记录
+ */
+int hinata_backlinks_insert(hinata_backlink_store_t *store, const hinata_uuid_t source,
+                            const hinata_uuid_t target, hinata_reference_type_t type);
+int hinata_backlinks_delete(hinata_backlink_store_t *store, const hinata_uuid_t source,
+                            const hinata_uuid_t target, hinata_reference_type_t type);
+
+/**
+ * 根据块修改前后的引用集合追加增删记录
+ * old_block 为 NULL 表示新建，new_block 为 NULL 表示删除
+ */
+int hinata_backlinks_update_block(hinata_backlink_store_t *store,
+                                  const hinata_compact_block_t *old_block,
+                                  const hinata_compact_block_t *new_block);
+
+/**
+ * 批量导入：期间不自动压缩，结束时一次性压缩
+ */
+void hinata_backlinks_bulk_begin(hinata_backlink_store_t *store);
+int hinata_backlinks_bulk_end(hinata_backlink_store_t *store);
+
+/**
+ * 后台压缩：把边记录合并进 CSR
+ */
+int hinata_backlinks_compact(hinata_backlink_store_t *store);
+
+/**
+ * 读取反向链接
+ * count 只统计数量；get 覆盖 out 原有内容；fill_block 写入块的 backlinks 向量
+ */
+uint32_t hinata_backlinks_count(hinata_backlink_store_t *store, const hinata_uuid_t target);
+int hinata_backlinks_get(hinata_backlink_store_t *store, const hinata_uuid_t target,
+                         hinata_uuid_vec_t *out);
+int hinata_backlinks_fill_block(hinata_backlink_store_t *store, hinata_compact_block_t *block);
+
+#endif /* _HINATA_BACKLINKS_H */
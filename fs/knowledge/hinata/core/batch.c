@@ -0,0 +1,626 @@
+/**
+ * HiNATA 二进制批量操作 - C 语言实现
+ */
+
+#include "batch.h"
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 操作记录的最小长度：长度、类型、目标、字段数和 ID 长度
+#define HINATA_BATCH_OP_MIN_SIZE 10
+#define HINATA_BATCH_OP_PREFIX 4
+
+// ============================================================================
+// 小端序读写
+// ============================================================================
+
+static void hinata_batch_store_u16(uint8_t *dest, uint16_t value)
+{
+    dest[0] = (uint8_t)value;
+    dest[1] = (uint8_t)(value >> 8);
+}
+
+static void hinata_batch_store_u32(uint8_t *dest, uint32_t value)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        dest[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void hinata_batch_store_u64(uint8_t *dest, uint64_t value)
+{
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        dest[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint16_t hinata_batch_load_u16(const uint8_t *src)
+{
+    return (uint16_t)(src[0] | (src[1] << 8));
+}
+
+static uint32_t hinata_batch_load_u32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) |
+           ((uint32_t)src[3] << 24);
+}
+
+static uint64_t hinata_batch_load_u64(const uint8_t *src)
+{
+    uint64_t value = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--) {
+        value = (value << 8) | src[i];
+    }
+    return value;
+}
+
+// ============================================================================
+// 编码
+// ============================================================================
+
+/**
+ * 在末尾预留 length 字节并返回其起始位置
+ */
+static uint8_t *hinata_batch_grow(hinata_batch_writer_t *writer, size_t length)
+{
+    uint8_t *dest;
+
+    if (length > UINT32_MAX - writer->size) {
+        return NULL;
+    }
+    if (hinata_vec_reserve((void **)&writer->data, &writer->capacity,
+                           writer->size + (uint32_t)length, 1) < 0) {
+        return NULL;
+    }
+
+    dest = writer->data + writer->size;
+    writer->size += (uint32_t)length;
+    return dest;
+}
+
+int hinata_batch_writer_init(hinata_batch_writer_t *writer)
+{
+    uint8_t *header;
+
+    if (!writer) {
+        return -EINVAL;
+    }
+
+    memset(writer, 0, sizeof(*writer));
+    header = hinata_batch_grow(writer, HINATA_BATCH_HEADER_SIZE);
+    if (!header) {
+        return -ENOMEM;
+    }
+
+    memcpy(header, HINATA_BATCH_MAGIC, 4);
+    hinata_batch_store_u16(header + 4, HINATA_BATCH_VERSION);
+    hinata_batch_store_u16(header + 6, 0);
+    hinata_batch_store_u32(header + 8, 0);
+    return 0;
+}
+
+void hinata_batch_writer_free(hinata_batch_writer_t *writer)
+{
+    if (!writer) {
+        return;
+    }
+
+    free(writer->data);
+    memset(writer, 0, sizeof(*writer));
+}
+
+int hinata_batch_begin_op(hinata_batch_writer_t *writer, hinata_batch_operation_type_t type,
+                          hinata_batch_target_t target, const char *id)
+{
+    const char *nul;
+    uint8_t *dest;
+    size_t id_len = 0;
+    uint32_t start;
+
+    if (!writer || !writer->data || writer->op_start) {
+        return -EINVAL;
+    }
+    if ((unsigned)type > HINATA_BATCH_DELETE || (unsigned)target >= HINATA_BATCH_TARGET_COUNT) {
+        return -EINVAL;
+    }
+    if (writer->op_count == UINT32_MAX) {
+        return -EOVERFLOW;
+    }
+
+    if (id) {
+        nul = memchr(id, '\0', HINATA_UUID_LEN);
+        id_len = nul ? (size_t)(nul - id) : HINATA_UUID_LEN - 1;
+    }
+
+    start = writer->size;
+    dest = hinata_batch_grow(writer, HINATA_BATCH_OP_MIN_SIZE + id_len);
+    if (!dest) {
+        return -ENOMEM;
+    }
+
+    // 记录长度和字段数在 end_op 中回填
+    hinata_batch_store_u32(dest, 0);
+    dest[4] = (uint8_t)type;
+    dest[5] = (uint8_t)target;
+    hinata_batch_store_u16(dest + 6, 0);
+    hinata_batch_store_u16(dest + 8, (uint16_t)id_len);
+    if (id_len) {
+        memcpy(dest + HINATA_BATCH_OP_MIN_SIZE, id, id_len);
+    }
+
+    writer->op_start = start;
+    writer->field_count = 0;
+    return 0;
+}
+
+/**
+ * 写入字段头部，返回值的写入位置
+ */
+static uint8_t *hinata_batch_put_field(hinata_batch_writer_t *writer, const char *key,
+                                       hinata_batch_value_type_t type, size_t value_len, int *ret)
+{
+    size_t key_len;
+    uint8_t *dest;
+
+    *ret = -EINVAL;
+    if (!writer || !writer->op_start || !key) {
+        return NULL;
+    }
+
+    key_len = strlen(key);
+    *ret = -EOVERFLOW;
+    if (key_len > UINT16_MAX || writer->field_count == UINT16_MAX) {
+        return NULL;
+    }
+
+    *ret = -ENOMEM;
+    dest = hinata_batch_grow(writer, 3 + key_len + value_len);
+    if (!dest) {
+        return NULL;
+    }
+
+    dest[0] = (uint8_t)type;
+    hinata_batch_store_u16(dest + 1, (uint16_t)key_len);
+    memcpy(dest + 3, key, key_len);
+    writer->field_count++;
+    *ret = 0;
+    return dest + 3 + key_len;
+}
+
+int hinata_batch_put_null(hinata_batch_writer_t *writer, const char *key)
+{
+    int ret;
+
+    hinata_batch_put_field(writer, key, HINATA_BATCH_VALUE_NULL, 0, &ret);
+    return ret;
+}
+
+int hinata_batch_put_bool(hinata_batch_writer_t *writer, const char *key, bool value)
+{
+    uint8_t *dest;
+    int ret;
+
+    dest = hinata_batch_put_field(writer, key, HINATA_BATCH_VALUE_BOOL, 1, &ret);
+    if (dest) {
+        dest[0] = value ? 1 : 0;
+    }
+    return ret;
+}
+
+int hinata_batch_put_int(hinata_batch_writer_t *writer, const char *key, int64_t value)
+{
+    uint8_t *dest;
+    int ret;
+
+    dest = hinata_batch_put_field(writer, key, HINATA_BATCH_VALUE_INT, 8, &ret);
+    if (dest) {
+        hinata_batch_store_u64(dest, (uint64_t)value);
+    }
+    return ret;
+}
+
+int hinata_batch_put_double(hinata_batch_writer_t *writer, const char *key, double value)
+{
+    uint64_t bits;
+    uint8_t *dest;
+    int ret;
+
+    dest = hinata_batch_put_field(writer, key, HINATA_BATCH_VALUE_DOUBLE, 8, &ret);
+    if (dest) {
+        memcpy(&bits, &value, sizeof(bits));
+        hinata_batch_store_u64(dest, bits);
+    }
+    return ret;
+}
+
+static int hinata_batch_put_blob(hinata_batch_writer_t *writer, const char *key,
+                                 hinata_batch_value_type_t type, const void *value,
+                                 uint32_t length)
+{
+    uint8_t *dest;
+    int ret;
+
+    if (!value && length) {
+        return -EINVAL;
+    }
+
+    dest = hinata_batch_put_field(writer, key, type, 4 + (size_t)length, &ret);
+    if (dest) {
+        hinata_batch_store_u32(dest, length);
+        if (length) {
+            memcpy(dest + 4, value, length);
+        }
+    }
+    return ret;
+}
+
+int hinata_batch_put_string(hinata_batch_writer_t *writer, const char *key, const char *value)
+{
+    size_t length;
+
+    if (!value) {
+        return -EINVAL;
+    }
+
+    length = strlen(value);
+    if (length > UINT32_MAX) {
+        return -EOVERFLOW;
+    }
+    return hinata_batch_put_blob(writer, key, HINATA_BATCH_VALUE_STRING, value, (uint32_t)length);
+}
+
+int hinata_batch_put_bytes(hinata_batch_writer_t *writer, const char *key, const void *value,
+                           uint32_t length)
+{
+    return hinata_batch_put_blob(writer, key, HINATA_BATCH_VALUE_BYTES, value, length);
+}
+
+int hinata_batch_end_op(hinata_batch_writer_t *writer)
+{
+    uint8_t *record;
+
+    if (!writer || !writer->op_start) {
+        return -EINVAL;
+    }
+
+    record = writer->data + writer->op_start;
+    hinata_batch_store_u32(record, writer->size - writer->op_start - HINATA_BATCH_OP_PREFIX);
+    hinata_batch_store_u16(record + 6, writer->field_count);
+
+    writer->op_count++;
+    writer->op_start = 0;
+    writer->field_count = 0;
+    return 0;
+}
+
+int hinata_batch_finish(hinata_batch_writer_t *writer)
+{
+    if (!writer || !writer->data || writer->op_start) {
+        return -EINVAL;
+    }
+
+    hinata_batch_store_u32(writer->data + 8, writer->op_count);
+    return 0;
+}
+
+int hinata_batch_put_legacy(hinata_batch_writer_t *writer, const hinata_batch_operation_t *op)
+{
+    const char *nul;
+    int ret;
+
+    if (!op) {
+        return -EINVAL;
+    }
+
+    ret = hinata_batch_begin_op(writer, op->type, op->target, op->has_id ? op->id : NULL);
+    if (ret < 0) {
+        return ret;
+    }
+
+    nul = memchr(op->data_json, '\0', sizeof(op->data_json));
+    if (nul != op->data_json) {
+        ret = hinata_batch_put_blob(writer, "data_json", HINATA_BATCH_VALUE_STRING, op->data_json,
+                                    nul ? (uint32_t)(nul - op->data_json) :
+                                    (uint32_t)sizeof(op->data_json));
+    }
+    if (!ret) {
+        ret = hinata_batch_end_op(writer);
+    }
+    if (ret < 0) {
+        // 丢弃写了一半的操作
+        writer->size = writer->op_start ? writer->op_start : writer->size;
+        writer->op_start = 0;
+        writer->field_count = 0;
+    }
+    return ret;
+}
+
+// ============================================================================
+// 解码
+// ============================================================================
+
+/**
+ * 解析一个字段并前移 pos，越界时返回 -EBADMSG
+ */
+static int hinata_batch_parse_field(const uint8_t **pos, const uint8_t *end,
+                                    hinata_batch_field_t *field)
+{
+    const uint8_t *p = *pos;
+    uint64_t bits;
+    uint32_t length;
+
+    if (end - p < 3) {
+        return -EBADMSG;
+    }
+
+    field->type = (hinata_batch_value_type_t)p[0];
+    field->key.length = hinata_batch_load_u16(p + 1);
+    p += 3;
+    if ((size_t)(end - p) < field->key.length) {
+        return -EBADMSG;
+    }
+    field->key.data = (const char *)p;
+    p += field->key.length;
+
+    switch (field->type) {
+    case HINATA_BATCH_VALUE_NULL:
+        break;
+    case HINATA_BATCH_VALUE_BOOL:
+        if (end - p < 1 || p[0] > 1) {
+            return -EBADMSG;
+        }
+        field->boolean = p[0] != 0;
+        p += 1;
+        break;
+    case HINATA_BATCH_VALUE_INT:
+    case HINATA_BATCH_VALUE_DOUBLE:
+        if (end - p < 8) {
+            return -EBADMSG;
+        }
+        bits = hinata_batch_load_u64(p);
+        if (field->type == HINATA_BATCH_VALUE_INT) {
+            field->integer = (int64_t)bits;
+        } else {
+            memcpy(&field->number, &bits, sizeof(bits));
+        }
+        p += 8;
+        break;
+    case HINATA_BATCH_VALUE_STRING:
+    case HINATA_BATCH_VALUE_BYTES:
+        if (end - p < 4) {
+            return -EBADMSG;
+        }
+        length = hinata_batch_load_u32(p);
+        p += 4;
+        if ((size_t)(end - p) < length) {
+            return -EBADMSG;
+        }
+        field->bytes.data = (const char *)p;
+        field->bytes.length = length;
+        p += length;
+        break;
+    default:
+        return -EBADMSG;
+    }
+
+    *pos = p;
+    return 0;
+}
+
+int hinata_batch_reader_init(hinata_batch_reader_t *reader, const void *data, size_t size)
+{
+    const uint8_t *bytes = data;
+
+    if (!reader || (!data && size)) {
+        return -EINVAL;
+    }
+    if (size < HINATA_BATCH_HEADER_SIZE || memcmp(bytes, HINATA_BATCH_MAGIC, 4) != 0 ||
+        hinata_batch_load_u16(bytes + 4) != HINATA_BATCH_VERSION) {
+        return -EBADMSG;
+    }
+
+    reader->pos = bytes + HINATA_BATCH_HEADER_SIZE;
+    reader->end = bytes + size;
+    reader->op_count = hinata_batch_load_u32(bytes + 8);
+    reader->next_index = 0;
+
+    // 声明的操作数不可能放进剩余数据时直接拒绝，避免按它分配内存
+    if (reader->op_count > (size - HINATA_BATCH_HEADER_SIZE) / HINATA_BATCH_OP_MIN_SIZE) {
+        return -EBADMSG;
+    }
+    return 0;
+}
+
+int hinata_batch_reader_next(hinata_batch_reader_t *reader, hinata_batch_op_t *op)
+{
+    hinata_batch_field_t field;
+    const uint8_t *p, *end;
+    uint32_t length;
+    uint16_t i;
+
+    if (!reader || !op) {
+        return -EINVAL;
+    }
+    if (reader->next_index == reader->op_count) {
+        return reader->pos == reader->end ? 0 : -EBADMSG;
+    }
+
+    p = reader->pos;
+    if (reader->end - p < HINATA_BATCH_OP_MIN_SIZE) {
+        return -EBADMSG;
+    }
+    length = hinata_batch_load_u32(p);
+    p += HINATA_BATCH_OP_PREFIX;
+    if (length < HINATA_BATCH_OP_MIN_SIZE - HINATA_BATCH_OP_PREFIX ||
+        (size_t)(reader->end - p) < length) {
+        return -EBADMSG;
+    }
+    end = p + length;
+
+    if (p[0] > HINATA_BATCH_DELETE || p[1] >= HINATA_BATCH_TARGET_COUNT) {
+        return -EBADMSG;
+    }
+    op->type = (hinata_batch_operation_type_t)p[0];
+    op->target = (hinata_batch_target_t)p[1];
+    op->field_count = hinata_batch_load_u16(p + 2);
+    op->id.length = hinata_batch_load_u16(p + 4);
+    p += 6;
+    if ((size_t)(end - p) < op->id.length || op->id.length >= HINATA_UUID_LEN) {
+        return -EBADMSG;
+    }
+    op->id.data = (const char *)p;
+    p += op->id.length;
+
+    // 一次性校验所有字段，之后的字段遍历不再检查边界
+    op->fields = p;
+    op->end = end;
+    for (i = 0; i < op->field_count; i++) {
+        if (hinata_batch_parse_field(&p, end, &field) < 0) {
+            return -EBADMSG;
+        }
+    }
+    if (p != end) {
+        return -EBADMSG;
+    }
+
+    op->index = reader->next_index++;
+    reader->pos = end;
+    return 1;
+}
+
+void hinata_batch_fields(const hinata_batch_op_t *op, hinata_batch_field_iter_t *iter)
+{
+    iter->pos = op->fields;
+    iter->end = op->end;
+}
+
+bool hinata_batch_field_next(hinata_batch_field_iter_t *iter, hinata_batch_field_t *field)
+{
+    if (iter->pos >= iter->end) {
+        return false;
+    }
+
+    return hinata_batch_parse_field(&iter->pos, iter->end, field) == 0;
+}
+
+bool hinata_batch_slice_eq(hinata_batch_slice_t slice, const char *value)
+{
+    size_t length = strlen(value);
+
+    return length == slice.length && memcmp(slice.data, value, length) == 0;
+}
+
+bool hinata_batch_find_field(const hinata_batch_op_t *op, const char *key,
+                             hinata_batch_field_t *field)
+{
+    hinata_batch_field_iter_t iter;
+
+    hinata_batch_fields(op, &iter);
+    while (hinata_batch_field_next(&iter, field)) {
+        if (hinata_batch_slice_eq(field->key, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// 执行
+// ============================================================================
+
+void hinata_batch_report_free(hinata_batch_report_t *report)
+{
+    if (!report) {
+        return;
+    }
+
+    free(report->statuses);
+    memset(report, 0, sizeof(*report));
+}
+
+int hinata_batch_execute(const void *data, size_t size,
+                         const hinata_batch_handler_t handlers[HINATA_BATCH_TARGET_COUNT],
+                         hinata_batch_report_t *report)
+{
+    uint32_t offsets[HINATA_BATCH_TARGET_COUNT + 1] = { 0 };
+    const hinata_batch_handler_t *handler;
+    hinata_batch_reader_t reader;
+    hinata_batch_op_t *ops, *grouped;
+    uint32_t target, i;
+    int ret;
+
+    if (!handlers || !report) {
+        return -EINVAL;
+    }
+
+    memset(report, 0, sizeof(*report));
+    ret = hinata_batch_reader_init(&reader, data, size);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ops = malloc(((size_t)reader.op_count ? reader.op_count : 1) * 2 * sizeof(*ops));
+    report->statuses = calloc(reader.op_count ? reader.op_count : 1, sizeof(*report->statuses));
+    if (!ops || !report->statuses) {
+        free(ops);
+        hinata_batch_report_free(report);
+        return -ENOMEM;
+    }
+    grouped = ops + reader.op_count;
+
+    while ((ret = hinata_batch_reader_next(&reader, &ops[reader.next_index])) > 0) {
+        offsets[ops[reader.next_index - 1].target + 1]++;
+    }
+    if (ret < 0) {
+        free(ops);
+        hinata_batch_report_free(report);
+        return ret;
+    }
+
+    // 按目标稳定分组，同一目标的操作连续处理
+    for (target = 0; target < HINATA_BATCH_TARGET_COUNT; target++) {
+        offsets[target + 1] += offsets[target];
+    }
+    for (i = 0; i < reader.op_count; i++) {
+        grouped[offsets[ops[i].target]++] = ops[i];
+    }
+
+    report->count = reader.op_count;
+    for (i = 0; i < reader.op_count;) {
+        target = grouped[i].target;
+        handler = &handlers[target];
+        ret = 0;
+
+        if (!handler->apply) {
+            ret = -EOPNOTSUPP;
+        } else if (handler->begin) {
+            ret = handler->begin(handler->ctx, (hinata_batch_target_t)target,
+                                 offsets[target] - i);
+        }
+
+        for (; i < offsets[target]; i++) {
+            report->statuses[grouped[i].index] = ret < 0 ? ret :
+                                                 handler->apply(handler->ctx, &grouped[i]);
+            if (report->statuses[grouped[i].index] < 0) {
+                report->error_count++;
+            }
+        }
+
+        if (!ret && handler->apply && handler->end) {
+            handler->end(handler->ctx, (hinata_batch_target_t)target);
+        }
+    }
+
+    report->success = report->error_count == 0;
+    free(ops);
+    return 0;
+}
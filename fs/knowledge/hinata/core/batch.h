@@ -0,0 +1,187 @@
+/**
+ * HiNATA 二进制批量操作 - C 语言定义
+ *
+ * hinata_batch_operation_t 为每个操作预留 4 KB 的 JSON 缓冲区，结果再预留
+ * 2.5 KB，一批 50 个操作约 350 KB 且每个操作都要解析和生成 JSON。
+ * 这里定义紧凑的二进制编码：
+ *
+ *   头部    magic "HNB1" | u16 版本 | u16 保留 | u32 操作数
+ *   操作    u32 记录长度 | u8 类型 | u8 目标 | u16 字段数 | u16 ID 长度 | ID
+ *   字段    u8 值类型 | u16 键长度 | 键 | 值
+ *   值      BOOL: u8；INT: i64；DOUBLE: f64；STRING/BYTES: u32 长度 | 内容
+ *
+ * 多字节整数均为小端序。读取端不复制数据，字符串和字节串直接指向输入缓冲区，
+ * 不以 null 结尾。批量大小只受 32 位计数限制。
+ *
+ * 执行器按目标类型分组调用处理函数，同一目标内保持原有顺序；
+ * 不同目标的操作之间不保证顺序，需要先后依赖的操作应放在不同批次中。
+ */
+
+#ifndef _HINATA_BATCH_H
+#define _HINATA_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+
+// ============================================================================
+// 基础类型定义
+// ============================================================================
+
+#define HINATA_BATCH_MAGIC "HNB1"
+#define HINATA_BATCH_VERSION 1
+#define HINATA_BATCH_HEADER_SIZE 12
+
+#define HINATA_BATCH_TARGET_COUNT 3
+
+/**
+ * 字段值类型
+ */
+typedef enum {
+    HINATA_BATCH_VALUE_NULL = 0,
+    HINATA_BATCH_VALUE_BOOL = 1,
+    HINATA_BATCH_VALUE_INT = 2,
+    HINATA_BATCH_VALUE_DOUBLE = 3,
+    HINATA_BATCH_VALUE_STRING = 4,
+    HINATA_BATCH_VALUE_BYTES = 5
+} hinata_batch_value_type_t;
+
+/**
+ * 指向输入缓冲区的字节片段
+ */
+typedef struct {
+    const char *data;
+    uint32_t length;
+} hinata_batch_slice_t;
+
+/**
+ * 字段
+ */
+typedef struct {
+    hinata_batch_slice_t key;
+    hinata_batch_value_type_t type;
+    union {
+        bool boolean;
+        int64_t integer;
+        double number;
+        hinata_batch_slice_t bytes;     // STRING 和 BYTES
+    };
+} hinata_batch_field_t;
+
+/**
+ * 操作视图，fields 指向第一个字段
+ */
+typedef struct {
+    hinata_batch_operation_type_t type;
+    hinata_batch_target_t target;
+    hinata_batch_slice_t id;            // length 为 0 表示没有 ID
+    uint32_t index;                     // 在批次中的序号
+    uint16_t field_count;
+    const uint8_t *fields;
+    const uint8_t *end;
+} hinata_batch_op_t;
+
+/**
+ * 字段游标
+ */
+typedef struct {
+    const uint8_t *pos;
+    const uint8_t *end;
+} hinata_batch_field_iter_t;
+
+/**
+ * 编码器
+ */
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t capacity;
+    uint32_t op_count;
+    uint32_t op_start;                  // 当前操作记录的起始位置，0 表示不在操作中
+    uint16_t field_count;
+} hinata_batch_writer_t;
+
+/**
+ * 解码器
+ */
+typedef struct {
+    const uint8_t *pos;
+    const uint8_t *end;
+    uint32_t op_count;
+    uint32_t next_index;
+} hinata_batch_reader_t;
+
+/**
+ * 单个目标的处理函数
+ * begin/end 在每组开始和结束时调用，可以为 NULL；apply 返回 0 或负的 errno
+ */
+typedef struct {
+    int (*begin)(void *ctx, hinata_batch_target_t target, uint32_t count);
+    int (*apply)(void *ctx, const hinata_batch_op_t *op);
+    void (*end)(void *ctx, hinata_batch_target_t target);
+    void *ctx;
+} hinata_batch_handler_t;
+
+/**
+ * 执行结果，statuses 按操作在批次中的顺序排列，0 表示成功
+ */
+typedef struct {
+    int32_t *statuses;
+    uint32_t count;
+    uint32_t error_count;
+    bool success;
+} hinata_batch_report_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 编码
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ * 字段只能在 begin_op 和 end_op 之间写入；finish 之后 data/size 即为完整批次
+ */
+int hinata_batch_writer_init(hinata_batch_writer_t *writer);
+void hinata_batch_writer_free(hinata_batch_writer_t *writer);
+int hinata_batch_begin_op(hinata_batch_writer_t *writer, hinata_batch_operation_type_t type,
+                          hinata_batch_target_t target, const char *id);
+int hinata_batch_put_null(hinata_batch_writer_t *writer, const char *key);
+int hinata_batch_put_bool(hinata_batch_writer_t *writer, const char *key, bool value);
+int hinata_batch_put_int(hinata_batch_writer_t *writer, const char *key, int64_t value);
+int hinata_batch_put_double(hinata_batch_writer_t *writer, const char *key, double value);
+int hinata_batch_put_string(hinata_batch_writer_t *writer, const char *key, const char *value);
+int hinata_batch_put_bytes(hinata_batch_writer_t *writer, const char *key, const void *value,
+                           uint32_t length);
+int hinata_batch_end_op(hinata_batch_writer_t *writer);
+int hinata_batch_finish(hinata_batch_writer_t *writer);
+
+/**
+ * 把旧结构体中的操作编码为一个操作，data_json 作为 "data_json" 字符串字段
+ */
+int hinata_batch_put_legacy(hinata_batch_writer_t *writer, const hinata_batch_operation_t *op);
+
+/**
+ * 解码
+ * reader_init 校验头部；next 校验整条记录后返回 1，批次结束返回 0，
+ * 数据损坏返回 -EBADMSG。字段游标只能用于 next 成功返回的操作
+ */
+int hinata_batch_reader_init(hinata_batch_reader_t *reader, const void *data, size_t size);
+int hinata_batch_reader_next(hinata_batch_reader_t *reader, hinata_batch_op_t *op);
+void hinata_batch_fields(const hinata_batch_op_t *op, hinata_batch_field_iter_t *iter);
+bool hinata_batch_field_next(hinata_batch_field_iter_t *iter, hinata_batch_field_t *field);
+bool hinata_batch_find_field(const hinata_batch_op_t *op, const char *key,
+                             hinata_batch_field_t *field);
+bool hinata_batch_slice_eq(hinata_batch_slice_t slice, const char *value);
+
+/**
+ * 执行批次：先完整校验，数据损坏时不调用任何处理函数并返回 -EBADMSG。
+ * 没有处理函数的目标记为 -EOPNOTSUPP；begin 失败时该组所有操作记为它的返回值
+ */
+int hinata_batch_execute(const void *data, size_t size,
+                         const hinata_batch_handler_t handlers[HINATA_BATCH_TARGET_COUNT],
+                         hinata_batch_report_t *report);
+void hinata_batch_report_free(hinata_batch_report_t *report);
+
+#endif /* _HINATA_BATCH_H */
@@ -0,0 +1,1143 @@
+/**
+ * HiNATA 压缩位图 - C 语言实现
+ *
+ * 位集运算的 SIMD 版本与向量距离内核一样通过 target 属性单独编译，
+ * 运行时再按 CPU 特性分派。
+ */
+
+#include "bitmap.h"
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HINATA_BITMAP_X86 1
+#endif
+
+/**
+ * 位集运算：结果写入 dest，返回结果的基数
+ */
+typedef uint32_t (*hinata_words_op_t)(uint64_t *dest, const uint64_t *a, const uint64_t *b);
+
+/**
+ * 只计算交集基数，不写结果
+ */
+typedef uint32_t (*hinata_words_count_t)(const uint64_t *a, const uint64_t *b);
+
+typedef struct {
+    const char *name;
+    hinata_words_op_t and_words;
+    hinata_words_op_t or_words;
+    hinata_words_op_t andnot_words;
+    hinata_words_count_t and_count;
+} hinata_bitmap_kernel_t;
+
+// ============================================================================
+// 位集运算内核
+// ============================================================================
+
+static uint32_t hinata_and_words_scalar(uint64_t *dest, const uint64_t *a, const uint64_t *b)
+{
+    uint32_t card = 0;
+    uint32_t i;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i++) {
+        dest[i] = a[i] & b[i];
+        card += (uint32_t)__builtin_popcountll(dest[i]);
+    }
+
+    return card;
+}
+
+static uint32_t hinata_or_words_scalar(uint64_t *dest, const uint64_t *a, const uint64_t *b)
+{
+    uint32_t card = 0;
+    uint32_t i;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i++) {
+        dest[i] = a[i] | b[i];
+        card += (uint32_t)__builtin_popcountll(dest[i]);
+    }
+
+    return card;
+}
+
+static uint32_t hinata_andnot_words_scalar(uint64_t *dest, const uint64_t *a, const uint64_t *b)
+{
+    uint32_t card = 0;
+    uint32_t i;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i++) {
+        dest[i] = a[i] & ~b[i];
+        card += (uint32_t)__builtin_popcountll(dest[i]);
+    }
+
+    return card;
+}
+
+static uint32_t hinata_and_count_scalar(const uint64_t *a, const uint64_t *b)
+{
+    uint32_t card = 0;
+    uint32_t i;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i++) {
+        card += (uint32_t)__builtin_popcountll(a[i] & b[i]);
+    }
+
+    return card;
+}
+
+static const hinata_bitmap_kernel_t hinata_bitmap_scalar = {
+    .name = "scalar",
+    .and_words = hinata_and_words_scalar,
+    .or_words = hinata_or_words_scalar,
+    .andnot_words = hinata_andnot_words_scalar,
+    .and_count = hinata_and_count_scalar,
+};
+
+#ifdef HINATA_BITMAP_X86
+
+__attribute__((target("avx2,popcnt")))
+static uint32_t hinata_popcount256(const uint64_t *words)
+{
+    return (uint32_t)(__builtin_popcountll(words[0]) + __builtin_popcountll(words[1]) +
+                      __builtin_popcountll(words[2]) + __builtin_popcountll(words[3]));
+}
+
+__attribute__((target("avx2,popcnt")))
+static uint32_t hinata_and_words_avx2(uint64_t *dest, const uint64_t *a, const uint64_t *b)
+{
+    uint32_t card = 0;
+    uint32_t i;
+    __m256i v;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i += 4) {
+        v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + i)),
+                             _mm256_loadu_si256((const __m256i *)(b + i)));
+        _mm256_storeu_si256((__m256i *)(dest + i), v);
+        card += hinata_popcount256(dest + i);
+    }
+
+    return card;
+}
+
+__attribute__((target("avx2,popcnt")))
+static uint32_t hinata_or_words_avx2(uint64_t *dest, const uint64_t *a, const uint64_t *b)
+{
+    uint32_t card = 0;
+    uint32_t i;
+    __m256i v;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i += 4) {
+        v = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(a + i)),
+                            _mm256_loadu_si256((const __m256i *)(b + i)));
+        _mm256_storeu_si256((__m256i *)(dest + i), v);
+        card += hinata_popcount256(dest + i);
+    }
+
+    return card;
+}
+
+__attribute__((target("avx2,popcnt")))
+static uint32_t hinata_andnot_words_avx2(uint64_t *dest, const uint64_t *a, const uint64_t *b)
+{
+    uint32_t card = 0;
+    uint32_t i;
+    __m256i v;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i += 4) {
+        // andnot 对第一个操作数取反
+        v = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i *)(b + i)),
+                                _mm256_loadu_si256((const __m256i *)(a + i)));
+        _mm256_storeu_si256((__m256i *)(dest + i), v);
+        card += hinata_popcount256(dest + i);
+    }
+
+    return card;
+}
+
+__attribute__((target("avx2,popcnt")))
+static uint32_t hinata_and_count_avx2(const uint64_t *a, const uint64_t *b)
+{
+    uint64_t tmp[4];
+    uint32_t card = 0;
+    uint32_t i;
+    __m256i v;
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i += 4) {
+        v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + i)),
+                             _mm256_loadu_si256((const __m256i *)(b + i)));
+        _mm256_storeu_si256((__m256i *)tmp, v);
+        card += hinata_popcount256(tmp);
+    }
+
+    return card;
+}
+
+static const hinata_bitmap_kernel_t hinata_bitmap_avx2 = {
+    .name = "avx2",
+    .and_words = hinata_and_words_avx2,
+    .or_words = hinata_or_words_avx2,
+    .andnot_words = hinata_andnot_words_avx2,
+    .and_count = hinata_and_count_avx2,
+};
+
+#endif /* HINATA_BITMAP_X86 */
+
+static const hinata_bitmap_kernel_t *hinata_bitmap_kernel(void)
+{
+    // 并发首次调用只会重复选择出同一结果
+    static const hinata_bitmap_kernel_t *selected;
+
+    if (!selected) {
+        selected = &hinata_bitmap_scalar;
+#ifdef HINATA_BITMAP_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+            selected = &hinata_bitmap_avx2;
+        }
+#endif
+    }
+
+    return selected;
+}
+
+const char *hinata_bitmap_kernel_name(void)
+{
+    return hinata_bitmap_kernel()->name;
+}
+
+// ============================================================================
+// 容器
+// ============================================================================
+
+static void hinata_container_free(hinata_bitmap_container_t *c)
+{
+    if (c->type == HINATA_CONTAINER_BITSET) {
+        free(c->words);
+    } else {
+        free(c->array);
+    }
+    c->array = NULL;
+    c->cardinality = 0;
+    c->capacity = 0;
+}
+
+static int hinata_container_new_array(hinata_bitmap_container_t *c, uint16_t key, uint32_t capacity)
+{
+    memset(c, 0, sizeof(*c));
+    c->key = key;
+    c->type = HINATA_CONTAINER_ARRAY;
+    if (capacity) {
+        c->array = malloc((size_t)capacity * sizeof(*c->array));
+        if (!c->array) {
+            return -ENOMEM;
+        }
+        c->capacity = capacity;
+    }
+    return 0;
+}
+
+static int hinata_container_new_bitset(hinata_bitmap_container_t *c, uint16_t key)
+{
+    memset(c, 0, sizeof(*c));
+    c->key = key;
+    c->type = HINATA_CONTAINER_BITSET;
+    c->words = calloc(HINATA_BITMAP_WORDS, sizeof(*c->words));
+    return c->words ? 0 : -ENOMEM;
+}
+
+static int hinata_container_copy(hinata_bitmap_container_t *dest, const hinata_bitmap_container_t *src)
+{
+    int ret;
+
+    if (src->type == HINATA_CONTAINER_BITSET) {
+        ret = hinata_container_new_bitset(dest, src->key);
+        if (ret < 0) {
+            return ret;
+        }
+        memcpy(dest->words, src->words, HINATA_BITMAP_WORDS * sizeof(*dest->words));
+    } else {
+        ret = hinata_container_new_array(dest, src->key, src->cardinality);
+        if (ret < 0) {
+            return ret;
+        }
+        memcpy(dest->array, src->array, (size_t)src->cardinality * sizeof(*dest->array));
+    }
+
+    dest->cardinality = src->cardinality;
+    return 0;
+}
+
+static int hinata_container_to_bitset(hinata_bitmap_container_t *c)
+{
+    uint64_t *words = calloc(HINATA_BITMAP_WORDS, sizeof(*words));
+    uint32_t i;
+
+    if (!words) {
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < c->cardinality; i++) {
+        words[c->array[i] >> 6] |= 1ULL << (c->array[i] & 63);
+    }
+
+    free(c->array);
+    c->words = words;
+    c->type = HINATA_CONTAINER_BITSET;
+    c->capacity = 0;
+    return 0;
+}
+
+static int hinata_container_to_array(hinata_bitmap_container_t *c)
+{
+    uint16_t *array = malloc((c->cardinality ? c->cardinality : 1) * sizeof(*array));
+    uint32_t count = 0;
+    uint64_t word;
+    uint32_t i;
+
+    if (!array) {
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < HINATA_BITMAP_WORDS; i++) {
+        for (word = c->words[i]; word; word &= word - 1) {
+            array[count++] = (uint16_t)(i * 64 + (uint32_t)__builtin_ctzll(word));
+        }
+    }
+
+    free(c->words);
+    c->array = array;
+    c->type = HINATA_CONTAINER_ARRAY;
+    c->capacity = c->cardinality ? c->cardinality : 1;
+    return 0;
+}
+
+/**
+ * 位集运算后基数较小时转回数组
+ */
+static int hinata_container_fit(hinata_bitmap_container_t *c)
+{
+    if (c->type == HINATA_CONTAINER_BITSET && c->cardinality <= HINATA_BITMAP_ARRAY_MAX) {
+        return hinata_container_to_array(c);
+    }
+    return 0;
+}
+
+/**
+ * 在数组容器中二分查找，返回第一个不小于 low 的位置
+ */
+static uint32_t hinata_array_lower_bound(const uint16_t *array, uint32_t count, uint16_t low)
+{
+    uint32_t left = 0, right = count, mid;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (array[mid] < low) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+static bool hinata_container_contains(const hinata_bitmap_container_t *c, uint16_t low)
+{
+    uint32_t pos;
+
+    if (c->type == HINATA_CONTAINER_BITSET) {
+        return (c->words[low >> 6] >> (low & 63)) & 1;
+    }
+
+    pos = hinata_array_lower_bound(c->array, c->cardinality, low);
+    return pos < c->cardinality && c->array[pos] == low;
+}
+
+static int hinata_container_add(hinata_bitmap_container_t *c, uint16_t low)
+{
+    uint32_t pos;
+    int ret;
+
+    if (c->type == HINATA_CONTAINER_ARRAY) {
+        pos = hinata_array_lower_bound(c->array, c->cardinality, low);
+        if (pos < c->cardinality && c->array[pos] == low) {
+            return 0;
+        }
+        if (c->cardinality < HINATA_BITMAP_ARRAY_MAX) {
+            ret = hinata_vec_reserve((void **)&c->array, &c->capacity, c->cardinality + 1,
+                                     sizeof(*c->array));
+            if (ret < 0) {
+                return ret;
+            }
+            memmove(c->array + pos + 1, c->array + pos,
+                    (size_t)(c->cardinality - pos) * sizeof(*c->array));
+            c->array[pos] = low;
+            c->cardinality++;
+            return 0;
+        }
+
+        ret = hinata_container_to_bitset(c);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (!((c->words[low >> 6] >> (low & 63)) & 1)) {
+        c->words[low >> 6] |= 1ULL << (low & 63);
+        c->cardinality++;
+    }
+    return 0;
+}
+
+static int hinata_container_remove(hinata_bitmap_container_t *c, uint16_t low)
+{
+    uint32_t pos;
+
+    if (c->type == HINATA_CONTAINER_ARRAY) {
+        pos = hinata_array_lower_bound(c->array, c->cardinality, low);
+        if (pos < c->cardinality && c->array[pos] == low) {
+            memmove(c->array + pos, c->array + pos + 1,
+                    (size_t)(c->cardinality - pos - 1) * sizeof(*c->array));
+            c->cardinality--;
+        }
+        return 0;
+    }
+
+    if ((c->words[low >> 6] >> (low & 63)) & 1) {
+        c->words[low >> 6] &= ~(1ULL << (low & 63));
+        c->cardinality--;
+    }
+    return hinata_container_fit(c);
+}
+
+// ============================================================================
+// 容器之间的运算
+// ============================================================================
+
+static int hinata_container_and(hinata_bitmap_container_t *dest, const hinata_bitmap_container_t *a,
+                                const hinata_bitmap_container_t *b)
+{
+    const hinata_bitmap_container_t *tmp;
+    uint32_t i = 0, j = 0, n = 0;
+    int ret;
+
+    if (a->type == HINATA_CONTAINER_BITSET && b->type == HINATA_CONTAINER_BITSET) {
+        ret = hinata_container_new_bitset(dest, a->key);
+        if (ret < 0) {
+            return ret;
+        }
+        dest->cardinality = hinata_bitmap_kernel()->and_words(dest->words, a->words, b->words);
+        return hinata_container_fit(dest);
+    }
+
+    if (a->type == HINATA_CONTAINER_BITSET) {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    ret = hinata_container_new_array(dest, a->key, a->cardinality < b->cardinality ?
+                                     a->cardinality : b->cardinality);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (b->type == HINATA_CONTAINER_BITSET) {
+        for (i = 0; i < a->cardinality; i++) {
+            if (hinata_container_contains(b, a->array[i])) {
+                dest->array[n++] = a->array[i];
+            }
+        }
+    } else {
+        while (i < a->cardinality && j < b->cardinality) {
+            if (a->array[i] < b->array[j]) {
+                i++;
+            } else if (a->array[i] > b->array[j]) {
+                j++;
+            } else {
+                dest->array[n++] = a->array[i];
+                i++;
+                j++;
+            }
+        }
+    }
+
+    dest->cardinality = n;
+    return 0;
+}
+
+static int hinata_container_or(hinata_bitmap_container_t *dest, const hinata_bitmap_container_t *a,
+                               const hinata_bitmap_container_t *b)
+{
+    const hinata_bitmap_container_t *tmp;
+    uint32_t i = 0, j = 0, n = 0;
+    uint16_t low;
+    int ret;
+
+    if (a->type == HINATA_CONTAINER_BITSET && b->type == HINATA_CONTAINER_BITSET) {
+        ret = hinata_container_new_bitset(dest, a->key);
+        if (ret < 0) {
+            return ret;
+        }
+        dest->cardinality = hinata_bitmap_kernel()->or_words(dest->words, a->words, b->words);
+        return 0;
+    }
+
+    if (a->type == HINATA_CONTAINER_ARRAY && b->type == HINATA_CONTAINER_ARRAY &&
+        a->cardinality + b->cardinality <= HINATA_BITMAP_ARRAY_MAX) {
+        ret = hinata_container_new_array(dest, a->key, a->cardinality + b->cardinality);
+        if (ret < 0) {
+            return ret;
+        }
+        while (i < a->cardinality || j < b->cardinality) {
+            if (j == b->cardinality || (i < a->cardinality && a->array[i] < b->array[j])) {
+                dest->array[n++] = a->array[i++];
+            } else if (i == a->cardinality || b->array[j] < a->array[i]) {
+                dest->array[n++] = b->array[j++];
+            } else {
+                dest->array[n++] = a->array[i];
+                i++;
+                j++;
+            }
+        }
+        dest->cardinality = n;
+        return 0;
+    }
+
+    // 其余情况先复制位集（或把较大的数组转为位集），再逐个置位
+    if (b->type == HINATA_CONTAINER_BITSET) {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    ret = hinata_container_copy(dest, a);
+    if (!ret && dest->type == HINATA_CONTAINER_ARRAY) {
+        ret = hinata_container_to_bitset(dest);
+    }
+    if (ret < 0) {
+        hinata_container_free(dest);
+        return ret;
+    }
+
+    for (i = 0; i < b->cardinality; i++) {
+        low = b->array[i];
+        if (!((dest->words[low >> 6] >> (low & 63)) & 1)) {
+            dest->words[low >> 6] |= 1ULL << (low & 63);
+            dest->cardinality++;
+        }
+    }
+
+    return hinata_container_fit(dest);
+}
+
+static int hinata_container_andnot(hinata_bitmap_container_t *dest, const hinata_bitmap_container_t *a,
+                                   const hinata_bitmap_container_t *b)
+{
+    uint32_t i = 0, j = 0, n = 0;
+    uint16_t low;
+    int ret;
+
+    if (a->type == HINATA_CONTAINER_BITSET) {
+        ret = hinata_container_new_bitset(dest, a->key);
+        if (ret < 0) {
+            return ret;
+        }
+        if (b->type == HINATA_CONTAINER_BITSET) {
+            dest->cardinality = hinata_bitmap_kernel()->andnot_words(dest->words, a->words, b->words);
+        } else {
+            memcpy(dest->words, a->words, HINATA_BITMAP_WORDS * sizeof(*dest->words));
+            dest->cardinality = a->cardinality;
+            for (i = 0; i < b->cardinality; i++) {
+                low = b->array[i];
+                if ((dest->words[low >> 6] >> (low & 63)) & 1) {
+                    dest->words[low >> 6] &= ~(1ULL << (low & 63));
+                    dest->cardinality--;
+                }
+            }
+        }
+        return hinata_container_fit(dest);
+    }
+
+    ret = hinata_container_new_array(dest, a->key, a->cardinality);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (b->type == HINATA_CONTAINER_BITSET) {
+        for (i = 0; i < a->cardinality; i++) {
+            if (!hinata_container_contains(b, a->array[i])) {
+                dest->array[n++] = a->array[i];
+            }
+        }
+    } else {
+        while (i < a->cardinality) {
+            if (j == b->cardinality || a->array[i] < b->array[j]) {
+                dest->array[n++] = a->array[i++];
+            } else if (a->array[i] > b->array[j]) {
+                j++;
+            } else {
+                i++;
+                j++;
+            }
+        }
+    }
+
+    dest->cardinality = n;
+    return 0;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_bitmap_init(hinata_bitmap_t *bitmap)
+{
+    memset(bitmap, 0, sizeof(*bitmap));
+}
+
+void hinata_bitmap_free(hinata_bitmap_t *bitmap)
+{
+    uint32_t i;
+
+    if (!bitmap) {
+        return;
+    }
+
+    for (i = 0; i < bitmap->count; i++) {
+        hinata_container_free(&bitmap->containers[i]);
+    }
+    free(bitmap->containers);
+    hinata_bitmap_init(bitmap);
+}
+
+/**
+ * 在末尾追加容器；基数为 0 的容器直接释放
+ */
+static int hinata_bitmap_push(hinata_bitmap_t *bitmap, hinata_bitmap_container_t *c)
+{
+    int ret;
+
+    if (c->cardinality == 0) {
+        hinata_container_free(c);
+        return 0;
+    }
+
+    ret = hinata_vec_reserve((void **)&bitmap->containers, &bitmap->capacity, bitmap->count + 1,
+                             sizeof(*bitmap->containers));
+    if (ret < 0) {
+        hinata_container_free(c);
+        return ret;
+    }
+
+    bitmap->containers[bitmap->count++] = *c;
+    return 0;
+}
+
+int hinata_bitmap_copy(hinata_bitmap_t *dest, const hinata_bitmap_t *src)
+{
+    hinata_bitmap_container_t c;
+    uint32_t i;
+    int ret;
+
+    if (!dest || !src) {
+        return -EINVAL;
+    }
+
+    hinata_bitmap_free(dest);
+    for (i = 0; i < src->count; i++) {
+        ret = hinata_container_copy(&c, &src->containers[i]);
+        if (!ret) {
+            ret = hinata_bitmap_push(dest, &c);
+        }
+        if (ret < 0) {
+            hinata_bitmap_free(dest);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+// ============================================================================
+// 单个元素操作
+// ============================================================================
+
+/**
+ * 查找 key 对应的容器，返回第一个 key 不小于给定值的位置
+ */
+static uint32_t hinata_bitmap_find(const hinata_bitmap_t *bitmap, uint16_t key)
+{
+    uint32_t left = 0, right = bitmap->count, mid;
+
+    // 按升序插入时绝大多数访问落在最后一个容器
+    if (bitmap->count && bitmap->containers[bitmap->count - 1].key == key) {
+        return bitmap->count - 1;
+    }
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (bitmap->containers[mid].key < key) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+int hinata_bitmap_add(hinata_bitmap_t *bitmap, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    uint32_t pos;
+    int ret;
+
+    if (!bitmap) {
+        return -EINVAL;
+    }
+
+    pos = hinata_bitmap_find(bitmap, key);
+    if (pos == bitmap->count || bitmap->containers[pos].key != key) {
+        ret = hinata_vec_reserve((void **)&bitmap->containers, &bitmap->capacity,
+                                 bitmap->count + 1, sizeof(*bitmap->containers));
+        if (ret < 0) {
+            return ret;
+        }
+        memmove(bitmap->containers + pos + 1, bitmap->containers + pos,
+                (size_t)(bitmap->count - pos) * sizeof(*bitmap->containers));
+        hinata_container_new_array(&bitmap->containers[pos], key, 0);
+        bitmap->count++;
+    }
+
+    ret = hinata_container_add(&bitmap->containers[pos], (uint16_t)value);
+    if (ret < 0 && bitmap->containers[pos].cardinality == 0) {
+        hinata_container_free(&bitmap->containers[pos]);
+        memmove(bitmap->containers + pos, bitmap->containers + pos + 1,
+                (size_t)(bitmap->count - pos - 1) * sizeof(*bitmap->containers));
+        bitmap->count--;
+    }
+
+    return ret;
+}
+
+int hinata_bitmap_remove(hinata_bitmap_t *bitmap, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    uint32_t pos;
+    int ret;
+
+    if (!bitmap) {
+        return -EINVAL;
+    }
+
+    pos = hinata_bitmap_find(bitmap, key);
+    if (pos == bitmap->count || bitmap->containers[pos].key != key) {
+        return 0;
+    }
+
+    ret = hinata_container_remove(&bitmap->containers[pos], (uint16_t)value);
+    if (bitmap->containers[pos].cardinality == 0) {
+        hinata_container_free(&bitmap->containers[pos]);
+        memmove(bitmap->containers + pos, bitmap->containers + pos + 1,
+                (size_t)(bitmap->count - pos - 1) * sizeof(*bitmap->containers));
+        bitmap->count--;
+    }
+
+    return ret;
+}
+
+bool hinata_bitmap_contains(const hinata_bitmap_t *bitmap, uint32_t value)
+{
+    uint16_t key = (uint16_t)(value >> 16);
+    uint32_t pos;
+
+    if (!bitmap) {
+        return false;
+    }
+
+    pos = hinata_bitmap_find(bitmap, key);
+    return pos < bitmap->count && bitmap->containers[pos].key == key &&
+           hinata_container_contains(&bitmap->containers[pos], (uint16_t)value);
+}
+
+uint64_t hinata_bitmap_cardinality(const hinata_bitmap_t *bitmap)
+{
+    uint64_t total = 0;
+    uint32_t i;
+
+    for (i = 0; bitmap && i < bitmap->count; i++) {
+        total += bitmap->containers[i].cardinality;
+    }
+
+    return total;
+}
+
+static uint32_t hinata_container_and_count(const hinata_bitmap_container_t *a,
+                                           const hinata_bitmap_container_t *b)
+{
+    const hinata_bitmap_container_t *tmp;
+    uint32_t i = 0, j = 0, n = 0;
+
+    if (a->type == HINATA_CONTAINER_BITSET && b->type == HINATA_CONTAINER_BITSET) {
+        return hinata_bitmap_kernel()->and_count(a->words, b->words);
+    }
+
+    if (a->type == HINATA_CONTAINER_BITSET) {
+        tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    if (b->type == HINATA_CONTAINER_BITSET) {
+        for (i = 0; i < a->cardinality; i++) {
+            n += hinata_container_contains(b, a->array[i]);
+        }
+        return n;
+    }
+
+    while (i < a->cardinality && j < b->cardinality) {
+        if (a->array[i] < b->array[j]) {
+            i++;
+        } else if (a->array[i] > b->array[j]) {
+            j++;
+        } else {
+            n++;
+            i++;
+            j++;
+        }
+    }
+
+    return n;
+}
+
+uint64_t hinata_bitmap_and_cardinality(const hinata_bitmap_t *a, const hinata_bitmap_t *b)
+{
+    uint64_t total = 0;
+    uint32_t i = 0, j = 0;
+
+    while (i < a->count && j < b->count) {
+        if (a->containers[i].key < b->containers[j].key) {
+            i++;
+        } else if (a->containers[i].key > b->containers[j].key) {
+            j++;
+        } else {
+            total += hinata_container_and_count(&a->containers[i], &b->containers[j]);
+            i++;
+            j++;
+        }
+    }
+
+    return total;
+}
+
+// ============================================================================
+// 集合运算
+// ============================================================================
+
+typedef enum {
+    HINATA_BITMAP_OP_AND = 0,
+    HINATA_BITMAP_OP_OR = 1,
+    HINATA_BITMAP_OP_ANDNOT = 2
+} hinata_bitmap_op_t;
+
+/**
+ * 按 key 归并两个容器序列
+ */
+static int hinata_bitmap_apply(hinata_bitmap_t *dest, const hinata_bitmap_t *a,
+                               const hinata_bitmap_t *b, hinata_bitmap_op_t op)
+{
+    const hinata_bitmap_container_t *ca, *cb;
+    hinata_bitmap_container_t c;
+    uint32_t i = 0, j = 0;
+    int ret = 0;
+
+    if (!dest || !a || !b || dest == a || dest == b) {
+        return -EINVAL;
+    }
+
+    hinata_bitmap_free(dest);
+    while (i < a->count || j < b->count) {
+        ca = i < a->count ? &a->containers[i] : NULL;
+        cb = j < b->count ? &b->containers[j] : NULL;
+
+        if (ca && cb && ca->key == cb->key) {
+            if (op == HINATA_BITMAP_OP_AND) {
+                ret = hinata_container_and(&c, ca, cb);
+            } else if (op == HINATA_BITMAP_OP_OR) {
+                ret = hinata_container_or(&c, ca, cb);
+            } else {
+                ret = hinata_container_andnot(&c, ca, cb);
+            }
+            i++;
+            j++;
+        } else if (ca && (!cb || ca->key < cb->key)) {
+            i++;
+            if (op == HINATA_BITMAP_OP_AND) {
+                continue;
+            }
+            ret = hinata_container_copy(&c, ca);
+        } else {
+            j++;
+            if (op != HINATA_BITMAP_OP_OR) {
+                // 与和差运算不再需要 a 之外的容器
+                if (i == a->count) {
+                    break;
+                }
+                continue;
+            }
+            ret = hinata_container_copy(&c, cb);
+        }
+
+        if (!ret) {
+            ret = hinata_bitmap_push(dest, &c);
+        }
+        if (ret < 0) {
+            hinata_bitmap_free(dest);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int hinata_bitmap_and(hinata_bitmap_t *dest, const hinata_bitmap_t *a, const hinata_bitmap_t *b)
+{
+    return hinata_bitmap_apply(dest, a, b, HINATA_BITMAP_OP_AND);
+}
+
+int hinata_bitmap_or(hinata_bitmap_t *dest, const hinata_bitmap_t *a, const hinata_bitmap_t *b)
+{
+    return hinata_bitmap_apply(dest, a, b, HINATA_BITMAP_OP_OR);
+}
+
+int hinata_bitmap_andnot(hinata_bitmap_t *dest, const hinata_bitmap_t *a, const hinata_bitmap_t *b)
+{
+    return hinata_bitmap_apply(dest, a, b, HINATA_BITMAP_OP_ANDNOT);
+}
+
+int hinata_bitmap_and_inplace(hinata_bitmap_t *a, const hinata_bitmap_t *b)
+{
+    hinata_bitmap_t result;
+    int ret;
+
+    hinata_bitmap_init(&result);
+    ret = hinata_bitmap_and(&result, a, b);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hinata_bitmap_free(a);
+    *a = result;
+    return 0;
+}
+
+int hinata_bitmap_or_inplace(hinata_bitmap_t *a, const hinata_bitmap_t *b)
+{
+    hinata_bitmap_t result;
+    int ret;
+
+    hinata_bitmap_init(&result);
+    ret = hinata_bitmap_or(&result, a, b);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hinata_bitmap_free(a);
+    *a = result;
+    return 0;
+}
+
+/**
+ * 合并 key 相同的多个容器：单个容器直接复制，否则在位集上逐个合并
+ */
+static int hinata_container_union(hinata_bitmap_container_t *dest,
+                                  const hinata_bitmap_container_t *const *parts, uint32_t count)
+{
+    const hinata_bitmap_container_t *part, *bitset = NULL;
+    uint32_t i, w;
+    uint16_t low;
+    int ret;
+
+    if (count == 1) {
+        return hinata_container_copy(dest, parts[0]);
+    }
+
+    ret = hinata_container_new_bitset(dest, parts[0]->key);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // 先置位数组容器，再用位集运算合并其余位集并顺带得到基数
+    for (i = 0; i < count; i++) {
+        part = parts[i];
+        if (part->type == HINATA_CONTAINER_BITSET) {
+            bitset = part;
+            continue;
+        }
+        for (w = 0; w < part->cardinality; w++) {
+            low = part->array[w];
+            dest->words[low >> 6] |= 1ULL << (low & 63);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (parts[i]->type == HINATA_CONTAINER_BITSET) {
+            dest->cardinality = hinata_bitmap_kernel()->or_words(dest->words, dest->words,
+                                                                 parts[i]->words);
+        }
+    }
+    if (!bitset) {
+        dest->cardinality = hinata_bitmap_kernel()->or_words(dest->words, dest->words, dest->words);
+    }
+
+    return hinata_container_fit(dest);
+}
+
+int hinata_bitmap_or_many(hinata_bitmap_t *dest, const hinata_bitmap_t *const *inputs,
+                          uint32_t count)
+{
+    const hinata_bitmap_container_t **parts;
+    hinata_bitmap_container_t c;
+    uint32_t *cursors;
+    uint32_t key, found, i;
+    int ret = 0;
+
+    if (!dest || (count && !inputs)) {
+        return -EINVAL;
+    }
+    for (i = 0; i < count; i++) {
+        if (inputs[i] == dest) {
+            return -EINVAL;
+        }
+    }
+
+    hinata_bitmap_free(dest);
+    cursors = calloc(count ? count : 1, sizeof(*cursors));
+    parts = malloc((count ? count : 1) * sizeof(*parts));
+    if (!cursors || !parts) {
+        free(cursors);
+        free(parts);
+        return -ENOMEM;
+    }
+
+    // 每轮取出所有输入中最小的 key，总代价与容器总数成正比
+    for (;;) {
+        key = UINT32_MAX;
+        for (i = 0; i < count; i++) {
+            if (cursors[i] < inputs[i]->count && inputs[i]->containers[cursors[i]].key < key) {
+                key = inputs[i]->containers[cursors[i]].key;
+            }
+        }
+        if (key == UINT32_MAX) {
+            break;
+        }
+
+        found = 0;
+        for (i = 0; i < count; i++) {
+            if (cursors[i] < inputs[i]->count && inputs[i]->containers[cursors[i]].key == key) {
+                parts[found++] = &inputs[i]->containers[cursors[i]++];
+            }
+        }
+
+        ret = hinata_container_union(&c, parts, found);
+        if (!ret) {
+            ret = hinata_bitmap_push(dest, &c);
+        }
+        if (ret < 0) {
+            hinata_bitmap_free(dest);
+            break;
+        }
+    }
+
+    free(cursors);
+    free(parts);
+    return ret;
+}
+
+// ============================================================================
+// 遍历
+// ============================================================================
+
+void hinata_bitmap_foreach(const hinata_bitmap_t *bitmap, hinata_bitmap_visit_t visit, void *ctx)
+{
+    const hinata_bitmap_container_t *c;
+    uint32_t high, i, w;
+    uint64_t word;
+
+    for (i = 0; bitmap && i < bitmap->count; i++) {
+        c = &bitmap->containers[i];
+        high = (uint32_t)c->key << 16;
+
+        if (c->type == HINATA_CONTAINER_ARRAY) {
+            for (w = 0; w < c->cardinality; w++) {
+                if (!visit(ctx, high | c->array[w])) {
+                    return;
+                }
+            }
+            continue;
+        }
+
+        for (w = 0; w < HINATA_BITMAP_WORDS; w++) {
+            for (word = c->words[w]; word; word &= word - 1) {
+                if (!visit(ctx, high | (w * 64 + (uint32_t)__builtin_ctzll(word)))) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+uint32_t hinata_bitmap_to_array(const hinata_bitmap_t *bitmap, uint32_t *out, uint32_t max)
+{
+    const hinata_bitmap_container_t *c;
+    uint32_t n = 0;
+    uint32_t high, i, w;
+    uint64_t word;
+
+    for (i = 0; bitmap && i < bitmap->count && n < max; i++) {
+        c = &bitmap->containers[i];
+        high = (uint32_t)c->key << 16;
+
+        if (c->type == HINATA_CONTAINER_ARRAY) {
+            for (w = 0; w < c->cardinality && n < max; w++) {
+                out[n++] = high | c->array[w];
+            }
+            continue;
+        }
+
+        for (w = 0; w < HINATA_BITMAP_WORDS && n < max; w++) {
+            for (word = c->words[w]; word && n < max; word &= word - 1) {
+                out[n++] = high | (w * 64 + (uint32_t)__builtin_ctzll(word));
+            }
+        }
+    }
+
+    return n;
+}
+
+size_t hinata_bitmap_footprint(const hinata_bitmap_t *bitmap)
+{
+    size_t total;
+    uint32_t i;
+
+    if (!bitmap) {
+        return 0;
+    }
+
+    total = (size_t)bitmap->capacity * sizeof(*bitmap->containers);
+    for (i = 0; i < bitmap->count; i++) {
+        if (bitmap->containers[i].type == HINATA_CONTAINER_BITSET) {
+            total += HINATA_BITMAP_WORDS * sizeof(uint64_t);
+        } else {
+            total += (size_t)bitmap->containers[i].capacity * sizeof(uint16_t);
+        }
+    }
+
+    return total;
+}
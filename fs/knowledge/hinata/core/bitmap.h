@@ -0,0 +1,121 @@
+/**
+ * HiNATA 压缩位图 - C 语言定义
+ *
+ * Roaring 风格的 32 位整数集合：按高 16 位分成容器，基数不超过
+ * HINATA_BITMAP_ARRAY_MAX 的容器存为有序 uint16 数组，否则存为 65536 位
+ * 的位集。位集之间的与、或、差运算按 CPU 特性选择 SIMD 实现。
+ *
+ * 位图不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_BITMAP_H
+#define _HINATA_BITMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// 数组容器的最大基数，超过后转为位集
+#define HINATA_BITMAP_ARRAY_MAX 4096
+
+// 位集容器的 64 位字数
+#define HINATA_BITMAP_WORDS 1024
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 容器类型
+ */
+typedef enum {
+    HINATA_CONTAINER_ARRAY = 0,
+    HINATA_CONTAINER_BITSET = 1
+} hinata_container_type_t;
+
+/**
+ * 容器：保存高 16 位为 key 的所有元素的低 16 位
+ */
+typedef struct {
+    uint16_t key;
+    uint8_t type;
+    uint32_t cardinality;
+    uint32_t capacity;      // 数组容器的容量
+    union {
+        uint16_t *array;
+        uint64_t *words;
+    };
+} hinata_bitmap_container_t;
+
+/**
+ * 压缩位图，容器按 key 升序排列
+ */
+typedef struct {
+    hinata_bitmap_container_t *containers;
+    uint32_t count;
+    uint32_t capacity;
+} hinata_bitmap_t;
+
+/**
+ * 遍历回调，返回 false 时停止
+ */
+typedef bool (*hinata_bitmap_visit_t)(void *ctx, uint32_t value);
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_bitmap_init(hinata_bitmap_t *bitmap);
+void hinata_bitmap_free(hinata_bitmap_t *bitmap);
+int hinata_bitmap_copy(hinata_bitmap_t *dest, const hinata_bitmap_t *src);
+
+/**
+ * 单个元素操作
+ */
+int hinata_bitmap_add(hinata_bitmap_t *bitmap, uint32_t value);
+int hinata_bitmap_remove(hinata_bitmap_t *bitmap, uint32_t value);
+bool hinata_bitmap_contains(const hinata_bitmap_t *bitmap, uint32_t value);
+uint64_t hinata_bitmap_cardinality(const hinata_bitmap_t *bitmap);
+
+/**
+ * 交集的基数，不生成交集本身
+ */
+uint64_t hinata_bitmap_and_cardinality(const hinata_bitmap_t *a, const hinata_bitmap_t *b);
+
+/**
+ * 集合运算，dest 会被覆盖且不能与输入相同
+ * inplace 版本把结果写回 a
+ */
+int hinata_bitmap_and(hinata_bitmap_t *dest, const hinata_bitmap_t *a, const hinata_bitmap_t *b);
+int hinata_bitmap_or(hinata_bitmap_t *dest, const hinata_bitmap_t *a, const hinata_bitmap_t *b);
+int hinata_bitmap_andnot(hinata_bitmap_t *dest, const hinata_bitmap_t *a, const hinata_bitmap_t *b);
+int hinata_bitmap_and_inplace(hinata_bitmap_t *a, const hinata_bitmap_t *b);
+int hinata_bitmap_or_inplace(hinata_bitmap_t *a, const hinata_bitmap_t *b);
+
+/**
+ * 多路并集，代价与输入的容器总数成正比；dest 不能是输入之一
+ */
+int hinata_bitmap_or_many(hinata_bitmap_t *dest, const hinata_bitmap_t *const *inputs,
+                          uint32_t count);
+
+/**
+ * 按升序遍历；to_array 最多写入 max 个元素并返回写入数
+ */
+void hinata_bitmap_foreach(const hinata_bitmap_t *bitmap, hinata_bitmap_visit_t visit, void *ctx);
+uint32_t hinata_bitmap_to_array(const hinata_bitmap_t *bitmap, uint32_t *out, uint32_t max);
+
+/**
+ * 占用的堆内存字节数
+ */
+size_t hinata_bitmap_footprint(const hinata_bitmap_t *bitmap);
+
+/**
+ * 当前使用的位集运算实现名称
+ */
+const char *hinata_bitmap_kernel_name(void);
+
+#endif /* _HINATA_BITMAP_H */
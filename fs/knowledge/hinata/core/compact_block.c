@@ -0,0 +1,730 @@
+/**
+ * HiNATA 紧凑知识块 - C 语言实现
+ *
+ * 字符串只追加到块私有的 arena，替换字段时旧内容留在原处，
+ * 由 hinata_compact_block_shrink() 统一回收。
+ */
+
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_ARENA_MIN_CAPACITY 256
+#define HINATA_VEC_MIN_CAPACITY 4
+#define HINATA_UUID_MIN_SLOTS 64
+
+#define HINATA_ARRAY_LEN(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+// ============================================================================
+// 向量工具函数
+// ============================================================================
+
+/**
+ * 保证向量至少能容纳 needed 个元素，按倍数增长
+ */
+int hinata_vec_reserve(void **items, uint32_t *capacity, uint32_t needed, size_t elem_size)
+{
+    uint32_t new_capacity;
+    void *new_items;
+
+    if (needed <= *capacity) {
+        return 0;
+    }
+
+    new_capacity = *capacity ? *capacity : HINATA_VEC_MIN_CAPACITY;
+    while (new_capacity < needed) {
+        if (new_capacity > UINT32_MAX / 2) {
+            return -EOVERFLOW;
+        }
+        new_capacity *= 2;
+    }
+
+    new_items = realloc(*items, (size_t)new_capacity * elem_size);
+    if (!new_items) {
+        return -ENOMEM;
+    }
+
+    *items = new_items;
+    *capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * 把向量容量收缩到元素个数
+ */
+void hinata_vec_shrink(void **items, uint32_t *capacity, uint32_t count, size_t elem_size)
+{
+    void *new_items;
+
+    if (count == *capacity) {
+        return;
+    }
+
+    if (count == 0) {
+        free(*items);
+        *items = NULL;
+        *capacity = 0;
+        return;
+    }
+
+    new_items = realloc(*items, (size_t)count * elem_size);
+    if (new_items) {
+        *items = new_items;
+        *capacity = count;
+    }
+}
+
+/**
+ * 进程内递增的写入版本，从 1 开始
+ */
+uint64_t hinata_next_version(void)
+{
+    static atomic_uint_least64_t next = 1;
+
+    return atomic_fetch_add(&next, 1);
+}
+
+// ============================================================================
+// arena 操作
+// ============================================================================
+
+int hinata_arena_append(hinata_arena_t *arena, const char *value, size_t len,
+                        hinata_str_ref_t *ref)
+{
+    uint32_t needed;
+    uint32_t new_capacity;
+    char *new_data;
+    size_t value_offset = 0;
+    bool inside;
+
+    if (len == 0) {
+        ref->offset = 0;
+        ref->length = 0;
+        return 0;
+    }
+
+    if (len >= UINT32_MAX - arena->used) {
+        return -EOVERFLOW;
+    }
+
+    // value 可能指向 arena 自身（如用一个字段的内容设置另一个字段），扩容前记下偏移
+    inside = arena->data && (uintptr_t)value >= (uintptr_t)arena->data &&
+             (uintptr_t)value < (uintptr_t)(arena->data + arena->used);
+    if (inside) {
+        value_offset = (size_t)(value - arena->data);
+    }
+
+    needed = arena->used + (uint32_t)len + 1;
+    if (needed > arena->capacity) {
+        new_capacity = arena->capacity ? arena->capacity : HINATA_ARENA_MIN_CAPACITY;
+        while (new_capacity < needed) {
+            new_capacity = new_capacity > UINT32_MAX / 2 ? UINT32_MAX : new_capacity * 2;
+        }
+
+        new_data = realloc(arena->data, new_capacity);
+        if (!new_data) {
+            return -ENOMEM;
+        }
+
+        arena->data = new_data;
+        arena->capacity = new_capacity;
+        if (inside) {
+            value = arena->data + value_offset;
+        }
+    }
+
+    memcpy(arena->data + arena->used, value, len);
+    arena->data[arena->used + len] = '\0';
+
+    ref->offset = arena->used;
+    ref->length = (uint32_t)len;
+    arena->used = needed;
+    return 0;
+}
+
+const char *hinata_arena_str(const hinata_arena_t *arena, hinata_str_ref_t ref)
+{
+    if (ref.length == 0 || !arena->data) {
+        return "";
+    }
+
+    return arena->data + ref.offset;
+}
+
+void hinata_arena_free(hinata_arena_t *arena)
+{
+    free(arena->data);
+    arena->data = NULL;
+    arena->used = 0;
+    arena->capacity = 0;
+}
+
+// ============================================================================
+// UUID 哈希表
+// ============================================================================
+
+/**
+ * FNV-1a 哈希，最多读取 UUID 长度的字符
+ */
+uint32_t hinata_uuid_hash(const char *uuid)
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < HINATA_UUID_LEN - 1 && uuid[i]; i++) {
+        hash ^= (uint8_t)uuid[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+uint32_t hinata_uuid_slot(const uint32_t *slots, uint32_t capacity, const char *uuid,
+                          hinata_uuid_key_t key, const void *owner)
+{
+    uint32_t mask = capacity - 1;
+    uint32_t slot = hinata_uuid_hash(uuid) & mask;
+    uint32_t entry;
+
+    while ((entry = slots[slot]) != 0) {
+        if (strncmp(key(owner, entry), uuid, HINATA_UUID_LEN - 1) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * 负载超过一半时扩容并重新插入
+ */
+int hinata_uuid_slots_grow(uint32_t **slots, uint32_t *capacity, uint32_t count,
+                           uint32_t entries, hinata_uuid_key_t key, const void *owner)
+{
+    uint32_t *old_slots = *slots;
+    uint32_t new_capacity, entry;
+    const char *uuid;
+
+    if ((count + 1) * 2 <= *capacity) {
+        return 0;
+    }
+
+    if (*capacity > UINT32_MAX / 2) {
+        return -EOVERFLOW;
+    }
+    new_capacity = *capacity ? *capacity * 2 : HINATA_UUID_MIN_SLOTS;
+    *slots = calloc(new_capacity, sizeof(**slots));
+    if (!*slots) {
+        *slots = old_slots;
+        return -ENOMEM;
+    }
+
+    *capacity = new_capacity;
+    for (entry = 1; entry <= entries; entry++) {
+        uuid = key(owner, entry);
+        if (uuid) {
+            (*slots)[hinata_uuid_slot(*slots, new_capacity, uuid, key, owner)] = entry;
+        }
+    }
+
+    free(old_slots);
+    return 0;
+}
+
+/**
+ * 删除 hole 处的条目，后面的条目向前移动填补空位
+ */
+void hinata_uuid_slots_unlink(uint32_t *slots, uint32_t capacity, uint32_t hole,
+                              hinata_uuid_key_t key, const void *owner)
+{
+    uint32_t mask = capacity - 1;
+    uint32_t slot, home;
+
+    for (slot = (hole + 1) & mask; slots[slot]; slot = (slot + 1) & mask) {
+        home = hinata_uuid_hash(key(owner, slots[slot])) & mask;
+        // home 不在 (hole, slot] 之间时，该条目可以移到 hole
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            slots[hole] = slots[slot];
+            hole = slot;
+        }
+    }
+    slots[hole] = 0;
+}
+
+// ============================================================================
+// 内部工具函数
+// ============================================================================
+
+/**
+ * 把有长度上限的旧结构体字段存入 arena
+ */
+static int hinata_arena_store_bounded(hinata_arena_t *arena, const char *value, size_t max_len,
+                                      hinata_str_ref_t *ref)
+{
+    const char *end = memchr(value, '\0', max_len);
+
+    return hinata_arena_append(arena, value, end ? (size_t)(end - value) : max_len, ref);
+}
+
+/**
+ * 把 arena 字符串复制到定长缓冲区，截断时返回 false
+ */
+static bool hinata_copy_bounded(char *dest, size_t size, const char *src, uint32_t len)
+{
+    size_t n = len < size ? len : size - 1;
+
+    memcpy(dest, src, n);
+    dest[n] = '\0';
+    return n == len;
+}
+
+/**
+ * 复制 UUID，保证 null 结尾
+ */
+void hinata_uuid_assign(hinata_uuid_t dest, const hinata_uuid_t src)
+{
+    size_t i;
+
+    for (i = 0; i < HINATA_UUID_LEN - 1 && src[i]; i++) {
+        dest[i] = src[i];
+    }
+    memset(dest + i, 0, HINATA_UUID_LEN - i);
+}
+
+/**
+ * 向 UUID 向量追加一项
+ */
+static int hinata_uuid_vec_push(hinata_uuid_vec_t *vec, const hinata_uuid_t uuid)
+{
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&vec->items, &vec->capacity, vec->count + 1,
+                             sizeof(*vec->items));
+    if (ret < 0) {
+        return ret;
+    }
+
+    hinata_uuid_assign(vec->items[vec->count++], uuid);
+    return 0;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_compact_block_init(hinata_compact_block_t *block)
+{
+    memset(block, 0, sizeof(*block));
+}
+
+void hinata_compact_block_free(hinata_compact_block_t *block)
+{
+    if (!block) {
+        return;
+    }
+
+    free(block->core.tags.items);
+    free(block->note_items);
+    free(block->references.items);
+    free(block->backlinks.items);
+    free(block->arena.data);
+    hinata_compact_block_init(block);
+}
+
+// ============================================================================
+// 字符串访问与修改
+// ============================================================================
+
+const char *hinata_compact_str(const hinata_compact_block_t *block, hinata_str_ref_t ref)
+{
+    return hinata_arena_str(&block->arena, ref);
+}
+
+int hinata_compact_block_set_str(hinata_compact_block_t *block, hinata_str_ref_t *field,
+                                 const char *value)
+{
+    if (!block || !field) {
+        return -EINVAL;
+    }
+
+    return hinata_arena_append(&block->arena, value ? value : "", value ? strlen(value) : 0,
+                              field);
+}
+
+int hinata_compact_block_add_tag(hinata_compact_block_t *block, const char *tag)
+{
+    hinata_str_ref_vec_t *tags;
+    int ret;
+
+    if (!block || !tag || !*tag) {
+        return -EINVAL;
+    }
+
+    tags = &block->core.tags;
+    ret = hinata_vec_reserve((void **)&tags->items, &tags->capacity, tags->count + 1,
+                             sizeof(*tags->items));
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = hinata_arena_append(&block->arena, tag, strlen(tag), &tags->items[tags->count]);
+    if (ret < 0) {
+        return ret;
+    }
+
+    tags->count++;
+    return 0;
+}
+
+int hinata_compact_block_add_note_item(hinata_compact_block_t *block,
+                                       const hinata_uuid_t id,
+                                       const char *content,
+                                       hinata_content_format_t format,
+                                       uint8_t order,
+                                       hinata_timestamp_t created_at,
+                                       hinata_timestamp_t updated_at)
+{
+    hinata_compact_note_item_t *item;
+    int ret;
+
+    if (!block || !id || !content) {
+        return -EINVAL;
+    }
+
+    ret = hinata_vec_reserve((void **)&block->note_items, &block->note_item_capacity,
+                             block->note_item_count + 1, sizeof(*block->note_items));
+    if (ret < 0) {
+        return ret;
+    }
+
+    item = &block->note_items[block->note_item_count];
+    memset(item, 0, sizeof(*item));
+
+    ret = hinata_arena_append(&block->arena, content, strlen(content), &item->content);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hinata_uuid_assign(item->id, id);
+    item->content_format = format;
+    item->order = order;
+    item->created_at = created_at;
+    item->updated_at = updated_at;
+
+    block->note_item_count++;
+    return 0;
+}
+
+int hinata_compact_block_add_reference(hinata_compact_block_t *block, const hinata_uuid_t target)
+{
+    if (!block || !target) {
+        return -EINVAL;
+    }
+
+    return hinata_uuid_vec_push(&block->references, target);
+}
+
+int hinata_compact_block_add_backlink(hinata_compact_block_t *block, const hinata_uuid_t source)
+{
+    if (!block || !source) {
+        return -EINVAL;
+    }
+
+    return hinata_uuid_vec_push(&block->backlinks, source);
+}
+
+// ============================================================================
+// 空间回收
+// ============================================================================
+
+/**
+ * 把一个字符串从旧 arena 搬到新 arena
+ */
+static int hinata_arena_move(hinata_arena_t *dest, const hinata_arena_t *src, hinata_str_ref_t *ref)
+{
+    if (ref->length == 0) {
+        return 0;
+    }
+
+    return hinata_arena_append(dest, src->data + ref->offset, ref->length, ref);
+}
+
+int hinata_compact_block_shrink(hinata_compact_block_t *block)
+{
+    hinata_compact_block_t moved;
+    hinata_arena_t arena = { 0 };
+    uint32_t i;
+    int ret = 0;
+
+    if (!block) {
+        return -EINVAL;
+    }
+
+    // 在副本上搬移，失败时原块保持不变；空向量不再持有内存
+    moved = *block;
+    moved.core.tags.items = NULL;
+    moved.note_items = NULL;
+    if (moved.core.tags.count) {
+        moved.core.tags.items = malloc(moved.core.tags.count * sizeof(*moved.core.tags.items));
+    }
+    if (moved.note_item_count) {
+        moved.note_items = malloc(moved.note_item_count * sizeof(*moved.note_items));
+    }
+    if ((moved.core.tags.count && !moved.core.tags.items) ||
+        (moved.note_item_count && !moved.note_items)) {
+        ret = -ENOMEM;
+        goto out_free;
+    }
+
+    if (moved.core.tags.count) {
+        memcpy(moved.core.tags.items, block->core.tags.items,
+               moved.core.tags.count * sizeof(*moved.core.tags.items));
+    }
+    if (moved.note_item_count) {
+        memcpy(moved.note_items, block->note_items,
+               moved.note_item_count * sizeof(*moved.note_items));
+    }
+
+    ret = hinata_arena_move(&arena, &block->arena, &moved.core.highlight);
+    if (!ret) ret = hinata_arena_move(&arena, &block->arena, &moved.core.note);
+    if (!ret) ret = hinata_arena_move(&arena, &block->arena, &moved.core.at);
+    if (!ret) ret = hinata_arena_move(&arena, &block->arena, &moved.position.xpath);
+    for (i = 0; !ret && i < moved.core.tags.count; i++) {
+        ret = hinata_arena_move(&arena, &block->arena, &moved.core.tags.items[i]);
+    }
+    for (i = 0; !ret && i < moved.note_item_count; i++) {
+        ret = hinata_arena_move(&arena, &block->arena, &moved.note_items[i].content);
+    }
+    if (ret < 0) {
+        goto out_free;
+    }
+
+    free(block->core.tags.items);
+    free(block->note_items);
+    free(block->arena.data);
+
+    moved.core.tags.capacity = moved.core.tags.count;
+    moved.note_item_capacity = moved.note_item_count;
+    moved.arena = arena;
+    hinata_vec_shrink((void **)&moved.arena.data, &moved.arena.capacity, moved.arena.used, 1);
+    hinata_vec_shrink((void **)&moved.references.items, &moved.references.capacity,
+                      moved.references.count, sizeof(*moved.references.items));
+    hinata_vec_shrink((void **)&moved.backlinks.items, &moved.backlinks.capacity,
+                      moved.backlinks.count, sizeof(*moved.backlinks.items));
+
+    *block = moved;
+    return 0;
+
+out_free:
+    free(arena.data);
+    free(moved.core.tags.items);
+    free(moved.note_items);
+    return ret;
+}
+
+size_t hinata_compact_block_footprint(const hinata_compact_block_t *block)
+{
+    return sizeof(*block) +
+           block->arena.capacity +
+           block->core.tags.capacity * sizeof(*block->core.tags.items) +
+           block->note_item_capacity * sizeof(*block->note_items) +
+           block->references.capacity * sizeof(*block->references.items) +
+           block->backlinks.capacity * sizeof(*block->backlinks.items);
+}
+
+// ============================================================================
+// 与旧结构体的转换
+// ============================================================================
+
+int hinata_compact_block_from_legacy(hinata_compact_block_t *dest,
+                                     const hinata_knowledge_block_t *src)
+{
+    hinata_compact_block_t block;
+    const hinata_note_item_t *note;
+    uint32_t count;
+    uint32_t i;
+    int ret;
+
+    if (!dest || !src) {
+        return -EINVAL;
+    }
+
+    hinata_compact_block_init(&block);
+
+    hinata_uuid_assign(block.id, src->id);
+    hinata_uuid_assign(block.user_id, src->user_id);
+    hinata_uuid_assign(block.library_item_id, src->library_item_id);
+    block.core.access = src->core.access;
+    block.created_at = src->created_at;
+    block.updated_at = src->updated_at;
+
+    block.position.start_offset = src->position.start_offset;
+    block.position.end_offset = src->position.end_offset;
+    block.position.line_number = src->position.line_number;
+    block.position.column_number = src->position.column_number;
+    block.position.has_position = src->position.has_position;
+
+    ret = hinata_arena_store_bounded(&block.arena, src->core.highlight,
+                                     sizeof(src->core.highlight), &block.core.highlight);
+    if (!ret) {
+        ret = hinata_arena_store_bounded(&block.arena, src->core.note,
+                                         sizeof(src->core.note), &block.core.note);
+    }
+    if (!ret) {
+        ret = hinata_arena_store_bounded(&block.arena, src->core.at,
+                                         sizeof(src->core.at), &block.core.at);
+    }
+    if (!ret) {
+        ret = hinata_arena_store_bounded(&block.arena, src->position.xpath,
+                                         sizeof(src->position.xpath), &block.position.xpath);
+    }
+
+    count = src->core.tag_count < HINATA_MAX_TAGS ? src->core.tag_count : HINATA_MAX_TAGS;
+    for (i = 0; !ret && i < count; i++) {
+        if (src->core.tags[i][0]) {
+            ret = hinata_compact_block_add_tag(&block, src->core.tags[i]);
+        }
+    }
+
+    count = src->note_item_count < HINATA_ARRAY_LEN(src->note_items) ?
+            src->note_item_count : HINATA_ARRAY_LEN(src->note_items);
+    for (i = 0; !ret && i < count; i++) {
+        note = &src->note_items[i];
+        ret = hinata_vec_reserve((void **)&block.note_items, &block.note_item_capacity,
+                                 block.note_item_count + 1, sizeof(*block.note_items));
+        if (ret < 0) {
+            break;
+        }
+
+        memset(&block.note_items[i], 0, sizeof(block.note_items[i]));
+        hinata_uuid_assign(block.note_items[i].id, note->id);
+        block.note_items[i].content_format = note->content_format;
+        block.note_items[i].order = note->order;
+        block.note_items[i].created_at = note->created_at;
+        block.note_items[i].updated_at = note->updated_at;
+        ret = hinata_arena_store_bounded(&block.arena, note->content, sizeof(note->content),
+                                         &block.note_items[i].content);
+        if (!ret) {
+            block.note_item_count++;
+        }
+    }
+
+    count = src->reference_count < HINATA_ARRAY_LEN(src->references) ?
+            src->reference_count : HINATA_ARRAY_LEN(src->references);
+    for (i = 0; !ret && i < count; i++) {
+        ret = hinata_uuid_vec_push(&block.references, src->references[i]);
+    }
+
+    count = src->backlink_count < HINATA_ARRAY_LEN(src->backlinks) ?
+            src->backlink_count : HINATA_ARRAY_LEN(src->backlinks);
+    for (i = 0; !ret && i < count; i++) {
+        ret = hinata_uuid_vec_push(&block.backlinks, src->backlinks[i]);
+    }
+
+    if (ret < 0) {
+        hinata_compact_block_free(&block);
+        return ret;
+    }
+
+    *dest = block;
+    return 0;
+}
+
+int hinata_compact_block_to_legacy(const hinata_compact_block_t *src,
+                                   hinata_knowledge_block_t *dest)
+{
+    const hinata_compact_note_item_t *note;
+    bool complete = true;
+    uint32_t count;
+    uint32_t i;
+
+    if (!src || !dest) {
+        return -EINVAL;
+    }
+
+    memset(dest, 0, sizeof(*dest));
+
+    hinata_uuid_assign(dest->id, src->id);
+    hinata_uuid_assign(dest->user_id, src->user_id);
+    hinata_uuid_assign(dest->library_item_id, src->library_item_id);
+    dest->core.access = src->core.access;
+    dest->created_at = src->created_at;
+    dest->updated_at = src->updated_at;
+
+    complete &= hinata_copy_bounded(dest->core.highlight, sizeof(dest->core.highlight),
+                                    hinata_compact_str(src, src->core.highlight),
+                                    src->core.highlight.length);
+    complete &= hinata_copy_bounded(dest->core.note, sizeof(dest->core.note),
+                                    hinata_compact_str(src, src->core.note),
+                                    src->core.note.length);
+    complete &= hinata_copy_bounded(dest->core.at, sizeof(dest->core.at),
+                                    hinata_compact_str(src, src->core.at),
+                                    src->core.at.length);
+
+    count = src->core.tags.count;
+    if (count > HINATA_MAX_TAGS) {
+        count = HINATA_MAX_TAGS;
+        complete = false;
+    }
+    for (i = 0; i < count; i++) {
+        complete &= hinata_copy_bounded(dest->core.tags[i], sizeof(dest->core.tags[i]),
+                                        hinata_compact_str(src, src->core.tags.items[i]),
+                                        src->core.tags.items[i].length);
+    }
+    dest->core.tag_count = (uint8_t)count;
+
+    dest->position.start_offset = src->position.start_offset;
+    dest->position.end_offset = src->position.end_offset;
+    dest->position.line_number = src->position.line_number;
+    dest->position.column_number = src->position.column_number;
+    dest->position.has_position = src->position.has_position;
+    complete &= hinata_copy_bounded(dest->position.xpath, sizeof(dest->position.xpath),
+                                    hinata_compact_str(src, src->position.xpath),
+                                    src->position.xpath.length);
+
+    count = src->note_item_count;
+    if (count > HINATA_ARRAY_LEN(dest->note_items)) {
+        count = HINATA_ARRAY_LEN(dest->note_items);
+        complete = false;
+    }
+    for (i = 0; i < count; i++) {
+        note = &src->note_items[i];
+        hinata_uuid_assign(dest->note_items[i].id, note->id);
+        hinata_uuid_assign(dest->note_items[i].knowledge_block_id, src->id);
+        complete &= hinata_copy_bounded(dest->note_items[i].content,
+                                        sizeof(dest->note_items[i].content),
+                                        hinata_compact_str(src, note->content),
+                                        note->content.length);
+        dest->note_items[i].content_format = note->content_format;
+        dest->note_items[i].order = note->order;
+        dest->note_items[i].created_at = note->created_at;
+        dest->note_items[i].updated_at = note->updated_at;
+    }
+    dest->note_item_count = (uint8_t)count;
+
+    count = src->references.count;
+    if (count > HINATA_ARRAY_LEN(dest->references)) {
+        count = HINATA_ARRAY_LEN(dest->references);
+        complete = false;
+    }
+    for (i = 0; i < count; i++) {
+        hinata_uuid_assign(dest->references[i], src->references.items[i]);
+    }
+    dest->reference_count = (uint8_t)count;
+
+    count = src->backlinks.count;
+    if (count > HINATA_ARRAY_LEN(dest->backlinks)) {
+        count = HINATA_ARRAY_LEN(dest->backlinks);
+        complete = false;
+    }
+    for (i = 0; i < count; i++) {
+        hinata_uuid_assign(dest->backlinks[i], src->backlinks.items[i]);
+    }
+    dest->backlink_count = (uint8_t)count;
+
+    return complete ? 0 : -ENOSPC;
+}
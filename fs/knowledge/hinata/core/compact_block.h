@@ -0,0 +1,218 @@
+/**
+ * HiNATA 紧凑知识块 - C 语言定义
+ *
+ * hinata_knowledge_block_t 按最大容量预留所有字段，单个块超过 200 KB。
+ * 这里定义变长的紧凑表示：字符串以 offset/length 存放在块私有的 arena 中，
+ * 笔记项、标签、引用和反向链接使用可增长的向量，没有固定上限。
+ * 热路径使用紧凑表示，需要旧结构体的接口通过转换函数继续工作。
+ */
+
+#ifndef _HINATA_COMPACT_BLOCK_H
+#define _HINATA_COMPACT_BLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+
+// ============================================================================
+// 基础类型定义
+// ============================================================================
+
+/**
+ * arena 中的字符串引用（length 不含 null 终止符）
+ */
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} hinata_str_ref_t;
+
+/**
+ * 追加式字符串 arena，每个字符串以 null 结尾存放
+ */
+typedef struct {
+    char *data;
+    uint32_t used;
+    uint32_t capacity;
+} hinata_arena_t;
+
+/**
+ * 可增长的 UUID 向量
+ */
+typedef struct {
+    hinata_uuid_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} hinata_uuid_vec_t;
+
+/**
+ * 可增长的字符串引用向量
+ */
+typedef struct {
+    hinata_str_ref_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} hinata_str_ref_vec_t;
+
+// ============================================================================
+// 紧凑数据结构
+// ============================================================================
+
+/**
+ * 紧凑 HiNATA 核心结构
+ */
+typedef struct {
+    hinata_str_ref_t highlight;
+    hinata_str_ref_t note;
+    hinata_str_ref_t at;
+    hinata_str_ref_vec_t tags;
+    hinata_access_level_t access;
+} hinata_compact_core_t;
+
+/**
+ * 紧凑位置信息
+ */
+typedef struct {
+    uint32_t start_offset;
+    uint32_t end_offset;
+    uint32_t line_number;
+    uint32_t column_number;
+    hinata_str_ref_t xpath;
+    bool has_position;
+} hinata_compact_position_t;
+
+/**
+ * 紧凑笔记项（所属知识块即外层块）
+ */
+typedef struct {
+    hinata_uuid_t id;
+    hinata_str_ref_t content;
+    hinata_content_format_t content_format;
+    uint8_t order;
+    hinata_timestamp_t created_at;
+    hinata_timestamp_t updated_at;
+} hinata_compact_note_item_t;
+
+/**
+ * 紧凑知识块
+ */
+typedef struct {
+    hinata_uuid_t id;
+    hinata_uuid_t user_id;
+    hinata_uuid_t library_item_id;
+
+    // HiNATA 核心结构
+    hinata_compact_core_t core;
+
+    // 位置信息
+    hinata_compact_position_t position;
+
+    // 笔记项集合
+    hinata_compact_note_item_t *note_items;
+    uint32_t note_item_count;
+    uint32_t note_item_capacity;
+
+    // 时间戳
+    hinata_timestamp_t created_at;
+    hinata_timestamp_t updated_at;
+
+    // 关联关系
+    hinata_uuid_vec_t references;
+    hinata_uuid_vec_t backlinks;
+
+    // 字符串存储
+    hinata_arena_t arena;
+} hinata_compact_block_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * arena 操作，追加的 value 可以指向同一 arena 中的字符串
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+int hinata_arena_append(hinata_arena_t *arena, const char *value, size_t len,
+                        hinata_str_ref_t *ref);
+const char *hinata_arena_str(const hinata_arena_t *arena, hinata_str_ref_t ref);
+void hinata_arena_free(hinata_arena_t *arena);
+
+/**
+ * 向量与 UUID 工具
+ * hinata_vec_reserve 按倍数增长，保证至少能容纳 needed 个元素
+ * hinata_next_version 返回进程内递增、从不为 0 的写入版本，
+ * 索引释放后重新初始化也不会重复用过的版本
+ */
+int hinata_vec_reserve(void **items, uint32_t *capacity, uint32_t needed, size_t elem_size);
+void hinata_vec_shrink(void **items, uint32_t *capacity, uint32_t count, size_t elem_size);
+uint64_t hinata_next_version(void);
+void hinata_uuid_assign(hinata_uuid_t dest, const hinata_uuid_t src);
+
+/**
+ * UUID 键的线性探测哈希表：槽位存放条目编号（下标 + 1），0 为空，容量为 2 的幂。
+ * key 返回条目编号对应的 UUID，条目已不存在时返回 NULL（扩容时跳过）。
+ *
+ * hinata_uuid_slot 返回 uuid 所在的槽位，不存在时为应插入的空槽位；
+ * hinata_uuid_slots_grow 在再放入一个条目会使负载超过一半时把容量翻倍，
+ * 并重新插入编号 1..entries 的条目；
+ * hinata_uuid_slots_unlink 删除 hole 处的条目，后面的条目前移，不留墓碑
+ */
+typedef const char *(*hinata_uuid_key_t)(const void *owner, uint32_t entry);
+
+uint32_t hinata_uuid_hash(const char *uuid);
+uint32_t hinata_uuid_slot(const uint32_t *slots, uint32_t capacity, const char *uuid,
+                          hinata_uuid_key_t key, const void *owner);
+int hinata_uuid_slots_grow(uint32_t **slots, uint32_t *capacity, uint32_t count,
+                           uint32_t entries, hinata_uuid_key_t key, const void *owner);
+void hinata_uuid_slots_unlink(uint32_t *slots, uint32_t capacity, uint32_t hole,
+                              hinata_uuid_key_t key, const void *owner);
+
+/**
+ * 初始化与释放
+ */
+void hinata_compact_block_init(hinata_compact_block_t *block);
+void hinata_compact_block_free(hinata_compact_block_t *block);
+
+/**
+ * 字符串访问
+ * 返回的指针指向 arena，块被修改后失效
+ */
+const char *hinata_compact_str(const hinata_compact_block_t *block, hinata_str_ref_t ref);
+
+/**
+ * 内容修改
+ */
+int hinata_compact_block_set_str(hinata_compact_block_t *block, hinata_str_ref_t *field,
+                                 const char *value);
+int hinata_compact_block_add_tag(hinata_compact_block_t *block, const char *tag);
+int hinata_compact_block_add_note_item(hinata_compact_block_t *block,
+                                       const hinata_uuid_t id,
+                                       const char *content,
+                                       hinata_content_format_t format,
+                                       uint8_t order,
+                                       hinata_timestamp_t created_at,
+                                       hinata_timestamp_t updated_at);
+int hinata_compact_block_add_reference(hinata_compact_block_t *block, const hinata_uuid_t target);
+int hinata_compact_block_add_backlink(hinata_compact_block_t *block, const hinata_uuid_t source);
+
+/**
+ * 回收被替换字符串占用的 arena 空间，并收缩所有向量
+ */
+int hinata_compact_block_shrink(hinata_compact_block_t *block);
+
+/**
+ * 当前占用的堆内存（字节，含结构体本身）
+ */
+size_t hinata_compact_block_footprint(const hinata_compact_block_t *block);
+
+/**
+ * 与 hinata_knowledge_block_t 互相转换
+ * to_legacy 超出旧结构体容量时截断并返回 -ENOSPC，其余字段照常填写
+ */
+int hinata_compact_block_from_legacy(hinata_compact_block_t *dest,
+                                     const hinata_knowledge_block_t *src);
+int hinata_compact_block_to_legacy(const hinata_compact_block_t *src,
+                                   hinata_knowledge_block_t *dest);
+
+#endif /* _HINATA_COMPACT_BLOCK_H */
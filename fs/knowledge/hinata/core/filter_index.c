@@ -0,0 +1,742 @@
+/**
+ * HiNATA 过滤索引 - C 语言实现
+ */
+
+#include "filter_index.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * 日期范围边界桶的逐个比较
+ */
+typedef struct {
+    const hinata_filter_index_t *index;
+    const hinata_date_range_t *range;
+    hinata_bitmap_t *out;
+    int ret;
+} hinata_filter_range_ctx_t;
+
+// ============================================================================
+// 文档与用户字典
+// ============================================================================
+
+static const char *hinata_filter_doc_key(const void *owner, uint32_t entry)
+{
+    return ((const hinata_filter_index_t *)owner)->docs[entry - 1].id;
+}
+
+static const char *hinata_filter_user_key(const void *owner, uint32_t entry)
+{
+    return ((const hinata_filter_index_t *)owner)->users[entry - 1].id;
+}
+
+static uint32_t hinata_filter_doc_slot(const hinata_filter_index_t *index, const char *uuid)
+{
+    return hinata_uuid_slot(index->doc_slots, index->doc_slot_capacity, uuid,
+                            hinata_filter_doc_key, index);
+}
+
+static uint32_t hinata_filter_user_slot(const hinata_filter_index_t *index, const char *uuid)
+{
+    return hinata_uuid_slot(index->user_slots, index->user_slot_capacity, uuid,
+                            hinata_filter_user_key, index);
+}
+
+/**
+ * 负载超过一半时扩容并重新插入
+ */
+static int hinata_filter_grow_slots(hinata_filter_index_t *index, bool users)
+{
+    if (users) {
+        return hinata_uuid_slots_grow(&index->user_slots, &index->user_slot_capacity,
+                                      index->user_count, index->user_count,
+                                      hinata_filter_user_key, index);
+    }
+
+    return hinata_uuid_slots_grow(&index->doc_slots, &index->doc_slot_capacity,
+                                  index->doc_count, index->doc_count,
+                                  hinata_filter_doc_key, index);
+}
+
+static int hinata_filter_user(hinata_filter_index_t *index, const char *uuid, uint32_t *user)
+{
+    hinata_filter_user_t *entry;
+    uint32_t slot;
+    int ret;
+
+    ret = hinata_filter_grow_slots(index, true);
+    if (ret < 0) {
+        return ret;
+    }
+
+    slot = hinata_filter_user_slot(index, uuid);
+    if (index->user_slots[slot]) {
+        *user = index->user_slots[slot] - 1;
+        return 0;
+    }
+
+    ret = hinata_vec_reserve((void **)&index->users, &index->user_capacity, index->user_count + 1,
+                             sizeof(*index->users));
+    if (ret < 0) {
+        return ret;
+    }
+
+    entry = &index->users[index->user_count];
+    hinata_uuid_assign(entry->id, uuid);
+    hinata_bitmap_init(&entry->docs);
+    index->user_slots[slot] = index->user_count + 1;
+    *user = index->user_count++;
+    return 0;
+}
+
+// ============================================================================
+// 时间桶
+// ============================================================================
+
+static int64_t hinata_filter_bucket_of(const hinata_filter_index_t *index, hinata_timestamp_t ts)
+{
+    int64_t bucket = ts / index->bucket_width;
+
+    // 向下取整，负时间戳也落在正确的桶里
+    if (ts % index->bucket_width < 0) {
+        bucket--;
+    }
+
+    return bucket;
+}
+
+static uint32_t hinata_filter_bucket_lower_bound(const hinata_filter_index_t *index, int64_t bucket)
+{
+    uint32_t left = 0, right = index->bucket_count, mid;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (index->buckets[mid].bucket < bucket) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+static hinata_bitmap_t *hinata_filter_bucket(hinata_filter_index_t *index, hinata_timestamp_t ts,
+                                             bool create)
+{
+    int64_t bucket = hinata_filter_bucket_of(index, ts);
+    uint32_t pos = hinata_filter_bucket_lower_bound(index, bucket);
+
+    if (pos < index->bucket_count && index->buckets[pos].bucket == bucket) {
+        return &index->buckets[pos].docs;
+    }
+    if (!create || hinata_vec_reserve((void **)&index->buckets, &index->bucket_capacity,
+                                      index->bucket_count + 1, sizeof(*index->buckets)) < 0) {
+        return NULL;
+    }
+
+    memmove(index->buckets + pos + 1, index->buckets + pos,
+            (size_t)(index->bucket_count - pos) * sizeof(*index->buckets));
+    index->buckets[pos].bucket = bucket;
+    hinata_bitmap_init(&index->buckets[pos].docs);
+    index->bucket_count++;
+    return &index->buckets[pos].docs;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_filter_index_init(hinata_filter_index_t *index, hinata_timestamp_t bucket_width)
+{
+    memset(index, 0, sizeof(*index));
+    index->bucket_width = bucket_width > 0 ? bucket_width : HINATA_FILTER_BUCKET_WIDTH;
+    index->version = hinata_next_version();
+    hinata_tag_dict_init(&index->tags);
+}
+
+void hinata_filter_index_free(hinata_filter_index_t *index)
+{
+    uint32_t i;
+
+    if (!index) {
+        return;
+    }
+
+    for (i = 0; i < index->user_count; i++) {
+        hinata_bitmap_free(&index->users[i].docs);
+    }
+    for (i = 0; i < index->tag_docs_capacity; i++) {
+        hinata_bitmap_free(&index->tag_docs[i]);
+    }
+    for (i = 0; i < index->bucket_count; i++) {
+        hinata_bitmap_free(&index->buckets[i].docs);
+    }
+    for (i = 0; i < 4; i++) {
+        hinata_bitmap_free(&index->access[i]);
+    }
+    for (i = 0; i < 7; i++) {
+        hinata_bitmap_free(&index->formats[i]);
+    }
+    hinata_bitmap_free(&index->all);
+    hinata_bitmap_free(&index->attachments);
+
+    free(index->docs);
+    free(index->doc_slots);
+    free(index->tag_pool);
+    free(index->users);
+    free(index->user_slots);
+    free(index->tag_docs);
+    free(index->buckets);
+    hinata_tag_dict_free(&index->tags);
+    hinata_filter_index_init(index, 0);
+}
+
+// ============================================================================
+// 插入与删除
+// ============================================================================
+
+/**
+ * 从所有位图中清除文档
+ * 删除只会在位集转回数组时失败，此时元素已经清除，因此忽略返回值
+ */
+static void hinata_filter_unindex(hinata_filter_index_t *index, uint32_t doc_id)
+{
+    hinata_filter_record_t *record = &index->docs[doc_id];
+    hinata_bitmap_t *bucket;
+    uint32_t i;
+
+    if (!record->live) {
+        return;
+    }
+
+    hinata_bitmap_remove(&index->all, doc_id);
+    hinata_bitmap_remove(&index->access[record->access], doc_id);
+    if (record->format != HINATA_FILTER_NO_FORMAT) {
+        hinata_bitmap_remove(&index->formats[record->format], doc_id);
+    }
+    if (record->has_attachments) {
+        hinata_bitmap_remove(&index->attachments, doc_id);
+    }
+    hinata_bitmap_remove(&index->users[record->user].docs, doc_id);
+    for (i = 0; i < record->tag_count; i++) {
+        hinata_bitmap_remove(&index->tag_docs[index->tag_pool[record->tag_start + i]], doc_id);
+    }
+
+    bucket = hinata_filter_bucket(index, record->created_at, false);
+    if (bucket) {
+        hinata_bitmap_remove(bucket, doc_id);
+    }
+
+    record->live = false;
+    index->live_count--;
+}
+
+/**
+ * 把文档的标签写入 tag_pool，新标签同时分配位图
+ */
+static int hinata_filter_store_tags(hinata_filter_index_t *index, hinata_filter_record_t *record,
+                                    const hinata_filter_doc_t *doc)
+{
+    uint32_t start, tag, capacity, i;
+    int ret;
+
+    // 标签数不超过旧区间时原地覆盖
+    start = record->tag_start;
+    if (doc->tag_count > record->tag_count) {
+        ret = hinata_vec_reserve((void **)&index->tag_pool, &index->tag_pool_capacity,
+                                 index->tag_pool_count + doc->tag_count, sizeof(*index->tag_pool));
+        if (ret < 0) {
+            return ret;
+        }
+        start = index->tag_pool_count;
+        index->tag_pool_count += doc->tag_count;
+    }
+
+    record->tag_start = start;
+    record->tag_count = 0;
+    for (i = 0; i < doc->tag_count; i++) {
+        ret = hinata_tag_dict_intern(&index->tags, doc->tags[i], &tag);
+        if (ret == -EINVAL) {
+            continue;
+        }
+        if (ret < 0) {
+            return ret;
+        }
+
+        // 扩容后的位图全部初始化，释放时按容量遍历
+        capacity = index->tag_docs_capacity;
+        ret = hinata_vec_reserve((void **)&index->tag_docs, &index->tag_docs_capacity,
+                                 index->tags.count, sizeof(*index->tag_docs));
+        if (ret < 0) {
+            return ret;
+        }
+        for (; capacity < index->tag_docs_capacity; capacity++) {
+            hinata_bitmap_init(&index->tag_docs[capacity]);
+        }
+
+        index->tag_pool[start + record->tag_count++] = tag;
+    }
+
+    return 0;
+}
+
+int hinata_filter_index_upsert(hinata_filter_index_t *index, const hinata_filter_doc_t *doc,
+                               uint32_t *doc_id)
+{
+    hinata_filter_record_t *record;
+    hinata_bitmap_t *bucket;
+    uint32_t slot, id, i;
+    int ret;
+
+    if (!index || !doc || !doc->id || !doc->id[0] || (uint32_t)doc->access >= 4 ||
+        (doc->has_content_format && (uint32_t)doc->content_format >= 7)) {
+        return -EINVAL;
+    }
+
+    ret = hinata_filter_grow_slots(index, false);
+    if (ret < 0) {
+        return ret;
+    }
+
+    index->version = hinata_next_version();
+    slot = hinata_filter_doc_slot(index, doc->id);
+    if (index->doc_slots[slot]) {
+        id = index->doc_slots[slot] - 1;
+        hinata_filter_unindex(index, id);
+    } else {
+        ret = hinata_vec_reserve((void **)&index->docs, &index->doc_capacity, index->doc_count + 1,
+                                 sizeof(*index->docs));
+        if (ret < 0) {
+            return ret;
+        }
+        id = index->doc_count++;
+        memset(&index->docs[id], 0, sizeof(index->docs[id]));
+        hinata_uuid_assign(index->docs[id].id, doc->id);
+        index->doc_slots[slot] = id + 1;
+    }
+
+    record = &index->docs[id];
+    ret = hinata_filter_user(index, doc->user_id ? doc->user_id : "", &record->user);
+    if (!ret) {
+        ret = hinata_filter_store_tags(index, record, doc);
+    }
+    if (ret < 0) {
+        record->tag_count = 0;
+        return ret;
+    }
+
+    record->created_at = doc->created_at;
+    record->access = (uint8_t)doc->access;
+    record->format = doc->has_content_format ? (uint8_t)doc->content_format : HINATA_FILTER_NO_FORMAT;
+    record->has_attachments = doc->has_attachments;
+
+    // 先标记为有效，失败时 remove 仍能清除已经写入的位
+    record->live = true;
+    index->live_count++;
+
+    ret = hinata_bitmap_add(&index->all, id);
+    if (!ret) {
+        ret = hinata_bitmap_add(&index->access[record->access], id);
+    }
+    if (!ret && record->format != HINATA_FILTER_NO_FORMAT) {
+        ret = hinata_bitmap_add(&index->formats[record->format], id);
+    }
+    if (!ret && record->has_attachments) {
+        ret = hinata_bitmap_add(&index->attachments, id);
+    }
+    if (!ret) {
+        ret = hinata_bitmap_add(&index->users[record->user].docs, id);
+    }
+    for (i = 0; !ret && i < record->tag_count; i++) {
+        ret = hinata_bitmap_add(&index->tag_docs[index->tag_pool[record->tag_start + i]], id);
+    }
+    if (!ret) {
+        bucket = hinata_filter_bucket(index, record->created_at, true);
+        ret = bucket ? hinata_bitmap_add(bucket, id) : -ENOMEM;
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (doc_id) {
+        *doc_id = id;
+    }
+    return 0;
+}
+
+/**
+ * 收集定长标签数组的指针
+ */
+static uint32_t hinata_filter_tag_ptrs(const char (*tags)[HINATA_MAX_TAG_LEN], uint8_t count,
+                                       const char **ptrs)
+{
+    uint32_t i;
+
+    if (count > HINATA_MAX_TAGS) {
+        count = HINATA_MAX_TAGS;
+    }
+    for (i = 0; i < count; i++) {
+        ptrs[i] = tags[i];
+    }
+
+    return count;
+}
+
+int hinata_filter_index_add_library_item(hinata_filter_index_t *index,
+                                         const hinata_library_item_t *item)
+{
+    const char *tags[HINATA_MAX_TAGS];
+    hinata_filter_doc_t doc;
+
+    if (!item) {
+        return -EINVAL;
+    }
+
+    memset(&doc, 0, sizeof(doc));
+    doc.id = item->id;
+    doc.user_id = item->user_id;
+    doc.tags = tags;
+    doc.tag_count = hinata_filter_tag_ptrs(item->core.tags, item->core.tag_count, tags);
+    doc.access = item->core.access;
+    doc.content_format = item->content_format;
+    doc.has_content_format = true;
+    doc.created_at = item->created_at;
+    return hinata_filter_index_upsert(index, &doc, NULL);
+}
+
+int hinata_filter_index_add_knowledge_block(hinata_filter_index_t *index,
+                                            const hinata_knowledge_block_t *block)
+{
+    const char *tags[HINATA_MAX_TAGS];
+    hinata_filter_doc_t doc;
+
+    if (!block) {
+        return -EINVAL;
+    }
+
+    memset(&doc, 0, sizeof(doc));
+    doc.id = block->id;
+    doc.user_id = block->user_id;
+    doc.tags = tags;
+    doc.tag_count = hinata_filter_tag_ptrs(block->core.tags, block->core.tag_count, tags);
+    doc.access = block->core.access;
+    doc.created_at = block->created_at;
+    return hinata_filter_index_upsert(index, &doc, NULL);
+}
+
+int hinata_filter_index_add_compact_block(hinata_filter_index_t *index,
+                                          const hinata_compact_block_t *block)
+{
+    const char **tags;
+    hinata_filter_doc_t doc;
+    uint32_t i;
+    int ret;
+
+    if (!block) {
+        return -EINVAL;
+    }
+
+    tags = malloc((block->core.tags.count ? block->core.tags.count : 1) * sizeof(*tags));
+    if (!tags) {
+        return -ENOMEM;
+    }
+    for (i = 0; i < block->core.tags.count; i++) {
+        tags[i] = hinata_compact_str(block, block->core.tags.items[i]);
+    }
+
+    memset(&doc, 0, sizeof(doc));
+    doc.id = block->id;
+    doc.user_id = block->user_id;
+    doc.tags = tags;
+    doc.tag_count = block->core.tags.count;
+    doc.access = block->core.access;
+    doc.created_at = block->created_at;
+    ret = hinata_filter_index_upsert(index, &doc, NULL);
+
+    free(tags);
+    return ret;
+}
+
+int hinata_filter_index_add_packet(hinata_filter_index_t *index, const hinata_data_packet_t *packet,
+                                   const hinata_uuid_t user_id)
+{
+    const char *tags[HINATA_MAX_TAGS];
+    hinata_filter_doc_t doc;
+
+    if (!packet) {
+        return -EINVAL;
+    }
+
+    memset(&doc, 0, sizeof(doc));
+    doc.id = packet->metadata.packet_id;
+    doc.user_id = user_id;
+    doc.tags = tags;
+    doc.tag_count = hinata_filter_tag_ptrs(packet->payload.core.tags,
+                                           packet->payload.core.tag_count, tags);
+    doc.access = packet->payload.core.access;
+    doc.content_format = packet->payload.content_format;
+    doc.has_content_format = true;
+    doc.has_attachments = packet->payload.attachment_count > 0;
+    doc.created_at = packet->metadata.capture_timestamp;
+    return hinata_filter_index_upsert(index, &doc, NULL);
+}
+
+int hinata_filter_index_remove(hinata_filter_index_t *index, const char *id)
+{
+    uint32_t entry;
+
+    if (!index || !id) {
+        return -EINVAL;
+    }
+    if (!index->doc_slot_capacity) {
+        return -ENOENT;
+    }
+
+    entry = index->doc_slots[hinata_filter_doc_slot(index, id)];
+    if (!entry || !index->docs[entry - 1].live) {
+        return -ENOENT;
+    }
+
+    index->version = hinata_next_version();
+    hinata_filter_unindex(index, entry - 1);
+    return 0;
+}
+
+// ============================================================================
+// 过滤求值
+// ============================================================================
+
+/**
+ * 用 set 收窄结果；第一个条件直接复制
+ */
+static int hinata_filter_narrow(hinata_bitmap_t *out, bool *started, const hinata_bitmap_t *set)
+{
+    if (!*started) {
+        *started = true;
+        return hinata_bitmap_copy(out, set);
+    }
+
+    return hinata_bitmap_and_inplace(out, set);
+}
+
+/**
+ * 用若干位图的并集收窄结果
+ */
+static int hinata_filter_narrow_any(hinata_bitmap_t *out, bool *started,
+                                    const hinata_bitmap_t *const *sets, uint32_t count)
+{
+    hinata_bitmap_t set;
+    int ret;
+
+    hinata_bitmap_init(&set);
+    ret = hinata_bitmap_or_many(&set, sets, count);
+    if (!ret) {
+        ret = hinata_filter_narrow(out, started, &set);
+    }
+
+    hinata_bitmap_free(&set);
+    return ret;
+}
+
+static bool hinata_filter_range_visit(void *ctx, uint32_t doc_id)
+{
+    hinata_filter_range_ctx_t *range_ctx = ctx;
+    const hinata_date_range_t *range = range_ctx->range;
+    hinata_timestamp_t ts = range_ctx->index->docs[doc_id].created_at;
+
+    if ((range->has_start && ts < range->start) || (range->has_end && ts > range->end)) {
+        return true;
+    }
+
+    range_ctx->ret = hinata_bitmap_add(range_ctx->out, doc_id);
+    return range_ctx->ret == 0;
+}
+
+/**
+ * 日期范围：完全落在范围内的桶整体参与并集，边界桶逐个比较时间戳
+ */
+static int hinata_filter_date_range(const hinata_filter_index_t *index,
+                                    const hinata_date_range_t *range, hinata_bitmap_t *out,
+                                    bool *started)
+{
+    const hinata_filter_bucket_t *bucket;
+    const hinata_bitmap_t **sets = NULL;
+    hinata_filter_range_ctx_t ctx;
+    hinata_bitmap_t edge;
+    int64_t last = range->has_end ? hinata_filter_bucket_of(index, range->end) : INT64_MAX;
+    hinata_timestamp_t begin;
+    uint64_t range_docs = 0, out_docs;
+    uint32_t count = 0, capacity = 0;
+    uint32_t pos = 0, i;
+    int ret = 0;
+
+    if (range->has_start) {
+        pos = hinata_filter_bucket_lower_bound(index, hinata_filter_bucket_of(index, range->start));
+    }
+
+    hinata_bitmap_init(&edge);
+    ctx.index = index;
+    ctx.range = range;
+    ctx.out = &edge;
+    ctx.ret = 0;
+
+    // 前面的条件已经比日期范围更有选择性时，直接按时间戳筛选现有结果
+    if (*started) {
+        out_docs = hinata_bitmap_cardinality(out);
+        for (i = pos; range_docs <= out_docs && i < index->bucket_count &&
+             index->buckets[i].bucket <= last; i++) {
+            range_docs += hinata_bitmap_cardinality(&index->buckets[i].docs);
+        }
+        if (range_docs > out_docs) {
+            hinata_bitmap_foreach(out, hinata_filter_range_visit, &ctx);
+            if (ctx.ret < 0) {
+                hinata_bitmap_free(&edge);
+                return ctx.ret;
+            }
+            hinata_bitmap_free(out);
+            *out = edge;
+            return 0;
+        }
+    }
+
+    for (; !ret && pos < index->bucket_count && index->buckets[pos].bucket <= last; pos++) {
+        bucket = &index->buckets[pos];
+        begin = bucket->bucket * index->bucket_width;
+
+        if ((!range->has_start || begin >= range->start) &&
+            (!range->has_end || begin + index->bucket_width - 1 <= range->end)) {
+            ret = hinata_vec_reserve((void **)&sets, &capacity, count + 2, sizeof(*sets));
+            if (!ret) {
+                sets[count++] = &bucket->docs;
+            }
+        } else {
+            hinata_bitmap_foreach(&bucket->docs, hinata_filter_range_visit, &ctx);
+            ret = ctx.ret;
+        }
+    }
+
+    if (!ret) {
+        ret = hinata_vec_reserve((void **)&sets, &capacity, count + 1, sizeof(*sets));
+    }
+    if (!ret) {
+        sets[count++] = &edge;
+        ret = hinata_filter_narrow_any(out, started, sets, count);
+    }
+
+    free(sets);
+    hinata_bitmap_free(&edge);
+    return ret;
+}
+
+int hinata_filter_index_evaluate(const hinata_filter_index_t *index,
+                                 const hinata_search_filters_t *filters, hinata_bitmap_t *out)
+{
+    const hinata_bitmap_t *sets[HINATA_MAX_TAGS];
+    const hinata_bitmap_t *set;
+    hinata_bitmap_t empty;
+    bool started = false;
+    uint32_t tag, count, n, i;
+    int ret = 0;
+
+    if (!index || !out) {
+        return -EINVAL;
+    }
+
+    hinata_bitmap_free(out);
+    if (!filters) {
+        return hinata_bitmap_copy(out, &index->all);
+    }
+
+    // 先用单个位图的条件收窄，再处理需要合并的条件
+    if (filters->has_user_id) {
+        hinata_bitmap_init(&empty);
+        set = hinata_filter_index_user_docs(index, filters->user_id);
+        ret = hinata_filter_narrow(out, &started, set ? set : &empty);
+    }
+    if (!ret && filters->has_attachments) {
+        ret = hinata_filter_narrow(out, &started, &index->attachments);
+    }
+
+    // 标签之间为"任一匹配"，与存储层的 block.tag.includes 一致，名称先规范化
+    if (!ret && filters->tag_count) {
+        count = filters->tag_count < HINATA_MAX_TAGS ? filters->tag_count : HINATA_MAX_TAGS;
+        for (i = 0, n = 0; i < count; i++) {
+            if (hinata_tag_dict_find(&index->tags, filters->tags[i], &tag) == 0) {
+                sets[n++] = &index->tag_docs[tag];
+            }
+        }
+        ret = hinata_filter_narrow_any(out, &started, sets, n);
+    }
+
+    if (!ret && filters->access_level_count) {
+        count = filters->access_level_count < 4 ? filters->access_level_count : 4;
+        for (i = 0, n = 0; i < count; i++) {
+            if ((uint32_t)filters->access_levels[i] < 4) {
+                sets[n++] = &index->access[filters->access_levels[i]];
+            }
+        }
+        ret = hinata_filter_narrow_any(out, &started, sets, n);
+    }
+
+    if (!ret && filters->content_format_count) {
+        count = filters->content_format_count < 7 ? filters->content_format_count : 7;
+        for (i = 0, n = 0; i < count; i++) {
+            if ((uint32_t)filters->content_formats[i] < 7) {
+                sets[n++] = &index->formats[filters->content_formats[i]];
+            }
+        }
+        ret = hinata_filter_narrow_any(out, &started, sets, n);
+    }
+
+    if (!ret && (filters->date_range.has_start || filters->date_range.has_end)) {
+        ret = hinata_filter_date_range(index, &filters->date_range, out, &started);
+    }
+
+    if (!ret && !started) {
+        ret = hinata_bitmap_copy(out, &index->all);
+    }
+    if (ret < 0) {
+        hinata_bitmap_free(out);
+    }
+
+    return ret;
+}
+
+// ============================================================================
+// 访问
+// ============================================================================
+
+const char *hinata_filter_index_doc_uuid(const hinata_filter_index_t *index, uint32_t doc_id)
+{
+    if (!index || doc_id >= index->doc_count) {
+        return NULL;
+    }
+
+    return index->docs[doc_id].id;
+}
+
+uint32_t hinata_filter_index_size(const hinata_filter_index_t *index)
+{
+    return index ? index->live_count : 0;
+}
+
+uint64_t hinata_filter_index_version(const hinata_filter_index_t *index)
+{
+    return index ? index->version : 0;
+}
+
+const hinata_bitmap_t *hinata_filter_index_user_docs(const hinata_filter_index_t *index,
+                                                     const char *user_id)
+{
+    uint32_t entry;
+
+    if (!index || !user_id || !index->user_slot_capacity) {
+        return NULL;
+    }
+
+    entry = index->user_slots[hinata_filter_user_slot(index, user_id)];
+    return entry ? &index->users[entry - 1].docs : NULL;
+}
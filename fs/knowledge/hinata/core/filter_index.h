@@ -0,0 +1,176 @@
+/**
+ * HiNATA 过滤索引 - C 语言定义
+ *
+ * 为 hinata_search_filters_t 中的每个条件维护压缩位图：每个标签、访问级别、
+ * 内容格式、用户和"有附件"各一个位图，创建时间按固定宽度分桶，每桶一个位图。
+ * 过滤条件被转换为位图的与、或运算，在排序之前得到候选文档集合，
+ * 只有落在日期范围边界上的桶才需要逐个比较时间戳。
+ *
+ * 索引不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_FILTER_INDEX_H
+#define _HINATA_FILTER_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+#include "bitmap.h"
+#include "tag_dict.h"
+
+// 默认时间桶宽度：一天（毫秒）
+#define HINATA_FILTER_BUCKET_WIDTH 86400000LL
+
+// 没有内容格式的文档（如知识块）
+#define HINATA_FILTER_NO_FORMAT 0xFF
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 被索引文档的描述，tags 中的名称按标签规则规范化
+ */
+typedef struct {
+    const char *id;
+    const char *user_id;
+    const char *const *tags;
+    uint32_t tag_count;
+    hinata_access_level_t access;
+    hinata_content_format_t content_format;
+    bool has_content_format;
+    bool has_attachments;
+    hinata_timestamp_t created_at;
+} hinata_filter_doc_t;
+
+/**
+ * 文档记录，下标即文档 ID（位图中的元素）
+ */
+typedef struct {
+    hinata_uuid_t id;
+    uint32_t user;              // 用户下标
+    uint32_t tag_start;         // 在 tag_pool 中的起始位置
+    uint32_t tag_count;
+    hinata_timestamp_t created_at;
+    uint8_t access;
+    uint8_t format;             // HINATA_FILTER_NO_FORMAT 表示没有格式
+    bool has_attachments;
+    bool live;
+} hinata_filter_record_t;
+
+/**
+ * 用户
+ */
+typedef struct {
+    hinata_uuid_t id;
+    hinata_bitmap_t docs;
+} hinata_filter_user_t;
+
+/**
+ * 时间桶：created_at 落在 [bucket * width, (bucket + 1) * width) 的文档
+ */
+typedef struct {
+    int64_t bucket;
+    hinata_bitmap_t docs;
+} hinata_filter_bucket_t;
+
+/**
+ * 过滤索引
+ */
+typedef struct {
+    hinata_timestamp_t bucket_width;
+
+    // 初始化和每次写入时取进程内递增的新值，查询缓存据此判断结果是否过期
+    uint64_t version;
+
+    // 文档，外部 ID -> 文档 ID + 1
+    hinata_filter_record_t *docs;
+    uint32_t doc_count;
+    uint32_t doc_capacity;
+    uint32_t *doc_slots;
+    uint32_t doc_slot_capacity;
+    uint32_t live_count;
+
+    // 文档的标签下标，更新时标签变多才追加新区间
+    uint32_t *tag_pool;
+    uint32_t tag_pool_count;
+    uint32_t tag_pool_capacity;
+
+    // 用户，user_id -> 用户下标 + 1
+    hinata_filter_user_t *users;
+    uint32_t user_count;
+    uint32_t user_capacity;
+    uint32_t *user_slots;
+    uint32_t user_slot_capacity;
+
+    // 标签位图，下标与标签字典一致
+    hinata_tag_dict_t tags;
+    hinata_bitmap_t *tag_docs;
+    uint32_t tag_docs_capacity;
+
+    // 取值较少的字段
+    hinata_bitmap_t all;
+    hinata_bitmap_t access[4];
+    hinata_bitmap_t formats[7];
+    hinata_bitmap_t attachments;
+
+    // 按 bucket 升序排列
+    hinata_filter_bucket_t *buckets;
+    uint32_t bucket_count;
+    uint32_t bucket_capacity;
+} hinata_filter_index_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放，bucket_width 为 0 时使用 HINATA_FILTER_BUCKET_WIDTH
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_filter_index_init(hinata_filter_index_t *index, hinata_timestamp_t bucket_width);
+void hinata_filter_index_free(hinata_filter_index_t *index);
+
+/**
+ * 插入或更新文档，doc_id 可为 NULL
+ */
+int hinata_filter_index_upsert(hinata_filter_index_t *index, const hinata_filter_doc_t *doc,
+                               uint32_t *doc_id);
+int hinata_filter_index_add_library_item(hinata_filter_index_t *index,
+                                         const hinata_library_item_t *item);
+int hinata_filter_index_add_knowledge_block(hinata_filter_index_t *index,
+                                            const hinata_knowledge_block_t *block);
+int hinata_filter_index_add_compact_block(hinata_filter_index_t *index,
+                                          const hinata_compact_block_t *block);
+int hinata_filter_index_add_packet(hinata_filter_index_t *index, const hinata_data_packet_t *packet,
+                                   const hinata_uuid_t user_id);
+
+/**
+ * 删除文档，不存在时返回 -ENOENT
+ */
+int hinata_filter_index_remove(hinata_filter_index_t *index, const char *id);
+
+/**
+ * 计算满足过滤条件的文档集合，结果覆盖写入 out（调用方负责初始化和释放）
+ * filters 为 NULL 时返回全部文档
+ */
+int hinata_filter_index_evaluate(const hinata_filter_index_t *index,
+                                 const hinata_search_filters_t *filters, hinata_bitmap_t *out);
+
+/**
+ * 文档 ID 对应的外部 ID；有效文档数；写入版本
+ */
+const char *hinata_filter_index_doc_uuid(const hinata_filter_index_t *index, uint32_t doc_id);
+uint32_t hinata_filter_index_size(const hinata_filter_index_t *index);
+uint64_t hinata_filter_index_version(const hinata_filter_index_t *index);
+
+/**
+ * 用户的文档集合，用户不存在时返回 NULL
+ */
+const hinata_bitmap_t *hinata_filter_index_user_docs(const hinata_filter_index_t *index,
+                                                     const char *user_id);
+
+#endif /* _HINATA_FILTER_INDEX_H */
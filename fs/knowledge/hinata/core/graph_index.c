@@ -0,0 +1,627 @@
+/**
+ * HiNATA 关系图索引 - C 语言实现
+ */
+
+#include "graph_index.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_GRAPH_MERGE_THRESHOLD 1024
+
+/**
+ * 合并时使用的边三元组
+ */
+typedef struct {
+    hinata_node_id_t source;
+    hinata_node_id_t target;
+    uint32_t seq;
+    uint8_t type;
+    uint8_t removed;
+} hinata_graph_triple_t;
+
+// ============================================================================
+// 节点字典
+// ============================================================================
+
+static const char *hinata_graph_node_key(const void *owner, uint32_t entry)
+{
+    return ((const hinata_graph_index_t *)owner)->node_uuids[entry - 1];
+}
+
+/**
+ * 查找 UUID 所在的槽位，返回槽位下标（可能为空槽）
+ */
+static uint32_t hinata_graph_slot(const hinata_graph_index_t *graph, const char *uuid)
+{
+    return hinata_uuid_slot(graph->slots, graph->slot_capacity, uuid, hinata_graph_node_key,
+                            graph);
+}
+
+/**
+ * 创建新节点
+ */
+static int hinata_graph_node_create(hinata_graph_index_t *graph, const char *uuid,
+                                    hinata_node_id_t *id)
+{
+    uint32_t old_capacity = graph->marks_capacity;
+    int ret;
+
+    if (graph->node_count == HINATA_NODE_INVALID) {
+        return -EOVERFLOW;
+    }
+
+    ret = hinata_uuid_slots_grow(&graph->slots, &graph->slot_capacity, graph->node_count,
+                                 graph->node_count, hinata_graph_node_key, graph);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = hinata_vec_reserve((void **)&graph->node_uuids, &graph->node_capacity,
+                             graph->node_count + 1, sizeof(*graph->node_uuids));
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = hinata_vec_reserve((void **)&graph->visit_marks, &graph->marks_capacity,
+                             graph->node_count + 1, sizeof(*graph->visit_marks));
+    if (ret < 0) {
+        return ret;
+    }
+    memset(graph->visit_marks + old_capacity, 0,
+           (graph->marks_capacity - old_capacity) * sizeof(*graph->visit_marks));
+
+    *id = graph->node_count;
+    hinata_uuid_assign(graph->node_uuids[*id], uuid);
+    graph->slots[hinata_graph_slot(graph, uuid)] = *id + 1;
+    graph->node_count++;
+    return 0;
+}
+
+int hinata_graph_node_id(hinata_graph_index_t *graph, const char *uuid, bool create,
+                         hinata_node_id_t *id)
+{
+    uint32_t entry = 0;
+
+    if (!graph || !uuid || !*uuid || !id) {
+        return -EINVAL;
+    }
+
+    if (graph->slot_capacity) {
+        entry = graph->slots[hinata_graph_slot(graph, uuid)];
+    }
+    if (entry) {
+        *id = entry - 1;
+        return 0;
+    }
+    if (!create) {
+        return -ENOENT;
+    }
+
+    return hinata_graph_node_create(graph, uuid, id);
+}
+
+const char *hinata_graph_node_uuid(const hinata_graph_index_t *graph, hinata_node_id_t id)
+{
+    if (!graph || id >= graph->node_count) {
+        return NULL;
+    }
+
+    return graph->node_uuids[id];
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+static void hinata_graph_csr_free(hinata_graph_csr_t *csr)
+{
+    free(csr->offsets);
+    free(csr->edges);
+    memset(csr, 0, sizeof(*csr));
+}
+
+void hinata_graph_init(hinata_graph_index_t *graph, uint32_t merge_threshold)
+{
+    memset(graph, 0, sizeof(*graph));
+    graph->merge_threshold = merge_threshold ? merge_threshold : HINATA_GRAPH_MERGE_THRESHOLD;
+}
+
+void hinata_graph_free(hinata_graph_index_t *graph)
+{
+    if (!graph) {
+        return;
+    }
+
+    free(graph->node_uuids);
+    free(graph->slots);
+    hinata_graph_csr_free(&graph->forward);
+    hinata_graph_csr_free(&graph->reverse);
+    free(graph->delta);
+    free(graph->visit_marks);
+    hinata_graph_init(graph, graph->merge_threshold);
+}
+
+// ============================================================================
+// 边的增删
+// ============================================================================
+
+/**
+ * 判断边当前是否存在：delta 日志中最新的一项优先于 CSR
+ */
+static bool hinata_graph_has_edge(const hinata_graph_index_t *graph, hinata_node_id_t source,
+                                  hinata_node_id_t target, uint8_t type)
+{
+    const hinata_graph_delta_t *entry;
+    const hinata_graph_edge_t *edge;
+    uint32_t i;
+
+    for (i = graph->delta_count; i > 0; i--) {
+        entry = &graph->delta[i - 1];
+        if (entry->source == source && entry->target == target && entry->type == type) {
+            return !entry->removed;
+        }
+    }
+
+    if (source >= graph->csr_node_count) {
+        return false;
+    }
+
+    for (i = graph->forward.offsets[source]; i < graph->forward.offsets[source + 1]; i++) {
+        edge = &graph->forward.edges[i];
+        if (edge->node == target && edge->type == type) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * 追加 delta 日志项，达到阈值时合并
+ */
+static int hinata_graph_log(hinata_graph_index_t *graph, hinata_node_id_t source,
+                            hinata_node_id_t target, uint8_t type, bool removed)
+{
+    hinata_graph_delta_t *entry;
+    uint32_t threshold;
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&graph->delta, &graph->delta_capacity,
+                             graph->delta_count + 1, sizeof(*graph->delta));
+    if (ret < 0) {
+        return ret;
+    }
+
+    entry = &graph->delta[graph->delta_count++];
+    entry->source = source;
+    entry->target = target;
+    entry->type = type;
+    entry->removed = removed;
+
+    // 日志较小时查询开销可以忽略；合并失败只是推迟到下一次修改
+    threshold = graph->forward.edge_count / 8;
+    if (threshold < graph->merge_threshold) {
+        threshold = graph->merge_threshold;
+    }
+    if (graph->delta_count >= threshold) {
+        hinata_graph_merge(graph);
+    }
+
+    return 0;
+}
+
+int hinata_graph_add_edge(hinata_graph_index_t *graph, const char *source, const char *target,
+                          hinata_reference_type_t type)
+{
+    hinata_node_id_t source_id;
+    hinata_node_id_t target_id;
+    int ret;
+
+    if (!graph || (uint32_t)type > HINATA_REF_SEMANTIC) {
+        return -EINVAL;
+    }
+
+    ret = hinata_graph_node_id(graph, source, true, &source_id);
+    if (!ret) {
+        ret = hinata_graph_node_id(graph, target, true, &target_id);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (hinata_graph_has_edge(graph, source_id, target_id, type)) {
+        return 0;
+    }
+
+    return hinata_graph_log(graph, source_id, target_id, type, false);
+}
+
+int hinata_graph_remove_edge(hinata_graph_index_t *graph, const char *source, const char *target,
+                             hinata_reference_type_t type)
+{
+    hinata_node_id_t source_id;
+    hinata_node_id_t target_id;
+    int ret;
+
+    if (!graph || (uint32_t)type > HINATA_REF_SEMANTIC) {
+        return -EINVAL;
+    }
+
+    ret = hinata_graph_node_id(graph, source, false, &source_id);
+    if (!ret) {
+        ret = hinata_graph_node_id(graph, target, false, &target_id);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (!hinata_graph_has_edge(graph, source_id, target_id, type)) {
+        return -ENOENT;
+    }
+
+    return hinata_graph_log(graph, source_id, target_id, type, true);
+}
+
+int hinata_graph_append_edge(hinata_graph_index_t *graph, const char *source, const char *target,
+                             hinata_reference_type_t type)
+{
+    hinata_node_id_t source_id;
+    hinata_node_id_t target_id;
+    int ret;
+
+    if (!graph || (uint32_t)type > HINATA_REF_SEMANTIC) {
+        return -EINVAL;
+    }
+
+    ret = hinata_graph_node_id(graph, source, true, &source_id);
+    if (!ret) {
+        ret = hinata_graph_node_id(graph, target, true, &target_id);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    // 重复的记录在查询重放和合并时都会被折叠
+    return hinata_graph_log(graph, source_id, target_id, type, false);
+}
+
+int hinata_graph_add_reference(hinata_graph_index_t *graph,
+                               const hinata_knowledge_block_reference_t *reference)
+{
+    if (!reference) {
+        return -EINVAL;
+    }
+
+    return hinata_graph_add_edge(graph, reference->source_block_id, reference->target_block_id,
+                                 reference->reference_type);
+}
+
+int hinata_graph_add_block(hinata_graph_index_t *graph, const hinata_compact_block_t *block)
+{
+    uint32_t i;
+    int ret;
+
+    if (!graph || !block) {
+        return -EINVAL;
+    }
+
+    // 反向链接由正向边派生，只需登记引用
+    for (i = 0; i < block->references.count; i++) {
+        ret = hinata_graph_add_edge(graph, block->id, block->references.items[i],
+                                    HINATA_REF_STRONG);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+// ============================================================================
+// 合并
+// ============================================================================
+
+static int hinata_graph_triple_cmp(const void *a, const void *b)
+{
+    const hinata_graph_triple_t *x = a;
+    const hinata_graph_triple_t *y = b;
+
+    if (x->source != y->source) {
+        return x->source < y->source ? -1 : 1;
+    }
+    if (x->target != y->target) {
+        return x->target < y->target ? -1 : 1;
+    }
+    if (x->type != y->type) {
+        return x->type < y->type ? -1 : 1;
+    }
+    if (x->seq != y->seq) {
+        return x->seq < y->seq ? -1 : 1;
+    }
+    return 0;
+}
+
+int hinata_graph_merge(hinata_graph_index_t *graph)
+{
+    hinata_graph_csr_t forward = { 0 };
+    hinata_graph_csr_t reverse = { 0 };
+    hinata_graph_triple_t *triples;
+    uint32_t *fill;
+    uint32_t count = 0;
+    uint32_t live = 0;
+    uint32_t i, j, n;
+
+    if (!graph) {
+        return -EINVAL;
+    }
+    if (graph->delta_count == 0 && graph->csr_node_count == graph->node_count) {
+        return 0;
+    }
+
+    triples = malloc(((size_t)graph->forward.edge_count + graph->delta_count + 1) *
+                     sizeof(*triples));
+    forward.offsets = calloc((size_t)graph->node_count + 1, sizeof(*forward.offsets));
+    reverse.offsets = calloc((size_t)graph->node_count + 1, sizeof(*reverse.offsets));
+    fill = malloc(((size_t)graph->node_count + 1) * sizeof(*fill));
+    if (!triples || !forward.offsets || !reverse.offsets || !fill) {
+        goto err_nomem;
+    }
+
+    // CSR 中的边序号为 0，日志项按写入顺序编号，排序后每组最后一项生效
+    for (n = 0; n < graph->csr_node_count; n++) {
+        for (i = graph->forward.offsets[n]; i < graph->forward.offsets[n + 1]; i++) {
+            triples[count].source = n;
+            triples[count].target = graph->forward.edges[i].node;
+            triples[count].type = graph->forward.edges[i].type;
+            triples[count].seq = 0;
+            triples[count].removed = 0;
+            count++;
+        }
+    }
+    for (i = 0; i < graph->delta_count; i++) {
+        triples[count].source = graph->delta[i].source;
+        triples[count].target = graph->delta[i].target;
+        triples[count].type = graph->delta[i].type;
+        triples[count].seq = i + 1;
+        triples[count].removed = graph->delta[i].removed;
+        count++;
+    }
+
+    qsort(triples, count, sizeof(*triples), hinata_graph_triple_cmp);
+
+    for (i = 0; i < count; i = j) {
+        for (j = i + 1; j < count; j++) {
+            if (triples[j].source != triples[i].source ||
+                triples[j].target != triples[i].target ||
+                triples[j].type != triples[i].type) {
+                break;
+            }
+        }
+        if (!triples[j - 1].removed) {
+            triples[live++] = triples[j - 1];
+        }
+    }
+
+    forward.edges = malloc(((size_t)live + 1) * sizeof(*forward.edges));
+    reverse.edges = malloc(((size_t)live + 1) * sizeof(*reverse.edges));
+    if (!forward.edges || !reverse.edges) {
+        goto err_nomem;
+    }
+    forward.edge_count = live;
+    reverse.edge_count = live;
+
+    for (i = 0; i < live; i++) {
+        forward.offsets[triples[i].source + 1]++;
+        reverse.offsets[triples[i].target + 1]++;
+    }
+    for (n = 0; n < graph->node_count; n++) {
+        forward.offsets[n + 1] += forward.offsets[n];
+        reverse.offsets[n + 1] += reverse.offsets[n];
+    }
+
+    // 三元组已按 (source, target) 排序，两个方向的每一行也随之有序
+    for (i = 0; i < live; i++) {
+        forward.edges[i].node = triples[i].target;
+        forward.edges[i].type = triples[i].type;
+    }
+    memcpy(fill, reverse.offsets, ((size_t)graph->node_count + 1) * sizeof(*fill));
+    for (i = 0; i < live; i++) {
+        j = fill[triples[i].target]++;
+        reverse.edges[j].node = triples[i].source;
+        reverse.edges[j].type = triples[i].type;
+    }
+
+    free(triples);
+    free(fill);
+
+    hinata_graph_csr_free(&graph->forward);
+    hinata_graph_csr_free(&graph->reverse);
+    graph->forward = forward;
+    graph->reverse = reverse;
+    graph->csr_node_count = graph->node_count;
+    graph->delta_count = 0;
+    return 0;
+
+err_nomem:
+    free(triples);
+    free(fill);
+    hinata_graph_csr_free(&forward);
+    hinata_graph_csr_free(&reverse);
+    return -ENOMEM;
+}
+
+// ============================================================================
+// 查询
+// ============================================================================
+
+/**
+ * 收集一个方向上的邻居：先取 CSR 行，再按顺序重放相关的日志项
+ */
+static int hinata_graph_collect(const hinata_graph_index_t *graph, hinata_node_id_t node,
+                                bool reverse, uint32_t type_mask, hinata_graph_edge_vec_t *out)
+{
+    const hinata_graph_csr_t *csr = reverse ? &graph->reverse : &graph->forward;
+    const hinata_graph_delta_t *entry;
+    hinata_node_id_t neighbor;
+    uint32_t first = out->count;
+    uint32_t i, k;
+    int ret;
+
+    if (node < graph->csr_node_count) {
+        ret = hinata_vec_reserve((void **)&out->items, &out->capacity,
+                                 out->count + csr->offsets[node + 1] - csr->offsets[node],
+                                 sizeof(*out->items));
+        if (ret < 0) {
+            return ret;
+        }
+
+        for (i = csr->offsets[node]; i < csr->offsets[node + 1]; i++) {
+            if (type_mask & HINATA_EDGE_TYPE_BIT(csr->edges[i].type)) {
+                out->items[out->count++] = csr->edges[i];
+            }
+        }
+    }
+
+    for (i = 0; i < graph->delta_count; i++) {
+        entry = &graph->delta[i];
+        if (!(type_mask & HINATA_EDGE_TYPE_BIT(entry->type))) {
+            continue;
+        }
+        if ((reverse ? entry->target : entry->source) != node) {
+            continue;
+        }
+
+        neighbor = reverse ? entry->source : entry->target;
+        for (k = first; k < out->count; k++) {
+            if (out->items[k].node == neighbor && out->items[k].type == entry->type) {
+                break;
+            }
+        }
+
+        if (entry->removed) {
+            if (k < out->count) {
+                out->items[k] = out->items[--out->count];
+            }
+        } else if (k == out->count) {
+            ret = hinata_vec_reserve((void **)&out->items, &out->capacity, out->count + 1,
+                                     sizeof(*out->items));
+            if (ret < 0) {
+                return ret;
+            }
+            out->items[out->count].node = neighbor;
+            out->items[out->count].type = entry->type;
+            out->count++;
+        }
+    }
+
+    return 0;
+}
+
+int hinata_graph_neighbors(hinata_graph_index_t *graph, hinata_node_id_t node,
+                           hinata_edge_dir_t dir, uint32_t type_mask,
+                           hinata_graph_edge_vec_t *out)
+{
+    int ret = 0;
+
+    if (!graph || !out || node >= graph->node_count) {
+        return -EINVAL;
+    }
+
+    out->count = 0;
+    if (dir & HINATA_EDGE_OUT) {
+        ret = hinata_graph_collect(graph, node, false, type_mask, out);
+    }
+    if (!ret && (dir & HINATA_EDGE_IN)) {
+        ret = hinata_graph_collect(graph, node, true, type_mask, out);
+    }
+
+    return ret;
+}
+
+int hinata_graph_khop(hinata_graph_index_t *graph, hinata_node_id_t start,
+                      hinata_edge_dir_t dir, uint32_t type_mask, uint16_t max_depth,
+                      uint32_t max_results, hinata_graph_hit_vec_t *out)
+{
+    hinata_graph_edge_vec_t scratch = { 0 };
+    hinata_node_id_t node = start;
+    uint16_t depth = 0;
+    uint32_t head = 0;
+    uint32_t i;
+    int ret = 0;
+
+    if (!graph || !out || start >= graph->node_count) {
+        return -EINVAL;
+    }
+
+    out->count = 0;
+
+    // 用递增的轮次号代替每次清空标记数组
+    if (++graph->visit_epoch == 0) {
+        memset(graph->visit_marks, 0, graph->marks_capacity * sizeof(*graph->visit_marks));
+        graph->visit_epoch = 1;
+    }
+    graph->visit_marks[start] = graph->visit_epoch;
+
+    while (depth < max_depth) {
+        ret = hinata_graph_neighbors(graph, node, dir, type_mask, &scratch);
+        if (ret < 0) {
+            break;
+        }
+
+        for (i = 0; i < scratch.count; i++) {
+            if (graph->visit_marks[scratch.items[i].node] == graph->visit_epoch) {
+                continue;
+            }
+            graph->visit_marks[scratch.items[i].node] = graph->visit_epoch;
+
+            ret = hinata_vec_reserve((void **)&out->items, &out->capacity, out->count + 1,
+                                     sizeof(*out->items));
+            if (ret < 0) {
+                goto out;
+            }
+            out->items[out->count].node = scratch.items[i].node;
+            out->items[out->count].depth = depth + 1;
+            out->count++;
+
+            if (max_results && out->count >= max_results) {
+                goto out;
+            }
+        }
+
+        // 命中向量本身就是 BFS 队列
+        do {
+            if (head >= out->count) {
+                goto out;
+            }
+            node = out->items[head].node;
+            depth = out->items[head].depth;
+            head++;
+        } while (depth >= max_depth);
+    }
+
+out:
+    hinata_graph_edge_vec_free(&scratch);
+    return ret;
+}
+
+void hinata_graph_edge_vec_free(hinata_graph_edge_vec_t *vec)
+{
+    if (!vec) {
+        return;
+    }
+
+    free(vec->items);
+    memset(vec, 0, sizeof(*vec));
+}
+
+void hinata_graph_hit_vec_free(hinata_graph_hit_vec_t *vec)
+{
+    if (!vec) {
+        return;
+    }
+
+    free(vec->items);
+    memset(vec, 0, sizeof(*vec));
+}
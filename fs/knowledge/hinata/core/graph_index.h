@@ -0,0 +1,185 @@
+/**
+ * HiNATA 关系图索引 - C 语言定义
+ *
+ * 知识块之间的引用以稠密整数节点 ID 表示，正向与反向邻接各保存为一份
+ * CSR（压缩稀疏行）数组。增量修改先写入 delta 日志，查询时与 CSR 合并，
+ * 日志达到阈值后重建 CSR。每条边只记录一次，正反两个方向由同一份日志
+ * 派生，因此始终一致。
+ *
+ * 索引不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_GRAPH_INDEX_H
+#define _HINATA_GRAPH_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+
+// ============================================================================
+// 基础类型定义
+// ============================================================================
+
+typedef uint32_t hinata_node_id_t;
+
+#define HINATA_NODE_INVALID UINT32_MAX
+
+/**
+ * 遍历方向
+ */
+typedef enum {
+    HINATA_EDGE_OUT = 1,   // 引用
+    HINATA_EDGE_IN = 2,    // 反向链接
+    HINATA_EDGE_BOTH = 3
+} hinata_edge_dir_t;
+
+/**
+ * 边类型掩码，第 n 位对应 hinata_reference_type_t 的值 n
+ */
+#define HINATA_EDGE_TYPE_BIT(type) (1U << (type))
+#define HINATA_EDGE_TYPES_ALL 0xFU
+
+/**
+ * 邻接表中的一条边
+ */
+typedef struct {
+    hinata_node_id_t node;
+    uint8_t type;
+} hinata_graph_edge_t;
+
+/**
+ * 边向量
+ */
+typedef struct {
+    hinata_graph_edge_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} hinata_graph_edge_vec_t;
+
+/**
+ * k 跳遍历命中的节点
+ */
+typedef struct {
+    hinata_node_id_t node;
+    uint16_t depth;
+} hinata_graph_hit_t;
+
+/**
+ * 命中向量，按 BFS 顺序排列
+ */
+typedef struct {
+    hinata_graph_hit_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} hinata_graph_hit_vec_t;
+
+/**
+ * CSR 邻接：节点 n 的边为 edges[offsets[n] .. offsets[n + 1])
+ */
+typedef struct {
+    uint32_t *offsets;
+    hinata_graph_edge_t *edges;
+    uint32_t edge_count;
+} hinata_graph_csr_t;
+
+/**
+ * delta 日志项
+ */
+typedef struct {
+    hinata_node_id_t source;
+    hinata_node_id_t target;
+    uint8_t type;
+    uint8_t removed;
+} hinata_graph_delta_t;
+
+/**
+ * 关系图索引
+ */
+typedef struct {
+    // 节点字典：UUID <-> 稠密 ID
+    hinata_uuid_t *node_uuids;
+    uint32_t node_count;
+    uint32_t node_capacity;
+    uint32_t *slots;        // 开放寻址哈希表，存放 ID + 1，0 为空
+    uint32_t slot_capacity;
+
+    // 已合并的邻接
+    hinata_graph_csr_t forward;
+    hinata_graph_csr_t reverse;
+    uint32_t csr_node_count;
+
+    // 未合并的修改
+    hinata_graph_delta_t *delta;
+    uint32_t delta_count;
+    uint32_t delta_capacity;
+    uint32_t merge_threshold;
+
+    // 遍历标记，容量单独记录，至少为 node_count
+    uint32_t *visit_marks;
+    uint32_t marks_capacity;
+    uint32_t visit_epoch;
+} hinata_graph_index_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * merge_threshold 为 0 时使用默认值
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_graph_init(hinata_graph_index_t *graph, uint32_t merge_threshold);
+void hinata_graph_free(hinata_graph_index_t *graph);
+
+/**
+ * 节点字典
+ * 节点不存在且 create 为 false 时返回 -ENOENT
+ */
+int hinata_graph_node_id(hinata_graph_index_t *graph, const char *uuid, bool create,
+                         hinata_node_id_t *id);
+const char *hinata_graph_node_uuid(const hinata_graph_index_t *graph, hinata_node_id_t id);
+
+/**
+ * 边的增删，必要时自动合并 delta 日志
+ * 重复添加同一条边不产生多重边；删除不存在的边返回 -ENOENT
+ */
+int hinata_graph_add_edge(hinata_graph_index_t *graph, const char *source, const char *target,
+                          hinata_reference_type_t type);
+int hinata_graph_remove_edge(hinata_graph_index_t *graph, const char *source, const char *target,
+                             hinata_reference_type_t type);
+/**
+ * 不检查边是否已存在，直接追加记录，用于批量导入
+ */
+int hinata_graph_append_edge(hinata_graph_index_t *graph, const char *source, const char *target,
+                             hinata_reference_type_t type);
+int hinata_graph_add_reference(hinata_graph_index_t *graph,
+                               const hinata_knowledge_block_reference_t *reference);
+int hinata_graph_add_block(hinata_graph_index_t *graph, const hinata_compact_block_t *block);
+
+/**
+ * 把 delta 日志合并进 CSR；失败时索引保持不变
+ */
+int hinata_graph_merge(hinata_graph_index_t *graph);
+
+/**
+ * 邻居查询，结果覆盖 out 原有内容
+ */
+int hinata_graph_neighbors(hinata_graph_index_t *graph, hinata_node_id_t node,
+                           hinata_edge_dir_t dir, uint32_t type_mask,
+                           hinata_graph_edge_vec_t *out);
+
+/**
+ * 从 start 出发的 k 跳邻域（不含 start），max_results 为 0 表示不限
+ */
+int hinata_graph_khop(hinata_graph_index_t *graph, hinata_node_id_t start,
+                      hinata_edge_dir_t dir, uint32_t type_mask, uint16_t max_depth,
+                      uint32_t max_results, hinata_graph_hit_vec_t *out);
+
+void hinata_graph_edge_vec_free(hinata_graph_edge_vec_t *vec);
+void hinata_graph_hit_vec_free(hinata_graph_hit_vec_t *vec);
+
+#endif /* _HINATA_GRAPH_INDEX_H */
@@ -0,0 +1,888 @@
+/**
+ * HiNATA 层级索引 - C 语言实现
+ */
+
+#include "hierarchy_index.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_HIERARCHY_MERGE_THRESHOLD 1024
+
+// 重新分配标签后，子树根的每个标签单位至少有这么多空位，保证后续插入不会立刻再分配
+#define HINATA_HIERARCHY_MIN_UNIT 4
+
+// ============================================================================
+// 节点字典
+// ============================================================================
+
+// 虚拟根没有外部 ID，不进入哈希表
+static const char *hinata_hierarchy_node_key(const void *owner, uint32_t entry)
+{
+    if (entry - 1 == HINATA_HIERARCHY_ROOT) {
+        return NULL;
+    }
+
+    return ((const hinata_hierarchy_index_t *)owner)->nodes[entry - 1].id;
+}
+
+static uint32_t hinata_hierarchy_slot(const hinata_hierarchy_index_t *index, const char *uuid)
+{
+    return hinata_uuid_slot(index->slots, index->slot_capacity, uuid, hinata_hierarchy_node_key,
+                            index);
+}
+
+/**
+ * 创建未挂接的节点
+ */
+static int hinata_hierarchy_node_create(hinata_hierarchy_index_t *index, const char *uuid,
+                                        uint32_t *id)
+{
+    hinata_hierarchy_node_t *node;
+    int ret;
+
+    if (index->node_count == HINATA_HIERARCHY_NONE - 1) {
+        return -EOVERFLOW;
+    }
+
+    ret = hinata_uuid_slots_grow(&index->slots, &index->slot_capacity, index->node_count,
+                                 index->node_count, hinata_hierarchy_node_key, index);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = hinata_vec_reserve((void **)&index->nodes, &index->node_capacity, index->node_count + 1,
+                             sizeof(*index->nodes));
+    if (ret < 0) {
+        return ret;
+    }
+
+    *id = index->node_count++;
+    node = &index->nodes[*id];
+    memset(node, 0, sizeof(*node));
+    hinata_uuid_assign(node->id, uuid);
+    node->parent = HINATA_HIERARCHY_NONE;
+    node->first_child = HINATA_HIERARCHY_NONE;
+    node->last_child = HINATA_HIERARCHY_NONE;
+    node->prev_sibling = HINATA_HIERARCHY_NONE;
+    node->next_sibling = HINATA_HIERARCHY_NONE;
+    node->size = 1;
+
+    if (*id != HINATA_HIERARCHY_ROOT) {
+        index->slots[hinata_hierarchy_slot(index, uuid)] = *id + 1;
+    }
+    return 0;
+}
+
+int hinata_hierarchy_node_id(const hinata_hierarchy_index_t *index, const char *uuid,
+                             uint32_t *node)
+{
+    uint32_t entry;
+
+    if (!index || !uuid || !*uuid || !node) {
+        return -EINVAL;
+    }
+    if (!index->slot_capacity) {
+        return -ENOENT;
+    }
+
+    entry = index->slots[hinata_hierarchy_slot(index, uuid)];
+    if (!entry || !index->nodes[entry - 1].live) {
+        return -ENOENT;
+    }
+
+    *node = entry - 1;
+    return 0;
+}
+
+const char *hinata_hierarchy_node_uuid(const hinata_hierarchy_index_t *index, uint32_t node)
+{
+    if (!index || node == HINATA_HIERARCHY_ROOT || node >= index->node_count) {
+        return NULL;
+    }
+
+    return index->nodes[node].id;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+int hinata_hierarchy_init(hinata_hierarchy_index_t *index)
+{
+    uint32_t root;
+    int ret;
+
+    if (!index) {
+        return -EINVAL;
+    }
+
+    memset(index, 0, sizeof(*index));
+    ret = hinata_hierarchy_node_create(index, "", &root);
+    if (ret < 0) {
+        return ret;
+    }
+
+    index->nodes[root].enter = 0;
+    index->nodes[root].exit = UINT64_MAX;
+    index->nodes[root].live = true;
+    return 0;
+}
+
+void hinata_hierarchy_free(hinata_hierarchy_index_t *index)
+{
+    if (!index) {
+        return;
+    }
+
+    free(index->nodes);
+    free(index->slots);
+    free(index->entries);
+    free(index->pending);
+    free(index->stack);
+    memset(index, 0, sizeof(*index));
+}
+
+void hinata_hierarchy_vec_free(hinata_hierarchy_vec_t *vec)
+{
+    if (!vec) {
+        return;
+    }
+
+    free(vec->items);
+    vec->items = NULL;
+    vec->count = 0;
+    vec->capacity = 0;
+}
+
+static int hinata_hierarchy_vec_push(hinata_hierarchy_vec_t *vec, uint32_t node)
+{
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&vec->items, &vec->capacity, vec->count + 1,
+                             sizeof(*vec->items));
+    if (ret < 0) {
+        return ret;
+    }
+
+    vec->items[vec->count++] = node;
+    return 0;
+}
+
+static int hinata_hierarchy_push_frame(hinata_hierarchy_index_t *index, uint32_t *depth,
+                                       uint32_t node, uint64_t lo, uint64_t hi)
+{
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&index->stack, &index->stack_capacity, *depth + 1,
+                             sizeof(*index->stack));
+    if (ret < 0) {
+        return ret;
+    }
+
+    index->stack[*depth].node = node;
+    index->stack[*depth].lo = lo;
+    index->stack[*depth].hi = hi;
+    (*depth)++;
+    return 0;
+}
+
+// ============================================================================
+// 合并
+// ============================================================================
+
+int hinata_hierarchy_merge(hinata_hierarchy_index_t *index)
+{
+    hinata_hierarchy_entry_t *entries;
+    const hinata_hierarchy_node_t *node;
+    uint32_t depth = 0, count = 0;
+    uint32_t current, child;
+    int ret;
+
+    if (!index) {
+        return -EINVAL;
+    }
+
+    entries = malloc((index->live_count ? index->live_count : 1) * sizeof(*entries));
+    if (!entries) {
+        return -ENOMEM;
+    }
+
+    // 子节点链表的顺序与标签顺序一致，先序遍历即得到按进入标签排序的结果
+    ret = hinata_hierarchy_push_frame(index, &depth, HINATA_HIERARCHY_ROOT, 0, 0);
+    while (!ret && depth > 0) {
+        current = index->stack[--depth].node;
+        node = &index->nodes[current];
+        if (current != HINATA_HIERARCHY_ROOT) {
+            entries[count].label = node->enter;
+            entries[count].node = current;
+            count++;
+        }
+
+        for (child = node->last_child; !ret && child != HINATA_HIERARCHY_NONE;
+             child = index->nodes[child].prev_sibling) {
+            ret = hinata_hierarchy_push_frame(index, &depth, child, 0, 0);
+        }
+    }
+    if (ret < 0) {
+        free(entries);
+        return ret;
+    }
+
+    for (current = 0; current < index->pending_count; current++) {
+        index->nodes[index->pending[current]].pending = 0;
+    }
+
+    free(index->entries);
+    index->entries = entries;
+    index->entry_count = count;
+    index->entry_capacity = index->live_count ? index->live_count : 1;
+    index->pending_count = 0;
+    return 0;
+}
+
+static int hinata_hierarchy_maybe_merge(hinata_hierarchy_index_t *index)
+{
+    uint32_t threshold = index->entry_count / 8;
+
+    if (threshold < HINATA_HIERARCHY_MERGE_THRESHOLD) {
+        threshold = HINATA_HIERARCHY_MERGE_THRESHOLD;
+    }
+    if (index->pending_count < threshold) {
+        return 0;
+    }
+
+    return hinata_hierarchy_merge(index);
+}
+
+/**
+ * 记录标签改变的节点
+ */
+static int hinata_hierarchy_mark(hinata_hierarchy_index_t *index, uint32_t node)
+{
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&index->pending, &index->pending_capacity,
+                             index->pending_count + 1, sizeof(*index->pending));
+    if (ret < 0) {
+        return ret;
+    }
+
+    index->pending[index->pending_count++] = node;
+    index->nodes[node].pending = index->pending_count;
+    return 0;
+}
+
+// ============================================================================
+// 标签分配
+// ============================================================================
+
+/**
+ * 重新统计 top 子树中每个节点的子树大小
+ * size 不随挂接和删除沿祖先链更新（否则深链上每次插入都要走完整条祖先链），
+ * 只在重新分配标签前对要分配的子树统计一次。沿子链表和父指针遍历，
+ * 不需要额外空间
+ */
+static void hinata_hierarchy_count(hinata_hierarchy_index_t *index, uint32_t top)
+{
+    hinata_hierarchy_node_t *nodes = index->nodes;
+    uint32_t current = top;
+
+    nodes[top].size = 1;
+    for (;;) {
+        if (nodes[current].first_child != HINATA_HIERARCHY_NONE) {
+            current = nodes[current].first_child;
+            nodes[current].size = 1;
+            continue;
+        }
+
+        // 子树已统计完，向上累加到还有下一个兄弟的祖先
+        while (current != top && nodes[current].next_sibling == HINATA_HIERARCHY_NONE) {
+            nodes[nodes[current].parent].size += nodes[current].size;
+            current = nodes[current].parent;
+        }
+        if (current == top) {
+            return;
+        }
+
+        nodes[nodes[current].parent].size += nodes[current].size;
+        current = nodes[current].next_sibling;
+        nodes[current].size = 1;
+    }
+}
+
+/**
+ * 在 [lo, hi] 内为 top 的子树重新分配标签
+ * 每个节点按子树大小给子节点分配空间，末尾按子节点数预留追加空间：
+ * 扇出大的节点预留得多，深链每层只损失很小的比例。
+ * 调用前须用 hinata_hierarchy_count 统计 top 的子树大小；
+ * apply 为 false 时只检查空间是否足够
+ */
+static int hinata_hierarchy_relabel(hinata_hierarchy_index_t *index, uint32_t top, uint64_t lo,
+                                    uint64_t hi, bool apply)
+{
+    hinata_hierarchy_node_t *node;
+    hinata_hierarchy_frame_t frame;
+    uint64_t unit, pos, width, denom;
+    uint32_t depth = 0;
+    uint32_t child, children;
+    int ret;
+
+    ret = hinata_hierarchy_push_frame(index, &depth, top, lo, hi);
+    while (!ret && depth > 0) {
+        frame = index->stack[--depth];
+        node = &index->nodes[frame.node];
+
+        if (apply && frame.node != HINATA_HIERARCHY_ROOT &&
+            (node->enter != frame.lo || node->exit != frame.hi || frame.node == top)) {
+            node->enter = frame.lo;
+            node->exit = frame.hi;
+            ret = hinata_hierarchy_mark(index, frame.node);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+        if (node->first_child == HINATA_HIERARCHY_NONE) {
+            continue;
+        }
+
+        children = 0;
+        for (child = node->first_child; child != HINATA_HIERARCHY_NONE;
+             child = index->nodes[child].next_sibling) {
+            children++;
+        }
+
+        // 叶子的区间可能只有一个标签，增加子节点后必须从更上层重新分配
+        if (frame.hi - frame.lo < 2) {
+            return -ENOSPC;
+        }
+
+        denom = (uint64_t)(node->size - 1) + 2 * ((uint64_t)children + 1);
+        unit = (frame.hi - frame.lo - 1) / denom;
+        if (unit < (frame.node == top ? HINATA_HIERARCHY_MIN_UNIT : 1)) {
+            return -ENOSPC;
+        }
+
+        pos = frame.lo + 1;
+        for (child = node->first_child; !ret && child != HINATA_HIERARCHY_NONE;
+             child = index->nodes[child].next_sibling) {
+            width = unit * index->nodes[child].size;
+            ret = hinata_hierarchy_push_frame(index, &depth, child, pos, pos + width - 1);
+            pos += width;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * 为刚挂到父节点末尾的 node 分配标签
+ * 先在父节点末尾的空闲区间取一段与子树大小成比例的空间，不够时从父节点
+ * 向上找第一个能重新分配的祖先
+ */
+static int hinata_hierarchy_place(hinata_hierarchy_index_t *index, uint32_t node)
+{
+    const hinata_hierarchy_node_t *n = &index->nodes[node];
+    const hinata_hierarchy_node_t *p = &index->nodes[n->parent];
+    uint64_t lo, hi, width;
+    uint32_t ancestor, distance;
+    int ret;
+
+    // 按父节点区间平均每个节点的份额取宽度，连续追加大量子节点时每次只消耗
+    // 固定比例的预留空间；最多取剩余空间的一半。父节点的 size 是上次重新分配
+    // 时的统计值，只用来估计份额；空间用完后父节点或更上层的祖先会重新统计
+    hinata_hierarchy_count(index, node);
+    lo = n->prev_sibling != HINATA_HIERARCHY_NONE ? index->nodes[n->prev_sibling].exit :
+         p->enter;
+    hi = p->exit;
+    width = (p->exit - p->enter) / (2 * (uint64_t)p->size + 2) * n->size;
+    if (width > (hi - lo) / 2) {
+        width = (hi - lo) / 2;
+    }
+
+    if (width >= 2 && hinata_hierarchy_relabel(index, node, lo + 1, lo + width, false) == 0) {
+        return hinata_hierarchy_relabel(index, node, lo + 1, lo + width, true);
+    }
+
+    // 只尝试距离为 2 的幂的祖先和虚拟根，失败的尝试总代价与最终重新分配的
+    // 子树大小成正比
+    for (ancestor = n->parent, distance = 1; ancestor != HINATA_HIERARCHY_NONE;
+         ancestor = index->nodes[ancestor].parent, distance++) {
+        if ((distance & (distance - 1)) != 0 && ancestor != HINATA_HIERARCHY_ROOT) {
+            continue;
+        }
+
+        hinata_hierarchy_count(index, ancestor);
+        ret = hinata_hierarchy_relabel(index, ancestor, index->nodes[ancestor].enter,
+                                       index->nodes[ancestor].exit, false);
+        if (ret == 0) {
+            return hinata_hierarchy_relabel(index, ancestor, index->nodes[ancestor].enter,
+                                            index->nodes[ancestor].exit, true);
+        }
+        if (ret != -ENOSPC) {
+            return ret;
+        }
+    }
+
+    return -ENOSPC;
+}
+
+// ============================================================================
+// 挂接与摘除
+// ============================================================================
+
+/**
+ * 从父节点的子链表中摘下 node（保留其子树）
+ */
+static void hinata_hierarchy_unlink(hinata_hierarchy_index_t *index, uint32_t node)
+{
+    hinata_hierarchy_node_t *n = &index->nodes[node];
+    hinata_hierarchy_node_t *parent = &index->nodes[n->parent];
+
+    if (n->prev_sibling != HINATA_HIERARCHY_NONE) {
+        index->nodes[n->prev_sibling].next_sibling = n->next_sibling;
+    } else {
+        parent->first_child = n->next_sibling;
+    }
+    if (n->next_sibling != HINATA_HIERARCHY_NONE) {
+        index->nodes[n->next_sibling].prev_sibling = n->prev_sibling;
+    } else {
+        parent->last_child = n->prev_sibling;
+    }
+
+    n->parent = HINATA_HIERARCHY_NONE;
+    n->prev_sibling = HINATA_HIERARCHY_NONE;
+    n->next_sibling = HINATA_HIERARCHY_NONE;
+}
+
+/**
+ * 更新子树深度
+ */
+static int hinata_hierarchy_set_depth(hinata_hierarchy_index_t *index, uint32_t top,
+                                      uint32_t top_depth)
+{
+    uint32_t depth = 0;
+    uint32_t current, child;
+    int ret;
+
+    ret = hinata_hierarchy_push_frame(index, &depth, top, top_depth, 0);
+    while (!ret && depth > 0) {
+        current = index->stack[depth - 1].node;
+        index->nodes[current].depth = (uint32_t)index->stack[depth - 1].lo;
+        depth--;
+
+        for (child = index->nodes[current].first_child; !ret && child != HINATA_HIERARCHY_NONE;
+             child = index->nodes[child].next_sibling) {
+            ret = hinata_hierarchy_push_frame(index, &depth, child,
+                                              index->nodes[current].depth + 1, 0);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * 把 node（连同子树）挂到 parent 的子链表末尾并分配标签
+ */
+static int hinata_hierarchy_attach(hinata_hierarchy_index_t *index, uint32_t node, uint32_t parent)
+{
+    hinata_hierarchy_node_t *n = &index->nodes[node];
+    hinata_hierarchy_node_t *p = &index->nodes[parent];
+    int ret;
+
+    n->parent = parent;
+    n->prev_sibling = p->last_child;
+    n->next_sibling = HINATA_HIERARCHY_NONE;
+    if (p->last_child != HINATA_HIERARCHY_NONE) {
+        index->nodes[p->last_child].next_sibling = node;
+    } else {
+        p->first_child = node;
+    }
+    p->last_child = node;
+
+    ret = hinata_hierarchy_set_depth(index, node, p->depth + 1);
+    if (!ret) {
+        ret = hinata_hierarchy_place(index, node);
+    }
+    if (!ret) {
+        ret = hinata_hierarchy_maybe_merge(index);
+    }
+
+    return ret;
+}
+
+// ============================================================================
+// 插入、移动与删除
+// ============================================================================
+
+/**
+ * 查找或创建节点，新节点作为顶层节点挂接
+ */
+static int hinata_hierarchy_resolve(hinata_hierarchy_index_t *index, const char *uuid,
+                                    uint32_t *node, bool *created)
+{
+    hinata_hierarchy_node_t *n;
+    uint32_t entry;
+    int ret;
+
+    *created = false;
+    entry = index->slot_capacity ? index->slots[hinata_hierarchy_slot(index, uuid)] : 0;
+    if (entry && index->nodes[entry - 1].live) {
+        *node = entry - 1;
+        return 0;
+    }
+
+    if (entry) {
+        // 删除过的节点重新出现，沿用原来的节点 ID
+        *node = entry - 1;
+        n = &index->nodes[*node];
+        n->first_child = HINATA_HIERARCHY_NONE;
+        n->last_child = HINATA_HIERARCHY_NONE;
+        n->size = 1;
+    } else {
+        ret = hinata_hierarchy_node_create(index, uuid, node);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    index->nodes[*node].live = true;
+    index->live_count++;
+    *created = true;
+    return 0;
+}
+
+int hinata_hierarchy_set_parent(hinata_hierarchy_index_t *index, const char *uuid,
+                                const char *parent, uint32_t *node)
+{
+    uint32_t n, p = HINATA_HIERARCHY_ROOT;
+    bool created;
+    int ret;
+
+    if (!index || !index->nodes || !uuid || !*uuid) {
+        return -EINVAL;
+    }
+    if (parent && *parent && strncmp(uuid, parent, HINATA_UUID_LEN - 1) == 0) {
+        return -ELOOP;
+    }
+
+    if (parent && *parent) {
+        ret = hinata_hierarchy_resolve(index, parent, &p, &created);
+        if (!ret && created) {
+            ret = hinata_hierarchy_attach(index, p, HINATA_HIERARCHY_ROOT);
+        }
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    ret = hinata_hierarchy_resolve(index, uuid, &n, &created);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (!created) {
+        if (index->nodes[n].parent == p) {
+            if (node) {
+                *node = n;
+            }
+            return 0;
+        }
+        if (hinata_hierarchy_is_ancestor(index, n, p)) {
+            return -ELOOP;
+        }
+        hinata_hierarchy_unlink(index, n);
+    }
+
+    ret = hinata_hierarchy_attach(index, n, p);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (node) {
+        *node = n;
+    }
+    return 0;
+}
+
+int hinata_hierarchy_add_library_item(hinata_hierarchy_index_t *index,
+                                      const hinata_library_item_t *item)
+{
+    uint32_t count, child, i;
+    int ret;
+
+    if (!item) {
+        return -EINVAL;
+    }
+
+    ret = hinata_hierarchy_set_parent(index, item->id, item->has_parent ? item->parent_item : NULL,
+                                      NULL);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // parent_item 是权威来源；child_items 只用来挂接尚未出现的子项
+    count = item->child_item_count;
+    if (count > sizeof(item->child_items) / sizeof(item->child_items[0])) {
+        count = sizeof(item->child_items) / sizeof(item->child_items[0]);
+    }
+    for (i = 0; i < count; i++) {
+        if (hinata_hierarchy_node_id(index, item->child_items[i], &child) == 0) {
+            continue;
+        }
+        ret = hinata_hierarchy_set_parent(index, item->child_items[i], item->id, NULL);
+        if (ret < 0 && ret != -EINVAL) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int hinata_hierarchy_remove(hinata_hierarchy_index_t *index, const char *uuid)
+{
+    hinata_hierarchy_node_t *n, *p;
+    uint32_t node, child;
+    int ret;
+
+    ret = hinata_hierarchy_node_id(index, uuid, &node);
+    if (ret < 0) {
+        return ret;
+    }
+
+    n = &index->nodes[node];
+    p = &index->nodes[n->parent];
+
+    // 子节点的标签本来就嵌套在被删节点的区间内，原位提升无需重新分配
+    for (child = n->first_child; child != HINATA_HIERARCHY_NONE;
+         child = index->nodes[child].next_sibling) {
+        index->nodes[child].parent = n->parent;
+        ret = hinata_hierarchy_set_depth(index, child, n->depth);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (n->first_child != HINATA_HIERARCHY_NONE) {
+        index->nodes[n->first_child].prev_sibling = n->prev_sibling;
+        index->nodes[n->last_child].next_sibling = n->next_sibling;
+        if (n->prev_sibling != HINATA_HIERARCHY_NONE) {
+            index->nodes[n->prev_sibling].next_sibling = n->first_child;
+        } else {
+            p->first_child = n->first_child;
+        }
+        if (n->next_sibling != HINATA_HIERARCHY_NONE) {
+            index->nodes[n->next_sibling].prev_sibling = n->last_child;
+        } else {
+            p->last_child = n->last_child;
+        }
+
+        n->parent = HINATA_HIERARCHY_NONE;
+        n->first_child = HINATA_HIERARCHY_NONE;
+        n->last_child = HINATA_HIERARCHY_NONE;
+        n->prev_sibling = HINATA_HIERARCHY_NONE;
+        n->next_sibling = HINATA_HIERARCHY_NONE;
+        n->size = 1;
+    } else {
+        hinata_hierarchy_unlink(index, node);
+    }
+
+    n->live = false;
+    index->live_count--;
+    return 0;
+}
+
+// ============================================================================
+// 查询
+// ============================================================================
+
+static bool hinata_hierarchy_valid(const hinata_hierarchy_index_t *index, uint32_t node)
+{
+    return index && node < index->node_count && index->nodes[node].live;
+}
+
+bool hinata_hierarchy_is_ancestor(const hinata_hierarchy_index_t *index, uint32_t ancestor,
+                                  uint32_t node)
+{
+    if (!hinata_hierarchy_valid(index, ancestor) || !hinata_hierarchy_valid(index, node) ||
+        ancestor == node) {
+        return false;
+    }
+
+    return index->nodes[ancestor].enter < index->nodes[node].enter &&
+           index->nodes[node].exit < index->nodes[ancestor].exit;
+}
+
+int hinata_hierarchy_depth(const hinata_hierarchy_index_t *index, uint32_t node)
+{
+    if (!hinata_hierarchy_valid(index, node) || node == HINATA_HIERARCHY_ROOT) {
+        return -ENOENT;
+    }
+
+    return (int)index->nodes[node].depth - 1;
+}
+
+uint32_t hinata_hierarchy_descendants(const hinata_hierarchy_index_t *index, uint32_t node)
+{
+    const hinata_hierarchy_node_t *nodes;
+    uint32_t current, count = 0;
+
+    if (!hinata_hierarchy_valid(index, node)) {
+        return 0;
+    }
+    if (node == HINATA_HIERARCHY_ROOT) {
+        return index->live_count;
+    }
+
+    // 先序遍历子树：有子节点向下，否则找自己或最近祖先的下一个兄弟
+    nodes = index->nodes;
+    current = nodes[node].first_child;
+    while (current != HINATA_HIERARCHY_NONE) {
+        count++;
+        if (nodes[current].first_child != HINATA_HIERARCHY_NONE) {
+            current = nodes[current].first_child;
+            continue;
+        }
+        while (current != node && nodes[current].next_sibling == HINATA_HIERARCHY_NONE) {
+            current = nodes[current].parent;
+        }
+        current = current == node ? HINATA_HIERARCHY_NONE : nodes[current].next_sibling;
+    }
+
+    return count;
+}
+
+int hinata_hierarchy_ancestors(const hinata_hierarchy_index_t *index, uint32_t node,
+                               hinata_hierarchy_vec_t *out)
+{
+    int ret;
+
+    if (!hinata_hierarchy_valid(index, node) || !out) {
+        return -EINVAL;
+    }
+
+    for (node = index->nodes[node].parent;
+         node != HINATA_HIERARCHY_NONE && node != HINATA_HIERARCHY_ROOT;
+         node = index->nodes[node].parent) {
+        ret = hinata_hierarchy_vec_push(out, node);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+int hinata_hierarchy_children(const hinata_hierarchy_index_t *index, uint32_t node,
+                              hinata_hierarchy_vec_t *out)
+{
+    uint32_t child;
+    int ret;
+
+    if (!hinata_hierarchy_valid(index, node) || !out) {
+        return -EINVAL;
+    }
+
+    for (child = index->nodes[node].first_child; child != HINATA_HIERARCHY_NONE;
+         child = index->nodes[child].next_sibling) {
+        ret = hinata_hierarchy_vec_push(out, child);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+static int hinata_hierarchy_entry_cmp(const void *a, const void *b)
+{
+    const hinata_hierarchy_entry_t *x = a, *y = b;
+
+    if (x->label != y->label) {
+        return x->label < y->label ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * 节点是否属于查询结果：在区间内且深度不超过限制
+ */
+static bool hinata_hierarchy_in_subtree(const hinata_hierarchy_node_t *top,
+                                        const hinata_hierarchy_node_t *node, uint32_t max_depth)
+{
+    return node->live && node->enter > top->enter && node->exit < top->exit &&
+           (max_depth == 0 || node->depth - top->depth <= max_depth);
+}
+
+int hinata_hierarchy_subtree(const hinata_hierarchy_index_t *index, uint32_t node,
+                             uint32_t max_depth, hinata_hierarchy_vec_t *out)
+{
+    const hinata_hierarchy_node_t *top, *n;
+    hinata_hierarchy_entry_t *extra = NULL;
+    uint32_t extra_count = 0, extra_capacity = 0;
+    uint32_t left, right, mid, start, i, j;
+    int ret = 0;
+
+    if (!hinata_hierarchy_valid(index, node) || !out) {
+        return -EINVAL;
+    }
+
+    top = &index->nodes[node];
+
+    // 标签改变过的节点不在 entries 中的正确位置，单独收集后排序
+    for (i = 0; i < index->pending_count && !ret; i++) {
+        n = &index->nodes[index->pending[i]];
+        if (n->pending == i + 1 && hinata_hierarchy_in_subtree(top, n, max_depth)) {
+            ret = hinata_vec_reserve((void **)&extra, &extra_capacity, extra_count + 1,
+                                     sizeof(*extra));
+            if (!ret) {
+                extra[extra_count].label = n->enter;
+                extra[extra_count].node = index->pending[i];
+                extra_count++;
+            }
+        }
+    }
+    if (ret < 0) {
+        free(extra);
+        return ret;
+    }
+    if (extra_count > 1) {
+        qsort(extra, extra_count, sizeof(*extra), hinata_hierarchy_entry_cmp);
+    }
+
+    left = 0;
+    right = index->entry_count;
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (index->entries[mid].label <= top->enter) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    start = left;
+
+    // 一次区间扫描，与 pending 中的节点按标签归并
+    for (i = start, j = 0; !ret && (i < index->entry_count || j < extra_count);) {
+        if (i < index->entry_count && index->entries[i].label >= top->exit) {
+            i = index->entry_count;
+            continue;
+        }
+        if (j < extra_count &&
+            (i == index->entry_count || extra[j].label < index->entries[i].label)) {
+            ret = hinata_hierarchy_vec_push(out, extra[j++].node);
+            continue;
+        }
+
+        n = &index->nodes[index->entries[i].node];
+        if (!n->pending && n->enter == index->entries[i].label &&
+            hinata_hierarchy_in_subtree(top, n, max_depth)) {
+            ret = hinata_hierarchy_vec_push(out, index->entries[i].node);
+        }
+        i++;
+    }
+
+    free(extra);
+    return ret;
+}
@@ -0,0 +1,171 @@
+/**
+ * HiNATA 层级索引 - C 语言定义
+ *
+ * 为信息物料的父子关系维护区间标签：每个节点有进入和离开两个 64 位标签，
+ * 子树中所有节点的标签都落在祖先的区间之内。标签之间预留间隔，插入叶子
+ * 只需在父节点区间的空闲部分取值；空间不足时从父节点向上找到第一个足够
+ * 稀疏的祖先，只重新分配它的子树。
+ *
+ * 子树查询在按进入标签排序的数组上做一次区间扫描，结果为先序；祖先判断
+ * 只需比较标签。子节点以链表保存，没有数量上限。
+ *
+ * 子树大小不沿祖先链维护，只在重新分配前对要分配的子树统计，插入叶子
+ * 通常不访问祖先。标签空间固定为 64 位，每层按子树大小预留，深度为 d 的
+ * 链最底层只分到约 1/d^4 的空间：链深到几千层后，末端追加几乎每次都要
+ * 重新分配上百层祖先的子树，逐层追加建一条 n 层的链总代价接近 O(n^2)
+ * （5 万层约数秒）。删除节点和 descendants 的代价与子树大小成正比。
+ *
+ * 索引不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_HIERARCHY_INDEX_H
+#define _HINATA_HIERARCHY_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+
+// ============================================================================
+// 基础类型定义
+// ============================================================================
+
+#define HINATA_HIERARCHY_NONE UINT32_MAX
+
+// 虚拟根节点，所有顶层物料都是它的子节点
+#define HINATA_HIERARCHY_ROOT 0
+
+/**
+ * 层级节点
+ */
+typedef struct {
+    hinata_uuid_t id;
+    uint64_t enter;
+    uint64_t exit;
+    uint32_t parent;
+    uint32_t first_child;
+    uint32_t last_child;
+    uint32_t prev_sibling;
+    uint32_t next_sibling;
+    uint32_t depth;             // 虚拟根为 0，顶层物料为 1
+    uint32_t size;              // 上次统计的子树节点数（含自身），只在重新分配标签时准确
+    uint32_t pending;           // 在 pending 中最新位置 + 1，0 表示标签已在 entries 中
+    bool live;
+} hinata_hierarchy_node_t;
+
+/**
+ * 按进入标签排序的条目
+ */
+typedef struct {
+    uint64_t label;
+    uint32_t node;
+} hinata_hierarchy_entry_t;
+
+/**
+ * 遍历栈中的一帧：节点及分配给它的区间
+ */
+typedef struct {
+    uint32_t node;
+    uint64_t lo;
+    uint64_t hi;
+} hinata_hierarchy_frame_t;
+
+/**
+ * 节点向量
+ */
+typedef struct {
+    uint32_t *items;
+    uint32_t count;
+    uint32_t capacity;
+} hinata_hierarchy_vec_t;
+
+/**
+ * 层级索引
+ */
+typedef struct {
+    hinata_hierarchy_node_t *nodes;
+    uint32_t node_count;
+    uint32_t node_capacity;
+    uint32_t live_count;
+
+    // 外部 ID -> 节点 ID + 1
+    uint32_t *slots;
+    uint32_t slot_capacity;
+
+    // 上次合并时的先序，之后标签改变的节点记录在 pending 中
+    hinata_hierarchy_entry_t *entries;
+    uint32_t entry_count;
+    uint32_t entry_capacity;
+    uint32_t *pending;
+    uint32_t pending_count;
+    uint32_t pending_capacity;
+
+    // 遍历栈
+    hinata_hierarchy_frame_t *stack;
+    uint32_t stack_capacity;
+} hinata_hierarchy_index_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+int hinata_hierarchy_init(hinata_hierarchy_index_t *index);
+void hinata_hierarchy_free(hinata_hierarchy_index_t *index);
+
+/**
+ * 设置父节点，parent 为 NULL 或空字符串表示顶层
+ * 节点或父节点不存在时自动创建（父节点先作为顶层节点）；
+ * 已存在的节点连同子树移动到新父节点下，移动到自己的子树中返回 -ELOOP
+ */
+int hinata_hierarchy_set_parent(hinata_hierarchy_index_t *index, const char *uuid,
+                                const char *parent, uint32_t *node);
+int hinata_hierarchy_add_library_item(hinata_hierarchy_index_t *index,
+                                      const hinata_library_item_t *item);
+
+/**
+ * 删除节点，子节点按原顺序提升到被删节点的父节点下；不存在时返回 -ENOENT
+ */
+int hinata_hierarchy_remove(hinata_hierarchy_index_t *index, const char *uuid);
+
+/**
+ * 节点查找
+ */
+int hinata_hierarchy_node_id(const hinata_hierarchy_index_t *index, const char *uuid,
+                             uint32_t *node);
+const char *hinata_hierarchy_node_uuid(const hinata_hierarchy_index_t *index, uint32_t node);
+
+/**
+ * 结构查询
+ * depth 顶层节点为 0；descendants 不含自身
+ */
+bool hinata_hierarchy_is_ancestor(const hinata_hierarchy_index_t *index, uint32_t ancestor,
+                                  uint32_t node);
+int hinata_hierarchy_depth(const hinata_hierarchy_index_t *index, uint32_t node);
+uint32_t hinata_hierarchy_descendants(const hinata_hierarchy_index_t *index, uint32_t node);
+
+/**
+ * 列表查询，结果追加到 out
+ * ancestors 由近到远；children 按插入顺序；subtree 为先序，不含自身，
+ * max_depth 为 0 表示不限深度
+ */
+int hinata_hierarchy_ancestors(const hinata_hierarchy_index_t *index, uint32_t node,
+                               hinata_hierarchy_vec_t *out);
+int hinata_hierarchy_children(const hinata_hierarchy_index_t *index, uint32_t node,
+                              hinata_hierarchy_vec_t *out);
+int hinata_hierarchy_subtree(const hinata_hierarchy_index_t *index, uint32_t node,
+                             uint32_t max_depth, hinata_hierarchy_vec_t *out);
+
+/**
+ * 把 pending 合并进 entries（一次先序遍历）
+ */
+int hinata_hierarchy_merge(hinata_hierarchy_index_t *index);
+
+void hinata_hierarchy_vec_free(hinata_hierarchy_vec_t *vec);
+
+#endif /* _HINATA_HIERARCHY_INDEX_H */
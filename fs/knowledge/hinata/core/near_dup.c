@@ -0,0 +1,612 @@
+/**
+ * HiNATA 近似重复检测 - C 语言实现
+ */
+
+#include "near_dup.h"
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_DUP_MIN_HEADS 256
+#define HINATA_DUP_SEED 0x9e3779b97f4a7c15ULL
+
+// ============================================================================
+// 哈希
+// ============================================================================
+
+static uint64_t hinata_dup_mix(uint64_t x)
+{
+    x += HINATA_DUP_SEED;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// ============================================================================
+// 文本规范化
+// ============================================================================
+
+/**
+ * 解码一个 UTF-8 字符，非法字节按单字节处理
+ */
+static uint32_t hinata_dup_decode(const uint8_t *text, size_t length, size_t *pos)
+{
+    uint32_t cp = text[*pos];
+    size_t need, i;
+
+    if (cp < 0x80) {
+        (*pos)++;
+        return cp;
+    }
+
+    need = cp >= 0xf8 ? 0 : cp >= 0xf0 ? 3 : cp >= 0xe0 ? 2 : cp >= 0xc0 ? 1 : 0;
+    if (need == 0 || *pos + need >= length) {
+        (*pos)++;
+        return cp | 0x200000;
+    }
+
+    cp &= 0x3f >> need;
+    for (i = 1; i <= need; i++) {
+        if ((text[*pos + i] & 0xc0) != 0x80) {
+            cp = text[(*pos)++] | 0x200000;
+            return cp;
+        }
+        cp = (cp << 6) | (text[*pos + i] & 0x3f);
+    }
+
+    *pos += need + 1;
+    return cp;
+}
+
+/**
+ * 空白和标点都视为分隔符
+ */
+static bool hinata_dup_is_separator(uint32_t cp)
+{
+    if (cp < 0x80) {
+        return cp <= ' ' || cp == 0x7f ||
+               (cp >= '!' && cp <= '/') || (cp >= ':' && cp <= '@') ||
+               (cp >= '[' && cp <= '`') || (cp >= '{' && cp <= '~');
+    }
+
+    // 不换行空格、通用标点、CJK 符号和全角标点
+    return cp == 0xa0 || (cp >= 0x2000 && cp <= 0x206f) || (cp >= 0x3000 && cp <= 0x303f) ||
+           (cp >= 0xff01 && cp <= 0xff0f) || (cp >= 0xff1a && cp <= 0xff20) ||
+           (cp >= 0xff3b && cp <= 0xff40) || (cp >= 0xff5b && cp <= 0xff65);
+}
+
+// ============================================================================
+// 签名
+// ============================================================================
+
+/**
+ * 签名计算过程中的状态
+ */
+typedef struct {
+    uint32_t minhash[HINATA_DUP_HASHES];
+    uint32_t mul[HINATA_DUP_HASHES];
+    uint32_t add[HINATA_DUP_HASHES];
+    uint64_t lanes[8];          // SimHash 位计数：lanes[b] 的第 k 个字节计第 8k + b 位
+    uint32_t lane_count;
+    uint32_t ones[64];
+    uint32_t ring[HINATA_DUP_SHINGLE];
+    uint32_t emitted;
+    uint32_t shingles;
+} hinata_dup_state_t;
+
+static void hinata_dup_flush_lanes(hinata_dup_state_t *state)
+{
+    int b, k;
+
+    for (b = 0; b < 8; b++) {
+        for (k = 0; k < 8; k++) {
+            state->ones[8 * k + b] += (uint32_t)(state->lanes[b] >> (8 * k)) & 0xff;
+        }
+        state->lanes[b] = 0;
+    }
+    state->lane_count = 0;
+}
+
+/**
+ * 片段哈希加入签名
+ * 第 i 个 MinHash 位置使用 x * mul + add（mod 2^32，mul 为奇数），
+ * 对 32 位值是一个置换；循环无分支，便于编译器向量化。
+ * SimHash 用字节并行计数代替逐位加减
+ */
+static void hinata_dup_add_hash(hinata_dup_state_t *state, uint64_t hash)
+{
+    uint32_t x = (uint32_t)(hash ^ (hash >> 32));
+    uint32_t value;
+    int i;
+
+    for (i = 0; i < HINATA_DUP_HASHES; i++) {
+        value = x * state->mul[i] + state->add[i];
+        state->minhash[i] = value < state->minhash[i] ? value : state->minhash[i];
+    }
+
+    // 每个字节计数器最多累加 255 次，满了再展开到 ones
+    for (i = 0; i < 8; i++) {
+        state->lanes[i] += (hash >> i) & 0x0101010101010101ULL;
+    }
+    if (++state->lane_count == 255) {
+        hinata_dup_flush_lanes(state);
+    }
+
+    state->shingles++;
+}
+
+/**
+ * ring 中从 start 开始的 count 个字符的片段哈希
+ */
+static uint64_t hinata_dup_shingle_hash(const hinata_dup_state_t *state, uint32_t start,
+                                        uint32_t count)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        hash ^= state->ring[(start + i) % HINATA_DUP_SHINGLE];
+        hash *= 1099511628211ULL;
+    }
+
+    return hinata_dup_mix(hash);
+}
+
+/**
+ * 追加一个规范化后的字符，凑满一个片段时加入签名
+ */
+static void hinata_dup_emit(hinata_dup_state_t *state, uint32_t cp)
+{
+    state->ring[state->emitted++ % HINATA_DUP_SHINGLE] = cp;
+    if (state->emitted >= HINATA_DUP_SHINGLE) {
+        hinata_dup_add_hash(state, hinata_dup_shingle_hash(state, state->emitted,
+                                                           HINATA_DUP_SHINGLE));
+    }
+}
+
+int hinata_dup_signature(const char *text, size_t length, hinata_dup_signature_t *signature)
+{
+    const uint8_t *bytes = (const uint8_t *)text;
+    hinata_dup_state_t state;
+    bool separator = false;
+    size_t pos = 0;
+    uint32_t cp;
+    int i;
+
+    if ((!text && length) || !signature) {
+        return -EINVAL;
+    }
+
+    memset(&state, 0, sizeof(state));
+    memset(state.minhash, 0xff, sizeof(state.minhash));
+    for (i = 0; i < HINATA_DUP_HASHES; i++) {
+        state.mul[i] = (uint32_t)hinata_dup_mix(2 * (uint64_t)i + 1) | 1;
+        state.add[i] = (uint32_t)hinata_dup_mix(2 * (uint64_t)i + 2);
+    }
+
+    while (pos < length && bytes[pos]) {
+        cp = hinata_dup_decode(bytes, length, &pos);
+        if (hinata_dup_is_separator(cp)) {
+            separator = state.emitted > 0;
+            continue;
+        }
+        if (cp >= 'A' && cp <= 'Z') {
+            cp += 'a' - 'A';
+        }
+
+        // 连续的分隔符合并为一个空格，开头和结尾的分隔符丢弃
+        if (separator) {
+            hinata_dup_emit(&state, ' ');
+            separator = false;
+        }
+        hinata_dup_emit(&state, cp);
+    }
+
+    if (state.emitted == 0) {
+        return -ENODATA;
+    }
+    if (state.emitted < HINATA_DUP_SHINGLE) {
+        hinata_dup_add_hash(&state, hinata_dup_shingle_hash(&state, 0, state.emitted));
+    }
+
+    memset(signature, 0, sizeof(*signature));
+    memcpy(signature->minhash, state.minhash, sizeof(signature->minhash));
+    signature->shingle_count = state.shingles;
+    // 超过一半片段的哈希在该位为 1 时，SimHash 的该位为 1
+    hinata_dup_flush_lanes(&state);
+    for (i = 0; i < 64; i++) {
+        if (2 * (uint64_t)state.ones[i] > state.shingles) {
+            signature->simhash |= 1ULL << i;
+        }
+    }
+    return 0;
+}
+
+int hinata_dup_signature_packet(const hinata_data_packet_t *packet,
+                                hinata_dup_signature_t *signature)
+{
+    const hinata_core_t *core;
+    const char *nul;
+
+    if (!packet) {
+        return -EINVAL;
+    }
+
+    core = &packet->payload.core;
+    if (core->highlight[0]) {
+        nul = memchr(core->highlight, '\0', sizeof(core->highlight));
+        return hinata_dup_signature(core->highlight,
+                                    nul ? (size_t)(nul - core->highlight) :
+                                    sizeof(core->highlight), signature);
+    }
+
+    nul = memchr(core->note, '\0', sizeof(core->note));
+    return hinata_dup_signature(core->note, nul ? (size_t)(nul - core->note) : sizeof(core->note),
+                                signature);
+}
+
+float hinata_dup_similarity(const hinata_dup_signature_t *a, const hinata_dup_signature_t *b)
+{
+    uint32_t equal = 0;
+    int i;
+
+    for (i = 0; i < HINATA_DUP_HASHES; i++) {
+        equal += a->minhash[i] == b->minhash[i];
+    }
+
+    return (float)equal / HINATA_DUP_HASHES;
+}
+
+uint32_t hinata_dup_simhash_distance(const hinata_dup_signature_t *a,
+                                     const hinata_dup_signature_t *b)
+{
+    uint64_t diff = a->simhash ^ b->simhash;
+    uint32_t count = 0;
+
+    while (diff) {
+        diff &= diff - 1;
+        count++;
+    }
+    return count;
+}
+
+// ============================================================================
+// 索引
+// ============================================================================
+
+static uint64_t hinata_dup_band_key(const hinata_dup_signature_t *signature, uint32_t band)
+{
+    uint64_t key = hinata_dup_mix(band + 1);
+    uint32_t row;
+
+    for (row = 0; row < HINATA_DUP_ROWS; row++) {
+        key = hinata_dup_mix(key ^ signature->minhash[band * HINATA_DUP_ROWS + row]);
+    }
+    return key;
+}
+
+static const char *hinata_dup_id_key(const void *owner, uint32_t entry)
+{
+    return ((const hinata_dup_index_t *)owner)->ids[entry - 1];
+}
+
+static uint32_t hinata_dup_find_slot(const hinata_dup_index_t *index, const char *uuid)
+{
+    return hinata_uuid_slot(index->slots, index->slot_capacity, uuid, hinata_dup_id_key, index);
+}
+
+/**
+ * 把文档的各段加入桶，调用前保证 entries 和 heads 的容量
+ */
+static void hinata_dup_link(hinata_dup_index_t *index, uint32_t doc)
+{
+    hinata_dup_entry_t *entry;
+    uint32_t band, bucket;
+
+    for (band = 0; band < HINATA_DUP_BANDS; band++) {
+        entry = &index->entries[index->entry_count];
+        entry->key = hinata_dup_band_key(&index->signatures[doc], band);
+        entry->doc = doc;
+        bucket = (uint32_t)entry->key & (index->head_capacity - 1);
+        entry->next = index->heads[bucket];
+        index->heads[bucket] = ++index->entry_count;
+    }
+}
+
+/**
+ * 为重建分配桶头并预留条目，extra 为之后还会变为有效的文档数；
+ * 失败时索引不变
+ */
+static int hinata_dup_rebuild_reserve(hinata_dup_index_t *index, uint32_t extra,
+                                      uint32_t **out_heads, uint32_t *out_capacity)
+{
+    uint32_t needed = (index->live_count + extra) * HINATA_DUP_BANDS;
+    uint32_t head_capacity = HINATA_DUP_MIN_HEADS;
+    uint32_t *heads;
+    int ret;
+
+    while (head_capacity < needed) {
+        head_capacity *= 2;
+    }
+
+    heads = calloc(head_capacity, sizeof(*heads));
+    if (!heads) {
+        return -ENOMEM;
+    }
+
+    ret = hinata_vec_reserve((void **)&index->entries, &index->entry_capacity, needed,
+                             sizeof(*index->entries));
+    if (ret < 0) {
+        free(heads);
+        return ret;
+    }
+
+    *out_heads = heads;
+    *out_capacity = head_capacity;
+    return 0;
+}
+
+/**
+ * 按当前签名重建所有桶，丢弃过期条目；heads 由 hinata_dup_rebuild_reserve 分配
+ */
+static void hinata_dup_rebuild(hinata_dup_index_t *index, uint32_t *heads, uint32_t head_capacity)
+{
+    uint32_t doc;
+
+    free(index->heads);
+    index->heads = heads;
+    index->head_capacity = head_capacity;
+    index->entry_count = 0;
+    index->stale_count = 0;
+
+    for (doc = 0; doc < index->doc_count; doc++) {
+        if (index->live[doc]) {
+            hinata_dup_link(index, doc);
+        }
+    }
+}
+
+void hinata_dup_index_init(hinata_dup_index_t *index)
+{
+    memset(index, 0, sizeof(*index));
+}
+
+void hinata_dup_index_free(hinata_dup_index_t *index)
+{
+    if (!index) {
+        return;
+    }
+
+    free(index->ids);
+    free(index->signatures);
+    free(index->live);
+    free(index->slots);
+    free(index->heads);
+    free(index->entries);
+    memset(index, 0, sizeof(*index));
+}
+
+/**
+ * 新建文档，签名由调用方写入
+ */
+static int hinata_dup_doc_create(hinata_dup_index_t *index, const char *uuid, uint32_t *doc)
+{
+    uint32_t capacity = index->doc_capacity;
+    void *items;
+    int ret;
+
+    ret = hinata_uuid_slots_grow(&index->slots, &index->slot_capacity, index->doc_count,
+                                 index->doc_count, hinata_dup_id_key, index);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = hinata_vec_reserve((void **)&index->ids, &capacity, index->doc_count + 1,
+                             sizeof(*index->ids));
+    if (ret < 0) {
+        return ret;
+    }
+    if (capacity != index->doc_capacity) {
+        items = realloc(index->signatures, capacity * sizeof(*index->signatures));
+        if (!items) {
+            return -ENOMEM;
+        }
+        index->signatures = items;
+
+        items = realloc(index->live, capacity * sizeof(*index->live));
+        if (!items) {
+            return -ENOMEM;
+        }
+        index->live = items;
+        index->doc_capacity = capacity;
+    }
+
+    *doc = index->doc_count++;
+    hinata_uuid_assign(index->ids[*doc], uuid);
+    index->live[*doc] = false;
+    index->slots[hinata_dup_find_slot(index, uuid)] = *doc + 1;
+    return 0;
+}
+
+int hinata_dup_index_add(hinata_dup_index_t *index, const char *uuid,
+                         const hinata_dup_signature_t *signature, uint32_t *doc)
+{
+    uint32_t id, entry, head_capacity = 0;
+    uint32_t *heads = NULL;
+    bool was_live, rebuild;
+    int ret;
+
+    if (!index || !uuid || !*uuid || !signature) {
+        return -EINVAL;
+    }
+
+    entry = index->slot_capacity ? index->slots[hinata_dup_find_slot(index, uuid)] : 0;
+    if (entry) {
+        id = entry - 1;
+    } else {
+        ret = hinata_dup_doc_create(index, uuid, &id);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    // 先完成可能失败的分配，失败时旧签名和计数保持不变
+    was_live = index->live[id];
+    rebuild = index->entry_count + HINATA_DUP_BANDS > index->head_capacity ||
+              index->stale_count + (was_live ? HINATA_DUP_BANDS : 0) > index->entry_count / 2;
+    if (rebuild) {
+        ret = hinata_dup_rebuild_reserve(index, was_live ? 0 : 1, &heads, &head_capacity);
+    } else {
+        ret = hinata_vec_reserve((void **)&index->entries, &index->entry_capacity,
+                                 index->entry_count + HINATA_DUP_BANDS, sizeof(*index->entries));
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    // 替换签名时旧条目仍在桶中，查询时按当前签名校验即可过滤
+    if (was_live) {
+        index->stale_count += HINATA_DUP_BANDS;
+    } else {
+        index->live[id] = true;
+        index->live_count++;
+    }
+    index->signatures[id] = *signature;
+
+    if (rebuild) {
+        hinata_dup_rebuild(index, heads, head_capacity);
+    } else {
+        hinata_dup_link(index, id);
+    }
+
+    if (doc) {
+        *doc = id;
+    }
+    return 0;
+}
+
+int hinata_dup_index_remove(hinata_dup_index_t *index, const char *uuid)
+{
+    uint32_t entry;
+
+    if (!index || !uuid || !*uuid) {
+        return -EINVAL;
+    }
+
+    entry = index->slot_capacity ? index->slots[hinata_dup_find_slot(index, uuid)] : 0;
+    if (!entry || !index->live[entry - 1]) {
+        return -ENOENT;
+    }
+
+    index->live[entry - 1] = false;
+    index->live_count--;
+    index->stale_count += HINATA_DUP_BANDS;
+    return 0;
+}
+
+const char *hinata_dup_index_uuid(const hinata_dup_index_t *index, uint32_t doc)
+{
+    if (!index || doc >= index->doc_count) {
+        return NULL;
+    }
+
+    return index->ids[doc];
+}
+
+static int hinata_dup_uint_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int hinata_dup_match_cmp(const void *a, const void *b)
+{
+    const hinata_dup_match_t *x = a, *y = b;
+
+    if (x->similarity != y->similarity) {
+        return x->similarity > y->similarity ? -1 : 1;
+    }
+    return (x->doc > y->doc) - (x->doc < y->doc);
+}
+
+int hinata_dup_index_find(const hinata_dup_index_t *index, const hinata_dup_signature_t *signature,
+                          float threshold, hinata_dup_match_t *matches, uint32_t max,
+                          uint32_t *count)
+{
+    hinata_dup_match_t *found = NULL;
+    uint32_t *candidates = NULL;
+    uint32_t candidate_count = 0, candidate_capacity = 0;
+    uint32_t found_count = 0, found_capacity = 0;
+    const hinata_dup_entry_t *entry;
+    uint32_t band, next, i;
+    uint64_t key;
+    float similarity;
+    int ret = 0;
+
+    if (!index || !signature || (!matches && max) || !count) {
+        return -EINVAL;
+    }
+
+    *count = 0;
+    if (!index->head_capacity) {
+        return 0;
+    }
+
+    // 至少有一段完全相同的文档才是候选
+    for (band = 0; band < HINATA_DUP_BANDS && !ret; band++) {
+        key = hinata_dup_band_key(signature, band);
+        for (next = index->heads[(uint32_t)key & (index->head_capacity - 1)]; next && !ret;
+             next = entry->next) {
+            entry = &index->entries[next - 1];
+            if (entry->key != key || !index->live[entry->doc]) {
+                continue;
+            }
+            ret = hinata_vec_reserve((void **)&candidates, &candidate_capacity,
+                                     candidate_count + 1, sizeof(*candidates));
+            if (!ret) {
+                candidates[candidate_count++] = entry->doc;
+            }
+        }
+    }
+    if (ret < 0) {
+        free(candidates);
+        return ret;
+    }
+
+    if (candidate_count > 1) {
+        qsort(candidates, candidate_count, sizeof(*candidates), hinata_dup_uint_cmp);
+    }
+    for (i = 0; i < candidate_count && !ret; i++) {
+        if (i > 0 && candidates[i] == candidates[i - 1]) {
+            continue;
+        }
+        similarity = hinata_dup_similarity(signature, &index->signatures[candidates[i]]);
+        if (similarity < threshold) {
+            continue;
+        }
+        ret = hinata_vec_reserve((void **)&found, &found_capacity, found_count + 1,
+                                 sizeof(*found));
+        if (!ret) {
+            found[found_count].doc = candidates[i];
+            found[found_count].similarity = similarity;
+            found_count++;
+        }
+    }
+
+    if (!ret) {
+        if (found_count > 1) {
+            qsort(found, found_count, sizeof(*found), hinata_dup_match_cmp);
+        }
+        *count = found_count < max ? found_count : max;
+        if (*count) {
+            memcpy(matches, found, *count * sizeof(*found));
+        }
+    }
+
+    free(candidates);
+    free(found);
+    return ret;
+}
@@ -0,0 +1,131 @@
+/**
+ * HiNATA 近似重复检测 - C 语言定义
+ *
+ * 同一段文字从不同页面、不同设备反复摘录时，空白、大小写和标点的细微差别
+ * 就会让精确哈希失效。这里先规范化文本（小写、合并空白、去掉标点），
+ * 再取连续 HINATA_DUP_SHINGLE 个字符作为片段，计算：
+ *
+ *   MinHash   HINATA_DUP_HASHES 个最小哈希，相同位置相等的比例估计 Jaccard 相似度
+ *   SimHash   64 位指纹，汉明距离小说明内容接近
+ *
+ * 索引把 MinHash 分成 HINATA_DUP_BANDS 段，每段的哈希作为桶键（LSH 分段），
+ * 查询只比较至少有一段完全相同的候选，代价与索引规模无关。
+ * 以字符而不是单词为片段，中文等不以空格分词的文本同样适用。
+ *
+ * 索引不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_NEAR_DUP_H
+#define _HINATA_NEAR_DUP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+
+// 片段长度（字符数）
+#define HINATA_DUP_SHINGLE 4
+
+// MinHash 个数，等于分段数乘以每段行数
+#define HINATA_DUP_HASHES 64
+#define HINATA_DUP_BANDS 16
+#define HINATA_DUP_ROWS (HINATA_DUP_HASHES / HINATA_DUP_BANDS)
+
+// 默认相似度阈值
+#define HINATA_DUP_DEFAULT_THRESHOLD 0.8f
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 文本签名
+ */
+typedef struct {
+    uint32_t minhash[HINATA_DUP_HASHES];
+    uint64_t simhash;
+    uint32_t shingle_count;
+} hinata_dup_signature_t;
+
+/**
+ * 查询结果
+ */
+typedef struct {
+    uint32_t doc;
+    float similarity;
+} hinata_dup_match_t;
+
+/**
+ * 桶中的条目，next 为同一桶下一条目的位置 + 1
+ */
+typedef struct {
+    uint64_t key;
+    uint32_t doc;
+    uint32_t next;
+} hinata_dup_entry_t;
+
+/**
+ * 近似重复索引
+ */
+typedef struct {
+    // 文档
+    hinata_uuid_t *ids;
+    hinata_dup_signature_t *signatures;
+    bool *live;
+    uint32_t doc_count;
+    uint32_t doc_capacity;
+    uint32_t live_count;
+
+    // 外部 ID -> 文档 ID + 1
+    uint32_t *slots;
+    uint32_t slot_capacity;
+
+    // LSH 桶：heads 为桶中第一个条目的位置 + 1
+    uint32_t *heads;
+    uint32_t head_capacity;
+    hinata_dup_entry_t *entries;
+    uint32_t entry_count;
+    uint32_t entry_capacity;
+    uint32_t stale_count;       // 已删除或已替换签名留下的条目
+} hinata_dup_index_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 签名
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ * 规范化后没有任何字符时返回 -ENODATA；packet 版本使用摘录，摘录为空时使用笔记
+ */
+int hinata_dup_signature(const char *text, size_t length, hinata_dup_signature_t *signature);
+int hinata_dup_signature_packet(const hinata_data_packet_t *packet,
+                                hinata_dup_signature_t *signature);
+
+/**
+ * 签名比较：MinHash 估计的 Jaccard 相似度和 SimHash 汉明距离
+ */
+float hinata_dup_similarity(const hinata_dup_signature_t *a, const hinata_dup_signature_t *b);
+uint32_t hinata_dup_simhash_distance(const hinata_dup_signature_t *a,
+                                     const hinata_dup_signature_t *b);
+
+/**
+ * 索引
+ * add 对已存在的 ID 替换签名；remove 不存在时返回 -ENOENT
+ */
+void hinata_dup_index_init(hinata_dup_index_t *index);
+void hinata_dup_index_free(hinata_dup_index_t *index);
+int hinata_dup_index_add(hinata_dup_index_t *index, const char *uuid,
+                         const hinata_dup_signature_t *signature, uint32_t *doc);
+int hinata_dup_index_remove(hinata_dup_index_t *index, const char *uuid);
+const char *hinata_dup_index_uuid(const hinata_dup_index_t *index, uint32_t doc);
+
+/**
+ * 查找相似度不低于 threshold 的文档，按相似度降序最多写入 max 个
+ */
+int hinata_dup_index_find(const hinata_dup_index_t *index, const hinata_dup_signature_t *signature,
+                          float threshold, hinata_dup_match_t *matches, uint32_t max,
+                          uint32_t *count);
+
+#endif /* _HINATA_NEAR_DUP_H */
@@ -0,0 +1,769 @@
+/**
+ * HiNATA 数据包元数据驻留 - C 语言实现
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "packet_meta.h"
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define HINATA_CONTEXT_MIN_SLOTS 64
+
+#define HINATA_META_FILE_MAGIC "HNTMETA1"
+#define HINATA_META_FILE_VERSION 1
+
+#define HINATA_ARRAY_LEN(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+// ============================================================================
+// 字段工具
+// ============================================================================
+
+/**
+ * 定长字段中字符串的长度
+ */
+static size_t hinata_meta_field_len(const char *field, size_t size)
+{
+    const char *nul = memchr(field, '\0', size);
+
+    return nul ? (size_t)(nul - field) : size;
+}
+
+/**
+ * 复制定长字段，保证以 null 结尾且其余字节为 0
+ */
+static void hinata_meta_field_copy(char *dest, const char *src, size_t size)
+{
+    size_t len = hinata_meta_field_len(src, size);
+
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(dest, src, len);
+    memset(dest + len, 0, size - len);
+}
+
+static uint64_t hinata_meta_hash_field(uint64_t hash, const char *field, size_t size)
+{
+    size_t len = hinata_meta_field_len(field, size);
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (uint8_t)field[i];
+        hash *= 1099511628211ULL;
+    }
+
+    // 字段之间加分隔，避免内容跨字段移动后哈希相同
+    hash ^= 0xff;
+    hash *= 1099511628211ULL;
+    return hash;
+}
+
+#define HINATA_CONTEXT_FIELDS(X) \
+    X(device_id) X(os_version) X(app_version) X(user_agent) X(screen_resolution) X(timezone)
+
+uint64_t hinata_context_hash(const hinata_device_context_t *context)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+#define HINATA_HASH_FIELD(name) \
+    hash = hinata_meta_hash_field(hash, context->name, sizeof(context->name));
+    HINATA_CONTEXT_FIELDS(HINATA_HASH_FIELD)
+#undef HINATA_HASH_FIELD
+
+    return hash;
+}
+
+static bool hinata_context_equal(const hinata_device_context_t *a, const hinata_device_context_t *b)
+{
+#define HINATA_CMP_FIELD(name) \
+    if (strncmp(a->name, b->name, sizeof(a->name)) != 0) { \
+        return false; \
+    }
+    HINATA_CONTEXT_FIELDS(HINATA_CMP_FIELD)
+#undef HINATA_CMP_FIELD
+
+    return true;
+}
+
+static void hinata_context_copy(hinata_device_context_t *dest, const hinata_device_context_t *src)
+{
+#define HINATA_COPY_FIELD(name) \
+    hinata_meta_field_copy(dest->name, src->name, sizeof(dest->name));
+    HINATA_CONTEXT_FIELDS(HINATA_COPY_FIELD)
+#undef HINATA_COPY_FIELD
+}
+
+// ============================================================================
+// 设备上下文字典
+// ============================================================================
+
+void hinata_context_pool_init(hinata_context_pool_t *pool)
+{
+    memset(pool, 0, sizeof(*pool));
+}
+
+void hinata_context_pool_free(hinata_context_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    free(pool->entries);
+    free(pool->slots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+static hinata_context_entry_t *hinata_context_entry(const hinata_context_pool_t *pool, uint32_t id)
+{
+    if (id == HINATA_CONTEXT_NONE || id > pool->entry_count || !pool->entries[id - 1].refcount) {
+        return NULL;
+    }
+
+    return &pool->entries[id - 1];
+}
+
+/**
+ * 查找内容相同的条目所在的槽位，不存在时返回应插入的空槽位
+ */
+static uint32_t hinata_context_find_slot(const hinata_context_pool_t *pool,
+                                         const hinata_device_context_t *context, uint64_t hash)
+{
+    uint32_t mask = pool->slot_capacity - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    const hinata_context_entry_t *entry;
+    uint32_t id;
+
+    while ((id = pool->slots[slot]) != 0) {
+        entry = &pool->entries[id - 1];
+        if (entry->hash == hash && hinata_context_equal(&entry->context, context)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static int hinata_context_rehash(hinata_context_pool_t *pool, uint32_t slot_capacity)
+{
+    uint32_t *old_slots = pool->slots;
+    uint32_t mask = slot_capacity - 1;
+    uint32_t id, slot;
+
+    pool->slots = calloc(slot_capacity, sizeof(*pool->slots));
+    if (!pool->slots) {
+        pool->slots = old_slots;
+        return -ENOMEM;
+    }
+
+    pool->slot_capacity = slot_capacity;
+    for (id = 1; id <= pool->entry_count; id++) {
+        if (!pool->entries[id - 1].refcount) {
+            continue;
+        }
+        slot = (uint32_t)pool->entries[id - 1].hash & mask;
+        while (pool->slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        pool->slots[slot] = id;
+    }
+
+    free(old_slots);
+    return 0;
+}
+
+/**
+ * 从哈希表中删除 id，后面的条目向前移动填补空位
+ */
+static void hinata_context_unlink(hinata_context_pool_t *pool, uint32_t id)
+{
+    uint32_t mask = pool->slot_capacity - 1;
+    uint32_t hole, slot, home;
+
+    hole = (uint32_t)pool->entries[id - 1].hash & mask;
+    while (pool->slots[hole] != id) {
+        hole = (hole + 1) & mask;
+    }
+
+    for (slot = (hole + 1) & mask; pool->slots[slot]; slot = (slot + 1) & mask) {
+        home = (uint32_t)pool->entries[pool->slots[slot] - 1].hash & mask;
+        // home 不在 (hole, slot] 之间时，该条目可以移到 hole
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            pool->slots[hole] = pool->slots[slot];
+            hole = slot;
+        }
+    }
+    pool->slots[hole] = 0;
+}
+
+int hinata_context_intern(hinata_context_pool_t *pool, const hinata_device_context_t *context,
+                          uint32_t *id)
+{
+    hinata_device_context_t canonical;
+    hinata_context_entry_t *entry;
+    uint64_t hash;
+    uint32_t slot, new_id;
+    int ret;
+
+    if (!pool || !context || !id) {
+        return -EINVAL;
+    }
+
+    // 先规范化（截断并补 0），保证哈希和比较都基于保存的内容
+    hinata_context_copy(&canonical, context);
+    context = &canonical;
+    hash = hinata_context_hash(context);
+    if (pool->slot_capacity) {
+        slot = hinata_context_find_slot(pool, context, hash);
+        if (pool->slots[slot]) {
+            entry = &pool->entries[pool->slots[slot] - 1];
+            if (entry->refcount == UINT32_MAX) {
+                return -EOVERFLOW;
+            }
+            entry->refcount++;
+            *id = pool->slots[slot];
+            return 0;
+        }
+    }
+
+    if ((pool->live_count + 1) * 2 > pool->slot_capacity) {
+        ret = hinata_context_rehash(pool, pool->slot_capacity ? pool->slot_capacity * 2 :
+                                    HINATA_CONTEXT_MIN_SLOTS);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (pool->free_head) {
+        new_id = pool->free_head;
+        pool->free_head = pool->entries[new_id - 1].next_free;
+    } else {
+        ret = hinata_vec_reserve((void **)&pool->entries, &pool->entry_capacity,
+                                 pool->entry_count + 1, sizeof(*pool->entries));
+        if (ret < 0) {
+            return ret;
+        }
+        new_id = ++pool->entry_count;
+    }
+
+    // 条目按原样写入文件，先清零，结构体填充字节不带入未初始化的内存
+    entry = &pool->entries[new_id - 1];
+    memset(entry, 0, sizeof(*entry));
+    entry->context = canonical;
+    entry->hash = hash;
+    entry->refcount = 1;
+    entry->next_free = 0;
+    pool->slots[hinata_context_find_slot(pool, context, hash)] = new_id;
+    pool->live_count++;
+
+    *id = new_id;
+    return 0;
+}
+
+int hinata_context_retain(hinata_context_pool_t *pool, uint32_t id)
+{
+    hinata_context_entry_t *entry;
+
+    if (!pool) {
+        return -EINVAL;
+    }
+
+    entry = hinata_context_entry(pool, id);
+    if (!entry) {
+        return -ENOENT;
+    }
+    if (entry->refcount == UINT32_MAX) {
+        return -EOVERFLOW;
+    }
+
+    entry->refcount++;
+    return 0;
+}
+
+int hinata_context_release(hinata_context_pool_t *pool, uint32_t id)
+{
+    hinata_context_entry_t *entry;
+
+    if (!pool) {
+        return -EINVAL;
+    }
+
+    entry = hinata_context_entry(pool, id);
+    if (!entry) {
+        return -ENOENT;
+    }
+
+    if (--entry->refcount == 0) {
+        hinata_context_unlink(pool, id);
+        entry->next_free = pool->free_head;
+        pool->free_head = id;
+        pool->live_count--;
+    }
+    return 0;
+}
+
+const hinata_device_context_t *hinata_context_get(const hinata_context_pool_t *pool, uint32_t id)
+{
+    const hinata_context_entry_t *entry;
+
+    if (!pool) {
+        return NULL;
+    }
+
+    entry = hinata_context_entry(pool, id);
+    return entry ? &entry->context : NULL;
+}
+
+// ============================================================================
+// 处理标志
+// ============================================================================
+
+void hinata_flag_table_init(hinata_flag_table_t *table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+int hinata_flag_lookup(const hinata_flag_table_t *table, const char *name)
+{
+    uint32_t i;
+
+    if (!table || !name || !*name) {
+        return -EINVAL;
+    }
+
+    for (i = 0; i < table->count; i++) {
+        if (strncmp(table->names[i], name, HINATA_PROCESSING_FLAG_LEN - 1) == 0) {
+            return (int)i;
+        }
+    }
+
+    return -ENOENT;
+}
+
+int hinata_flag_register(hinata_flag_table_t *table, const char *name)
+{
+    uint32_t bit;
+    char *dest;
+    size_t len;
+    int ret;
+
+    ret = hinata_flag_lookup(table, name);
+    if (ret != -ENOENT) {
+        return ret;
+    }
+
+    // 先找空闲位，其次追加，表满时复用没有掩码引用的位
+    for (bit = 0; bit < table->count && table->names[bit][0]; bit++) {
+    }
+    if (bit == HINATA_MAX_PROCESSING_FLAGS) {
+        for (bit = 0; bit < table->count && table->refs[bit]; bit++) {
+        }
+        if (bit == table->count) {
+            return -ENOSPC;
+        }
+    }
+    if (bit == table->count) {
+        table->count++;
+    }
+
+    dest = table->names[bit];
+    len = hinata_meta_field_len(name, HINATA_PROCESSING_FLAG_LEN - 1);
+    memcpy(dest, name, len);
+    memset(dest + len, 0, HINATA_PROCESSING_FLAG_LEN - len);
+    table->refs[bit] = 0;
+    return (int)bit;
+}
+
+/**
+ * 去掉末尾的空闲位
+ */
+static void hinata_flag_trim(hinata_flag_table_t *table)
+{
+    while (table->count && !table->names[table->count - 1][0]) {
+        table->count--;
+    }
+}
+
+int hinata_flags_encode(hinata_flag_table_t *table, const char (*names)[32], uint32_t count,
+                        uint64_t *mask)
+{
+    uint64_t result = 0, added = 0, bits;
+    uint32_t i;
+    int bit;
+
+    if (!table || (!names && count) || !mask) {
+        return -EINVAL;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (!names[i][0]) {
+            continue;
+        }
+        bit = hinata_flag_lookup(table, names[i]);
+        if (bit == -ENOENT) {
+            bit = hinata_flag_register(table, names[i]);
+            if (bit >= 0) {
+                added |= 1ULL << bit;
+            }
+        }
+        if (bit >= 0 && !(result & (1ULL << bit)) && table->refs[bit] == UINT32_MAX) {
+            bit = -EOVERFLOW;
+        }
+        if (bit < 0) {
+            // 撤销已增加的引用，并删除本次新登记的标志
+            for (bits = result, i = 0; bits; bits >>= 1, i++) {
+                if (bits & 1) {
+                    table->refs[i]--;
+                }
+                if (added & (1ULL << i)) {
+                    memset(table->names[i], 0, HINATA_PROCESSING_FLAG_LEN);
+                }
+            }
+            hinata_flag_trim(table);
+            return bit;
+        }
+        if (!(result & (1ULL << bit))) {
+            table->refs[bit]++;
+            result |= 1ULL << bit;
+        }
+    }
+
+    *mask = result;
+    return 0;
+}
+
+void hinata_flags_release(hinata_flag_table_t *table, uint64_t mask)
+{
+    uint32_t bit;
+
+    if (!table) {
+        return;
+    }
+
+    for (bit = 0; bit < table->count; bit++) {
+        if ((mask & (1ULL << bit)) && table->refs[bit] && --table->refs[bit] == 0) {
+            memset(table->names[bit], 0, HINATA_PROCESSING_FLAG_LEN);
+        }
+    }
+    hinata_flag_trim(table);
+}
+
+uint32_t hinata_flags_decode(const hinata_flag_table_t *table, uint64_t mask,
+                             char (*names)[32], uint32_t max)
+{
+    uint32_t count = 0, bit;
+
+    if (!table || !names) {
+        return 0;
+    }
+
+    for (bit = 0; bit < table->count && count < max; bit++) {
+        if (mask & (1ULL << bit)) {
+            hinata_meta_field_copy(names[count++], table->names[bit], HINATA_PROCESSING_FLAG_LEN);
+        }
+    }
+
+    return count;
+}
+
+// ============================================================================
+// 与旧结构体转换
+// ============================================================================
+
+int hinata_packet_meta_from_legacy(hinata_context_pool_t *pool, hinata_flag_table_t *flags,
+                                   const hinata_packet_metadata_t *legacy,
+                                   hinata_packet_meta_t *meta)
+{
+    uint32_t count;
+    int ret;
+
+    if (!pool || !flags || !legacy || !meta) {
+        return -EINVAL;
+    }
+
+    memset(meta, 0, sizeof(*meta));
+    hinata_uuid_assign(meta->packet_id, legacy->packet_id);
+    meta->capture_source = legacy->capture_source;
+    meta->capture_timestamp = legacy->capture_timestamp;
+    meta->user_action = legacy->user_action;
+    meta->attention_score_raw = legacy->attention_score_raw;
+
+    count = legacy->processing_flag_count < HINATA_ARRAY_LEN(legacy->processing_flags) ?
+            legacy->processing_flag_count : HINATA_ARRAY_LEN(legacy->processing_flags);
+    ret = hinata_flags_encode(flags, legacy->processing_flags, count, &meta->processing_flags);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = hinata_context_intern(pool, &legacy->device_context, &meta->context_id);
+    if (ret < 0) {
+        hinata_flags_release(flags, meta->processing_flags);
+        meta->processing_flags = 0;
+    }
+    return ret;
+}
+
+int hinata_packet_meta_to_legacy(const hinata_context_pool_t *pool,
+                                 const hinata_flag_table_t *flags,
+                                 const hinata_packet_meta_t *meta,
+                                 hinata_packet_metadata_t *legacy)
+{
+    const hinata_device_context_t *context;
+
+    if (!pool || !flags || !meta || !legacy) {
+        return -EINVAL;
+    }
+
+    context = hinata_context_get(pool, meta->context_id);
+    if (!context && meta->context_id != HINATA_CONTEXT_NONE) {
+        return -ENOENT;
+    }
+
+    memset(legacy, 0, sizeof(*legacy));
+    hinata_uuid_assign(legacy->packet_id, meta->packet_id);
+    legacy->capture_source = meta->capture_source;
+    legacy->capture_timestamp = meta->capture_timestamp;
+    legacy->user_action = meta->user_action;
+    legacy->attention_score_raw = meta->attention_score_raw;
+    if (context) {
+        legacy->device_context = *context;
+    }
+
+    legacy->processing_flag_count = (uint8_t)hinata_flags_decode(
+        flags, meta->processing_flags, legacy->processing_flags,
+        HINATA_ARRAY_LEN(legacy->processing_flags));
+    return 0;
+}
+
+int hinata_packet_meta_release(hinata_context_pool_t *pool, hinata_flag_table_t *flags,
+                               const hinata_packet_meta_t *meta)
+{
+    int ret;
+
+    if (!pool || !flags || !meta) {
+        return -EINVAL;
+    }
+
+    if (meta->context_id != HINATA_CONTEXT_NONE) {
+        ret = hinata_context_release(pool, meta->context_id);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    hinata_flags_release(flags, meta->processing_flags);
+    return 0;
+}
+
+// ============================================================================
+// 持久化
+// ============================================================================
+
+/**
+ * 文件头，其后依次为 entry_count 个上下文条目、flag_count 个标志名称和
+ * flag_count 个引用数，均为本机字节序
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t free_head;
+    uint32_t flag_count;
+} hinata_meta_file_header_t;
+
+int hinata_packet_meta_save(const hinata_context_pool_t *pool, const hinata_flag_table_t *flags,
+                            const char *path)
+{
+    hinata_meta_file_header_t header;
+    FILE *file;
+    int ret = 0;
+
+    if (!pool || !flags || !path) {
+        return -EINVAL;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HINATA_META_FILE_MAGIC, sizeof(header.magic));
+    header.version = HINATA_META_FILE_VERSION;
+    header.entry_count = pool->entry_count;
+    header.free_head = pool->free_head;
+    header.flag_count = flags->count;
+
+    file = fopen(path, "wb");
+    if (!file) {
+        return -errno;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        (pool->entry_count &&
+         fwrite(pool->entries, sizeof(*pool->entries), pool->entry_count, file) !=
+             pool->entry_count) ||
+        fwrite(flags->names, HINATA_PROCESSING_FLAG_LEN, flags->count, file) != flags->count ||
+        fwrite(flags->refs, sizeof(*flags->refs), flags->count, file) != flags->count) {
+        ret = -EIO;
+    }
+
+    if (fclose(file) != 0 && !ret) {
+        ret = -EIO;
+    }
+    return ret;
+}
+
+/**
+ * 校验加载的条目和空闲链表，重新计算哈希并建立哈希表
+ */
+static int hinata_context_pool_validate(hinata_context_pool_t *pool)
+{
+    hinata_device_context_t canonical;
+    hinata_context_entry_t *entry;
+    uint32_t capacity = HINATA_CONTEXT_MIN_SLOTS;
+    uint32_t id, free_count = 0, steps = 0;
+    int ret;
+
+    for (id = 1; id <= pool->entry_count; id++) {
+        entry = &pool->entries[id - 1];
+        if (!entry->refcount) {
+            free_count++;
+            continue;
+        }
+
+        // 保存的内容必须已经规范化，与 intern 写入的一致
+        hinata_context_copy(&canonical, &entry->context);
+        if (memcmp(&canonical, &entry->context, sizeof(canonical)) != 0) {
+            return -EINVAL;
+        }
+        entry->hash = hinata_context_hash(&entry->context);
+        pool->live_count++;
+    }
+
+    // 空闲链表恰好经过每个空闲条目一次
+    for (id = pool->free_head; id; id = pool->entries[id - 1].next_free) {
+        if (id > pool->entry_count || pool->entries[id - 1].refcount || ++steps > free_count) {
+            return -EINVAL;
+        }
+    }
+    if (steps != free_count) {
+        return -EINVAL;
+    }
+
+    while (capacity < pool->live_count * 2) {
+        capacity *= 2;
+    }
+    ret = hinata_context_rehash(pool, capacity);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // 内容重复的条目会被前一个条目遮住
+    for (id = 1; id <= pool->entry_count; id++) {
+        entry = &pool->entries[id - 1];
+        if (entry->refcount &&
+            pool->slots[hinata_context_find_slot(pool, &entry->context, entry->hash)] != id) {
+            return -EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+static int hinata_flag_table_validate(const hinata_flag_table_t *table)
+{
+    uint32_t bit, i;
+
+    if (table->count && !table->names[table->count - 1][0]) {
+        return -EINVAL;
+    }
+
+    for (bit = 0; bit < table->count; bit++) {
+        if (hinata_meta_field_len(table->names[bit], HINATA_PROCESSING_FLAG_LEN) ==
+            HINATA_PROCESSING_FLAG_LEN) {
+            return -EINVAL;
+        }
+        if (!table->names[bit][0]) {
+            if (table->refs[bit]) {
+                return -EINVAL;
+            }
+            continue;
+        }
+        for (i = 0; i < bit; i++) {
+            if (strcmp(table->names[i], table->names[bit]) == 0) {
+                return -EINVAL;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int hinata_packet_meta_load(hinata_context_pool_t *pool, hinata_flag_table_t *flags,
+                            const char *path)
+{
+    hinata_meta_file_header_t header;
+    struct stat st;
+    FILE *file;
+    int ret = 0;
+
+    if (!pool || !flags || !path) {
+        return -EINVAL;
+    }
+
+    hinata_context_pool_init(pool);
+    hinata_flag_table_init(flags);
+
+    file = fopen(path, "rb");
+    if (!file) {
+        return -errno;
+    }
+
+    // 先按文件大小核对条目数，避免按损坏的头部分配内存
+    if (fstat(fileno(file), &st) < 0) {
+        ret = -errno;
+    } else if (fread(&header, sizeof(header), 1, file) != 1 ||
+               memcmp(header.magic, HINATA_META_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+               header.version != HINATA_META_FILE_VERSION ||
+               header.entry_count > UINT32_MAX / 2 ||
+               header.flag_count > HINATA_MAX_PROCESSING_FLAGS ||
+               (uint64_t)st.st_size != sizeof(header) +
+                   (uint64_t)header.entry_count * sizeof(*pool->entries) +
+                   (uint64_t)header.flag_count *
+                       (HINATA_PROCESSING_FLAG_LEN + sizeof(*flags->refs))) {
+        ret = -EINVAL;
+    }
+
+    if (!ret && header.entry_count) {
+        ret = hinata_vec_reserve((void **)&pool->entries, &pool->entry_capacity,
+                                 header.entry_count, sizeof(*pool->entries));
+        if (!ret && fread(pool->entries, sizeof(*pool->entries), header.entry_count, file) !=
+                        header.entry_count) {
+            ret = -EIO;
+        }
+    }
+    if (!ret) {
+        pool->entry_count = header.entry_count;
+        pool->free_head = header.free_head;
+        flags->count = header.flag_count;
+        if (fread(flags->names, HINATA_PROCESSING_FLAG_LEN, flags->count, file) != flags->count ||
+            fread(flags->refs, sizeof(*flags->refs), flags->count, file) != flags->count) {
+            ret = -EIO;
+        }
+    }
+    fclose(file);
+
+    if (!ret) {
+        ret = hinata_context_pool_validate(pool);
+    }
+    if (!ret) {
+        ret = hinata_flag_table_validate(flags);
+    }
+    if (ret < 0) {
+        hinata_context_pool_free(pool);
+        hinata_flag_table_init(flags);
+    }
+    return ret;
+}
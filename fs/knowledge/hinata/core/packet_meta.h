@@ -0,0 +1,142 @@
+/**
+ * HiNATA 数据包元数据驻留 - C 语言定义
+ *
+ * hinata_packet_metadata_t 内嵌完整的设备上下文和 10 个处理标志字符串，
+ * 约 1 KB，而同一设备的成千上万个数据包这部分内容几乎完全相同。
+ * 这里把设备上下文驻留到按内容哈希索引的引用计数字典中，数据包只保存
+ * 4 字节的上下文 ID；处理标志登记到标志表后以 64 位掩码保存。
+ * 标志按掩码引用计数，不再被任何掩码引用的位可以分配给新标志。
+ * 字典和标志表一起保存到文件，加载后上下文 ID 和标志位保持不变。
+ *
+ * 字典和标志表不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_PACKET_META_H
+#define _HINATA_PACKET_META_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+
+// 0 表示没有设备上下文
+#define HINATA_CONTEXT_NONE 0
+
+// 标志表同时登记的标志数上限，等于掩码位数
+#define HINATA_MAX_PROCESSING_FLAGS 64
+#define HINATA_PROCESSING_FLAG_LEN 32
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 驻留的设备上下文，refcount 为 0 的条目在空闲链表中
+ */
+typedef struct {
+    hinata_device_context_t context;
+    uint64_t hash;
+    uint32_t refcount;
+    uint32_t next_free;         // 下一个空闲条目的 ID，0 表示没有
+} hinata_context_entry_t;
+
+/**
+ * 设备上下文字典，ID 为条目位置 + 1
+ */
+typedef struct {
+    hinata_context_entry_t *entries;
+    uint32_t entry_count;
+    uint32_t entry_capacity;
+    uint32_t live_count;
+    uint32_t free_head;
+
+    // 线性探测哈希表，保存上下文 ID
+    uint32_t *slots;
+    uint32_t slot_capacity;
+} hinata_context_pool_t;
+
+/**
+ * 处理标志表：第 i 个名称对应掩码的第 i 位，空名称为空闲位
+ * refs 为引用该位的掩码数；count 为用过的最高位 + 1
+ */
+typedef struct {
+    char names[HINATA_MAX_PROCESSING_FLAGS][HINATA_PROCESSING_FLAG_LEN];
+    uint32_t refs[HINATA_MAX_PROCESSING_FLAGS];
+    uint32_t count;
+} hinata_flag_table_t;
+
+/**
+ * 紧凑的数据包元数据
+ */
+typedef struct {
+    hinata_uuid_t packet_id;
+    hinata_timestamp_t capture_timestamp;
+    uint64_t processing_flags;
+    uint32_t context_id;
+    hinata_capture_source_t capture_source;
+    hinata_user_action_t user_action;
+    uint8_t attention_score_raw;
+} hinata_packet_meta_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 设备上下文字典
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ * intern 对相同内容返回同一 ID 并增加引用；release 引用归零时回收 ID
+ */
+void hinata_context_pool_init(hinata_context_pool_t *pool);
+void hinata_context_pool_free(hinata_context_pool_t *pool);
+int hinata_context_intern(hinata_context_pool_t *pool, const hinata_device_context_t *context,
+                          uint32_t *id);
+int hinata_context_retain(hinata_context_pool_t *pool, uint32_t id);
+int hinata_context_release(hinata_context_pool_t *pool, uint32_t id);
+const hinata_device_context_t *hinata_context_get(const hinata_context_pool_t *pool, uint32_t id);
+uint64_t hinata_context_hash(const hinata_device_context_t *context);
+
+/**
+ * 处理标志
+ * register 返回标志的位序号，64 位都被引用时返回 -ENOSPC；只登记不引用的位
+ * 可能被之后登记的标志复用，需要长期使用的位应通过 encode 得到；
+ * encode 登记未见过的标志并为掩码中的每一位增加一次引用，失败时不改变标志表；
+ * release 撤销 encode 的引用，引用归零的位被回收；
+ * decode 最多写入 max 个名称并返回写入数
+ */
+void hinata_flag_table_init(hinata_flag_table_t *table);
+int hinata_flag_register(hinata_flag_table_t *table, const char *name);
+int hinata_flag_lookup(const hinata_flag_table_t *table, const char *name);
+int hinata_flags_encode(hinata_flag_table_t *table, const char (*names)[32], uint32_t count,
+                        uint64_t *mask);
+void hinata_flags_release(hinata_flag_table_t *table, uint64_t mask);
+uint32_t hinata_flags_decode(const hinata_flag_table_t *table, uint64_t mask,
+                             char (*names)[32], uint32_t max);
+
+/**
+ * 与旧结构体互相转换
+ * from_legacy 驻留设备上下文（增加一次引用）并编码处理标志；
+ * to_legacy 展开为完整结构体，上下文 ID 不存在时返回 -ENOENT；
+ * release 撤销 from_legacy 增加的上下文和标志引用
+ */
+int hinata_packet_meta_from_legacy(hinata_context_pool_t *pool, hinata_flag_table_t *flags,
+                                   const hinata_packet_metadata_t *legacy,
+                                   hinata_packet_meta_t *meta);
+int hinata_packet_meta_to_legacy(const hinata_context_pool_t *pool,
+                                 const hinata_flag_table_t *flags,
+                                 const hinata_packet_meta_t *meta,
+                                 hinata_packet_metadata_t *legacy);
+int hinata_packet_meta_release(hinata_context_pool_t *pool, hinata_flag_table_t *flags,
+                               const hinata_packet_meta_t *meta);
+
+/**
+ * 持久化字典和标志表，包括引用计数和空闲条目；文件按本机字节序和结构体布局保存
+ * load 不需要事先初始化，失败时 pool 和 flags 为空
+ */
+int hinata_packet_meta_save(const hinata_context_pool_t *pool, const hinata_flag_table_t *flags,
+                            const char *path);
+int hinata_packet_meta_load(hinata_context_pool_t *pool, hinata_flag_table_t *flags,
+                            const char *path);
+
+#endif /* _HINATA_PACKET_META_H */
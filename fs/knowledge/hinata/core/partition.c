@@ -0,0 +1,506 @@
+/**
+ * HiNATA 按用户分区存储 - C 语言实现
+ */
+
+#include "partition.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_PARTITION_MIN_SLOTS 64
+
+// ============================================================================
+// 单个分区
+// ============================================================================
+
+static const char *hinata_partition_block_key(const void *owner, uint32_t entry)
+{
+    return ((const hinata_partition_t *)owner)->blocks[entry - 1].id;
+}
+
+static uint32_t hinata_partition_slot(const hinata_partition_t *partition, const char *block_id)
+{
+    return hinata_uuid_slot(partition->slots, partition->slot_capacity, block_id,
+                            hinata_partition_block_key, partition);
+}
+
+/**
+ * 保证还能再放入一个块：块数组和槽位都预留好
+ */
+static int hinata_partition_reserve(hinata_partition_t *partition)
+{
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&partition->blocks, &partition->block_capacity,
+                             partition->block_count + 1, sizeof(*partition->blocks));
+    if (ret < 0) {
+        return ret;
+    }
+
+    return hinata_uuid_slots_grow(&partition->slots, &partition->slot_capacity,
+                                  partition->block_count, partition->block_count,
+                                  hinata_partition_block_key, partition);
+}
+
+static hinata_partition_t *hinata_partition_create(const char *user_id,
+                                                   hinata_timestamp_t bucket_width)
+{
+    hinata_partition_t *partition;
+
+    partition = calloc(1, sizeof(*partition));
+    if (!partition) {
+        return NULL;
+    }
+
+    hinata_uuid_assign(partition->user_id, user_id);
+    hinata_filter_index_init(&partition->filters, bucket_width);
+    return partition;
+}
+
+static void hinata_partition_destroy(hinata_partition_t *partition)
+{
+    uint32_t i;
+
+    if (!partition) {
+        return;
+    }
+
+    for (i = 0; i < partition->block_count; i++) {
+        hinata_compact_block_free(&partition->blocks[i]);
+    }
+    free(partition->blocks);
+    free(partition->slots);
+    hinata_filter_index_free(&partition->filters);
+    free(partition);
+}
+
+/**
+ * 移除 pos 处的块，最后一个块移到 pos
+ */
+static void hinata_partition_take(hinata_partition_t *partition, uint32_t pos)
+{
+    uint32_t last = partition->block_count - 1;
+
+    hinata_filter_index_remove(&partition->filters, partition->blocks[pos].id);
+    hinata_uuid_slots_unlink(partition->slots, partition->slot_capacity,
+                             hinata_partition_slot(partition, partition->blocks[pos].id),
+                             hinata_partition_block_key, partition);
+    hinata_compact_block_free(&partition->blocks[pos]);
+
+    if (pos != last) {
+        partition->blocks[pos] = partition->blocks[last];
+        partition->slots[hinata_partition_slot(partition, partition->blocks[pos].id)] = pos + 1;
+    }
+    partition->block_count--;
+}
+
+const hinata_compact_block_t *hinata_partition_find(const hinata_partition_t *partition,
+                                                    const char *block_id)
+{
+    uint32_t entry;
+
+    if (!partition || !block_id || !partition->slot_capacity) {
+        return NULL;
+    }
+
+    entry = partition->slots[hinata_partition_slot(partition, block_id)];
+    return entry ? &partition->blocks[entry - 1] : NULL;
+}
+
+const hinata_compact_block_t *hinata_partition_doc_block(const hinata_partition_t *partition,
+                                                         uint32_t doc_id)
+{
+    const char *block_id;
+
+    if (!partition) {
+        return NULL;
+    }
+
+    block_id = hinata_filter_index_doc_uuid(&partition->filters, doc_id);
+    return block_id ? hinata_partition_find(partition, block_id) : NULL;
+}
+
+// ============================================================================
+// 用户路由
+// ============================================================================
+
+// 删除账号留下的空位返回 NULL
+static const char *hinata_partition_user_key(const void *owner, uint32_t entry)
+{
+    const hinata_partition_t *partition;
+
+    partition = ((const hinata_partition_set_t *)owner)->partitions[entry - 1];
+    return partition ? partition->user_id : NULL;
+}
+
+static uint32_t hinata_partition_user_slot(const hinata_partition_set_t *set, const char *user_id)
+{
+    return hinata_uuid_slot(set->user_slots, set->user_slot_capacity, user_id,
+                            hinata_partition_user_key, set);
+}
+
+/**
+ * 查找或创建用户的分区
+ */
+static int hinata_partition_for_user(hinata_partition_set_t *set, const char *user_id,
+                                     uint32_t *index)
+{
+    hinata_partition_t *partition;
+    uint32_t slot, i;
+    int ret;
+
+    ret = hinata_uuid_slots_grow(&set->user_slots, &set->user_slot_capacity, set->user_count,
+                                 set->partition_count, hinata_partition_user_key, set);
+    if (ret < 0) {
+        return ret;
+    }
+
+    slot = hinata_partition_user_slot(set, user_id);
+    if (set->user_slots[slot]) {
+        *index = set->user_slots[slot] - 1;
+        return 0;
+    }
+
+    // 优先复用删除账号留下的位置
+    i = set->partition_count;
+    if (set->free_count) {
+        i = 0;
+        while (set->partitions[i]) {
+            i++;
+        }
+    } else {
+        ret = hinata_vec_reserve((void **)&set->partitions, &set->partition_capacity,
+                                 set->partition_count + 1, sizeof(*set->partitions));
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    partition = hinata_partition_create(user_id, set->bucket_width);
+    if (!partition) {
+        return -ENOMEM;
+    }
+
+    if (i == set->partition_count) {
+        set->partition_count++;
+    } else {
+        set->free_count--;
+    }
+    set->partitions[i] = partition;
+    set->user_slots[slot] = i + 1;
+    set->user_count++;
+
+    *index = i;
+    return 0;
+}
+
+// ============================================================================
+// 块路由
+// ============================================================================
+
+static uint32_t hinata_partition_route_slot(const hinata_partition_set_t *set,
+                                            const char *block_id)
+{
+    uint32_t mask = set->route_capacity - 1;
+    uint32_t slot = hinata_uuid_hash(block_id) & mask;
+
+    while (set->routes[slot].id[0]) {
+        if (strncmp(set->routes[slot].id, block_id, HINATA_UUID_LEN - 1) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static const hinata_partition_route_t *hinata_partition_route(const hinata_partition_set_t *set,
+                                                              const char *block_id)
+{
+    const hinata_partition_route_t *route;
+
+    if (!set->route_capacity || !block_id[0]) {
+        return NULL;
+    }
+
+    route = &set->routes[hinata_partition_route_slot(set, block_id)];
+    return route->id[0] ? route : NULL;
+}
+
+static int hinata_partition_grow_routes(hinata_partition_set_t *set)
+{
+    hinata_partition_route_t *old_routes = set->routes;
+    uint32_t old_capacity = set->route_capacity;
+    uint32_t capacity, i;
+
+    if ((set->route_count + 1) * 2 <= set->route_capacity) {
+        return 0;
+    }
+
+    capacity = old_capacity ? old_capacity * 2 : HINATA_PARTITION_MIN_SLOTS;
+    set->routes = calloc(capacity, sizeof(*set->routes));
+    if (!set->routes) {
+        set->routes = old_routes;
+        return -ENOMEM;
+    }
+
+    set->route_capacity = capacity;
+    for (i = 0; i < old_capacity; i++) {
+        if (old_routes[i].id[0]) {
+            set->routes[hinata_partition_route_slot(set, old_routes[i].id)] = old_routes[i];
+        }
+    }
+
+    free(old_routes);
+    return 0;
+}
+
+/**
+ * 删除路由，后面的条目向前移动填补空位
+ */
+static void hinata_partition_unroute(hinata_partition_set_t *set, const char *block_id)
+{
+    uint32_t mask = set->route_capacity - 1;
+    uint32_t hole = hinata_partition_route_slot(set, block_id);
+    uint32_t slot, home;
+
+    if (!set->routes[hole].id[0]) {
+        return;
+    }
+
+    for (slot = (hole + 1) & mask; set->routes[slot].id[0]; slot = (slot + 1) & mask) {
+        home = hinata_uuid_hash(set->routes[slot].id) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            set->routes[hole] = set->routes[slot];
+            hole = slot;
+        }
+    }
+    memset(&set->routes[hole], 0, sizeof(set->routes[hole]));
+    set->route_count--;
+}
+
+// ============================================================================
+// 分区集合
+// ============================================================================
+
+void hinata_partition_set_init(hinata_partition_set_t *set, hinata_timestamp_t bucket_width)
+{
+    memset(set, 0, sizeof(*set));
+    set->bucket_width = bucket_width;
+    set->version = hinata_next_version();
+}
+
+void hinata_partition_set_free(hinata_partition_set_t *set)
+{
+    uint32_t i;
+
+    if (!set) {
+        return;
+    }
+
+    for (i = 0; i < set->partition_count; i++) {
+        hinata_partition_destroy(set->partitions[i]);
+    }
+    free(set->partitions);
+    free(set->user_slots);
+    free(set->routes);
+    memset(set, 0, sizeof(*set));
+}
+
+int hinata_partition_set_put(hinata_partition_set_t *set, hinata_compact_block_t *block)
+{
+    hinata_partition_route_t *route;
+    hinata_partition_t *partition, *old;
+    uint32_t index, slot, entry;
+    bool existed;
+    int ret;
+
+    if (!set || !block || !block->id[0]) {
+        return -EINVAL;
+    }
+
+    // 先预留所有空间，之后的步骤不会因内存不足而半途失败
+    ret = hinata_partition_grow_routes(set);
+    if (!ret) {
+        ret = hinata_partition_for_user(set, block->user_id, &index);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    partition = set->partitions[index];
+    ret = hinata_partition_reserve(partition);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // 之后即使失败，过滤索引也可能已经改变
+    set->version = hinata_next_version();
+    partition->version = set->version;
+
+    slot = hinata_partition_slot(partition, block->id);
+    existed = partition->slots[slot] != 0;
+    ret = hinata_filter_index_add_compact_block(&partition->filters, block);
+    if (ret < 0) {
+        if (!existed) {
+            hinata_filter_index_remove(&partition->filters, block->id);
+        }
+        return ret;
+    }
+
+    // 块换了用户：从原分区移出
+    route = &set->routes[hinata_partition_route_slot(set, block->id)];
+    if (!route->id[0]) {
+        route = NULL;
+    } else if (route->partition != index) {
+        old = set->partitions[route->partition];
+        entry = old->slots[hinata_partition_slot(old, block->id)];
+        if (entry) {
+            hinata_partition_take(old, entry - 1);
+        }
+        old->version = set->version;
+    }
+
+    if (existed) {
+        entry = partition->slots[slot];
+        hinata_compact_block_free(&partition->blocks[entry - 1]);
+        partition->blocks[entry - 1] = *block;
+    } else {
+        partition->blocks[partition->block_count] = *block;
+        partition->slots[slot] = ++partition->block_count;
+    }
+
+    if (!route) {
+        route = &set->routes[hinata_partition_route_slot(set, block->id)];
+        hinata_uuid_assign(route->id, block->id);
+        set->route_count++;
+    }
+    route->partition = index;
+
+    hinata_compact_block_init(block);
+    return 0;
+}
+
+int hinata_partition_set_remove(hinata_partition_set_t *set, const char *block_id)
+{
+    const hinata_partition_route_t *route;
+    hinata_partition_t *partition;
+    uint32_t entry;
+
+    if (!set || !block_id) {
+        return -EINVAL;
+    }
+
+    route = hinata_partition_route(set, block_id);
+    if (!route) {
+        return -ENOENT;
+    }
+
+    partition = set->partitions[route->partition];
+    entry = partition->slots[hinata_partition_slot(partition, block_id)];
+    if (entry) {
+        hinata_partition_take(partition, entry - 1);
+    }
+    set->version = hinata_next_version();
+    partition->version = set->version;
+
+    hinata_partition_unroute(set, block_id);
+    return 0;
+}
+
+const hinata_compact_block_t *hinata_partition_set_find(const hinata_partition_set_t *set,
+                                                        const char *block_id)
+{
+    const hinata_partition_route_t *route;
+
+    if (!set || !block_id) {
+        return NULL;
+    }
+
+    route = hinata_partition_route(set, block_id);
+    return route ? hinata_partition_find(set->partitions[route->partition], block_id) : NULL;
+}
+
+hinata_partition_t *hinata_partition_set_user(const hinata_partition_set_t *set,
+                                              const char *user_id)
+{
+    uint32_t entry;
+
+    if (!set || !user_id || !set->user_slot_capacity) {
+        return NULL;
+    }
+
+    entry = set->user_slots[hinata_partition_user_slot(set, user_id)];
+    return entry ? set->partitions[entry - 1] : NULL;
+}
+
+int hinata_partition_set_drop_user(hinata_partition_set_t *set, const char *user_id)
+{
+    hinata_partition_t *partition;
+    uint32_t slot, i;
+
+    if (!set || !user_id) {
+        return -EINVAL;
+    }
+    if (!set->user_slot_capacity) {
+        return -ENOENT;
+    }
+
+    slot = hinata_partition_user_slot(set, user_id);
+    if (!set->user_slots[slot]) {
+        return -ENOENT;
+    }
+
+    // 路由表只需按分区内的块逐个删除，不必扫描全部路由
+    partition = set->partitions[set->user_slots[slot] - 1];
+    for (i = 0; i < partition->block_count; i++) {
+        hinata_partition_unroute(set, partition->blocks[i].id);
+    }
+
+    i = set->user_slots[slot] - 1;
+    hinata_uuid_slots_unlink(set->user_slots, set->user_slot_capacity, slot,
+                             hinata_partition_user_key, set);
+    set->user_count--;
+
+    hinata_partition_destroy(partition);
+    set->partitions[i] = NULL;
+    set->free_count++;
+    set->version = hinata_next_version();
+    return 0;
+}
+
+uint64_t hinata_partition_set_version(const hinata_partition_set_t *set, const char *user_id)
+{
+    const hinata_partition_t *partition;
+
+    if (!set) {
+        return 0;
+    }
+    if (!user_id) {
+        return set->version;
+    }
+
+    partition = hinata_partition_set_user(set, user_id);
+    return partition ? partition->version : 0;
+}
+
+int hinata_partition_set_evaluate(const hinata_partition_set_t *set,
+                                  const hinata_search_filters_t *filters,
+                                  const hinata_partition_t **partition, hinata_bitmap_t *out)
+{
+    const hinata_partition_t *found;
+
+    if (!set || !filters || !filters->has_user_id || !partition || !out) {
+        return -EINVAL;
+    }
+
+    found = hinata_partition_set_user(set, filters->user_id);
+    *partition = found;
+    if (!found) {
+        hinata_bitmap_free(out);
+        return 0;
+    }
+
+    return hinata_filter_index_evaluate(&found->filters, filters, out);
+}
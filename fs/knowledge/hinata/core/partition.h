@@ -0,0 +1,145 @@
+/**
+ * HiNATA 按用户分区存储 - C 语言定义
+ *
+ * 几乎所有查询都限定在一个 user_id 之内，而知识块和索引却按 UUID 放在
+ * 全局表中，同一用户的数据散落各处。这里为每个用户建立一个分区：
+ *
+ *   blocks    该用户的知识块连续存放，删除时用最后一个块填补空位
+ *   slots     分区内 块 ID -> 位置 + 1
+ *   filters   分区内的过滤索引，只包含该用户的文档
+ *
+ * 带 user_id 的查询只访问一个分区；删除账号释放整个分区，
+ * 导出等批量操作顺序扫描 blocks 即可。
+ * 全局只保留 user_id -> 分区 和 块 ID -> 分区 两张路由表，
+ * 后者用于按 ID 删除以及块更换所属用户时从原分区移出。
+ *
+ * 每次写入从集合的版本计数器取一个新值记到集合和被修改的分区上，
+ * 查询缓存按分区版本失效；版本全局递增，删除后重建的分区也不会重复旧值。
+ *
+ * 分区集合不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_PARTITION_H
+#define _HINATA_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+#include "bitmap.h"
+#include "filter_index.h"
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 单个用户的分区
+ */
+typedef struct {
+    hinata_uuid_t user_id;
+    uint64_t version;           // 最后一次修改时集合的版本
+
+    // 知识块，下标在删除其他块时可能改变
+    hinata_compact_block_t *blocks;
+    uint32_t block_count;
+    uint32_t block_capacity;
+
+    // 块 ID -> 位置 + 1
+    uint32_t *slots;
+    uint32_t slot_capacity;
+
+    hinata_filter_index_t filters;
+} hinata_partition_t;
+
+/**
+ * 路由表条目，id 为空字符串表示空槽位
+ */
+typedef struct {
+    hinata_uuid_t id;
+    uint32_t partition;         // 分区下标
+} hinata_partition_route_t;
+
+/**
+ * 分区集合
+ */
+typedef struct {
+    hinata_timestamp_t bucket_width;
+    uint64_t version;           // 初始化和每次写入时取进程内递增的新值，从不为 0
+
+    // 分区指针，删除账号后留下 NULL 供新用户复用
+    hinata_partition_t **partitions;
+    uint32_t partition_count;
+    uint32_t partition_capacity;
+    uint32_t free_count;
+
+    // user_id -> 分区下标 + 1
+    uint32_t *user_slots;
+    uint32_t user_slot_capacity;
+    uint32_t user_count;
+
+    // 块 ID -> 分区下标
+    hinata_partition_route_t *routes;
+    uint32_t route_capacity;
+    uint32_t route_count;
+} hinata_partition_set_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放，bucket_width 传给各分区的过滤索引
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_partition_set_init(hinata_partition_set_t *set, hinata_timestamp_t bucket_width);
+void hinata_partition_set_free(hinata_partition_set_t *set);
+
+/**
+ * 写入知识块：block 的内容被移入所属用户的分区，成功后 block 被重新初始化。
+ * ID 已存在时替换旧块；旧块属于其他用户时先从原分区移出
+ */
+int hinata_partition_set_put(hinata_partition_set_t *set, hinata_compact_block_t *block);
+
+/**
+ * 按 ID 删除和查找，不存在时分别返回 -ENOENT 和 NULL
+ * 返回的指针在分区被修改后失效
+ */
+int hinata_partition_set_remove(hinata_partition_set_t *set, const char *block_id);
+const hinata_compact_block_t *hinata_partition_set_find(const hinata_partition_set_t *set,
+                                                        const char *block_id);
+
+/**
+ * 用户分区，没有数据的用户返回 NULL
+ * drop_user 释放整个分区（删除账号），不存在时返回 -ENOENT
+ */
+hinata_partition_t *hinata_partition_set_user(const hinata_partition_set_t *set,
+                                              const char *user_id);
+int hinata_partition_set_drop_user(hinata_partition_set_t *set, const char *user_id);
+
+/**
+ * 写入版本：user_id 为 NULL 时返回整个集合的版本，
+ * 否则返回该用户分区的版本，没有分区时为 0
+ */
+uint64_t hinata_partition_set_version(const hinata_partition_set_t *set, const char *user_id);
+
+/**
+ * 在 filters->user_id 的分区内求过滤结果，结果为该分区过滤索引的文档 ID；
+ * filters 必须带 user_id，否则返回 -EINVAL。用户没有分区时 out 为空、
+ * *partition 为 NULL
+ */
+int hinata_partition_set_evaluate(const hinata_partition_set_t *set,
+                                  const hinata_search_filters_t *filters,
+                                  const hinata_partition_t **partition, hinata_bitmap_t *out);
+
+/**
+ * 分区内查找；doc_block 把过滤索引的文档 ID 转换为知识块
+ */
+const hinata_compact_block_t *hinata_partition_find(const hinata_partition_t *partition,
+                                                    const char *block_id);
+const hinata_compact_block_t *hinata_partition_doc_block(const hinata_partition_t *partition,
+                                                         uint32_t doc_id);
+
+#endif /* _HINATA_PARTITION_H */
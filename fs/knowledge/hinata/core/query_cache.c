@@ -0,0 +1,521 @@
+/**
+ * HiNATA 查询结果缓存 - C 语言实现
+ */
+
+#include "query_cache.h"
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * 构造中的键
+ */
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t capacity;
+    int ret;
+} hinata_query_key_t;
+
+// ============================================================================
+// 键的规范化
+// ============================================================================
+
+static void hinata_query_key_put(hinata_query_key_t *key, const void *data, size_t len)
+{
+    if (key->ret < 0) {
+        return;
+    }
+
+    key->ret = hinata_vec_reserve((void **)&key->data, &key->capacity,
+                                  key->size + (uint32_t)len, 1);
+    if (key->ret < 0) {
+        return;
+    }
+
+    memcpy(key->data + key->size, data, len);
+    key->size += (uint32_t)len;
+}
+
+static void hinata_query_key_byte(hinata_query_key_t *key, uint8_t value)
+{
+    hinata_query_key_put(key, &value, 1);
+}
+
+static bool hinata_query_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/**
+ * 去掉首尾空白，连续空白合并为一个空格，ASCII 转小写
+ */
+static void hinata_query_key_text(hinata_query_key_t *key, const char *text, size_t max)
+{
+    bool started = false, space = false;
+    size_t i;
+    char c;
+
+    for (i = 0; i < max && text[i]; i++) {
+        c = text[i];
+        if (hinata_query_space(c)) {
+            space = started;
+            continue;
+        }
+        if (space) {
+            hinata_query_key_byte(key, ' ');
+            space = false;
+        }
+        hinata_query_key_byte(key, (uint8_t)(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c));
+        started = true;
+    }
+    hinata_query_key_byte(key, 0);
+}
+
+static int hinata_query_tag_cmp(const void *a, const void *b)
+{
+    return strcmp(a, b);
+}
+
+static void hinata_query_key_filters(hinata_query_key_t *key, const hinata_search_filters_t *filters)
+{
+    char tags[HINATA_MAX_TAGS][HINATA_MAX_TAG_LEN];
+    uint32_t count, n = 0, i;
+    uint8_t access = 0, formats = 0, flags;
+
+    if (filters->has_user_id) {
+        hinata_query_key_byte(key, 'u');
+        for (i = 0; i < HINATA_UUID_LEN - 1 && filters->user_id[i]; i++) {
+            hinata_query_key_byte(key, (uint8_t)filters->user_id[i]);
+        }
+        hinata_query_key_byte(key, 0);
+    }
+
+    // 标签为"任一匹配"，顺序和重复不影响结果
+    count = filters->tag_count < HINATA_MAX_TAGS ? filters->tag_count : HINATA_MAX_TAGS;
+    for (i = 0; i < count; i++) {
+        hinata_normalize_tag(filters->tags[i], tags[n], HINATA_MAX_TAG_LEN);
+        if (tags[n][0]) {
+            n++;
+        }
+    }
+    qsort(tags, n, sizeof(tags[0]), hinata_query_tag_cmp);
+    hinata_query_key_byte(key, 't');
+    for (i = 0; i < n; i++) {
+        if (i == 0 || strcmp(tags[i], tags[i - 1]) != 0) {
+            hinata_query_key_put(key, tags[i], strlen(tags[i]) + 1);
+        }
+    }
+    hinata_query_key_byte(key, 0);
+
+    count = filters->access_level_count < 4 ? filters->access_level_count : 4;
+    for (i = 0; i < count; i++) {
+        if ((uint32_t)filters->access_levels[i] < 4) {
+            access |= (uint8_t)(1u << filters->access_levels[i]);
+        }
+    }
+    count = filters->content_format_count < 7 ? filters->content_format_count : 7;
+    for (i = 0; i < count; i++) {
+        if ((uint32_t)filters->content_formats[i] < 7) {
+            formats |= (uint8_t)(1u << filters->content_formats[i]);
+        }
+    }
+    hinata_query_key_byte(key, access);
+    hinata_query_key_byte(key, formats);
+
+    flags = (uint8_t)((filters->date_range.has_start ? 1 : 0) |
+                      (filters->date_range.has_end ? 2 : 0) | (filters->has_attachments ? 4 : 0));
+    hinata_query_key_byte(key, flags);
+    if (filters->date_range.has_start) {
+        hinata_query_key_put(key, &filters->date_range.start, sizeof(filters->date_range.start));
+    }
+    if (filters->date_range.has_end) {
+        hinata_query_key_put(key, &filters->date_range.end, sizeof(filters->date_range.end));
+    }
+}
+
+/**
+ * 序列化规范化的键，调用方释放 key->data
+ */
+static int hinata_query_key_build(hinata_query_key_t *key, uint32_t kind,
+                                  const hinata_search_query_t *query)
+{
+    memset(key, 0, sizeof(*key));
+
+    hinata_query_key_put(key, &kind, sizeof(kind));
+    hinata_query_key_text(key, query->query, sizeof(query->query));
+
+    hinata_query_key_byte(key, query->has_filters ? 'f' : 0);
+    if (query->has_filters) {
+        hinata_query_key_filters(key, &query->filters);
+    }
+
+    hinata_query_key_byte(key, query->has_sort ? 's' : 0);
+    if (query->has_sort) {
+        hinata_query_key_byte(key, (uint8_t)query->sort.field);
+        hinata_query_key_byte(key, (uint8_t)query->sort.direction);
+    }
+
+    hinata_query_key_put(key, &query->pagination.page, sizeof(query->pagination.page));
+    hinata_query_key_put(key, &query->pagination.limit, sizeof(query->pagination.limit));
+    hinata_query_key_put(key, &query->pagination.offset, sizeof(query->pagination.offset));
+
+    if (key->ret < 0) {
+        free(key->data);
+        key->data = NULL;
+    }
+    return key->ret;
+}
+
+/**
+ * FNV-1a 64 位哈希
+ */
+static uint64_t hinata_query_hash(const uint8_t *data, uint32_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    uint32_t i;
+
+    for (i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+// ============================================================================
+// 槽位与最近使用链表
+// ============================================================================
+
+static uint32_t hinata_query_slot(const hinata_query_cache_t *cache, uint64_t hash,
+                                  const uint8_t *key, uint32_t size)
+{
+    uint32_t mask = cache->slot_capacity - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    const hinata_query_cache_entry_t *entry;
+
+    while (cache->slots[slot]) {
+        entry = &cache->entries[cache->slots[slot] - 1];
+        if (entry->hash == hash && entry->key_size == size && memcmp(entry->key, key, size) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+/**
+ * 清空槽位并把后续同簇的元素前移，保持线性探测的查找路径完整
+ */
+static void hinata_query_unlink_slot(hinata_query_cache_t *cache, uint32_t hole)
+{
+    uint32_t mask = cache->slot_capacity - 1;
+    uint32_t slot = hole, entry, home;
+
+    cache->slots[hole] = 0;
+    for (;;) {
+        slot = (slot + 1) & mask;
+        entry = cache->slots[slot];
+        if (!entry) {
+            break;
+        }
+        home = (uint32_t)cache->entries[entry - 1].hash & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            cache->slots[hole] = entry;
+            cache->slots[slot] = 0;
+            hole = slot;
+        }
+    }
+}
+
+static void hinata_query_lru_unlink(hinata_query_cache_t *cache, uint32_t index)
+{
+    hinata_query_cache_entry_t *entry = &cache->entries[index];
+
+    if (entry->prev) {
+        cache->entries[entry->prev - 1].next = entry->next;
+    } else {
+        cache->head = entry->next;
+    }
+    if (entry->next) {
+        cache->entries[entry->next - 1].prev = entry->prev;
+    } else {
+        cache->tail = entry->prev;
+    }
+    entry->prev = 0;
+    entry->next = 0;
+}
+
+static void hinata_query_lru_push(hinata_query_cache_t *cache, uint32_t index)
+{
+    hinata_query_cache_entry_t *entry = &cache->entries[index];
+
+    entry->prev = 0;
+    entry->next = cache->head;
+    if (cache->head) {
+        cache->entries[cache->head - 1].prev = index + 1;
+    } else {
+        cache->tail = index + 1;
+    }
+    cache->head = index + 1;
+}
+
+/**
+ * 删除 slot 上的条目并放回空闲链表
+ */
+static void hinata_query_drop(hinata_query_cache_t *cache, uint32_t slot)
+{
+    uint32_t index = cache->slots[slot] - 1;
+    hinata_query_cache_entry_t *entry = &cache->entries[index];
+
+    hinata_query_unlink_slot(cache, slot);
+    hinata_query_lru_unlink(cache, index);
+    cache->bytes -= entry->key_size + entry->value_size;
+    free(entry->key);
+    free(entry->value);
+    memset(entry, 0, sizeof(*entry));
+    entry->next = cache->free_head;
+    cache->free_head = index + 1;
+    cache->count--;
+}
+
+/**
+ * 首次写入时按 max_entries 分配条目和槽位，负载不超过一半
+ */
+static int hinata_query_cache_alloc(hinata_query_cache_t *cache)
+{
+    uint32_t capacity = 64, i;
+
+    if (cache->entries) {
+        return 0;
+    }
+
+    while (capacity < cache->max_entries * 2) {
+        capacity *= 2;
+    }
+
+    cache->entries = calloc(cache->max_entries, sizeof(*cache->entries));
+    cache->slots = calloc(capacity, sizeof(*cache->slots));
+    if (!cache->entries || !cache->slots) {
+        free(cache->entries);
+        free(cache->slots);
+        cache->entries = NULL;
+        cache->slots = NULL;
+        return -ENOMEM;
+    }
+
+    cache->slot_capacity = capacity;
+    for (i = 0; i < cache->max_entries; i++) {
+        cache->entries[i].next = i + 2 <= cache->max_entries ? i + 2 : 0;
+    }
+    cache->free_head = 1;
+    return 0;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_query_cache_init(hinata_query_cache_t *cache, uint32_t max_entries, size_t max_bytes)
+{
+    memset(cache, 0, sizeof(*cache));
+    if (!max_entries) {
+        max_entries = HINATA_QUERY_CACHE_ENTRIES;
+    } else if (max_entries > HINATA_QUERY_CACHE_MAX_ENTRIES) {
+        max_entries = HINATA_QUERY_CACHE_MAX_ENTRIES;
+    }
+    cache->max_entries = max_entries;
+    cache->max_bytes = max_bytes ? max_bytes : HINATA_QUERY_CACHE_BYTES;
+}
+
+void hinata_query_cache_clear(hinata_query_cache_t *cache)
+{
+    uint32_t i;
+
+    if (!cache || !cache->entries) {
+        return;
+    }
+
+    for (i = 0; i < cache->max_entries; i++) {
+        free(cache->entries[i].key);
+        free(cache->entries[i].value);
+        memset(&cache->entries[i], 0, sizeof(cache->entries[i]));
+        cache->entries[i].next = i + 2 <= cache->max_entries ? i + 2 : 0;
+    }
+    memset(cache->slots, 0, cache->slot_capacity * sizeof(*cache->slots));
+    cache->free_head = 1;
+    cache->count = 0;
+    cache->bytes = 0;
+    cache->head = 0;
+    cache->tail = 0;
+}
+
+void hinata_query_cache_free(hinata_query_cache_t *cache)
+{
+    if (!cache) {
+        return;
+    }
+
+    hinata_query_cache_clear(cache);
+    free(cache->entries);
+    free(cache->slots);
+    hinata_query_cache_init(cache, cache->max_entries, cache->max_bytes);
+}
+
+// ============================================================================
+// 读取与写入
+// ============================================================================
+
+int hinata_query_cache_get(hinata_query_cache_t *cache, uint32_t kind,
+                           const hinata_search_query_t *query, uint64_t version,
+                           const void **value, size_t *size)
+{
+    hinata_query_cache_entry_t *entry;
+    hinata_query_key_t key;
+    uint32_t slot, index;
+    uint64_t hash;
+    int ret;
+
+    if (!cache || !query || !value || !size) {
+        return -EINVAL;
+    }
+    if (!cache->entries) {
+        cache->stats.misses++;
+        return -ENOENT;
+    }
+
+    ret = hinata_query_key_build(&key, kind, query);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hash = hinata_query_hash(key.data, key.size);
+    slot = hinata_query_slot(cache, hash, key.data, key.size);
+    free(key.data);
+
+    if (!cache->slots[slot]) {
+        cache->stats.misses++;
+        return -ENOENT;
+    }
+
+    index = cache->slots[slot] - 1;
+    entry = &cache->entries[index];
+    if (entry->version != version) {
+        hinata_query_drop(cache, slot);
+        cache->stats.invalidations++;
+        cache->stats.misses++;
+        return -ENOENT;
+    }
+
+    hinata_query_lru_unlink(cache, index);
+    hinata_query_lru_push(cache, index);
+    cache->stats.hits++;
+    *value = entry->value;
+    *size = entry->value_size;
+    return 0;
+}
+
+int hinata_query_cache_put(hinata_query_cache_t *cache, uint32_t kind,
+                           const hinata_search_query_t *query, uint64_t version,
+                           const void *value, size_t size)
+{
+    hinata_query_cache_entry_t *entry;
+    hinata_query_key_t key;
+    uint32_t slot, index, tail;
+    uint64_t hash;
+    void *copy;
+    int ret;
+
+    if (!cache || !query || (size && !value)) {
+        return -EINVAL;
+    }
+
+    ret = hinata_query_cache_alloc(cache);
+    if (!ret) {
+        ret = hinata_query_key_build(&key, kind, query);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+    if (key.size + size > cache->max_bytes) {
+        free(key.data);
+        return -E2BIG;
+    }
+
+    copy = malloc(size ? size : 1);
+    if (!copy) {
+        free(key.data);
+        return -ENOMEM;
+    }
+    if (size) {
+        memcpy(copy, value, size);
+    }
+
+    // 同一个键已存在时先删除旧结果，按新条目重新计入容量
+    hash = hinata_query_hash(key.data, key.size);
+    slot = hinata_query_slot(cache, hash, key.data, key.size);
+    if (cache->slots[slot]) {
+        hinata_query_drop(cache, slot);
+    }
+
+    // 按最近使用顺序淘汰，直到条目数和字节数都有空间
+    while (cache->tail && (cache->count == cache->max_entries ||
+                           cache->bytes + key.size + size > cache->max_bytes)) {
+        tail = cache->tail - 1;
+        hinata_query_drop(cache, hinata_query_slot(cache, cache->entries[tail].hash,
+                                                   cache->entries[tail].key,
+                                                   cache->entries[tail].key_size));
+        cache->stats.evictions++;
+    }
+    slot = hinata_query_slot(cache, hash, key.data, key.size);
+
+    index = cache->free_head - 1;
+    entry = &cache->entries[index];
+    cache->free_head = entry->next;
+    entry->hash = hash;
+    entry->key = key.data;
+    entry->key_size = key.size;
+    entry->version = version;
+    entry->value = copy;
+    entry->value_size = size;
+    cache->slots[slot] = index + 1;
+    cache->bytes += key.size + size;
+    cache->count++;
+    hinata_query_lru_push(cache, index);
+    return 0;
+}
+
+int hinata_query_cache_remove(hinata_query_cache_t *cache, uint32_t kind,
+                              const hinata_search_query_t *query)
+{
+    hinata_query_key_t key;
+    uint32_t slot;
+    uint64_t hash;
+    int ret;
+
+    if (!cache || !query) {
+        return -EINVAL;
+    }
+    if (!cache->entries) {
+        return -ENOENT;
+    }
+
+    ret = hinata_query_key_build(&key, kind, query);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hash = hinata_query_hash(key.data, key.size);
+    slot = hinata_query_slot(cache, hash, key.data, key.size);
+    free(key.data);
+
+    if (!cache->slots[slot]) {
+        return -ENOENT;
+    }
+
+    hinata_query_drop(cache, slot);
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * HiNATA 查询结果缓存 - C 语言定义
+ *
+ * 仪表盘上的"最近条目""标签统计"等查询反复执行，结果在数据变化之前不会变。
+ * 这里按 规范化的查询 + 过滤条件 缓存结果，不设过期时间，而是在保存时
+ * 记下查询所依赖数据的写入版本（过滤索引、时间线或分区的 version）：
+ * 读取时版本不同即视为失效并丢弃，数据不变时热点查询一直由内存返回。
+ *
+ * 键的规范化：查询文本去掉首尾空白、连续空白合并为一个空格、ASCII 转小写；
+ * 标签按标签规则规范化后排序去重，访问级别和内容格式与顺序无关；
+ * 未设置的排序和过滤条件不参与比较。kind 区分同一查询的不同结果
+ * （如文档列表和聚合行）。
+ *
+ * 条目数和值的总字节数有上限，超出时淘汰最久未使用的条目。
+ * 版本取自进程内递增的计数，索引释放后重新初始化也不会与旧条目的版本相同。
+ *
+ * 缓存不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_QUERY_CACHE_H
+#define _HINATA_QUERY_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+
+// 默认上限
+#define HINATA_QUERY_CACHE_ENTRIES 1024
+#define HINATA_QUERY_CACHE_BYTES (16u << 20)
+
+// 条目数的最大值，槽位数为条目数的两倍以上，不能超出 32 位
+#define HINATA_QUERY_CACHE_MAX_ENTRIES (1u << 24)
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 缓存条目，prev/next 为最近使用链表中的 条目下标 + 1
+ */
+typedef struct {
+    uint64_t hash;
+    uint8_t *key;               // 规范化后的键
+    uint32_t key_size;
+    uint64_t version;
+    void *value;
+    size_t value_size;
+    uint32_t prev;
+    uint32_t next;
+} hinata_query_cache_entry_t;
+
+/**
+ * 命中统计
+ */
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t invalidations;     // 因版本变化丢弃的条目
+    uint64_t evictions;         // 因容量淘汰的条目
+} hinata_query_cache_stats_t;
+
+/**
+ * 查询结果缓存
+ */
+typedef struct {
+    uint32_t max_entries;
+    size_t max_bytes;
+    size_t bytes;
+
+    // 条目在首次写入时按 max_entries 分配，空闲条目用 next 串起来
+    hinata_query_cache_entry_t *entries;
+    uint32_t free_head;
+    uint32_t count;
+
+    // 哈希 -> 条目下标 + 1
+    uint32_t *slots;
+    uint32_t slot_capacity;
+
+    // 最近使用在前
+    uint32_t head;
+    uint32_t tail;
+
+    hinata_query_cache_stats_t stats;
+} hinata_query_cache_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放，上限为 0 时使用默认值，条目数超过 HINATA_QUERY_CACHE_MAX_ENTRIES 时取该值
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_query_cache_init(hinata_query_cache_t *cache, uint32_t max_entries, size_t max_bytes);
+void hinata_query_cache_free(hinata_query_cache_t *cache);
+
+/**
+ * 读取：命中且 version 一致时 *value / *size 指向缓存的结果并返回 0，
+ * 指针在下一次 put、remove 或 clear 之前有效；未命中返回 -ENOENT，
+ * 版本不一致的条目同时被丢弃
+ */
+int hinata_query_cache_get(hinata_query_cache_t *cache, uint32_t kind,
+                           const hinata_search_query_t *query, uint64_t version,
+                           const void **value, size_t *size);
+
+/**
+ * 保存结果的副本，同一个键已存在时替换；结果超过字节上限时返回 -E2BIG
+ */
+int hinata_query_cache_put(hinata_query_cache_t *cache, uint32_t kind,
+                           const hinata_search_query_t *query, uint64_t version,
+                           const void *value, size_t size);
+
+/**
+ * 删除单个键（不存在时返回 -ENOENT）或清空全部
+ */
+int hinata_query_cache_remove(hinata_query_cache_t *cache, uint32_t kind,
+                              const hinata_search_query_t *query);
+void hinata_query_cache_clear(hinata_query_cache_t *cache);
+
+#endif /* _HINATA_QUERY_CACHE_H */
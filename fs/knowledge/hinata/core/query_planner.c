@@ -0,0 +1,1019 @@
+/**
+ * HiNATA 查询计划 - C 语言实现
+ */
+
+#include "query_planner.h"
+#include "compact_block.h"
+#include "ranking.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_ARRAY_LEN(arr) (sizeof(arr) / sizeof((arr)[0]))
+#define HINATA_PLANNER_MIN_SLOTS 64
+
+// 没有词项统计时假定的文本选择性
+#define HINATA_PLANNER_TEXT_SELECTIVITY 0.1
+
+/**
+ * 一次规划中各条件的估计
+ */
+typedef struct {
+    double docs;
+    double filter;              // 全部过滤条件的选择性
+    double filter_no_date;      // 除日期范围之外的过滤条件
+    uint32_t filter_count;
+    double bitmap_rows;         // 位图求值读取的文档数
+    bool date;
+    double date_rows;           // 日期范围内的文档数，没有日期条件时为全部
+
+    bool text;
+    bool text_indexed;          // 有词项统计，可以使用文本优先
+    double text_sel;
+    double posting_rows;
+    double postings_out;
+
+    bool sort;                  // 查询带排序条件，没有时任取 need 个即可
+    double need;                // 排序后需要的前 need 个，0 表示全部
+    uint32_t skip;
+    uint32_t limit;
+} hinata_planner_estimate_t;
+
+// ============================================================================
+// 分词与词项统计
+// ============================================================================
+
+static bool hinata_planner_term_byte(unsigned char c)
+{
+    return c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+           (c >= 'A' && c <= 'Z');
+}
+
+/**
+ * 从 *pos 开始读取下一个词项的 FNV-1a 64 位哈希，没有更多词项时返回 false
+ */
+static bool hinata_planner_next_term(const char *text, size_t max, size_t *pos, uint64_t *hash)
+{
+    size_t i = *pos;
+    unsigned char c;
+
+    while (i < max && text[i] && !hinata_planner_term_byte((unsigned char)text[i])) {
+        i++;
+    }
+    if (i >= max || !text[i]) {
+        *pos = i;
+        return false;
+    }
+
+    *hash = 14695981039346656037ull;
+    for (; i < max && text[i] && hinata_planner_term_byte((unsigned char)text[i]); i++) {
+        c = (unsigned char)text[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = (unsigned char)(c - 'A' + 'a');
+        }
+        *hash ^= c;
+        *hash *= 1099511628211ull;
+    }
+
+    *pos = i;
+    return true;
+}
+
+static uint32_t hinata_planner_term_slot(const hinata_query_planner_t *planner, uint64_t hash)
+{
+    uint32_t mask = planner->term_slot_capacity - 1;
+    uint32_t slot = (uint32_t)hash & mask;
+    uint32_t entry;
+
+    while ((entry = planner->term_slots[slot]) != 0) {
+        if (planner->terms[entry - 1].hash == hash) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static const hinata_planner_term_t *hinata_planner_find_term(const hinata_query_planner_t *planner,
+                                                            uint64_t hash)
+{
+    uint32_t entry;
+
+    if (!planner->term_slot_capacity) {
+        return NULL;
+    }
+
+    entry = planner->term_slots[hinata_planner_term_slot(planner, hash)];
+    return entry ? &planner->terms[entry - 1] : NULL;
+}
+
+/**
+ * 负载超过一半时扩容并重新插入
+ */
+static int hinata_planner_grow_slots(hinata_query_planner_t *planner)
+{
+    uint32_t *old_slots = planner->term_slots;
+    uint32_t new_capacity;
+    uint32_t i;
+
+    if ((planner->term_count + 1) * 2 <= planner->term_slot_capacity) {
+        return 0;
+    }
+
+    new_capacity = planner->term_slot_capacity ? planner->term_slot_capacity * 2 :
+                   HINATA_PLANNER_MIN_SLOTS;
+    planner->term_slots = calloc(new_capacity, sizeof(*planner->term_slots));
+    if (!planner->term_slots) {
+        planner->term_slots = old_slots;
+        return -ENOMEM;
+    }
+
+    planner->term_slot_capacity = new_capacity;
+    for (i = 0; i < planner->term_count; i++) {
+        planner->term_slots[hinata_planner_term_slot(planner, planner->terms[i].hash)] = i + 1;
+    }
+
+    free(old_slots);
+    return 0;
+}
+
+static int hinata_planner_hash_cmp(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * 文档中每个不同的词项 docs 加 delta
+ */
+static int hinata_planner_count_text(hinata_query_planner_t *planner, const char *text, int delta)
+{
+    hinata_planner_term_t *term;
+    uint64_t *hashes = NULL, hash;
+    uint32_t count = 0, capacity = 0, slot, i;
+    size_t pos = 0;
+    int ret = 0;
+
+    if (!planner || !text) {
+        return -EINVAL;
+    }
+
+    while (hinata_planner_next_term(text, SIZE_MAX, &pos, &hash)) {
+        ret = hinata_vec_reserve((void **)&hashes, &capacity, count + 1, sizeof(*hashes));
+        if (ret < 0) {
+            free(hashes);
+            return ret;
+        }
+        hashes[count++] = hash;
+    }
+    if (count > 1) {
+        qsort(hashes, count, sizeof(*hashes), hinata_planner_hash_cmp);
+    }
+
+    for (i = 0; !ret && i < count; i++) {
+        if (i && hashes[i] == hashes[i - 1]) {
+            continue;
+        }
+
+        if (delta < 0) {
+            term = (hinata_planner_term_t *)hinata_planner_find_term(planner, hashes[i]);
+            if (term && term->docs) {
+                term->docs--;
+            }
+            continue;
+        }
+
+        ret = hinata_planner_grow_slots(planner);
+        if (ret < 0) {
+            break;
+        }
+        slot = hinata_planner_term_slot(planner, hashes[i]);
+        if (!planner->term_slots[slot]) {
+            ret = hinata_vec_reserve((void **)&planner->terms, &planner->term_capacity,
+                                     planner->term_count + 1, sizeof(*planner->terms));
+            if (ret < 0) {
+                break;
+            }
+            planner->terms[planner->term_count].hash = hashes[i];
+            planner->terms[planner->term_count].docs = 0;
+            planner->term_slots[slot] = ++planner->term_count;
+        }
+        planner->terms[planner->term_slots[slot] - 1].docs++;
+    }
+
+    // 中途失败时撤销已经登记的词项，保持统计一致
+    if (ret < 0) {
+        while (i-- > 0) {
+            if (i && hashes[i] == hashes[i - 1]) {
+                continue;
+            }
+            term = (hinata_planner_term_t *)hinata_planner_find_term(planner, hashes[i]);
+            if (term && term->docs) {
+                term->docs--;
+            }
+        }
+    } else if (delta > 0) {
+        planner->text_docs++;
+    } else if (planner->text_docs) {
+        planner->text_docs--;
+    }
+
+    free(hashes);
+    return ret;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_plan_costs_default(hinata_plan_costs_t *costs)
+{
+    if (!costs) {
+        return;
+    }
+
+    costs->bitmap_row = 0.02;
+    costs->posting = 1.0;
+    costs->probe = 0.5;
+    costs->verify = 25.0;
+    costs->timeline_row = 0.5;
+    costs->sort_row = 0.3;
+}
+
+void hinata_query_planner_init(hinata_query_planner_t *planner,
+                               const hinata_filter_index_t *index,
+                               const hinata_timeline_t *timeline)
+{
+    if (!planner) {
+        return;
+    }
+
+    memset(planner, 0, sizeof(*planner));
+    planner->index = index;
+    planner->timeline = timeline;
+    hinata_plan_costs_default(&planner->costs);
+}
+
+void hinata_query_planner_free(hinata_query_planner_t *planner)
+{
+    if (!planner) {
+        return;
+    }
+
+    free(planner->tag_counts);
+    free(planner->buckets);
+    free(planner->terms);
+    free(planner->term_slots);
+    memset(planner, 0, sizeof(*planner));
+}
+
+int hinata_query_planner_add_text(hinata_query_planner_t *planner, const char *text)
+{
+    return hinata_planner_count_text(planner, text, 1);
+}
+
+int hinata_query_planner_remove_text(hinata_query_planner_t *planner, const char *text)
+{
+    return hinata_planner_count_text(planner, text, -1);
+}
+
+uint32_t hinata_query_planner_term_docs(const hinata_query_planner_t *planner, const char *term)
+{
+    const hinata_planner_term_t *entry;
+    uint64_t hash;
+    size_t pos = 0;
+
+    if (!planner || !term || !hinata_planner_next_term(term, SIZE_MAX, &pos, &hash)) {
+        return 0;
+    }
+
+    entry = hinata_planner_find_term(planner, hash);
+    return entry ? entry->docs : 0;
+}
+
+// ============================================================================
+// 过滤索引统计
+// ============================================================================
+
+/**
+ * 索引版本变化后重建快照
+ */
+static int hinata_planner_refresh(hinata_query_planner_t *planner)
+{
+    const hinata_filter_index_t *index = planner->index;
+    uint64_t before = 0;
+    uint32_t i;
+    int ret;
+
+    if (planner->stats_valid && planner->stats_version == index->version) {
+        return 0;
+    }
+
+    ret = hinata_vec_reserve((void **)&planner->tag_counts, &planner->tag_capacity,
+                             index->tags.count, sizeof(*planner->tag_counts));
+    if (!ret) {
+        ret = hinata_vec_reserve((void **)&planner->buckets, &planner->bucket_capacity,
+                                 index->bucket_count, sizeof(*planner->buckets));
+    }
+    if (ret < 0) {
+        planner->stats_valid = false;
+        return ret;
+    }
+
+    planner->doc_count = index->live_count;
+    planner->tag_count = index->tags.count;
+    for (i = 0; i < planner->tag_count; i++) {
+        planner->tag_counts[i] = i < index->tag_docs_capacity ?
+                                 (uint32_t)hinata_bitmap_cardinality(&index->tag_docs[i]) : 0;
+    }
+    for (i = 0; i < 4; i++) {
+        planner->access_counts[i] = (uint32_t)hinata_bitmap_cardinality(&index->access[i]);
+    }
+    for (i = 0; i < 7; i++) {
+        planner->format_counts[i] = (uint32_t)hinata_bitmap_cardinality(&index->formats[i]);
+    }
+    planner->attachment_count = (uint32_t)hinata_bitmap_cardinality(&index->attachments);
+
+    planner->bucket_count = index->bucket_count;
+    for (i = 0; i < index->bucket_count; i++) {
+        planner->buckets[i].bucket = index->buckets[i].bucket;
+        planner->buckets[i].count = (uint32_t)hinata_bitmap_cardinality(&index->buckets[i].docs);
+        planner->buckets[i].before = before;
+        before += planner->buckets[i].count;
+    }
+
+    planner->stats_valid = true;
+    planner->stats_version = index->version;
+    return 0;
+}
+
+static int64_t hinata_planner_bucket_of(hinata_timestamp_t width, hinata_timestamp_t ts)
+{
+    int64_t bucket = ts / width;
+
+    if (ts % width < 0) {
+        bucket--;
+    }
+
+    return bucket;
+}
+
+static uint32_t hinata_planner_bucket_lower_bound(const hinata_query_planner_t *planner,
+                                                  int64_t bucket)
+{
+    uint32_t left = 0, right = planner->bucket_count, mid;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (planner->buckets[mid].bucket < bucket) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+/**
+ * 前 pos 个桶的文档数
+ */
+static double hinata_planner_bucket_prefix(const hinata_query_planner_t *planner, uint32_t pos)
+{
+    const hinata_planner_bucket_t *last;
+
+    if (pos < planner->bucket_count) {
+        return (double)planner->buckets[pos].before;
+    }
+    if (!planner->bucket_count) {
+        return 0;
+    }
+
+    last = &planner->buckets[planner->bucket_count - 1];
+    return (double)(last->before + last->count);
+}
+
+/**
+ * 日期范围内的文档数：时间线给出精确值；否则整桶求和，边界桶按范围覆盖的比例计入
+ */
+static double hinata_planner_date_rows(const hinata_query_planner_t *planner,
+                                       const hinata_date_range_t *range)
+{
+    hinata_timestamp_t width = planner->index->bucket_width;
+    const hinata_planner_bucket_t *bucket;
+    int64_t first = INT64_MIN, last = INT64_MAX;
+    uint32_t lo = 0, hi = planner->bucket_count;
+    double rows;
+
+    if (planner->timeline) {
+        rows = hinata_timeline_count(planner->timeline, range);
+        return rows < planner->doc_count ? rows : planner->doc_count;
+    }
+
+    if (range->has_start) {
+        first = hinata_planner_bucket_of(width, range->start);
+        lo = hinata_planner_bucket_lower_bound(planner, first);
+    }
+    if (range->has_end) {
+        last = hinata_planner_bucket_of(width, range->end);
+        hi = hinata_planner_bucket_lower_bound(planner, last + 1);
+    }
+    if (lo >= hi) {
+        return 0;
+    }
+
+    rows = hinata_planner_bucket_prefix(planner, hi) - hinata_planner_bucket_prefix(planner, lo);
+
+    bucket = &planner->buckets[lo];
+    if (range->has_start && bucket->bucket == first) {
+        rows -= bucket->count * (double)(range->start - first * width) / (double)width;
+    }
+    bucket = &planner->buckets[hi - 1];
+    if (range->has_end && bucket->bucket == last) {
+        rows -= bucket->count * (double)((last + 1) * width - 1 - range->end) / (double)width;
+    }
+
+    return rows > 0 ? rows : 0;
+}
+
+// ============================================================================
+// 估计
+// ============================================================================
+
+static void hinata_planner_predicate(hinata_query_plan_t *plan, hinata_predicate_kind_t kind,
+                                     double rows, double docs)
+{
+    hinata_plan_predicate_t *predicate = &plan->predicates[plan->predicate_count++];
+
+    if (rows > docs) {
+        rows = docs;
+    }
+
+    predicate->kind = (uint8_t)kind;
+    predicate->estimated_rows = rows;
+    predicate->selectivity = docs > 0 ? rows / docs : 0;
+    predicate->actual_rows = 0;
+    predicate->has_actual = false;
+}
+
+/**
+ * 过滤条件：同一字段内为并集（标签按独立估计，访问级别和格式互斥），字段之间相互独立；
+ * 规范化后相同的标签只计一次
+ */
+static void hinata_planner_estimate_filters(const hinata_query_planner_t *planner,
+                                            const hinata_search_filters_t *filters,
+                                            hinata_query_plan_t *plan,
+                                            hinata_planner_estimate_t *est)
+{
+    const hinata_bitmap_t *users;
+    uint32_t seen[HINATA_MAX_TAGS];
+    double rows, miss;
+    uint32_t mask, count, seen_count, tag, i, j;
+
+    if (filters->has_user_id) {
+        users = hinata_filter_index_user_docs(planner->index, filters->user_id);
+        rows = users ? (double)hinata_bitmap_cardinality(users) : 0;
+        hinata_planner_predicate(plan, HINATA_PREDICATE_USER, rows, est->docs);
+        est->bitmap_rows += rows;
+    }
+    if (filters->has_attachments) {
+        rows = planner->attachment_count;
+        hinata_planner_predicate(plan, HINATA_PREDICATE_ATTACHMENTS, rows, est->docs);
+        est->bitmap_rows += rows;
+    }
+
+    if (filters->tag_count) {
+        count = filters->tag_count < HINATA_MAX_TAGS ? filters->tag_count : HINATA_MAX_TAGS;
+        miss = 1;
+        rows = 0;
+        seen_count = 0;
+        for (i = 0; i < count; i++) {
+            if (hinata_tag_dict_find(&planner->index->tags, filters->tags[i], &tag) < 0 ||
+                tag >= planner->tag_count || est->docs <= 0) {
+                continue;
+            }
+            for (j = 0; j < seen_count && seen[j] != tag; j++) {
+            }
+            if (j < seen_count) {
+                continue;
+            }
+            seen[seen_count++] = tag;
+            miss *= 1 - planner->tag_counts[tag] / est->docs;
+            rows += planner->tag_counts[tag];
+        }
+        hinata_planner_predicate(plan, HINATA_PREDICATE_TAGS, (1 - miss) * est->docs, est->docs);
+        est->bitmap_rows += rows;
+    }
+
+    if (filters->access_level_count) {
+        count = filters->access_level_count < 4 ? filters->access_level_count : 4;
+        for (i = 0, mask = 0, rows = 0; i < count; i++) {
+            if ((uint32_t)filters->access_levels[i] < 4 &&
+                !(mask & (1u << filters->access_levels[i]))) {
+                mask |= 1u << filters->access_levels[i];
+                rows += planner->access_counts[filters->access_levels[i]];
+            }
+        }
+        hinata_planner_predicate(plan, HINATA_PREDICATE_ACCESS, rows, est->docs);
+        est->bitmap_rows += rows;
+    }
+
+    if (filters->content_format_count) {
+        count = filters->content_format_count < 7 ? filters->content_format_count : 7;
+        for (i = 0, mask = 0, rows = 0; i < count; i++) {
+            if ((uint32_t)filters->content_formats[i] < 7 &&
+                !(mask & (1u << filters->content_formats[i]))) {
+                mask |= 1u << filters->content_formats[i];
+                rows += planner->format_counts[filters->content_formats[i]];
+            }
+        }
+        hinata_planner_predicate(plan, HINATA_PREDICATE_FORMATS, rows, est->docs);
+        est->bitmap_rows += rows;
+    }
+
+    for (i = 0; i < plan->predicate_count; i++) {
+        est->filter_no_date *= plan->predicates[i].selectivity;
+    }
+    est->filter_count = plan->predicate_count;
+    est->filter = est->filter_no_date;
+
+    if (filters->date_range.has_start || filters->date_range.has_end) {
+        est->date_rows = hinata_planner_date_rows(planner, &filters->date_range);
+        hinata_planner_predicate(plan, HINATA_PREDICATE_DATE, est->date_rows, est->docs);
+        est->filter *= plan->predicates[plan->predicate_count - 1].selectivity;
+        est->bitmap_rows += est->date_rows;
+        est->filter_count++;
+        est->date = true;
+    }
+}
+
+/**
+ * 文本：词项之间为"全部匹配"，按独立估计；倒排表求交的输出不超过最罕见的词项
+ */
+static void hinata_planner_estimate_text(const hinata_query_planner_t *planner,
+                                         const hinata_search_query_t *query,
+                                         hinata_query_plan_t *plan,
+                                         hinata_planner_estimate_t *est)
+{
+    const hinata_planner_term_t *term;
+    uint64_t hashes[HINATA_PLAN_MAX_TERMS], hash;
+    double docs, min_docs = -1;
+    uint32_t count = 0, i;
+    size_t pos = 0;
+
+    while (count < HINATA_PLAN_MAX_TERMS &&
+           hinata_planner_next_term(query->query, sizeof(query->query), &pos, &hash)) {
+        for (i = 0; i < count && hashes[i] != hash; i++) {
+        }
+        if (i == count) {
+            hashes[count++] = hash;
+        }
+    }
+    if (!count) {
+        return;
+    }
+
+    est->text = true;
+    est->text_indexed = planner->text_docs > 0;
+    if (!est->text_indexed) {
+        est->text_sel = HINATA_PLANNER_TEXT_SELECTIVITY;
+        hinata_planner_predicate(plan, HINATA_PREDICATE_TEXT, est->docs * est->text_sel, est->docs);
+        return;
+    }
+
+    est->text_sel = 1;
+    for (i = 0; i < count; i++) {
+        term = hinata_planner_find_term(planner, hashes[i]);
+        docs = term ? term->docs : 0;
+        est->text_sel *= docs / planner->text_docs;
+        est->posting_rows += docs;
+        if (min_docs < 0 || docs < min_docs) {
+            min_docs = docs;
+        }
+    }
+    if (est->text_sel > 1) {
+        est->text_sel = 1;
+    }
+
+    est->postings_out = est->docs * est->text_sel;
+    if (est->postings_out > min_docs) {
+        est->postings_out = min_docs;
+    }
+    hinata_planner_predicate(plan, HINATA_PREDICATE_TEXT, est->postings_out, est->docs);
+}
+
+// ============================================================================
+// 规划
+// ============================================================================
+
+static void hinata_plan_step(hinata_query_plan_t *plan, hinata_plan_step_kind_t kind,
+                             double input, double output, double cost)
+{
+    hinata_plan_step_t *step = &plan->steps[plan->step_count++];
+
+    step->kind = (uint8_t)kind;
+    step->input_rows = input;
+    step->estimated_rows = output;
+    step->cost = cost;
+    step->actual_rows = 0;
+    step->has_actual = false;
+    plan->cost += cost;
+}
+
+/**
+ * 候选集合的 top-k 排序和分页，查询不排序或候选已有序时不计排序
+ */
+static void hinata_plan_finish(const hinata_query_planner_t *planner,
+                               const hinata_planner_estimate_t *est, hinata_query_plan_t *plan,
+                               double rows, bool sorted)
+{
+    double keep = est->need > 0 && est->need < rows ? est->need : rows;
+    double page;
+
+    if (est->sort && !sorted && rows > 0) {
+        hinata_plan_step(plan, HINATA_PLAN_STEP_SORT, rows, keep,
+                         planner->costs.sort_row * rows * log2(keep > 2 ? keep : 2));
+    }
+
+    page = keep > est->skip ? keep - est->skip : 0;
+    if (est->limit && page > est->limit) {
+        page = est->limit;
+    }
+    hinata_plan_step(plan, HINATA_PLAN_STEP_PAGE, keep, page, 0);
+}
+
+static void hinata_plan_filter_first(const hinata_query_planner_t *planner,
+                                     const hinata_planner_estimate_t *est,
+                                     hinata_query_plan_t *plan)
+{
+    const hinata_plan_costs_t *costs = &planner->costs;
+    double rows = est->docs * est->filter;
+
+    hinata_plan_step(plan, HINATA_PLAN_STEP_BITMAP,
+                     est->filter_count ? est->bitmap_rows : est->docs, rows,
+                     costs->bitmap_row * (est->filter_count ? est->bitmap_rows : est->docs));
+    if (est->text) {
+        hinata_plan_step(plan, HINATA_PLAN_STEP_VERIFY, rows, rows * est->text_sel,
+                         costs->verify * rows);
+        rows *= est->text_sel;
+    }
+
+    hinata_plan_finish(planner, est, plan, rows, false);
+}
+
+static void hinata_plan_text_first(const hinata_query_planner_t *planner,
+                                   const hinata_planner_estimate_t *est,
+                                   hinata_query_plan_t *plan)
+{
+    const hinata_plan_costs_t *costs = &planner->costs;
+    double rows = est->postings_out;
+
+    hinata_plan_step(plan, HINATA_PLAN_STEP_POSTINGS, est->posting_rows, rows,
+                     costs->posting * est->posting_rows);
+    if (est->filter_count) {
+        hinata_plan_step(plan, HINATA_PLAN_STEP_PROBE, rows, rows * est->filter,
+                         costs->probe * est->filter_count * rows);
+        rows *= est->filter;
+    }
+
+    hinata_plan_finish(planner, est, plan, rows, false);
+}
+
+/**
+ * 时间线按排序方向扫描，匹配密度为 filter_no_date * text_sel，凑够 need 个即停止
+ */
+static void hinata_plan_time_first(const hinata_query_planner_t *planner,
+                                   const hinata_planner_estimate_t *est,
+                                   hinata_query_plan_t *plan)
+{
+    const hinata_plan_costs_t *costs = &planner->costs;
+    double density = est->filter_no_date * (est->text ? est->text_sel : 1);
+    double scanned = est->date_rows;
+    double rows;
+    uint32_t probes = est->filter_count - (est->date ? 1 : 0);
+
+    if (est->need > 0 && density > 0 && est->need < est->date_rows * density) {
+        scanned = est->need / density;
+    }
+
+    hinata_plan_step(plan, HINATA_PLAN_STEP_TIMELINE, est->date_rows, scanned,
+                     costs->timeline_row * scanned);
+    rows = scanned;
+    if (probes) {
+        hinata_plan_step(plan, HINATA_PLAN_STEP_PROBE, rows, rows * est->filter_no_date,
+                         costs->probe * probes * rows);
+        rows *= est->filter_no_date;
+    }
+    if (est->text) {
+        hinata_plan_step(plan, HINATA_PLAN_STEP_VERIFY, rows, rows * est->text_sel,
+                         costs->verify * rows);
+        rows *= est->text_sel;
+    }
+
+    hinata_plan_finish(planner, est, plan, rows, true);
+}
+
+int hinata_query_planner_plan(hinata_query_planner_t *planner, const hinata_search_query_t *query,
+                              hinata_query_plan_t *plan)
+{
+    hinata_planner_estimate_t est;
+    hinata_query_plan_t candidate;
+    bool chosen = false;
+    uint32_t kind;
+    int ret;
+
+    if (!planner || !planner->index || !query || !plan) {
+        return -EINVAL;
+    }
+
+    ret = hinata_planner_refresh(planner);
+    if (ret < 0) {
+        return ret;
+    }
+
+    memset(plan, 0, sizeof(*plan));
+    memset(&est, 0, sizeof(est));
+    est.docs = planner->doc_count;
+    est.filter = 1;
+    est.filter_no_date = 1;
+    est.date_rows = est.docs;
+    est.skip = hinata_pagination_skip(&query->pagination);
+    est.limit = query->pagination.limit;
+    est.sort = query->has_sort;
+    est.need = est.limit ? (double)est.skip + est.limit : 0;
+
+    if (query->has_filters) {
+        hinata_planner_estimate_filters(planner, &query->filters, plan, &est);
+    }
+    hinata_planner_estimate_text(planner, query, plan, &est);
+
+    plan->doc_count = planner->doc_count;
+    plan->estimated_rows = est.docs * est.filter * (est.text ? est.text_sel : 1);
+    plan->applicable[HINATA_PLAN_FILTER_FIRST] = true;
+    plan->applicable[HINATA_PLAN_TEXT_FIRST] = est.text && est.text_indexed;
+    plan->applicable[HINATA_PLAN_TIME_FIRST] = planner->timeline && query->has_sort &&
+                                               query->sort.field == HINATA_SORT_CREATED_AT;
+
+    for (kind = 0; kind < HINATA_PLAN_KIND_COUNT; kind++) {
+        if (!plan->applicable[kind]) {
+            continue;
+        }
+
+        candidate = *plan;
+        candidate.kind = (hinata_plan_kind_t)kind;
+        candidate.cost = 0;
+        candidate.step_count = 0;
+        if (kind == HINATA_PLAN_FILTER_FIRST) {
+            hinata_plan_filter_first(planner, &est, &candidate);
+        } else if (kind == HINATA_PLAN_TEXT_FIRST) {
+            hinata_plan_text_first(planner, &est, &candidate);
+        } else {
+            hinata_plan_time_first(planner, &est, &candidate);
+        }
+
+        plan->costs[kind] = candidate.cost;
+        if (!chosen || candidate.cost < plan->cost) {
+            memcpy(plan->steps, candidate.steps, sizeof(plan->steps));
+            plan->step_count = candidate.step_count;
+            plan->kind = candidate.kind;
+            plan->cost = candidate.cost;
+            chosen = true;
+        }
+    }
+
+    return 0;
+}
+
+// ============================================================================
+// 实际行数
+// ============================================================================
+
+/**
+ * 只保留一个过滤条件的副本
+ */
+static void hinata_planner_single_filter(const hinata_search_filters_t *filters,
+                                         hinata_predicate_kind_t kind,
+                                         hinata_search_filters_t *single)
+{
+    memset(single, 0, sizeof(*single));
+
+    switch (kind) {
+    case HINATA_PREDICATE_USER:
+        memcpy(single->user_id, filters->user_id, sizeof(single->user_id));
+        single->has_user_id = true;
+        break;
+    case HINATA_PREDICATE_ATTACHMENTS:
+        single->has_attachments = true;
+        break;
+    case HINATA_PREDICATE_TAGS:
+        memcpy(single->tags, filters->tags, sizeof(single->tags));
+        single->tag_count = filters->tag_count;
+        break;
+    case HINATA_PREDICATE_ACCESS:
+        memcpy(single->access_levels, filters->access_levels, sizeof(single->access_levels));
+        single->access_level_count = filters->access_level_count;
+        break;
+    case HINATA_PREDICATE_FORMATS:
+        memcpy(single->content_formats, filters->content_formats,
+               sizeof(single->content_formats));
+        single->content_format_count = filters->content_format_count;
+        break;
+    case HINATA_PREDICATE_DATE:
+        single->date_range = filters->date_range;
+        break;
+    default:
+        break;
+    }
+}
+
+int hinata_query_planner_analyze(const hinata_query_planner_t *planner,
+                                 const hinata_search_query_t *query, hinata_query_plan_t *plan)
+{
+    hinata_search_filters_t single;
+    hinata_plan_predicate_t *predicate;
+    hinata_bitmap_t docs;
+    uint32_t i;
+    int ret = 0;
+
+    if (!planner || !planner->index || !query || !plan) {
+        return -EINVAL;
+    }
+
+    hinata_bitmap_init(&docs);
+    for (i = 0; !ret && query->has_filters && i < plan->predicate_count; i++) {
+        predicate = &plan->predicates[i];
+        if (predicate->kind == HINATA_PREDICATE_TEXT) {
+            continue;
+        }
+
+        hinata_planner_single_filter(&query->filters, (hinata_predicate_kind_t)predicate->kind,
+                                     &single);
+        ret = hinata_filter_index_evaluate(planner->index, &single, &docs);
+        if (!ret) {
+            predicate->actual_rows = hinata_bitmap_cardinality(&docs);
+            predicate->has_actual = true;
+        }
+    }
+
+    if (!ret && plan->kind == HINATA_PLAN_FILTER_FIRST) {
+        ret = hinata_filter_index_evaluate(planner->index,
+                                           query->has_filters ? &query->filters : NULL, &docs);
+        if (!ret) {
+            ret = hinata_query_plan_record_step(plan, HINATA_PLAN_STEP_BITMAP,
+                                                hinata_bitmap_cardinality(&docs));
+        }
+    }
+
+    hinata_bitmap_free(&docs);
+    return ret;
+}
+
+int hinata_query_plan_record_step(hinata_query_plan_t *plan, hinata_plan_step_kind_t kind,
+                                  uint64_t actual_rows)
+{
+    uint32_t i;
+
+    if (!plan) {
+        return -EINVAL;
+    }
+
+    for (i = 0; i < plan->step_count; i++) {
+        if (plan->steps[i].kind == (uint8_t)kind) {
+            plan->steps[i].actual_rows = actual_rows;
+            plan->steps[i].has_actual = true;
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+int hinata_query_plan_record_predicate(hinata_query_plan_t *plan, hinata_predicate_kind_t kind,
+                                       uint64_t actual_rows)
+{
+    uint32_t i;
+
+    if (!plan) {
+        return -EINVAL;
+    }
+
+    for (i = 0; i < plan->predicate_count; i++) {
+        if (plan->predicates[i].kind == (uint8_t)kind) {
+            plan->predicates[i].actual_rows = actual_rows;
+            plan->predicates[i].has_actual = true;
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+// ============================================================================
+// 说明
+// ============================================================================
+
+static const char *const hinata_plan_kind_names[HINATA_PLAN_KIND_COUNT] = {
+    "filter-first", "text-first", "time-first"
+};
+
+static const char *const hinata_plan_step_names[] = {
+    "bitmap", "postings", "timeline", "probe", "verify", "sort", "page"
+};
+
+static const char *const hinata_predicate_names[HINATA_PREDICATE_COUNT] = {
+    "user", "attachments", "tags", "access", "formats", "date", "text"
+};
+
+const char *hinata_plan_kind_name(hinata_plan_kind_t kind)
+{
+    return (uint32_t)kind < HINATA_PLAN_KIND_COUNT ? hinata_plan_kind_names[kind] : "unknown";
+}
+
+const char *hinata_plan_step_name(hinata_plan_step_kind_t kind)
+{
+    return (uint32_t)kind < HINATA_ARRAY_LEN(hinata_plan_step_names) ?
+           hinata_plan_step_names[kind] : "unknown";
+}
+
+const char *hinata_predicate_name(hinata_predicate_kind_t kind)
+{
+    return (uint32_t)kind < HINATA_PREDICATE_COUNT ? hinata_predicate_names[kind] : "unknown";
+}
+
+/**
+ * 追加格式化文本，pos 记录完整输出所需的长度
+ */
+static void hinata_plan_append(char *buf, size_t size, size_t *pos, const char *fmt, ...)
+{
+    va_list args;
+    int n;
+
+    va_start(args, fmt);
+    n = vsnprintf(*pos < size ? buf + *pos : NULL, *pos < size ? size - *pos : 0, fmt, args);
+    va_end(args);
+
+    if (n > 0) {
+        *pos += (size_t)n;
+    }
+}
+
+static void hinata_plan_append_actual(char *buf, size_t size, size_t *pos, bool has_actual,
+                                      uint64_t actual_rows)
+{
+    if (has_actual) {
+        hinata_plan_append(buf, size, pos, " actual=%llu", (unsigned long long)actual_rows);
+    }
+}
+
+int hinata_query_plan_explain(const hinata_query_plan_t *plan, char *buf, size_t size)
+{
+    const hinata_plan_predicate_t *predicate;
+    const hinata_plan_step_t *step;
+    size_t pos = 0;
+    uint32_t i;
+
+    if (!plan || (size && !buf)) {
+        return -EINVAL;
+    }
+
+    hinata_plan_append(buf, size, &pos, "plan %s cost=%.1f rows=%.1f docs=%u\n",
+                       hinata_plan_kind_name(plan->kind), plan->cost, plan->estimated_rows,
+                       plan->doc_count);
+
+    hinata_plan_append(buf, size, &pos, "  alternatives:");
+    for (i = 0; i < HINATA_PLAN_KIND_COUNT; i++) {
+        if (plan->applicable[i]) {
+            hinata_plan_append(buf, size, &pos, " %s=%.1f", hinata_plan_kind_names[i],
+                               plan->costs[i]);
+        } else {
+            hinata_plan_append(buf, size, &pos, " %s=n/a", hinata_plan_kind_names[i]);
+        }
+    }
+    hinata_plan_append(buf, size, &pos, "\n");
+
+    for (i = 0; i < plan->predicate_count; i++) {
+        predicate = &plan->predicates[i];
+        hinata_plan_append(buf, size, &pos, "  predicate %-11s sel=%.4f est=%.1f",
+                           hinata_predicate_name((hinata_predicate_kind_t)predicate->kind),
+                           predicate->selectivity, predicate->estimated_rows);
+        hinata_plan_append_actual(buf, size, &pos, predicate->has_actual, predicate->actual_rows);
+        hinata_plan_append(buf, size, &pos, "\n");
+    }
+
+    for (i = 0; i < plan->step_count; i++) {
+        step = &plan->steps[i];
+        hinata_plan_append(buf, size, &pos, "  step %-9s in=%.1f est=%.1f cost=%.1f",
+                           hinata_plan_step_name((hinata_plan_step_kind_t)step->kind),
+                           step->input_rows, step->estimated_rows, step->cost);
+        hinata_plan_append_actual(buf, size, &pos, step->has_actual, step->actual_rows);
+        hinata_plan_append(buf, size, &pos, "\n");
+    }
+
+    return pos < size ? 0 : -ENOSPC;
+}
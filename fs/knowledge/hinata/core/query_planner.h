@@ -0,0 +1,249 @@
+/**
+ * HiNATA 查询计划 - C 语言定义
+ *
+ * hinata_search_query_t 同时包含全文、多种过滤条件、排序和分页，
+ * 执行顺序的代价取决于各条件的选择性。计划器比较三种执行方式：
+ *
+ *   过滤优先  位图求出过滤结果，再逐个验证文本，适合过滤条件很有选择性
+ *   文本优先  倒排表求交得到文本候选，再逐个检查过滤条件，适合包含罕见词项
+ *   时间优先  按创建时间顺序扫描时间线，逐个检查，凑够一页即停止，
+ *             适合按 created_at 排序且条件宽松的查询（不计算精确总数）
+ *
+ * 统计信息：
+ *   标签频率、访问级别/内容格式/附件计数和时间桶计数来自过滤索引，
+ *   在索引版本变化后的第一次规划时重建快照；用户计数按需从位图读取；
+ *   日期范围有时间线时用其精确计数，否则用桶计数的前缀和、边界桶按比例估计；
+ *   词项的文档频率由调用方在全文索引写入时同步登记（与全文索引的分词一致）。
+ *
+ * 条件之间按相互独立估计。explain 输出每个条件和每个步骤的估计行数，
+ * analyze 用过滤索引求出各过滤条件的实际行数，文本和执行步骤的实际行数
+ * 由执行方记录，两者对照即可调整代价常数。
+ *
+ * 计划器不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_QUERY_PLANNER_H
+#define _HINATA_QUERY_PLANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "filter_index.h"
+#include "timeline.h"
+
+#define HINATA_PLAN_KIND_COUNT 3
+#define HINATA_PLAN_MAX_STEPS 5
+#define HINATA_PLAN_MAX_TERMS 32
+
+// ============================================================================
+// 计划结构
+// ============================================================================
+
+/**
+ * 执行方式
+ */
+typedef enum {
+    HINATA_PLAN_FILTER_FIRST = 0,
+    HINATA_PLAN_TEXT_FIRST = 1,
+    HINATA_PLAN_TIME_FIRST = 2
+} hinata_plan_kind_t;
+
+/**
+ * 执行步骤
+ */
+typedef enum {
+    HINATA_PLAN_STEP_BITMAP = 0,        // 过滤条件的位图求值
+    HINATA_PLAN_STEP_POSTINGS = 1,      // 词项倒排表求交
+    HINATA_PLAN_STEP_TIMELINE = 2,      // 按时间顺序扫描时间线
+    HINATA_PLAN_STEP_PROBE = 3,         // 逐个检查过滤条件
+    HINATA_PLAN_STEP_VERIFY = 4,        // 逐个验证文本
+    HINATA_PLAN_STEP_SORT = 5,          // top-k 排序
+    HINATA_PLAN_STEP_PAGE = 6           // 分页
+} hinata_plan_step_kind_t;
+
+/**
+ * 查询条件
+ */
+typedef enum {
+    HINATA_PREDICATE_USER = 0,
+    HINATA_PREDICATE_ATTACHMENTS = 1,
+    HINATA_PREDICATE_TAGS = 2,
+    HINATA_PREDICATE_ACCESS = 3,
+    HINATA_PREDICATE_FORMATS = 4,
+    HINATA_PREDICATE_DATE = 5,
+    HINATA_PREDICATE_TEXT = 6
+} hinata_predicate_kind_t;
+
+#define HINATA_PREDICATE_COUNT 7
+
+/**
+ * 单个步骤：input_rows 为输入行数，estimated_rows / actual_rows 为输出行数
+ */
+typedef struct {
+    uint8_t kind;
+    double input_rows;
+    double estimated_rows;
+    double cost;
+    uint64_t actual_rows;
+    bool has_actual;
+} hinata_plan_step_t;
+
+/**
+ * 单个条件：单独作用于全部文档时的行数
+ */
+typedef struct {
+    uint8_t kind;
+    double selectivity;
+    double estimated_rows;
+    uint64_t actual_rows;
+    bool has_actual;
+} hinata_plan_predicate_t;
+
+/**
+ * 查询计划
+ */
+typedef struct {
+    hinata_plan_kind_t kind;
+    double cost;
+    double estimated_rows;      // 满足全部条件的文档数
+    uint32_t doc_count;
+
+    // 所有方式的代价，用于 explain 比较
+    double costs[HINATA_PLAN_KIND_COUNT];
+    bool applicable[HINATA_PLAN_KIND_COUNT];
+
+    hinata_plan_step_t steps[HINATA_PLAN_MAX_STEPS];
+    uint32_t step_count;
+    hinata_plan_predicate_t predicates[HINATA_PREDICATE_COUNT];
+    uint32_t predicate_count;
+} hinata_query_plan_t;
+
+/**
+ * 代价常数，单位为读取一个倒排表项的代价
+ */
+typedef struct {
+    double bitmap_row;          // 位图运算中的每个文档
+    double posting;             // 每个倒排表项
+    double probe;               // 对单个候选检查一个过滤条件
+    double verify;              // 对单个候选验证文本
+    double timeline_row;        // 读取一个时间线条目
+    double sort_row;            // top-k 堆的每次比较
+} hinata_plan_costs_t;
+
+// ============================================================================
+// 计划器
+// ============================================================================
+
+/**
+ * 时间桶计数，before 为之前所有桶的文档数
+ */
+typedef struct {
+    int64_t bucket;
+    uint32_t count;
+    uint64_t before;
+} hinata_planner_bucket_t;
+
+/**
+ * 词项的文档频率，按 64 位哈希区分；频率降为 0 的词项保留
+ */
+typedef struct {
+    uint64_t hash;
+    uint32_t docs;
+} hinata_planner_term_t;
+
+/**
+ * 查询计划器
+ */
+typedef struct {
+    const hinata_filter_index_t *index;
+    const hinata_timeline_t *timeline;  // 可为 NULL；按 created_at 索引同一批文档
+    hinata_plan_costs_t costs;
+
+    // 过滤索引的统计快照
+    bool stats_valid;
+    uint64_t stats_version;
+    uint32_t doc_count;
+    uint32_t *tag_counts;               // 下标与标签字典一致
+    uint32_t tag_count;
+    uint32_t tag_capacity;
+    uint32_t access_counts[4];
+    uint32_t format_counts[7];
+    uint32_t attachment_count;
+    hinata_planner_bucket_t *buckets;
+    uint32_t bucket_count;
+    uint32_t bucket_capacity;
+
+    // 词项，哈希 -> 词项下标 + 1
+    hinata_planner_term_t *terms;
+    uint32_t term_count;
+    uint32_t term_capacity;
+    uint32_t *term_slots;
+    uint32_t term_slot_capacity;
+    uint32_t text_docs;                 // 已登记文本的文档数
+} hinata_query_planner_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放，timeline 可为 NULL（不考虑时间优先）
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_query_planner_init(hinata_query_planner_t *planner,
+                               const hinata_filter_index_t *index,
+                               const hinata_timeline_t *timeline);
+void hinata_query_planner_free(hinata_query_planner_t *planner);
+
+/**
+ * 默认代价常数
+ */
+void hinata_plan_costs_default(hinata_plan_costs_t *costs);
+
+/**
+ * 登记或撤销一个文档的文本，文档内重复的词项只计一次。
+ * 分词：ASCII 字母数字和非 ASCII 字节组成词项，ASCII 字母转小写
+ */
+int hinata_query_planner_add_text(hinata_query_planner_t *planner, const char *text);
+int hinata_query_planner_remove_text(hinata_query_planner_t *planner, const char *text);
+
+/**
+ * 词项的文档频率（按同样的规则规范化）
+ */
+uint32_t hinata_query_planner_term_docs(const hinata_query_planner_t *planner, const char *term);
+
+/**
+ * 为查询选择代价最低的执行方式
+ */
+int hinata_query_planner_plan(hinata_query_planner_t *planner, const hinata_search_query_t *query,
+                              hinata_query_plan_t *plan);
+
+/**
+ * 用过滤索引求出各过滤条件和位图步骤的实际行数，写入 plan
+ */
+int hinata_query_planner_analyze(const hinata_query_planner_t *planner,
+                                 const hinata_search_query_t *query, hinata_query_plan_t *plan);
+
+/**
+ * 执行方记录步骤或条件的实际行数，计划中没有对应项时返回 -ENOENT
+ */
+int hinata_query_plan_record_step(hinata_query_plan_t *plan, hinata_plan_step_kind_t kind,
+                                  uint64_t actual_rows);
+int hinata_query_plan_record_predicate(hinata_query_plan_t *plan, hinata_predicate_kind_t kind,
+                                       uint64_t actual_rows);
+
+/**
+ * 计划的文本说明，以 '\0' 结尾；缓冲区不足时截断并返回 -ENOSPC
+ */
+int hinata_query_plan_explain(const hinata_query_plan_t *plan, char *buf, size_t size);
+
+/**
+ * 执行方式、步骤和条件的名称
+ */
+const char *hinata_plan_kind_name(hinata_plan_kind_t kind);
+const char *hinata_plan_step_name(hinata_plan_step_kind_t kind);
+const char *hinata_predicate_name(hinata_predicate_kind_t kind);
+
+#endif /* _HINATA_QUERY_PLANNER_H */
@@ -0,0 +1,599 @@
+/**
+ * HiNATA 排序与分页 - C 语言实现
+ */
+
+#include "ranking.h"
+#include "compact_block.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_SORTED_MERGE_THRESHOLD 1024
+
+// 候选集合小于索引的 1/16 时改走有界堆
+#define HINATA_SORTED_SCAN_RATIO 16
+
+/**
+ * 有界堆选择时遍历候选集合的上下文
+ */
+typedef struct {
+    const hinata_sorted_index_t *index;
+    hinata_topk_t *topk;
+} hinata_sorted_visit_ctx_t;
+
+// ============================================================================
+// 排序键比较
+// ============================================================================
+
+int hinata_rank_key_cmp(const hinata_rank_key_t *a, const hinata_rank_key_t *b)
+{
+    if (a->value != b->value) {
+        return a->value < b->value ? -1 : 1;
+    }
+    if (a->doc != b->doc) {
+        return a->doc < b->doc ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * 按输出顺序比较，负数表示 a 排在前面
+ */
+static int hinata_rank_order(const hinata_rank_key_t *a, const hinata_rank_key_t *b,
+                             hinata_sort_direction_t direction)
+{
+    int cmp = hinata_rank_key_cmp(a, b);
+
+    return direction == HINATA_SORT_DESC ? -cmp : cmp;
+}
+
+static int hinata_rank_cmp_asc(const void *a, const void *b)
+{
+    return hinata_rank_key_cmp(a, b);
+}
+
+static int hinata_rank_cmp_desc(const void *a, const void *b)
+{
+    return hinata_rank_key_cmp(b, a);
+}
+
+static int hinata_sorted_entry_cmp(const void *a, const void *b)
+{
+    return hinata_rank_key_cmp(&((const hinata_sorted_entry_t *)a)->key,
+                               &((const hinata_sorted_entry_t *)b)->key);
+}
+
+// ============================================================================
+// 有界堆
+// ============================================================================
+
+int hinata_topk_init(hinata_topk_t *topk, uint32_t k, hinata_sort_direction_t direction,
+                     const hinata_rank_cursor_t *cursor)
+{
+    if (!topk) {
+        return -EINVAL;
+    }
+
+    memset(topk, 0, sizeof(*topk));
+    topk->k = k;
+    topk->direction = direction;
+    if (cursor) {
+        topk->cursor = *cursor;
+    }
+
+    if (k) {
+        topk->items = malloc((size_t)k * sizeof(*topk->items));
+        if (!topk->items) {
+            return -ENOMEM;
+        }
+    }
+
+    return 0;
+}
+
+void hinata_topk_free(hinata_topk_t *topk)
+{
+    if (!topk) {
+        return;
+    }
+
+    free(topk->items);
+    topk->items = NULL;
+    topk->count = 0;
+    topk->k = 0;
+}
+
+/**
+ * 堆顶为输出顺序中最后的元素
+ */
+static void hinata_topk_sift_down(hinata_topk_t *topk, uint32_t i)
+{
+    hinata_rank_key_t item = topk->items[i];
+    uint32_t child;
+
+    for (;;) {
+        child = 2 * i + 1;
+        if (child >= topk->count) {
+            break;
+        }
+        if (child + 1 < topk->count &&
+            hinata_rank_order(&topk->items[child + 1], &topk->items[child], topk->direction) > 0) {
+            child++;
+        }
+        if (hinata_rank_order(&topk->items[child], &item, topk->direction) <= 0) {
+            break;
+        }
+        topk->items[i] = topk->items[child];
+        i = child;
+    }
+
+    topk->items[i] = item;
+}
+
+void hinata_topk_push(hinata_topk_t *topk, hinata_rank_key_t key)
+{
+    uint32_t i, parent;
+
+    if (!topk || topk->k == 0) {
+        return;
+    }
+    if (topk->cursor.valid && hinata_rank_order(&key, &topk->cursor.after, topk->direction) <= 0) {
+        return;
+    }
+
+    if (topk->count == topk->k) {
+        // 不比当前最后一个更靠前的键直接丢弃
+        if (hinata_rank_order(&key, &topk->items[0], topk->direction) >= 0) {
+            return;
+        }
+        topk->items[0] = key;
+        hinata_topk_sift_down(topk, 0);
+        return;
+    }
+
+    i = topk->count++;
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (hinata_rank_order(&topk->items[parent], &key, topk->direction) >= 0) {
+            break;
+        }
+        topk->items[i] = topk->items[parent];
+        i = parent;
+    }
+    topk->items[i] = key;
+}
+
+void hinata_topk_finish(hinata_topk_t *topk)
+{
+    if (!topk || topk->count < 2) {
+        return;
+    }
+
+    qsort(topk->items, topk->count, sizeof(*topk->items),
+          topk->direction == HINATA_SORT_DESC ? hinata_rank_cmp_desc : hinata_rank_cmp_asc);
+}
+
+/**
+ * 把有界堆的结果去掉前 skip 个后写入 out
+ */
+static void hinata_topk_emit(const hinata_topk_t *topk, uint32_t skip, uint32_t limit,
+                             hinata_rank_key_t *out, uint32_t *out_count)
+{
+    uint32_t n = 0;
+    uint32_t i;
+
+    for (i = skip; i < topk->count && n < limit; i++) {
+        out[n++] = topk->items[i];
+    }
+
+    *out_count = n;
+}
+
+int hinata_topk_select(const hinata_rank_key_t *keys, uint32_t count,
+                       hinata_sort_direction_t direction, const hinata_rank_cursor_t *cursor,
+                       uint32_t skip, uint32_t limit, hinata_rank_key_t *out, uint32_t *out_count)
+{
+    hinata_topk_t topk;
+    uint32_t i;
+    int ret;
+
+    if ((!keys && count) || (!out && limit) || !out_count || skip > UINT32_MAX - limit) {
+        return -EINVAL;
+    }
+
+    ret = hinata_topk_init(&topk, skip + limit < count ? skip + limit : count, direction, cursor);
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (i = 0; i < count; i++) {
+        hinata_topk_push(&topk, keys[i]);
+    }
+    hinata_topk_finish(&topk);
+    hinata_topk_emit(&topk, skip, limit, out, out_count);
+
+    hinata_topk_free(&topk);
+    return 0;
+}
+
+int hinata_rank_library_item_value(const hinata_library_item_t *item, hinata_sort_field_t field,
+                                   double *value)
+{
+    if (!item || !value) {
+        return -EINVAL;
+    }
+
+    switch (field) {
+    case HINATA_SORT_CREATED_AT:
+        *value = (double)item->created_at;
+        return 0;
+    case HINATA_SORT_UPDATED_AT:
+        *value = (double)item->updated_at;
+        return 0;
+    case HINATA_SORT_ACCESSED_AT:
+        *value = (double)item->last_accessed_at;
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
+int hinata_rank_packet_value(const hinata_data_packet_t *packet, hinata_sort_field_t field,
+                             double *value)
+{
+    if (!packet || !value) {
+        return -EINVAL;
+    }
+
+    switch (field) {
+    case HINATA_SORT_CREATED_AT:
+        *value = (double)packet->metadata.capture_timestamp;
+        return 0;
+    case HINATA_SORT_ATTENTION_SCORE:
+        *value = packet->metadata.attention_score_raw;
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
+uint32_t hinata_pagination_skip(const hinata_pagination_options_t *pagination)
+{
+    uint64_t skip;
+
+    if (!pagination) {
+        return 0;
+    }
+    if (pagination->offset || pagination->page <= 1) {
+        return pagination->offset;
+    }
+
+    // 页码过大时饱和，skip + limit 仍不溢出，结果为空页
+    skip = (uint64_t)(pagination->page - 1) * pagination->limit;
+    return skip > UINT32_MAX - pagination->limit ? UINT32_MAX - pagination->limit : (uint32_t)skip;
+}
+
+// ============================================================================
+// 预排序索引
+// ============================================================================
+
+void hinata_sorted_index_init(hinata_sorted_index_t *index)
+{
+    memset(index, 0, sizeof(*index));
+}
+
+void hinata_sorted_index_free(hinata_sorted_index_t *index)
+{
+    if (!index) {
+        return;
+    }
+
+    free(index->sorted);
+    free(index->pending);
+    free(index->seqs);
+    free(index->values);
+    hinata_sorted_index_init(index);
+}
+
+static bool hinata_sorted_entry_live(const hinata_sorted_index_t *index,
+                                     const hinata_sorted_entry_t *entry)
+{
+    return index->seqs[entry->key.doc] == entry->seq;
+}
+
+int hinata_sorted_index_merge(hinata_sorted_index_t *index)
+{
+    hinata_sorted_entry_t *merged;
+    uint32_t i = 0, j = 0, n = 0, p = 0;
+
+    if (!index) {
+        return -EINVAL;
+    }
+
+    merged = malloc((size_t)(index->live_count ? index->live_count : 1) * sizeof(*merged));
+    if (!merged) {
+        return -ENOMEM;
+    }
+
+    // 去掉过期的待合并条目后排序
+    for (i = 0; i < index->pending_count; i++) {
+        if (hinata_sorted_entry_live(index, &index->pending[i])) {
+            index->pending[p++] = index->pending[i];
+        }
+    }
+    qsort(index->pending, p, sizeof(*index->pending), hinata_sorted_entry_cmp);
+
+    i = 0;
+    while (i < index->sorted_count || j < p) {
+        if (i < index->sorted_count && !hinata_sorted_entry_live(index, &index->sorted[i])) {
+            i++;
+        } else if (j == p || (i < index->sorted_count &&
+                              hinata_rank_key_cmp(&index->sorted[i].key, &index->pending[j].key) < 0)) {
+            merged[n++] = index->sorted[i++];
+        } else {
+            merged[n++] = index->pending[j++];
+        }
+    }
+
+    free(index->sorted);
+    index->sorted = merged;
+    index->sorted_count = n;
+    index->sorted_capacity = index->live_count ? index->live_count : 1;
+    index->pending_count = 0;
+    index->stale_count = 0;
+    return 0;
+}
+
+/**
+ * 待合并条目或过期条目过多时合并
+ * 与关系图的增量日志一样按已排序规模放宽阈值
+ */
+static int hinata_sorted_index_maybe_merge(hinata_sorted_index_t *index)
+{
+    uint32_t threshold = index->sorted_count / 8;
+
+    if (threshold < HINATA_SORTED_MERGE_THRESHOLD) {
+        threshold = HINATA_SORTED_MERGE_THRESHOLD;
+    }
+    if (index->pending_count < threshold && index->stale_count < threshold * 4) {
+        return 0;
+    }
+
+    return hinata_sorted_index_merge(index);
+}
+
+static int hinata_sorted_index_reserve_doc(hinata_sorted_index_t *index, uint32_t doc)
+{
+    uint32_t old_capacity = index->seq_capacity;
+    uint32_t capacity = old_capacity;
+    double *values;
+    int ret;
+
+    if (doc < index->seq_capacity) {
+        return 0;
+    }
+    if (doc == UINT32_MAX) {
+        return -EOVERFLOW;
+    }
+
+    ret = hinata_vec_reserve((void **)&index->seqs, &capacity, doc + 1, sizeof(*index->seqs));
+    if (ret < 0) {
+        return ret;
+    }
+
+    values = realloc(index->values, (size_t)capacity * sizeof(*index->values));
+    if (!values) {
+        return -ENOMEM;
+    }
+
+    memset(index->seqs + old_capacity, 0, (size_t)(capacity - old_capacity) * sizeof(*index->seqs));
+    index->values = values;
+    index->seq_capacity = capacity;
+    return 0;
+}
+
+int hinata_sorted_index_set(hinata_sorted_index_t *index, uint32_t doc, double value)
+{
+    hinata_sorted_entry_t *entry;
+    int ret;
+
+    if (!index || value != value) {
+        return -EINVAL;
+    }
+
+    ret = hinata_sorted_index_reserve_doc(index, doc);
+    if (ret < 0) {
+        return ret;
+    }
+    if (index->seqs[doc] && index->values[doc] == value) {
+        return 0;
+    }
+
+    ret = hinata_vec_reserve((void **)&index->pending, &index->pending_capacity,
+                             index->pending_count + 1, sizeof(*index->pending));
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (index->seqs[doc]) {
+        index->stale_count++;
+    } else {
+        index->live_count++;
+    }
+
+    // 序号回绕到 0 时跳过，0 表示不在索引中
+    if (++index->next_seq == 0) {
+        index->next_seq = 1;
+    }
+
+    entry = &index->pending[index->pending_count++];
+    entry->key.value = value;
+    entry->key.doc = doc;
+    entry->seq = index->next_seq;
+    index->seqs[doc] = entry->seq;
+    index->values[doc] = value;
+
+    return hinata_sorted_index_maybe_merge(index);
+}
+
+int hinata_sorted_index_remove(hinata_sorted_index_t *index, uint32_t doc)
+{
+    if (!index) {
+        return -EINVAL;
+    }
+    if (doc >= index->seq_capacity || !index->seqs[doc]) {
+        return -ENOENT;
+    }
+
+    index->seqs[doc] = 0;
+    index->live_count--;
+    index->stale_count++;
+    return hinata_sorted_index_maybe_merge(index);
+}
+
+/**
+ * 升序数组中第一个大于 key 的位置
+ */
+static uint32_t hinata_sorted_upper_bound(const hinata_sorted_index_t *index,
+                                          const hinata_rank_key_t *key)
+{
+    uint32_t left = 0, right = index->sorted_count, mid;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (hinata_rank_key_cmp(&index->sorted[mid].key, key) <= 0) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+static bool hinata_sorted_visit(void *ctx, uint32_t doc)
+{
+    hinata_sorted_visit_ctx_t *visit_ctx = ctx;
+    const hinata_sorted_index_t *index = visit_ctx->index;
+    hinata_rank_key_t key;
+
+    if (doc < index->seq_capacity && index->seqs[doc]) {
+        key.value = index->values[doc];
+        key.doc = doc;
+        hinata_topk_push(visit_ctx->topk, key);
+    }
+
+    return true;
+}
+
+int hinata_sorted_index_page(const hinata_sorted_index_t *index, const hinata_bitmap_t *candidates,
+                             hinata_sort_direction_t direction, const hinata_rank_cursor_t *cursor,
+                             uint32_t skip, uint32_t limit, hinata_rank_key_t *out,
+                             uint32_t *out_count)
+{
+    hinata_sorted_visit_ctx_t ctx;
+    const hinata_sorted_entry_t *entry;
+    hinata_topk_t pending;
+    hinata_rank_key_t key;
+    uint64_t candidate_count;
+    uint32_t wanted, n = 0, taken = 0, p = 0;
+    int64_t pos, step;
+    bool from_sorted;
+    int ret;
+
+    if (!index || (!out && limit) || !out_count || skip > UINT32_MAX - limit) {
+        return -EINVAL;
+    }
+
+    *out_count = 0;
+    wanted = skip + limit;
+    if (wanted == 0) {
+        return 0;
+    }
+
+    // 候选集合很小时，直接对候选集合选择比沿索引逐个跳过更快
+    if (candidates) {
+        candidate_count = hinata_bitmap_cardinality(candidates);
+        if (candidate_count * HINATA_SORTED_SCAN_RATIO < index->live_count) {
+            ret = hinata_topk_init(&pending, wanted < candidate_count ? wanted :
+                                   (uint32_t)candidate_count, direction, cursor);
+            if (ret < 0) {
+                return ret;
+            }
+            ctx.index = index;
+            ctx.topk = &pending;
+            hinata_bitmap_foreach(candidates, hinata_sorted_visit, &ctx);
+            hinata_topk_finish(&pending);
+            hinata_topk_emit(&pending, skip, limit, out, out_count);
+            hinata_topk_free(&pending);
+            return 0;
+        }
+    }
+
+    // 待合并条目不多，用有界堆排好后与 sorted 归并
+    ret = hinata_topk_init(&pending, wanted < index->pending_count ? wanted : index->pending_count,
+                           direction, cursor);
+    if (ret < 0) {
+        return ret;
+    }
+    for (p = 0; p < index->pending_count; p++) {
+        entry = &index->pending[p];
+        if (hinata_sorted_entry_live(index, entry) &&
+            (!candidates || hinata_bitmap_contains(candidates, entry->key.doc))) {
+            hinata_topk_push(&pending, entry->key);
+        }
+    }
+    hinata_topk_finish(&pending);
+
+    if (direction == HINATA_SORT_DESC) {
+        pos = cursor && cursor->valid ?
+              (int64_t)hinata_sorted_upper_bound(index, &cursor->after) - 1 :
+              (int64_t)index->sorted_count - 1;
+        // 游标本身不输出
+        if (cursor && cursor->valid && pos >= 0 &&
+            hinata_rank_key_cmp(&index->sorted[pos].key, &cursor->after) == 0) {
+            pos--;
+        }
+        step = -1;
+    } else {
+        pos = cursor && cursor->valid ? hinata_sorted_upper_bound(index, &cursor->after) : 0;
+        step = 1;
+    }
+
+    p = 0;
+    while (taken < wanted) {
+        // 跳到下一个有效的已排序条目
+        while (pos >= 0 && pos < (int64_t)index->sorted_count) {
+            entry = &index->sorted[pos];
+            if (hinata_sorted_entry_live(index, entry) &&
+                (!candidates || hinata_bitmap_contains(candidates, entry->key.doc))) {
+                break;
+            }
+            pos += step;
+        }
+
+        from_sorted = pos >= 0 && pos < (int64_t)index->sorted_count;
+        if (from_sorted && p < pending.count &&
+            hinata_rank_order(&pending.items[p], &index->sorted[pos].key, direction) < 0) {
+            from_sorted = false;
+        }
+
+        if (from_sorted) {
+            key = index->sorted[pos].key;
+            pos += step;
+        } else if (p < pending.count) {
+            key = pending.items[p++];
+        } else {
+            break;
+        }
+
+        if (taken++ >= skip) {
+            out[n++] = key;
+        }
+    }
+
+    hinata_topk_free(&pending);
+    *out_count = n;
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * HiNATA 排序与分页 - C 语言定义
+ *
+ * hinata_topk_t 是有界堆，只保留一页所需的 k 个结果，代价为 O(n log k)，
+ * 用于相关度这类随查询变化的排序值。时间戳和注意力分数这类稳定的排序值
+ * 由 hinata_sorted_index_t 预先排好，翻页时从游标位置顺序读取，
+ * 不需要对候选集合重新排序。
+ *
+ * 分页使用键集游标：记住上一页最后一个结果的 (value, doc)，下一页从它
+ * 之后开始，深页的代价与页号无关。offset 分页仍通过 skip 参数支持。
+ *
+ * 排序键按 (value, doc) 全序比较，降序即升序的逆序，doc 保证并列时次序稳定。
+ * 时间戳以 double 保存，毫秒时间戳在 2^53 以内可以精确表示。
+ */
+
+#ifndef _HINATA_RANKING_H
+#define _HINATA_RANKING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "bitmap.h"
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 排序键
+ */
+typedef struct {
+    double value;
+    uint32_t doc;
+} hinata_rank_key_t;
+
+/**
+ * 键集游标：valid 为 false 表示第一页
+ */
+typedef struct {
+    hinata_rank_key_t after;
+    bool valid;
+} hinata_rank_cursor_t;
+
+/**
+ * 有界堆，堆顶是当前保留结果中排在最后的一个
+ */
+typedef struct {
+    hinata_rank_key_t *items;
+    uint32_t count;
+    uint32_t k;
+    hinata_sort_direction_t direction;
+    hinata_rank_cursor_t cursor;
+} hinata_topk_t;
+
+/**
+ * 预排序索引的条目，seq 与 seqs[doc] 不一致的条目已经过期
+ */
+typedef struct {
+    hinata_rank_key_t key;
+    uint32_t seq;
+} hinata_sorted_entry_t;
+
+/**
+ * 预排序索引：sorted 按升序排列，新写入先进入 pending，累积到阈值后合并
+ */
+typedef struct {
+    hinata_sorted_entry_t *sorted;
+    uint32_t sorted_count;
+    uint32_t sorted_capacity;
+
+    hinata_sorted_entry_t *pending;
+    uint32_t pending_count;
+    uint32_t pending_capacity;
+
+    // 每个文档的当前序号（0 表示不在索引中）和排序值
+    uint32_t *seqs;
+    double *values;
+    uint32_t seq_capacity;
+    uint32_t next_seq;
+
+    uint32_t live_count;
+    uint32_t stale_count;   // 已过期的条目数
+} hinata_sorted_index_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 排序键比较，返回负数、0 或正数
+ */
+int hinata_rank_key_cmp(const hinata_rank_key_t *a, const hinata_rank_key_t *b);
+
+/**
+ * 有界堆
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ * push 跳过不在游标之后的键；finish 把结果按输出顺序排列在 items 中
+ */
+int hinata_topk_init(hinata_topk_t *topk, uint32_t k, hinata_sort_direction_t direction,
+                     const hinata_rank_cursor_t *cursor);
+void hinata_topk_free(hinata_topk_t *topk);
+void hinata_topk_push(hinata_topk_t *topk, hinata_rank_key_t key);
+void hinata_topk_finish(hinata_topk_t *topk);
+
+/**
+ * 从 keys 中选出游标之后的第 skip 到 skip + limit 个结果，按输出顺序写入 out
+ */
+int hinata_topk_select(const hinata_rank_key_t *keys, uint32_t count,
+                       hinata_sort_direction_t direction, const hinata_rank_cursor_t *cursor,
+                       uint32_t skip, uint32_t limit, hinata_rank_key_t *out, uint32_t *out_count);
+
+/**
+ * 预排序索引
+ * set 插入或更新文档的排序值（不能为 NaN）；remove 不存在时返回 -ENOENT
+ */
+void hinata_sorted_index_init(hinata_sorted_index_t *index);
+void hinata_sorted_index_free(hinata_sorted_index_t *index);
+int hinata_sorted_index_set(hinata_sorted_index_t *index, uint32_t doc, double value);
+int hinata_sorted_index_remove(hinata_sorted_index_t *index, uint32_t doc);
+int hinata_sorted_index_merge(hinata_sorted_index_t *index);
+
+/**
+ * 读取一页：只返回 candidates 中的文档（NULL 表示不限），
+ * 跳过游标之后的前 skip 个结果，最多写入 limit 个。
+ * 候选集合远小于索引时改为对候选集合做有界堆选择
+ */
+int hinata_sorted_index_page(const hinata_sorted_index_t *index, const hinata_bitmap_t *candidates,
+                             hinata_sort_direction_t direction, const hinata_rank_cursor_t *cursor,
+                             uint32_t skip, uint32_t limit, hinata_rank_key_t *out,
+                             uint32_t *out_count);
+
+/**
+ * 取对象在某个排序字段上的值；相关度随查询变化，没有静态值，返回 -EINVAL
+ */
+int hinata_rank_library_item_value(const hinata_library_item_t *item, hinata_sort_field_t field,
+                                   double *value);
+int hinata_rank_packet_value(const hinata_data_packet_t *packet, hinata_sort_field_t field,
+                             double *value);
+
+/**
+ * offset 分页换算：offset 非 0 时优先，否则为 (page - 1) * limit，
+ * 超出范围时饱和为 UINT32_MAX - limit
+ */
+uint32_t hinata_pagination_skip(const hinata_pagination_options_t *pagination);
+
+#endif /* _HINATA_RANKING_H */
@@ -0,0 +1,358 @@
+/**
+ * HiNATA 投影搜索结果 - C 语言实现
+ */
+
+#include "search_projection.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// 内部工具函数
+// ============================================================================
+
+/**
+ * 把定长缓冲区中的字符串存入 arena
+ */
+static int hinata_projected_store(hinata_projected_result_t *result, const char *value,
+                                  size_t max_len, hinata_str_ref_t *ref)
+{
+    const char *end = memchr(value, '\0', max_len);
+
+    return hinata_arena_append(&result->arena, value, end ? (size_t)(end - value) : max_len, ref);
+}
+
+/**
+ * 预留一个结果项并清零
+ */
+static hinata_projected_item_t *hinata_projected_item_reserve(hinata_projected_result_t *result)
+{
+    hinata_projected_item_t *item;
+
+    if (hinata_vec_reserve((void **)&result->items, &result->item_capacity,
+                           result->item_count + 1, sizeof(*result->items)) < 0) {
+        return NULL;
+    }
+
+    item = &result->items[result->item_count];
+    memset(item, 0, sizeof(*item));
+    item->tag_start = result->tags.count;
+    return item;
+}
+
+/**
+ * 投影旧结构体的核心字段
+ */
+static int hinata_projected_core(hinata_projected_result_t *result, hinata_projected_item_t *item,
+                                 const hinata_core_t *core)
+{
+    uint32_t count;
+    uint32_t i;
+    int ret = 0;
+
+    if (result->fields & HINATA_FIELD_HIGHLIGHT) {
+        ret = hinata_projected_store(result, core->highlight, sizeof(core->highlight),
+                                     &item->highlight);
+    }
+    if (!ret && (result->fields & HINATA_FIELD_NOTE)) {
+        ret = hinata_projected_store(result, core->note, sizeof(core->note), &item->note);
+    }
+    if (!ret && (result->fields & HINATA_FIELD_AT)) {
+        ret = hinata_projected_store(result, core->at, sizeof(core->at), &item->at);
+    }
+    if (ret < 0 || !(result->fields & HINATA_FIELD_TAGS)) {
+        return ret;
+    }
+
+    count = core->tag_count < HINATA_MAX_TAGS ? core->tag_count : HINATA_MAX_TAGS;
+    ret = hinata_vec_reserve((void **)&result->tags.items, &result->tags.capacity,
+                             result->tags.count + count, sizeof(*result->tags.items));
+    for (i = 0; !ret && i < count; i++) {
+        ret = hinata_projected_store(result, core->tags[i], sizeof(core->tags[i]),
+                                     &result->tags.items[result->tags.count]);
+        if (!ret) {
+            result->tags.count++;
+            item->tag_count++;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * 追加失败时丢弃本项已写入的标签和字符串，arena_used 为追加前的 arena 用量
+ */
+static int hinata_projected_item_commit(hinata_projected_result_t *result,
+                                        hinata_projected_item_t *item, uint32_t arena_used,
+                                        int ret)
+{
+    if (ret < 0) {
+        result->tags.count = item->tag_start;
+        result->arena.used = arena_used;
+        return ret;
+    }
+
+    result->item_count++;
+    return 0;
+}
+
+// ============================================================================
+// 初始化、重置与释放
+// ============================================================================
+
+void hinata_projected_result_init(hinata_projected_result_t *result, uint32_t fields)
+{
+    memset(result, 0, sizeof(*result));
+    result->fields = fields;
+}
+
+void hinata_projected_result_reset(hinata_projected_result_t *result)
+{
+    result->item_count = 0;
+    result->tags.count = 0;
+    result->arena.used = 0;
+    result->total = 0;
+    result->page = 0;
+    result->limit = 0;
+    result->has_more = false;
+}
+
+void hinata_projected_result_free(hinata_projected_result_t *result)
+{
+    if (!result) {
+        return;
+    }
+
+    free(result->items);
+    free(result->tags.items);
+    hinata_arena_free(&result->arena);
+    hinata_projected_result_init(result, result->fields);
+}
+
+// ============================================================================
+// 追加结果项
+// ============================================================================
+
+int hinata_projected_result_add_library_item(hinata_projected_result_t *result,
+                                             const hinata_library_item_t *item,
+                                             float relevance_score)
+{
+    hinata_projected_item_t *projected;
+    uint32_t arena_used;
+    int ret = 0;
+
+    if (!result || !item) {
+        return -EINVAL;
+    }
+
+    projected = hinata_projected_item_reserve(result);
+    if (!projected) {
+        return -ENOMEM;
+    }
+    arena_used = result->arena.used;
+
+    projected->type = HINATA_RESULT_LIBRARY_ITEM;
+    projected->relevance_score = relevance_score;
+    hinata_uuid_assign(projected->id, item->id);
+
+    if ((result->fields & HINATA_FIELD_OWNER) && item->has_parent) {
+        hinata_uuid_assign(projected->owner_id, item->parent_item);
+    }
+    if (result->fields & HINATA_FIELD_ACCESS) {
+        projected->access = item->core.access;
+    }
+    if (result->fields & HINATA_FIELD_TIMESTAMPS) {
+        projected->created_at = item->created_at;
+        projected->updated_at = item->updated_at;
+    }
+    if (result->fields & HINATA_FIELD_TITLE) {
+        ret = hinata_projected_store(result, item->title, sizeof(item->title), &projected->title);
+    }
+    if (!ret) {
+        ret = hinata_projected_core(result, projected, &item->core);
+    }
+
+    return hinata_projected_item_commit(result, projected, arena_used, ret);
+}
+
+int hinata_projected_result_add_knowledge_block(hinata_projected_result_t *result,
+                                                const hinata_knowledge_block_t *block,
+                                                float relevance_score)
+{
+    hinata_projected_item_t *projected;
+    uint32_t arena_used;
+    int ret;
+
+    if (!result || !block) {
+        return -EINVAL;
+    }
+
+    projected = hinata_projected_item_reserve(result);
+    if (!projected) {
+        return -ENOMEM;
+    }
+    arena_used = result->arena.used;
+
+    projected->type = HINATA_RESULT_KNOWLEDGE_BLOCK;
+    projected->relevance_score = relevance_score;
+    hinata_uuid_assign(projected->id, block->id);
+
+    if (result->fields & HINATA_FIELD_OWNER) {
+        hinata_uuid_assign(projected->owner_id, block->library_item_id);
+    }
+    if (result->fields & HINATA_FIELD_ACCESS) {
+        projected->access = block->core.access;
+    }
+    if (result->fields & HINATA_FIELD_TIMESTAMPS) {
+        projected->created_at = block->created_at;
+        projected->updated_at = block->updated_at;
+    }
+
+    ret = hinata_projected_core(result, projected, &block->core);
+    return hinata_projected_item_commit(result, projected, arena_used, ret);
+}
+
+int hinata_projected_result_add_compact_block(hinata_projected_result_t *result,
+                                              const hinata_compact_block_t *block,
+                                              float relevance_score)
+{
+    hinata_projected_item_t *projected;
+    const hinata_str_ref_vec_t *tags;
+    const char *value;
+    uint32_t arena_used;
+    uint32_t i;
+    int ret = 0;
+
+    if (!result || !block) {
+        return -EINVAL;
+    }
+
+    projected = hinata_projected_item_reserve(result);
+    if (!projected) {
+        return -ENOMEM;
+    }
+    arena_used = result->arena.used;
+
+    projected->type = HINATA_RESULT_KNOWLEDGE_BLOCK;
+    projected->relevance_score = relevance_score;
+    hinata_uuid_assign(projected->id, block->id);
+
+    if (result->fields & HINATA_FIELD_OWNER) {
+        hinata_uuid_assign(projected->owner_id, block->library_item_id);
+    }
+    if (result->fields & HINATA_FIELD_ACCESS) {
+        projected->access = block->core.access;
+    }
+    if (result->fields & HINATA_FIELD_TIMESTAMPS) {
+        projected->created_at = block->created_at;
+        projected->updated_at = block->updated_at;
+    }
+
+    // 长度已知，直接从块的 arena 复制
+    if (result->fields & HINATA_FIELD_HIGHLIGHT) {
+        value = hinata_compact_str(block, block->core.highlight);
+        ret = hinata_arena_append(&result->arena, value, block->core.highlight.length,
+                                  &projected->highlight);
+    }
+    if (!ret && (result->fields & HINATA_FIELD_NOTE)) {
+        value = hinata_compact_str(block, block->core.note);
+        ret = hinata_arena_append(&result->arena, value, block->core.note.length,
+                                  &projected->note);
+    }
+    if (!ret && (result->fields & HINATA_FIELD_AT)) {
+        value = hinata_compact_str(block, block->core.at);
+        ret = hinata_arena_append(&result->arena, value, block->core.at.length, &projected->at);
+    }
+    if (!ret && (result->fields & HINATA_FIELD_TAGS)) {
+        tags = &block->core.tags;
+        ret = hinata_vec_reserve((void **)&result->tags.items, &result->tags.capacity,
+                                 result->tags.count + tags->count, sizeof(*result->tags.items));
+        for (i = 0; !ret && i < tags->count; i++) {
+            value = hinata_compact_str(block, tags->items[i]);
+            ret = hinata_arena_append(&result->arena, value, tags->items[i].length,
+                                      &result->tags.items[result->tags.count]);
+            if (!ret) {
+                result->tags.count++;
+                projected->tag_count++;
+            }
+        }
+    }
+
+    return hinata_projected_item_commit(result, projected, arena_used, ret);
+}
+
+// ============================================================================
+// 字段访问
+// ============================================================================
+
+const char *hinata_projected_str(const hinata_projected_result_t *result, hinata_str_ref_t ref)
+{
+    return hinata_arena_str(&result->arena, ref);
+}
+
+const char *hinata_projected_tag(const hinata_projected_result_t *result,
+                                 const hinata_projected_item_t *item, uint32_t index)
+{
+    if (index >= item->tag_count) {
+        return NULL;
+    }
+
+    return hinata_arena_str(&result->arena, result->tags.items[item->tag_start + index]);
+}
+
+// ============================================================================
+// 按需加载
+// ============================================================================
+
+int hinata_projected_result_load_library_item(const hinata_projected_result_t *result,
+                                              uint32_t index,
+                                              const hinata_result_loader_t *loader,
+                                              hinata_library_item_t *dest)
+{
+    const hinata_projected_item_t *item;
+
+    if (!result || !loader || !dest || index >= result->item_count) {
+        return -EINVAL;
+    }
+
+    item = &result->items[index];
+    if (item->type != HINATA_RESULT_LIBRARY_ITEM) {
+        return -EINVAL;
+    }
+    if (!loader->load_library_item) {
+        return -EOPNOTSUPP;
+    }
+
+    return loader->load_library_item(loader->ctx, item->id, dest);
+}
+
+int hinata_projected_result_load_knowledge_block(const hinata_projected_result_t *result,
+                                                 uint32_t index,
+                                                 const hinata_result_loader_t *loader,
+                                                 hinata_knowledge_block_t *dest)
+{
+    const hinata_projected_item_t *item;
+
+    if (!result || !loader || !dest || index >= result->item_count) {
+        return -EINVAL;
+    }
+
+    item = &result->items[index];
+    if (item->type != HINATA_RESULT_KNOWLEDGE_BLOCK) {
+        return -EINVAL;
+    }
+    if (!loader->load_knowledge_block) {
+        return -EOPNOTSUPP;
+    }
+
+    return loader->load_knowledge_block(loader->ctx, item->id, dest);
+}
+
+size_t hinata_projected_result_footprint(const hinata_projected_result_t *result)
+{
+    return sizeof(*result) +
+           result->arena.capacity +
+           result->item_capacity * sizeof(*result->items) +
+           result->tags.capacity * sizeof(*result->tags.items);
+}
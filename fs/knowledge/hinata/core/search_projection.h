@@ -0,0 +1,152 @@
+/**
+ * HiNATA 投影搜索结果 - C 语言定义
+ *
+ * hinata_search_result_t 为每个结果保存完整的信息物料或知识块，
+ * 单个结果结构体达到数十 MB。投影结果只保存 ID、分数和调用方选择的字段，
+ * 字符串写入结果私有的 arena；需要完整对象时再通过加载器按 ID 读取。
+ */
+
+#ifndef _HINATA_SEARCH_PROJECTION_H
+#define _HINATA_SEARCH_PROJECTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+
+// ============================================================================
+// 投影字段
+// ============================================================================
+
+/**
+ * 可投影的字段（按位组合）
+ */
+typedef enum {
+    HINATA_FIELD_TITLE = 1 << 0,       // 仅信息物料
+    HINATA_FIELD_HIGHLIGHT = 1 << 1,
+    HINATA_FIELD_NOTE = 1 << 2,
+    HINATA_FIELD_AT = 1 << 3,
+    HINATA_FIELD_TAGS = 1 << 4,
+    HINATA_FIELD_ACCESS = 1 << 5,
+    HINATA_FIELD_TIMESTAMPS = 1 << 6,
+    HINATA_FIELD_OWNER = 1 << 7        // 知识块所属物料或物料的父项
+} hinata_search_field_t;
+
+#define HINATA_FIELDS_NONE 0
+#define HINATA_FIELDS_DEFAULT (HINATA_FIELD_TITLE | HINATA_FIELD_HIGHLIGHT)
+#define HINATA_FIELDS_ALL 0xFF
+
+// ============================================================================
+// 投影结果结构
+// ============================================================================
+
+/**
+ * 投影结果项
+ * 未投影的字符串字段为空引用，标签为结果 tags 向量中的一段
+ */
+typedef struct {
+    uint8_t type; // HINATA_RESULT_LIBRARY_ITEM 或 HINATA_RESULT_KNOWLEDGE_BLOCK
+    hinata_uuid_t id;
+    hinata_uuid_t owner_id;
+    float relevance_score;
+
+    hinata_str_ref_t title;
+    hinata_str_ref_t highlight;
+    hinata_str_ref_t note;
+    hinata_str_ref_t at;
+    uint32_t tag_start;
+    uint32_t tag_count;
+    hinata_access_level_t access;
+
+    hinata_timestamp_t created_at;
+    hinata_timestamp_t updated_at;
+} hinata_projected_item_t;
+
+/**
+ * 投影搜索结果
+ */
+typedef struct {
+    uint32_t fields;
+
+    hinata_projected_item_t *items;
+    uint32_t item_count;
+    uint32_t item_capacity;
+
+    // 所有结果项共享的标签引用
+    hinata_str_ref_vec_t tags;
+
+    // 分页信息
+    uint32_t total;
+    uint32_t page;
+    uint32_t limit;
+    bool has_more;
+
+    // 字符串存储
+    hinata_arena_t arena;
+} hinata_projected_result_t;
+
+/**
+ * 完整对象加载器，由存储层提供
+ * 回调成功返回 0，失败返回负的 errno；未提供的回调视为不支持
+ */
+typedef struct {
+    int (*load_library_item)(void *ctx, const hinata_uuid_t id, hinata_library_item_t *dest);
+    int (*load_knowledge_block)(void *ctx, const hinata_uuid_t id, hinata_knowledge_block_t *dest);
+    void *ctx;
+} hinata_result_loader_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化、重置与释放
+ * reset 保留已分配的缓冲区，便于同一结果对象重复用于多次查询
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_projected_result_init(hinata_projected_result_t *result, uint32_t fields);
+void hinata_projected_result_reset(hinata_projected_result_t *result);
+void hinata_projected_result_free(hinata_projected_result_t *result);
+
+/**
+ * 追加结果项，只复制 result->fields 选择的字段
+ */
+int hinata_projected_result_add_library_item(hinata_projected_result_t *result,
+                                             const hinata_library_item_t *item,
+                                             float relevance_score);
+int hinata_projected_result_add_knowledge_block(hinata_projected_result_t *result,
+                                                const hinata_knowledge_block_t *block,
+                                                float relevance_score);
+int hinata_projected_result_add_compact_block(hinata_projected_result_t *result,
+                                              const hinata_compact_block_t *block,
+                                              float relevance_score);
+
+/**
+ * 字段访问
+ * 返回的指针指向 arena，结果被修改后失效
+ */
+const char *hinata_projected_str(const hinata_projected_result_t *result, hinata_str_ref_t ref);
+const char *hinata_projected_tag(const hinata_projected_result_t *result,
+                                 const hinata_projected_item_t *item, uint32_t index);
+
+/**
+ * 按需加载完整对象
+ * 结果项类型不匹配返回 -EINVAL，加载器未提供对应回调返回 -EOPNOTSUPP
+ */
+int hinata_projected_result_load_library_item(const hinata_projected_result_t *result,
+                                              uint32_t index,
+                                              const hinata_result_loader_t *loader,
+                                              hinata_library_item_t *dest);
+int hinata_projected_result_load_knowledge_block(const hinata_projected_result_t *result,
+                                                 uint32_t index,
+                                                 const hinata_result_loader_t *loader,
+                                                 hinata_knowledge_block_t *dest);
+
+/**
+ * 当前占用的堆内存（字节，含结构体本身）
+ */
+size_t hinata_projected_result_footprint(const hinata_projected_result_t *result);
+
+#endif /* _HINATA_SEARCH_PROJECTION_H */
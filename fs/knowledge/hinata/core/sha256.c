@@ -0,0 +1,695 @@
+/**
+ * HiNATA SHA-256 - C 语言实现
+ *
+ * SIMD 版本通过 target 属性单独编译，整个文件仍可用通用编译选项构建，
+ * 运行时再按 CPU 特性分派。
+ */
+
+#include "sha256.h"
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HINATA_SHA256_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2 (1 << 6)
+#endif
+#define HINATA_SHA256_ARM 1
+#endif
+#endif
+
+// 多缓冲实现的通道数
+#define HINATA_SHA256_LANES 8
+
+/**
+ * 压缩函数：依次处理 blocks 个 64 字节块
+ */
+typedef void (*hinata_sha256_compress_t)(uint32_t state[8], const uint8_t *data, size_t blocks);
+
+/**
+ * 多缓冲压缩函数：state[字][通道]，每个通道处理一个块
+ */
+typedef void (*hinata_sha256_compress_lanes_t)(uint32_t state[8][HINATA_SHA256_LANES],
+                                               const uint8_t *const blocks[HINATA_SHA256_LANES]);
+
+typedef struct {
+    const char *name;
+    hinata_sha256_compress_t compress;
+    hinata_sha256_compress_lanes_t compress_lanes;  // NULL 表示批量时逐条计算
+    size_t lanes_max_len;       // 更长的消息逐条计算
+} hinata_sha256_ops_t;
+
+static const uint32_t hinata_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t hinata_sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+static inline uint32_t hinata_sha256_load_be(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void hinata_sha256_store_be(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/**
+ * 填充消息尾部：剩余的 rem 个字节、0x80、补零和 64 位大端长度
+ * 返回尾部块数（1 或 2）
+ */
+static uint32_t hinata_sha256_pad(uint8_t tail[2 * HINATA_SHA256_BLOCK_LEN], const uint8_t *rem,
+                                  uint32_t rem_len, uint64_t total_len)
+{
+    uint32_t blocks = rem_len + 9 > HINATA_SHA256_BLOCK_LEN ? 2 : 1;
+    uint32_t end = blocks * HINATA_SHA256_BLOCK_LEN;
+    uint64_t bits = total_len << 3;
+    uint32_t i;
+
+    memcpy(tail, rem, rem_len);
+    tail[rem_len] = 0x80;
+    memset(tail + rem_len + 1, 0, end - rem_len - 1);
+    for (i = 0; i < 8; i++) {
+        tail[end - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+
+    return blocks;
+}
+
+// ============================================================================
+// 标量实现
+// ============================================================================
+
+#define HINATA_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void hinata_sha256_compress_scalar(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    uint32_t w[64];
+    uint32_t a, b, c, d, e, f, g, h, t1, t2;
+    int i;
+
+    for (; blocks; blocks--, data += HINATA_SHA256_BLOCK_LEN) {
+        for (i = 0; i < 16; i++) {
+            w[i] = hinata_sha256_load_be(data + 4 * i);
+        }
+        for (i = 16; i < 64; i++) {
+            t1 = HINATA_ROTR(w[i - 2], 17) ^ HINATA_ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            t2 = HINATA_ROTR(w[i - 15], 7) ^ HINATA_ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            w[i] = t1 + w[i - 7] + t2 + w[i - 16];
+        }
+
+        a = state[0];
+        b = state[1];
+        c = state[2];
+        d = state[3];
+        e = state[4];
+        f = state[5];
+        g = state[6];
+        h = state[7];
+
+        for (i = 0; i < 64; i++) {
+            t1 = h + (HINATA_ROTR(e, 6) ^ HINATA_ROTR(e, 11) ^ HINATA_ROTR(e, 25)) +
+                 ((e & f) ^ (~e & g)) + hinata_sha256_k[i] + w[i];
+            t2 = (HINATA_ROTR(a, 2) ^ HINATA_ROTR(a, 13) ^ HINATA_ROTR(a, 22)) +
+                 ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+static const hinata_sha256_ops_t hinata_sha256_scalar = {
+    .name = "scalar",
+    .compress = hinata_sha256_compress_scalar,
+    .compress_lanes = NULL,
+    .lanes_max_len = 0,
+};
+
+// ============================================================================
+// x86 实现
+// ============================================================================
+
+#ifdef HINATA_SHA256_X86
+
+/**
+ * SHA 扩展：每条 sha256rnds2 完成两轮，状态按 ABEF/CDGH 排列
+ */
+__attribute__((target("sha,sse4.1")))
+static void hinata_sha256_compress_shani(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, msg, tmp, abef, cdgh;
+    __m128i m[4];
+    int i;
+
+    tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+    state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+    state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (; blocks; blocks--, data += HINATA_SHA256_BLOCK_LEN) {
+        abef = state0;
+        cdgh = state1;
+
+        for (i = 0; i < 4; i++) {
+            m[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), mask);
+        }
+
+        // 每组四轮；第 3 到 14 组同时算出下一组的消息
+        for (i = 0; i < 16; i++) {
+            msg = _mm_add_epi32(m[i & 3],
+                                _mm_loadu_si128((const __m128i *)&hinata_sha256_k[4 * i]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if (i >= 3 && i < 15) {
+                tmp = _mm_alignr_epi8(m[i & 3], m[(i + 3) & 3], 4);
+                m[(i + 1) & 3] = _mm_add_epi32(m[(i + 1) & 3], tmp);
+                m[(i + 1) & 3] = _mm_sha256msg2_epu32(m[(i + 1) & 3], m[i & 3]);
+            }
+            msg = _mm_shuffle_epi32(msg, 0x0e);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            if (i >= 1 && i < 13) {
+                m[(i - 1) & 3] = _mm_sha256msg1_epu32(m[(i - 1) & 3], m[i & 3]);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i *)&state[0], state0);
+    _mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+#define HINATA_ROTR8(x, n) \
+    _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+/**
+ * 读取 8 个通道同一半块的 8 个字，转置为 字 x 通道 并转为大端
+ */
+__attribute__((target("avx2")))
+static inline void hinata_sha256_load_lanes(__m256i w[8], const uint8_t *const blocks[8],
+                                            uint32_t offset)
+{
+    const __m256i bswap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                          12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    __m256i r[8], t[8], u[8];
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        r[i] = _mm256_loadu_si256((const __m256i *)(blocks[i] + offset));
+    }
+    for (i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (i = 0; i < 8; i += 4) {
+        u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (i = 0; i < 4; i++) {
+        w[i] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[i], u[i + 4], 0x20), bswap);
+        w[i + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[i], u[i + 4], 0x31), bswap);
+    }
+}
+
+/**
+ * AVX2 多缓冲：8 条消息各占一个 32 位通道，同时完成一个块
+ */
+__attribute__((target("avx2")))
+static void hinata_sha256_compress_avx2_lanes(uint32_t state[8][HINATA_SHA256_LANES],
+                                              const uint8_t *const blocks[HINATA_SHA256_LANES])
+{
+    __m256i w[16], s[8];
+    __m256i a, b, c, d, e, f, g, h, t1, t2, s0, s1;
+    int i;
+
+    hinata_sha256_load_lanes(w, blocks, 0);
+    hinata_sha256_load_lanes(w + 8, blocks, 32);
+
+    for (i = 0; i < 8; i++) {
+        s[i] = _mm256_loadu_si256((const __m256i *)state[i]);
+    }
+    a = s[0];
+    b = s[1];
+    c = s[2];
+    d = s[3];
+    e = s[4];
+    f = s[5];
+    g = s[6];
+    h = s[7];
+
+    for (i = 0; i < 64; i++) {
+        // 消息扩展使用 16 个字的环形缓冲
+        if (i >= 16) {
+            s0 = w[(i - 15) & 15];
+            s0 = _mm256_xor_si256(_mm256_xor_si256(HINATA_ROTR8(s0, 7), HINATA_ROTR8(s0, 18)),
+                                  _mm256_srli_epi32(s0, 3));
+            s1 = w[(i - 2) & 15];
+            s1 = _mm256_xor_si256(_mm256_xor_si256(HINATA_ROTR8(s1, 17), HINATA_ROTR8(s1, 19)),
+                                  _mm256_srli_epi32(s1, 10));
+            w[i & 15] = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0),
+                                         _mm256_add_epi32(w[(i - 7) & 15], s1));
+        }
+
+        s1 = _mm256_xor_si256(_mm256_xor_si256(HINATA_ROTR8(e, 6), HINATA_ROTR8(e, 11)),
+                              HINATA_ROTR8(e, 25));
+        t1 = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+        t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1), t1);
+        t1 = _mm256_add_epi32(t1, _mm256_add_epi32(_mm256_set1_epi32((int)hinata_sha256_k[i]),
+                                                   w[i & 15]));
+        s0 = _mm256_xor_si256(_mm256_xor_si256(HINATA_ROTR8(a, 2), HINATA_ROTR8(a, 13)),
+                              HINATA_ROTR8(a, 22));
+        t2 = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+        t2 = _mm256_add_epi32(s0, t2);
+
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(t1, t2);
+    }
+
+    s[0] = _mm256_add_epi32(s[0], a);
+    s[1] = _mm256_add_epi32(s[1], b);
+    s[2] = _mm256_add_epi32(s[2], c);
+    s[3] = _mm256_add_epi32(s[3], d);
+    s[4] = _mm256_add_epi32(s[4], e);
+    s[5] = _mm256_add_epi32(s[5], f);
+    s[6] = _mm256_add_epi32(s[6], g);
+    s[7] = _mm256_add_epi32(s[7], h);
+    for (i = 0; i < 8; i++) {
+        _mm256_storeu_si256((__m256i *)state[i], s[i]);
+    }
+}
+
+static const hinata_sha256_ops_t hinata_sha256_shani = {
+    .name = "sha-ni",
+    .compress = hinata_sha256_compress_shani,
+    .compress_lanes = NULL,
+    .lanes_max_len = 0,
+};
+
+// 短消息的填充和逐条调用占比高，8 通道仍然占优；长消息交给 SHA 扩展
+static const hinata_sha256_ops_t hinata_sha256_shani_avx2 = {
+    .name = "sha-ni+avx2-x8",
+    .compress = hinata_sha256_compress_shani,
+    .compress_lanes = hinata_sha256_compress_avx2_lanes,
+    .lanes_max_len = 512,
+};
+
+static const hinata_sha256_ops_t hinata_sha256_avx2 = {
+    .name = "avx2-x8",
+    .compress = hinata_sha256_compress_scalar,
+    .compress_lanes = hinata_sha256_compress_avx2_lanes,
+    .lanes_max_len = SIZE_MAX,
+};
+
+#endif /* HINATA_SHA256_X86 */
+
+// ============================================================================
+// ARM 实现
+// ============================================================================
+
+#ifdef HINATA_SHA256_ARM
+
+/**
+ * ARMv8 SHA2 扩展：每组四轮，状态按 ABCD/EFGH 排列
+ */
+__attribute__((target("arch=armv8-a+crypto")))
+static void hinata_sha256_compress_armv8(uint32_t state[8], const uint8_t *data, size_t blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&state[0]);
+    uint32x4_t state1 = vld1q_u32(&state[4]);
+    uint32x4_t abcd, efgh, wk, tmp;
+    uint32x4_t m[4];
+    int i;
+
+    for (; blocks; blocks--, data += HINATA_SHA256_BLOCK_LEN) {
+        abcd = state0;
+        efgh = state1;
+
+        for (i = 0; i < 4; i++) {
+            m[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16 * i)));
+        }
+
+        // 前 12 组同时算出 4 组之后的消息
+        for (i = 0; i < 16; i++) {
+            wk = vaddq_u32(m[i & 3], vld1q_u32(&hinata_sha256_k[4 * i]));
+            if (i < 12) {
+                m[i & 3] = vsha256su0q_u32(m[i & 3], m[(i + 1) & 3]);
+            }
+            tmp = state0;
+            state0 = vsha256hq_u32(state0, state1, wk);
+            state1 = vsha256h2q_u32(state1, tmp, wk);
+            if (i < 12) {
+                m[i & 3] = vsha256su1q_u32(m[i & 3], m[(i + 2) & 3], m[(i + 3) & 3]);
+            }
+        }
+
+        state0 = vaddq_u32(state0, abcd);
+        state1 = vaddq_u32(state1, efgh);
+    }
+
+    vst1q_u32(&state[0], state0);
+    vst1q_u32(&state[4], state1);
+}
+
+static const hinata_sha256_ops_t hinata_sha256_armv8 = {
+    .name = "armv8-sha2",
+    .compress = hinata_sha256_compress_armv8,
+    .compress_lanes = NULL,
+    .lanes_max_len = 0,
+};
+
+#endif /* HINATA_SHA256_ARM */
+
+// ============================================================================
+// 运行时分派
+// ============================================================================
+
+static const hinata_sha256_ops_t *hinata_sha256_select(void)
+{
+#if defined(HINATA_SHA256_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) {
+        return __builtin_cpu_supports("avx2") ? &hinata_sha256_shani_avx2 : &hinata_sha256_shani;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return &hinata_sha256_avx2;
+    }
+#elif defined(HINATA_SHA256_ARM)
+    if (getauxval(AT_HWCAP) & HWCAP_SHA2) {
+        return &hinata_sha256_armv8;
+    }
+#endif
+    return &hinata_sha256_scalar;
+}
+
+static const hinata_sha256_ops_t *hinata_sha256_ops(void)
+{
+    // 并发首次调用各自选择出同一结果，原子发布保证读到完整的指针
+    static _Atomic(const hinata_sha256_ops_t *) selected;
+    const hinata_sha256_ops_t *ops = atomic_load_explicit(&selected, memory_order_acquire);
+
+    if (!ops) {
+        ops = hinata_sha256_select();
+        atomic_store_explicit(&selected, ops, memory_order_release);
+    }
+
+    return ops;
+}
+
+const char *hinata_sha256_kernel_name(void)
+{
+    return hinata_sha256_ops()->name;
+}
+
+// ============================================================================
+// 增量计算
+// ============================================================================
+
+void hinata_sha256_init(hinata_sha256_t *ctx)
+{
+    memcpy(ctx->state, hinata_sha256_iv, sizeof(ctx->state));
+    ctx->length = 0;
+    ctx->buffered = 0;
+}
+
+void hinata_sha256_update(hinata_sha256_t *ctx, const void *data, size_t len)
+{
+    const hinata_sha256_ops_t *ops = hinata_sha256_ops();
+    const uint8_t *p = data;
+    size_t blocks, take;
+
+    ctx->length += len;
+
+    if (ctx->buffered) {
+        take = HINATA_SHA256_BLOCK_LEN - ctx->buffered;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->buffer + ctx->buffered, p, take);
+        ctx->buffered += take;
+        p += take;
+        len -= take;
+        if (ctx->buffered < HINATA_SHA256_BLOCK_LEN) {
+            return;
+        }
+        ops->compress(ctx->state, ctx->buffer, 1);
+        ctx->buffered = 0;
+    }
+
+    // 完整的块直接从输入压缩，不经过缓冲
+    blocks = len / HINATA_SHA256_BLOCK_LEN;
+    if (blocks) {
+        ops->compress(ctx->state, p, blocks);
+        p += blocks * HINATA_SHA256_BLOCK_LEN;
+        len -= blocks * HINATA_SHA256_BLOCK_LEN;
+    }
+
+    if (len) {
+        memcpy(ctx->buffer, p, len);
+        ctx->buffered = (uint32_t)len;
+    }
+}
+
+void hinata_sha256_final(hinata_sha256_t *ctx, uint8_t digest[HINATA_SHA256_DIGEST_LEN])
+{
+    uint8_t tail[2 * HINATA_SHA256_BLOCK_LEN];
+    uint32_t blocks, i;
+
+    blocks = hinata_sha256_pad(tail, ctx->buffer, ctx->buffered, ctx->length);
+    hinata_sha256_ops()->compress(ctx->state, tail, blocks);
+
+    for (i = 0; i < 8; i++) {
+        hinata_sha256_store_be(digest + 4 * i, ctx->state[i]);
+    }
+}
+
+void hinata_sha256_final_hex(hinata_sha256_t *ctx, char hex[HINATA_SHA256_HEX_LEN])
+{
+    uint8_t digest[HINATA_SHA256_DIGEST_LEN];
+
+    hinata_sha256_final(ctx, digest);
+    hinata_sha256_to_hex(digest, hex);
+}
+
+void hinata_sha256(const void *data, size_t len, uint8_t digest[HINATA_SHA256_DIGEST_LEN])
+{
+    hinata_sha256_t ctx;
+
+    hinata_sha256_init(&ctx);
+    hinata_sha256_update(&ctx, data, len);
+    hinata_sha256_final(&ctx, digest);
+}
+
+void hinata_sha256_to_hex(const uint8_t digest[HINATA_SHA256_DIGEST_LEN],
+                          char hex[HINATA_SHA256_HEX_LEN])
+{
+    static const char digits[] = "0123456789abcdef";
+    uint32_t i;
+
+    for (i = 0; i < HINATA_SHA256_DIGEST_LEN; i++) {
+        hex[2 * i] = digits[digest[i] >> 4];
+        hex[2 * i + 1] = digits[digest[i] & 0xf];
+    }
+    hex[2 * HINATA_SHA256_DIGEST_LEN] = '\0';
+}
+
+void hinata_sha256_attachment(hinata_attachment_t *attachment, const void *data, size_t len)
+{
+    uint8_t digest[HINATA_SHA256_DIGEST_LEN];
+
+    hinata_sha256(data, len, digest);
+    hinata_sha256_to_hex(digest, attachment->checksum);
+}
+
+// ============================================================================
+// 批量计算
+// ============================================================================
+
+/**
+ * 多缓冲的一个通道：先处理消息中的完整块，再处理填充后的尾部
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t blocks;
+    uint8_t tail[2 * HINATA_SHA256_BLOCK_LEN];
+    uint32_t tail_blocks;
+    uint32_t tail_pos;
+    uint32_t msg;
+    bool active;
+} hinata_sha256_lane_t;
+
+static void hinata_sha256_lane_start(hinata_sha256_lane_t *lane,
+                                     uint32_t state[8][HINATA_SHA256_LANES], uint32_t index,
+                                     const uint8_t *data, size_t len, uint32_t msg)
+{
+    size_t full = len / HINATA_SHA256_BLOCK_LEN;
+    uint32_t i;
+
+    lane->data = data;
+    lane->blocks = full;
+    lane->tail_blocks = hinata_sha256_pad(lane->tail, data + full * HINATA_SHA256_BLOCK_LEN,
+                                          (uint32_t)(len - full * HINATA_SHA256_BLOCK_LEN), len);
+    lane->tail_pos = 0;
+    lane->msg = msg;
+    lane->active = true;
+
+    for (i = 0; i < 8; i++) {
+        state[i][index] = hinata_sha256_iv[i];
+    }
+}
+
+/**
+ * 下一条交给多缓冲的消息，没有时返回 count
+ */
+static uint32_t hinata_sha256_next_short(const hinata_sha256_ops_t *ops, const size_t *lengths,
+                                         uint32_t count, uint32_t from)
+{
+    while (from < count && lengths[from] > ops->lanes_max_len) {
+        from++;
+    }
+    return from;
+}
+
+static void hinata_sha256_many_lanes(const hinata_sha256_ops_t *ops,
+                                     const void *const *data, const size_t *lengths,
+                                     uint32_t count, uint8_t (*digests)[HINATA_SHA256_DIGEST_LEN])
+{
+    static const uint8_t idle[HINATA_SHA256_BLOCK_LEN];
+    hinata_sha256_lane_t lanes[HINATA_SHA256_LANES];
+    uint32_t state[8][HINATA_SHA256_LANES];
+    const uint8_t *blocks[HINATA_SHA256_LANES];
+    hinata_sha256_lane_t *lane;
+    uint32_t next, active = 0, l, i;
+
+    memset(state, 0, sizeof(state));
+    next = hinata_sha256_next_short(ops, lengths, count, 0);
+    for (l = 0; l < HINATA_SHA256_LANES; l++) {
+        lanes[l].active = false;
+        if (next < count) {
+            hinata_sha256_lane_start(&lanes[l], state, l, data[next], lengths[next], next);
+            next = hinata_sha256_next_short(ops, lengths, count, next + 1);
+            active++;
+        }
+    }
+
+    while (active) {
+        for (l = 0; l < HINATA_SHA256_LANES; l++) {
+            lane = &lanes[l];
+            if (!lane->active) {
+                blocks[l] = idle;
+            } else if (lane->blocks) {
+                blocks[l] = lane->data;
+            } else {
+                blocks[l] = lane->tail + lane->tail_pos * HINATA_SHA256_BLOCK_LEN;
+            }
+        }
+
+        ops->compress_lanes(state, blocks);
+
+        // 完成的通道输出摘要并立即换上下一条消息
+        for (l = 0; l < HINATA_SHA256_LANES; l++) {
+            lane = &lanes[l];
+            if (!lane->active) {
+                continue;
+            }
+            if (lane->blocks) {
+                lane->data += HINATA_SHA256_BLOCK_LEN;
+                lane->blocks--;
+                continue;
+            }
+            if (++lane->tail_pos < lane->tail_blocks) {
+                continue;
+            }
+
+            for (i = 0; i < 8; i++) {
+                hinata_sha256_store_be(digests[lane->msg] + 4 * i, state[i][l]);
+            }
+            lane->active = false;
+            active--;
+            if (next < count) {
+                hinata_sha256_lane_start(lane, state, l, data[next], lengths[next], next);
+                next = hinata_sha256_next_short(ops, lengths, count, next + 1);
+                active++;
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (lengths[i] > ops->lanes_max_len) {
+            hinata_sha256(data[i], lengths[i], digests[i]);
+        }
+    }
+}
+
+int hinata_sha256_many(const void *const *data, const size_t *lengths, uint32_t count,
+                       uint8_t (*digests)[HINATA_SHA256_DIGEST_LEN])
+{
+    const hinata_sha256_ops_t *ops = hinata_sha256_ops();
+    uint32_t i;
+
+    if (count && (!data || !lengths || !digests)) {
+        return -EINVAL;
+    }
+    for (i = 0; i < count; i++) {
+        if (!data[i] && lengths[i]) {
+            return -EINVAL;
+        }
+    }
+
+    if (ops->compress_lanes && count > 1) {
+        hinata_sha256_many_lanes(ops, data, lengths, count, digests);
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        hinata_sha256(data[i], lengths[i], digests[i]);
+    }
+    return 0;
+}
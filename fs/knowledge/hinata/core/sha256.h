@@ -0,0 +1,81 @@
+/**
+ * HiNATA SHA-256 - C 语言定义
+ *
+ * hinata_attachment_t.checksum 保存附件内容的 SHA-256 十六进制串。
+ * 这里提供增量计算的上下文，附件在复制进存储的同时即可计算校验和，
+ * 不需要再读一遍。压缩函数在首次使用时按 CPU 特性选择：
+ *
+ *   sha-ni     x86 SHA 扩展
+ *   armv8-sha2 ARMv8 SHA2 扩展
+ *   scalar     可移植实现
+ *
+ * 大量小附件用 hinata_sha256_many 批量计算：AVX2 下 8 条消息各占一个
+ * 32 位通道同时压缩，填充和逐条调用的开销由 8 条分摊。同时有 SHA 扩展时
+ * 只有不超过 512 字节的消息走多缓冲，更长的逐条计算。
+ */
+
+#ifndef _HINATA_SHA256_H
+#define _HINATA_SHA256_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+
+#define HINATA_SHA256_BLOCK_LEN 64
+#define HINATA_SHA256_DIGEST_LEN 32
+#define HINATA_SHA256_HEX_LEN 65    // 含 null 终止符，与 hinata_attachment_t.checksum 一致
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 增量计算上下文
+ */
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;            // 已输入的字节数
+    uint8_t buffer[HINATA_SHA256_BLOCK_LEN];
+    uint32_t buffered;
+} hinata_sha256_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 增量计算：init 之后任意次 update，最后 final 输出摘要
+ * final 之后上下文需要重新 init 才能再用
+ */
+void hinata_sha256_init(hinata_sha256_t *ctx);
+void hinata_sha256_update(hinata_sha256_t *ctx, const void *data, size_t len);
+void hinata_sha256_final(hinata_sha256_t *ctx, uint8_t digest[HINATA_SHA256_DIGEST_LEN]);
+void hinata_sha256_final_hex(hinata_sha256_t *ctx, char hex[HINATA_SHA256_HEX_LEN]);
+
+/**
+ * 一次性计算与十六进制转换（小写）
+ */
+void hinata_sha256(const void *data, size_t len, uint8_t digest[HINATA_SHA256_DIGEST_LEN]);
+void hinata_sha256_to_hex(const uint8_t digest[HINATA_SHA256_DIGEST_LEN],
+                          char hex[HINATA_SHA256_HEX_LEN]);
+
+/**
+ * 批量计算 count 条消息的摘要，digests[i] 对应 data[i]
+ * 返回 0，参数无效时返回 -EINVAL
+ */
+int hinata_sha256_many(const void *const *data, const size_t *lengths, uint32_t count,
+                       uint8_t (*digests)[HINATA_SHA256_DIGEST_LEN]);
+
+/**
+ * 计算附件内容的校验和并写入 attachment->checksum
+ */
+void hinata_sha256_attachment(hinata_attachment_t *attachment, const void *data, size_t len);
+
+/**
+ * 当前使用的压缩函数名称
+ */
+const char *hinata_sha256_kernel_name(void);
+
+#endif /* _HINATA_SHA256_H */
@@ -0,0 +1,666 @@
+/**
+ * HiNATA 标签字典 - C 语言实现
+ */
+
+#include "tag_dict.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HINATA_TAG_MIN_SLOTS 64
+#define HINATA_TAG_REBUILD_PENDING 1024
+#define HINATA_TAG_REBUILD_UPDATES 4096
+
+/**
+ * 排序用的名称与下标
+ */
+typedef struct {
+    const char *name;
+    uint32_t index;
+} hinata_tag_sort_item_t;
+
+// ============================================================================
+// 规范化
+// ============================================================================
+
+static bool hinata_tag_is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/**
+ * 转小写，去掉首部空白，连续空白折叠为 '_'
+ * trim_end 为 false 时保留末尾的分隔符，供前缀补全使用
+ */
+static size_t hinata_tag_normalize(const char *tag, char *normalized, size_t size, bool trim_end)
+{
+    bool separator = false;
+    size_t len = 0;
+    char c;
+
+    if (size == 0) {
+        return 0;
+    }
+
+    for (; *tag && len + 1 < size; tag++) {
+        c = *tag;
+        if (hinata_tag_is_space(c)) {
+            separator = len > 0;
+            continue;
+        }
+        if (separator) {
+            normalized[len++] = '_';
+            separator = false;
+            if (len + 1 >= size) {
+                break;
+            }
+        }
+        normalized[len++] = (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+    }
+
+    if (separator && !trim_end && len + 1 < size) {
+        normalized[len++] = '_';
+    }
+
+    normalized[len] = '\0';
+    return len;
+}
+
+void hinata_normalize_tag(const char *tag, char *normalized, size_t size)
+{
+    hinata_tag_normalize(tag, normalized, size, true);
+}
+
+// ============================================================================
+// 哈希表
+// ============================================================================
+
+static uint32_t hinata_tag_hash(const char *key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static uint32_t hinata_tag_slot(const hinata_tag_dict_t *dict, const char *normalized)
+{
+    uint32_t mask = dict->slot_capacity - 1;
+    uint32_t slot = hinata_tag_hash(normalized, strlen(normalized)) & mask;
+    uint32_t entry;
+
+    while ((entry = dict->slots[slot]) != 0) {
+        if (strcmp(hinata_arena_str(&dict->arena, dict->entries[entry - 1].normalized),
+                   normalized) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static int hinata_tag_rehash(hinata_tag_dict_t *dict, uint32_t slot_capacity)
+{
+    uint32_t *old_slots = dict->slots;
+    uint32_t i;
+
+    dict->slots = calloc(slot_capacity, sizeof(*dict->slots));
+    if (!dict->slots) {
+        dict->slots = old_slots;
+        return -ENOMEM;
+    }
+
+    dict->slot_capacity = slot_capacity;
+    for (i = 0; i < dict->count; i++) {
+        dict->slots[hinata_tag_slot(dict, hinata_arena_str(&dict->arena,
+                                                           dict->entries[i].normalized))] = i + 1;
+    }
+
+    free(old_slots);
+    return 0;
+}
+
+/**
+ * 查找热门前缀
+ */
+static const hinata_tag_prefix_t *hinata_tag_prefix_find(const hinata_tag_dict_t *dict,
+                                                         const char *prefix, size_t len)
+{
+    const hinata_tag_prefix_t *node;
+    uint32_t mask, slot, entry;
+
+    if (!dict->prefix_slot_capacity) {
+        return NULL;
+    }
+
+    mask = dict->prefix_slot_capacity - 1;
+    slot = hinata_tag_hash(prefix, len) & mask;
+    while ((entry = dict->prefix_slots[slot]) != 0) {
+        node = &dict->prefixes[entry - 1];
+        if (node->prefix.length == len &&
+            memcmp(hinata_arena_str(&dict->prefix_arena, node->prefix), prefix, len) == 0) {
+            return node;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_tag_dict_init(hinata_tag_dict_t *dict)
+{
+    memset(dict, 0, sizeof(*dict));
+    atomic_init(&dict->usage_updates, 0);
+}
+
+void hinata_tag_dict_free(hinata_tag_dict_t *dict)
+{
+    if (!dict) {
+        return;
+    }
+
+    free(dict->entries);
+    free(dict->slots);
+    free(dict->sorted);
+    free(dict->prefixes);
+    free(dict->prefix_slots);
+    free(dict->tops);
+    hinata_arena_free(&dict->arena);
+    hinata_arena_free(&dict->prefix_arena);
+    hinata_tag_dict_init(dict);
+}
+
+// ============================================================================
+// 添加与查找
+// ============================================================================
+
+/**
+ * 追加一个已规范化的标签
+ */
+static int hinata_tag_dict_append(hinata_tag_dict_t *dict, const char *name, const char *normalized,
+                                  uint32_t slot, uint32_t *index)
+{
+    hinata_tag_entry_t *entry;
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&dict->entries, &dict->capacity, dict->count + 1,
+                             sizeof(*dict->entries));
+    if (ret < 0) {
+        return ret;
+    }
+
+    entry = &dict->entries[dict->count];
+    memset(entry, 0, sizeof(*entry));
+    atomic_init(&entry->usage_count, 0);
+
+    ret = hinata_arena_append(&dict->arena, name, strlen(name), &entry->name);
+    if (!ret) {
+        ret = hinata_arena_append(&dict->arena, normalized, strlen(normalized), &entry->normalized);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    dict->slots[slot] = dict->count + 1;
+    *index = dict->count++;
+    return 0;
+}
+
+/**
+ * 待合并标签过多时自动重建
+ * 与关系图的增量日志一样按已排序规模放宽阈值，批量导入时重建总代价为线性；
+ * 重建失败只影响补全速度，待合并标签仍会被扫描到
+ */
+static void hinata_tag_dict_maybe_rebuild(hinata_tag_dict_t *dict)
+{
+    uint32_t pending = dict->count - dict->sorted_count;
+
+    if (pending >= HINATA_TAG_REBUILD_PENDING && pending >= dict->sorted_count / 8) {
+        hinata_tag_dict_rebuild(dict);
+    }
+}
+
+/**
+ * 规范化后查找或准备插入
+ */
+static int hinata_tag_dict_lookup(hinata_tag_dict_t *dict, const char *name, char *normalized,
+                                  uint32_t *slot)
+{
+    int ret;
+
+    if (hinata_tag_normalize(name, normalized, HINATA_MAX_TAG_LEN, true) == 0) {
+        return -EINVAL;
+    }
+
+    if ((dict->count + 1) * 2 > dict->slot_capacity) {
+        ret = hinata_tag_rehash(dict, dict->slot_capacity ? dict->slot_capacity * 2 :
+                                HINATA_TAG_MIN_SLOTS);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    *slot = hinata_tag_slot(dict, normalized);
+    return 0;
+}
+
+int hinata_tag_dict_add(hinata_tag_dict_t *dict, const hinata_tag_t *tag, uint32_t *index)
+{
+    char normalized[HINATA_MAX_TAG_LEN];
+    uint32_t slot;
+    int ret;
+
+    if (!dict || !tag || !index) {
+        return -EINVAL;
+    }
+
+    ret = hinata_tag_dict_lookup(dict, tag->normalized_name[0] ? tag->normalized_name : tag->name,
+                                 normalized, &slot);
+    if (ret < 0) {
+        return ret;
+    }
+    if (dict->slots[slot]) {
+        *index = dict->slots[slot] - 1;
+        return -EEXIST;
+    }
+
+    ret = hinata_tag_dict_append(dict, tag->name[0] ? tag->name : normalized, normalized, slot,
+                                 index);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hinata_uuid_assign(dict->entries[*index].id, tag->id);
+    atomic_store_explicit(&dict->entries[*index].usage_count, tag->usage_count,
+                          memory_order_relaxed);
+    dict->entries[*index].is_system_tag = tag->is_system_tag;
+    hinata_tag_dict_maybe_rebuild(dict);
+    return 0;
+}
+
+int hinata_tag_dict_intern(hinata_tag_dict_t *dict, const char *name, uint32_t *index)
+{
+    char normalized[HINATA_MAX_TAG_LEN];
+    uint32_t slot;
+    int ret;
+
+    if (!dict || !name || !index) {
+        return -EINVAL;
+    }
+
+    ret = hinata_tag_dict_lookup(dict, name, normalized, &slot);
+    if (ret < 0) {
+        return ret;
+    }
+    if (dict->slots[slot]) {
+        *index = dict->slots[slot] - 1;
+        return 0;
+    }
+
+    ret = hinata_tag_dict_append(dict, name, normalized, slot, index);
+    if (ret < 0) {
+        return ret;
+    }
+
+    hinata_tag_dict_maybe_rebuild(dict);
+    return 0;
+}
+
+int hinata_tag_dict_find(const hinata_tag_dict_t *dict, const char *name, uint32_t *index)
+{
+    char normalized[HINATA_MAX_TAG_LEN];
+    uint32_t entry;
+
+    if (!dict || !name || !index) {
+        return -EINVAL;
+    }
+    if (!dict->slot_capacity || hinata_tag_normalize(name, normalized, sizeof(normalized), true) == 0) {
+        return -ENOENT;
+    }
+
+    entry = dict->slots[hinata_tag_slot(dict, normalized)];
+    if (!entry) {
+        return -ENOENT;
+    }
+
+    *index = entry - 1;
+    return 0;
+}
+
+// ============================================================================
+// 标签访问与使用计数
+// ============================================================================
+
+const char *hinata_tag_dict_name(const hinata_tag_dict_t *dict, uint32_t index)
+{
+    if (!dict || index >= dict->count) {
+        return NULL;
+    }
+
+    return hinata_arena_str(&dict->arena, dict->entries[index].name);
+}
+
+const char *hinata_tag_dict_normalized(const hinata_tag_dict_t *dict, uint32_t index)
+{
+    if (!dict || index >= dict->count) {
+        return NULL;
+    }
+
+    return hinata_arena_str(&dict->arena, dict->entries[index].normalized);
+}
+
+uint32_t hinata_tag_dict_usage(const hinata_tag_dict_t *dict, uint32_t index)
+{
+    if (!dict || index >= dict->count) {
+        return 0;
+    }
+
+    return atomic_load_explicit(&((hinata_tag_dict_t *)dict)->entries[index].usage_count,
+                                memory_order_relaxed);
+}
+
+void hinata_tag_dict_use(hinata_tag_dict_t *dict, uint32_t index, int32_t delta)
+{
+    atomic_uint *counter;
+    unsigned int old, next;
+
+    if (!dict || index >= dict->count || delta == 0) {
+        return;
+    }
+
+    counter = &dict->entries[index].usage_count;
+    if (delta > 0) {
+        atomic_fetch_add_explicit(counter, (unsigned int)delta, memory_order_relaxed);
+    } else {
+        old = atomic_load_explicit(counter, memory_order_relaxed);
+        do {
+            next = old > (unsigned int)-(int64_t)delta ? old - (unsigned int)-(int64_t)delta : 0;
+        } while (!atomic_compare_exchange_weak_explicit(counter, &old, next, memory_order_relaxed,
+                                                        memory_order_relaxed));
+    }
+
+    atomic_fetch_add_explicit(&dict->usage_updates, 1, memory_order_relaxed);
+}
+
+// ============================================================================
+// 补全
+// ============================================================================
+
+/**
+ * 把候选插入按使用次数降序排列的结果，同次数保持先到先得
+ */
+static void hinata_tag_rank(hinata_tag_suggestion_t *out, uint32_t *count, uint32_t limit,
+                            uint32_t tag, uint32_t usage)
+{
+    uint32_t i;
+
+    if (*count == limit && usage <= out[limit - 1].usage_count) {
+        return;
+    }
+
+    i = *count < limit ? (*count)++ : limit - 1;
+    while (i > 0 && out[i - 1].usage_count < usage) {
+        out[i] = out[i - 1];
+        i--;
+    }
+
+    out[i].tag = tag;
+    out[i].usage_count = usage;
+}
+
+/**
+ * 在排序数组中找出以 prefix 开头的区间 [lo, hi)
+ */
+static void hinata_tag_range(const hinata_tag_dict_t *dict, const char *prefix, size_t len,
+                             uint32_t *lo, uint32_t *hi)
+{
+    uint32_t left = 0, right = dict->sorted_count, mid;
+    const char *name;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        name = hinata_tag_dict_normalized(dict, dict->sorted[mid]);
+        if (strncmp(name, prefix, len) < 0) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    *lo = left;
+
+    right = dict->sorted_count;
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        name = hinata_tag_dict_normalized(dict, dict->sorted[mid]);
+        if (strncmp(name, prefix, len) <= 0) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+    *hi = left;
+}
+
+int hinata_tag_dict_suggest(const hinata_tag_dict_t *dict, const char *prefix,
+                            hinata_tag_suggestion_t *out, uint32_t limit)
+{
+    char normalized[HINATA_MAX_TAG_LEN];
+    const hinata_tag_prefix_t *node = NULL;
+    uint32_t count = 0;
+    uint32_t lo, hi, i, tag;
+    size_t len;
+
+    if (!dict || !prefix || !out) {
+        return -EINVAL;
+    }
+    if (limit == 0) {
+        return 0;
+    }
+
+    len = hinata_tag_normalize(prefix, normalized, sizeof(normalized), false);
+    hinata_tag_range(dict, normalized, len, &lo, &hi);
+
+    if (hi - lo > HINATA_TAG_SCAN_LIMIT && limit <= HINATA_TAG_TOP_K) {
+        node = hinata_tag_prefix_find(dict, normalized, len);
+    }
+
+    // 快照只决定候选集合，排序使用当前计数
+    if (node) {
+        for (i = 0; i < node->top_count; i++) {
+            tag = dict->tops[node->top_start + i];
+            hinata_tag_rank(out, &count, limit, tag, hinata_tag_dict_usage(dict, tag));
+        }
+    } else {
+        for (i = lo; i < hi; i++) {
+            tag = dict->sorted[i];
+            hinata_tag_rank(out, &count, limit, tag, hinata_tag_dict_usage(dict, tag));
+        }
+    }
+
+    for (tag = dict->sorted_count; tag < dict->count; tag++) {
+        if (strncmp(hinata_tag_dict_normalized(dict, tag), normalized, len) == 0) {
+            hinata_tag_rank(out, &count, limit, tag, hinata_tag_dict_usage(dict, tag));
+        }
+    }
+
+    return (int)count;
+}
+
+// ============================================================================
+// 重建
+// ============================================================================
+
+static int hinata_tag_sort_cmp(const void *a, const void *b)
+{
+    return strcmp(((const hinata_tag_sort_item_t *)a)->name,
+                  ((const hinata_tag_sort_item_t *)b)->name);
+}
+
+bool hinata_tag_dict_needs_rebuild(const hinata_tag_dict_t *dict)
+{
+    uint32_t updates = atomic_load_explicit(&((hinata_tag_dict_t *)dict)->usage_updates,
+                                            memory_order_relaxed);
+    uint32_t threshold = dict->count / 2;
+
+    if (threshold < HINATA_TAG_REBUILD_UPDATES) {
+        threshold = HINATA_TAG_REBUILD_UPDATES;
+    }
+
+    return dict->count - dict->sorted_count >= HINATA_TAG_REBUILD_PENDING || updates >= threshold;
+}
+
+/**
+ * 为区间 [lo, hi) 记录热门前缀，再按下一个字符拆分子区间
+ */
+static int hinata_tag_build_prefixes(hinata_tag_dict_t *dict, uint32_t lo, uint32_t hi,
+                                     uint32_t depth)
+{
+    hinata_tag_suggestion_t top[HINATA_TAG_TOP_K];
+    hinata_tag_prefix_t *node;
+    const char *name;
+    uint32_t count = 0;
+    uint32_t i, j;
+    int ret;
+
+    if (hi - lo <= HINATA_TAG_SCAN_LIMIT) {
+        return 0;
+    }
+
+    for (i = lo; i < hi; i++) {
+        hinata_tag_rank(top, &count, HINATA_TAG_TOP_K, dict->sorted[i],
+                        hinata_tag_dict_usage(dict, dict->sorted[i]));
+    }
+
+    ret = hinata_vec_reserve((void **)&dict->prefixes, &dict->prefix_capacity,
+                             dict->prefix_count + 1, sizeof(*dict->prefixes));
+    if (!ret) {
+        ret = hinata_vec_reserve((void **)&dict->tops, &dict->top_capacity,
+                                 dict->top_count + count, sizeof(*dict->tops));
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    // 前缀写入单独的 arena，扩容不会使指向标签名称的 name 失效
+    node = &dict->prefixes[dict->prefix_count];
+    name = hinata_tag_dict_normalized(dict, dict->sorted[lo]);
+    ret = hinata_arena_append(&dict->prefix_arena, name, depth, &node->prefix);
+    if (ret < 0) {
+        return ret;
+    }
+
+    node->top_start = dict->top_count;
+    node->top_count = count;
+    for (i = 0; i < count; i++) {
+        dict->tops[dict->top_count++] = top[i].tag;
+    }
+    dict->prefix_count++;
+
+    // 恰好等于前缀的名称排在最前，不属于任何子区间
+    i = lo;
+    while (i < hi && hinata_tag_dict_normalized(dict, dict->sorted[i])[depth] == '\0') {
+        i++;
+    }
+
+    while (i < hi) {
+        name = hinata_tag_dict_normalized(dict, dict->sorted[i]);
+        for (j = i + 1; j < hi; j++) {
+            if (hinata_tag_dict_normalized(dict, dict->sorted[j])[depth] != name[depth]) {
+                break;
+            }
+        }
+
+        ret = hinata_tag_build_prefixes(dict, i, j, depth + 1);
+        if (ret < 0) {
+            return ret;
+        }
+        i = j;
+    }
+
+    return 0;
+}
+
+int hinata_tag_dict_rebuild(hinata_tag_dict_t *dict)
+{
+    hinata_tag_sort_item_t *items;
+    hinata_tag_prefix_t *node;
+    uint32_t *sorted;
+    uint32_t capacity = HINATA_TAG_MIN_SLOTS;
+    uint32_t i, mask, slot;
+    int ret;
+
+    if (!dict) {
+        return -EINVAL;
+    }
+
+    items = malloc((dict->count ? dict->count : 1) * sizeof(*items));
+    sorted = malloc((dict->count ? dict->count : 1) * sizeof(*sorted));
+    if (!items || !sorted) {
+        free(items);
+        free(sorted);
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < dict->count; i++) {
+        items[i].name = hinata_tag_dict_normalized(dict, i);
+        items[i].index = i;
+    }
+    qsort(items, dict->count, sizeof(*items), hinata_tag_sort_cmp);
+    for (i = 0; i < dict->count; i++) {
+        sorted[i] = items[i].index;
+    }
+    free(items);
+
+    free(dict->sorted);
+    dict->sorted = sorted;
+    dict->sorted_count = dict->count;
+    dict->prefix_count = 0;
+    dict->top_count = 0;
+    dict->prefix_arena.used = 0;
+    atomic_store_explicit(&dict->usage_updates, 0, memory_order_relaxed);
+
+    // 旧槽位指向即将被覆盖的节点，重建失败时也不能再用
+    free(dict->prefix_slots);
+    dict->prefix_slots = NULL;
+    dict->prefix_slot_capacity = 0;
+
+    ret = hinata_tag_build_prefixes(dict, 0, dict->sorted_count, 0);
+    if (ret < 0) {
+        dict->prefix_count = 0;
+        return ret;
+    }
+
+    while (capacity < dict->prefix_count * 2) {
+        capacity *= 2;
+    }
+    dict->prefix_slots = calloc(capacity, sizeof(*dict->prefix_slots));
+    if (!dict->prefix_slots) {
+        dict->prefix_count = 0;
+        return -ENOMEM;
+    }
+    dict->prefix_slot_capacity = capacity;
+
+    mask = capacity - 1;
+    for (i = 0; i < dict->prefix_count; i++) {
+        node = &dict->prefixes[i];
+        slot = hinata_tag_hash(hinata_arena_str(&dict->prefix_arena, node->prefix),
+                               node->prefix.length) & mask;
+        while (dict->prefix_slots[slot]) {
+            slot = (slot + 1) & mask;
+        }
+        dict->prefix_slots[slot] = i + 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * HiNATA 标签字典 - C 语言定义
+ *
+ * 规范化名称通过哈希表定位标签；前缀补全在按名称排序的数组上二分得到
+ * 匹配区间，区间较小时直接按当前使用次数扫描，较大时使用重建快照中
+ * 预先算好的热门标签。使用次数为原子计数，可以与读取并发更新。
+ *
+ * 并发约定：添加标签和重建需要独占访问；查找、补全和使用计数可以并发。
+ */
+
+#ifndef _HINATA_TAG_DICT_H
+#define _HINATA_TAG_DICT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#include "models.h"
+#include "compact_block.h"
+
+// 前缀区间不超过该数目时直接扫描
+#define HINATA_TAG_SCAN_LIMIT 256
+
+// 每个热门前缀快照保存的标签数，也是可走快照的最大补全条数
+#define HINATA_TAG_TOP_K 32
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 字典中的标签
+ */
+typedef struct {
+    hinata_uuid_t id;
+    hinata_str_ref_t name;
+    hinata_str_ref_t normalized;
+    atomic_uint usage_count;
+    bool is_system_tag;
+} hinata_tag_entry_t;
+
+/**
+ * 热门前缀：匹配区间超过 HINATA_TAG_SCAN_LIMIT 的前缀
+ */
+typedef struct {
+    hinata_str_ref_t prefix;
+    uint32_t top_start;     // 在 tops 中的起始位置
+    uint32_t top_count;
+} hinata_tag_prefix_t;
+
+/**
+ * 补全结果
+ */
+typedef struct {
+    uint32_t tag;           // 标签下标
+    uint32_t usage_count;
+} hinata_tag_suggestion_t;
+
+/**
+ * 标签字典
+ */
+typedef struct {
+    hinata_tag_entry_t *entries;
+    uint32_t count;
+    uint32_t capacity;
+
+    // 规范化名称 -> 标签下标 + 1
+    uint32_t *slots;
+    uint32_t slot_capacity;
+
+    // 重建快照：sorted 覆盖 entries[0, sorted_count)，之后的为待合并标签
+    uint32_t *sorted;
+    uint32_t sorted_count;
+    hinata_tag_prefix_t *prefixes;
+    uint32_t prefix_count;
+    uint32_t prefix_capacity;
+    uint32_t *prefix_slots;
+    uint32_t prefix_slot_capacity;
+    uint32_t *tops;
+    uint32_t top_count;
+    uint32_t top_capacity;
+    hinata_arena_t prefix_arena;        // 前缀字符串，每次重建时清空
+
+    // 自上次重建以来的使用次数更新
+    atomic_uint usage_updates;
+
+    hinata_arena_t arena;
+} hinata_tag_dict_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_tag_dict_init(hinata_tag_dict_t *dict);
+void hinata_tag_dict_free(hinata_tag_dict_t *dict);
+
+/**
+ * 添加标签
+ * add 在规范化名称已存在时返回 -EEXIST 并通过 index 给出已有标签；
+ * intern 在已存在时直接返回已有标签
+ */
+int hinata_tag_dict_add(hinata_tag_dict_t *dict, const hinata_tag_t *tag, uint32_t *index);
+int hinata_tag_dict_intern(hinata_tag_dict_t *dict, const char *name, uint32_t *index);
+
+/**
+ * 按名称查找（先规范化），不存在时返回 -ENOENT
+ */
+int hinata_tag_dict_find(const hinata_tag_dict_t *dict, const char *name, uint32_t *index);
+
+/**
+ * 标签访问
+ */
+const char *hinata_tag_dict_name(const hinata_tag_dict_t *dict, uint32_t index);
+const char *hinata_tag_dict_normalized(const hinata_tag_dict_t *dict, uint32_t index);
+uint32_t hinata_tag_dict_usage(const hinata_tag_dict_t *dict, uint32_t index);
+
+/**
+ * 原子地调整使用次数，结果不低于 0
+ */
+void hinata_tag_dict_use(hinata_tag_dict_t *dict, uint32_t index, int32_t delta);
+
+/**
+ * 前缀补全，按当前使用次数降序写入最多 limit 条，返回条数或负的 errno
+ */
+int hinata_tag_dict_suggest(const hinata_tag_dict_t *dict, const char *prefix,
+                            hinata_tag_suggestion_t *out, uint32_t limit);
+
+/**
+ * 重建排序数组和热门前缀快照
+ * needs_rebuild 在待合并标签或使用次数变化较多时返回 true，供后台维护调用
+ */
+bool hinata_tag_dict_needs_rebuild(const hinata_tag_dict_t *dict);
+int hinata_tag_dict_rebuild(hinata_tag_dict_t *dict);
+
+#endif /* _HINATA_TAG_DICT_H */
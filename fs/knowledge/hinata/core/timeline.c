@@ -0,0 +1,553 @@
+/**
+ * HiNATA 捕获时间线索引 - C 语言实现
+ */
+
+#include "timeline.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// 条目字典
+// ============================================================================
+
+static const char *hinata_timeline_entry_key(const void *owner, uint32_t entry)
+{
+    return ((const hinata_timeline_t *)owner)->entries[entry - 1].id;
+}
+
+static uint32_t hinata_timeline_slot(const hinata_timeline_t *timeline, const char *uuid)
+{
+    return hinata_uuid_slot(timeline->slots, timeline->slot_capacity, uuid,
+                            hinata_timeline_entry_key, timeline);
+}
+
+// ============================================================================
+// 时间桶
+// ============================================================================
+
+static int64_t hinata_timeline_bucket_of(const hinata_timeline_t *timeline, hinata_timestamp_t ts)
+{
+    hinata_timestamp_t offset = ts - timeline->origin;
+    int64_t bucket = offset / timeline->bucket_width;
+
+    // 向下取整，origin 之前的时间戳也落在正确的桶里
+    if (offset % timeline->bucket_width < 0) {
+        bucket--;
+    }
+
+    return bucket;
+}
+
+static hinata_timestamp_t hinata_timeline_bucket_start(const hinata_timeline_t *timeline,
+                                                       int64_t bucket)
+{
+    return timeline->origin + bucket * timeline->bucket_width;
+}
+
+static uint32_t hinata_timeline_bucket_lower_bound(const hinata_timeline_t *timeline,
+                                                   int64_t bucket)
+{
+    uint32_t left = 0, right = timeline->bucket_count, mid;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (timeline->buckets[mid].bucket < bucket) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+static hinata_timeline_bucket_t *hinata_timeline_bucket(hinata_timeline_t *timeline,
+                                                        hinata_timestamp_t ts, bool create)
+{
+    int64_t bucket = hinata_timeline_bucket_of(timeline, ts);
+    uint32_t pos = hinata_timeline_bucket_lower_bound(timeline, bucket);
+    hinata_timeline_bucket_t *entry;
+
+    if (pos < timeline->bucket_count && timeline->buckets[pos].bucket == bucket) {
+        return &timeline->buckets[pos];
+    }
+    if (!create || hinata_vec_reserve((void **)&timeline->buckets, &timeline->bucket_capacity,
+                                      timeline->bucket_count + 1,
+                                      sizeof(*timeline->buckets)) < 0) {
+        return NULL;
+    }
+
+    memmove(timeline->buckets + pos + 1, timeline->buckets + pos,
+            (size_t)(timeline->bucket_count - pos) * sizeof(*timeline->buckets));
+    entry = &timeline->buckets[pos];
+    memset(entry, 0, sizeof(*entry));
+    entry->bucket = bucket;
+    timeline->bucket_count++;
+    return entry;
+}
+
+/**
+ * 删除 ts 所在的桶，如果它已经为空
+ */
+static void hinata_timeline_prune(hinata_timeline_t *timeline, hinata_timestamp_t ts)
+{
+    int64_t bucket = hinata_timeline_bucket_of(timeline, ts);
+    uint32_t pos = hinata_timeline_bucket_lower_bound(timeline, bucket);
+
+    if (pos == timeline->bucket_count || timeline->buckets[pos].bucket != bucket ||
+        timeline->buckets[pos].count) {
+        return;
+    }
+
+    free(timeline->buckets[pos].entries);
+    memmove(timeline->buckets + pos, timeline->buckets + pos + 1,
+            (size_t)(timeline->bucket_count - pos - 1) * sizeof(*timeline->buckets));
+    timeline->bucket_count--;
+}
+
+/**
+ * 桶内第一个排在 (ts, entry) 之后的位置；entry 为 UINT32_MAX 时即第一个时间戳大于 ts 的位置
+ */
+static uint32_t hinata_timeline_search(const hinata_timeline_t *timeline,
+                                       const hinata_timeline_bucket_t *bucket,
+                                       hinata_timestamp_t ts, uint32_t entry)
+{
+    uint32_t left = 0, right = bucket->count, mid, other;
+    hinata_timestamp_t other_ts;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        other = bucket->entries[mid];
+        other_ts = timeline->entries[other].timestamp;
+        if (other_ts < ts || (other_ts == ts && other <= entry)) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+/**
+ * 桶内第一个时间戳不小于 ts 的位置
+ */
+static uint32_t hinata_timeline_search_from(const hinata_timeline_t *timeline,
+                                            const hinata_timeline_bucket_t *bucket,
+                                            hinata_timestamp_t ts)
+{
+    uint32_t left = 0, right = bucket->count, mid;
+
+    while (left < right) {
+        mid = left + (right - left) / 2;
+        if (timeline->entries[bucket->entries[mid]].timestamp < ts) {
+            left = mid + 1;
+        } else {
+            right = mid;
+        }
+    }
+
+    return left;
+}
+
+/**
+ * 保证条目所在的桶存在且还能再放一个条目
+ */
+static int hinata_timeline_reserve(hinata_timeline_t *timeline, hinata_timestamp_t ts)
+{
+    hinata_timeline_bucket_t *bucket = hinata_timeline_bucket(timeline, ts, true);
+    int ret;
+
+    if (!bucket) {
+        return -ENOMEM;
+    }
+
+    ret = hinata_vec_reserve((void **)&bucket->entries, &bucket->capacity, bucket->count + 1,
+                             sizeof(*bucket->entries));
+    if (ret < 0) {
+        hinata_timeline_prune(timeline, ts);
+    }
+    return ret;
+}
+
+/**
+ * 把条目放入所在的桶，桶必须已由 hinata_timeline_reserve 准备好
+ */
+static void hinata_timeline_link(hinata_timeline_t *timeline, uint32_t entry)
+{
+    const hinata_timeline_entry_t *record = &timeline->entries[entry];
+    hinata_timeline_bucket_t *bucket = hinata_timeline_bucket(timeline, record->timestamp, false);
+    uint32_t pos = hinata_timeline_search(timeline, bucket, record->timestamp, entry);
+
+    memmove(bucket->entries + pos + 1, bucket->entries + pos,
+            (size_t)(bucket->count - pos) * sizeof(*bucket->entries));
+    bucket->entries[pos] = entry;
+    bucket->count++;
+    if (record->source < HINATA_TIMELINE_SOURCE_COUNT) {
+        bucket->sources[record->source]++;
+    }
+}
+
+/**
+ * 从桶中移出条目，空桶由调用方用 hinata_timeline_prune 删除
+ */
+static void hinata_timeline_unlink(hinata_timeline_t *timeline, uint32_t entry)
+{
+    const hinata_timeline_entry_t *record = &timeline->entries[entry];
+    hinata_timeline_bucket_t *bucket = hinata_timeline_bucket(timeline, record->timestamp, false);
+    uint32_t pos = hinata_timeline_search(timeline, bucket, record->timestamp, entry) - 1;
+
+    memmove(bucket->entries + pos, bucket->entries + pos + 1,
+            (size_t)(bucket->count - pos - 1) * sizeof(*bucket->entries));
+    bucket->count--;
+    if (record->source < HINATA_TIMELINE_SOURCE_COUNT) {
+        bucket->sources[record->source]--;
+    }
+}
+
+/**
+ * 桶内落在日期范围内的区间 [*lo, *hi)，只有边界桶需要二分查找
+ */
+static void hinata_timeline_span(const hinata_timeline_t *timeline,
+                                 const hinata_timeline_bucket_t *bucket,
+                                 const hinata_date_range_t *range, uint32_t *lo, uint32_t *hi)
+{
+    hinata_timestamp_t start = hinata_timeline_bucket_start(timeline, bucket->bucket);
+
+    *lo = 0;
+    *hi = bucket->count;
+    if (!range) {
+        return;
+    }
+
+    if (range->has_start && start < range->start) {
+        *lo = hinata_timeline_search_from(timeline, bucket, range->start);
+    }
+    if (range->has_end && start + timeline->bucket_width - 1 > range->end) {
+        *hi = hinata_timeline_search(timeline, bucket, range->end, UINT32_MAX);
+    }
+    if (*hi < *lo) {
+        *hi = *lo;
+    }
+}
+
+/**
+ * 与日期范围相交的桶 [*first, *last)
+ */
+static void hinata_timeline_bucket_span(const hinata_timeline_t *timeline,
+                                        const hinata_date_range_t *range, uint32_t *first,
+                                        uint32_t *last)
+{
+    *first = 0;
+    *last = timeline->bucket_count;
+    if (!range) {
+        return;
+    }
+
+    if (range->has_start) {
+        *first = hinata_timeline_bucket_lower_bound(
+            timeline, hinata_timeline_bucket_of(timeline, range->start));
+    }
+    if (range->has_end) {
+        *last = hinata_timeline_bucket_lower_bound(
+            timeline, hinata_timeline_bucket_of(timeline, range->end) + 1);
+    }
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+void hinata_timeline_init(hinata_timeline_t *timeline, hinata_timestamp_t bucket_width,
+                          hinata_timestamp_t origin)
+{
+    memset(timeline, 0, sizeof(*timeline));
+    timeline->bucket_width = bucket_width > 0 ? bucket_width : HINATA_TIMELINE_DAY;
+    timeline->origin = origin;
+    timeline->version = hinata_next_version();
+}
+
+void hinata_timeline_free(hinata_timeline_t *timeline)
+{
+    uint32_t i;
+
+    if (!timeline) {
+        return;
+    }
+
+    for (i = 0; i < timeline->bucket_count; i++) {
+        free(timeline->buckets[i].entries);
+    }
+    free(timeline->buckets);
+    free(timeline->entries);
+    free(timeline->slots);
+    hinata_timeline_init(timeline, timeline->bucket_width, timeline->origin);
+}
+
+// ============================================================================
+// 插入与删除
+// ============================================================================
+
+int hinata_timeline_upsert(hinata_timeline_t *timeline, const char *id,
+                           hinata_timestamp_t timestamp, uint8_t source)
+{
+    hinata_timeline_entry_t *record;
+    hinata_timestamp_t old_ts;
+    uint32_t slot, entry;
+    int ret;
+
+    if (!timeline || !id || !id[0]) {
+        return -EINVAL;
+    }
+    if (source >= HINATA_TIMELINE_SOURCE_COUNT) {
+        source = HINATA_TIMELINE_NO_SOURCE;
+    }
+
+    ret = hinata_uuid_slots_grow(&timeline->slots, &timeline->slot_capacity,
+                                 timeline->entry_count, timeline->entry_count,
+                                 hinata_timeline_entry_key, timeline);
+    if (ret < 0) {
+        return ret;
+    }
+
+    slot = hinata_timeline_slot(timeline, id);
+    if (timeline->slots[slot]) {
+        entry = timeline->slots[slot] - 1;
+    } else {
+        ret = hinata_vec_reserve((void **)&timeline->entries, &timeline->entry_capacity,
+                                 timeline->entry_count + 1, sizeof(*timeline->entries));
+        if (ret < 0) {
+            return ret;
+        }
+        entry = timeline->entry_count++;
+        record = &timeline->entries[entry];
+        memset(record, 0, sizeof(*record));
+        hinata_uuid_assign(record->id, id);
+        timeline->slots[slot] = entry + 1;
+    }
+
+    record = &timeline->entries[entry];
+    if (record->live && record->timestamp == timestamp && record->source == source) {
+        return 0;
+    }
+
+    // 先准备好新位置，失败时旧位置保持不变
+    ret = hinata_timeline_reserve(timeline, timestamp);
+    if (ret < 0) {
+        return ret;
+    }
+    timeline->version = hinata_next_version();
+
+    if (record->live) {
+        old_ts = record->timestamp;
+        hinata_timeline_unlink(timeline, entry);
+        record->timestamp = timestamp;
+        record->source = source;
+        hinata_timeline_link(timeline, entry);
+        hinata_timeline_prune(timeline, old_ts);
+        return 0;
+    }
+
+    record->timestamp = timestamp;
+    record->source = source;
+    record->live = true;
+    hinata_timeline_link(timeline, entry);
+    timeline->live_count++;
+    return 0;
+}
+
+int hinata_timeline_add_packet(hinata_timeline_t *timeline, const hinata_data_packet_t *packet)
+{
+    if (!packet) {
+        return -EINVAL;
+    }
+
+    return hinata_timeline_upsert(timeline, packet->metadata.packet_id,
+                                  packet->metadata.capture_timestamp,
+                                  (uint8_t)packet->metadata.capture_source);
+}
+
+int hinata_timeline_add_library_item(hinata_timeline_t *timeline,
+                                     const hinata_library_item_t *item)
+{
+    if (!item) {
+        return -EINVAL;
+    }
+
+    return hinata_timeline_upsert(timeline, item->id, item->created_at,
+                                  HINATA_TIMELINE_NO_SOURCE);
+}
+
+int hinata_timeline_add_compact_block(hinata_timeline_t *timeline,
+                                      const hinata_compact_block_t *block)
+{
+    if (!block) {
+        return -EINVAL;
+    }
+
+    return hinata_timeline_upsert(timeline, block->id, block->created_at,
+                                  HINATA_TIMELINE_NO_SOURCE);
+}
+
+int hinata_timeline_remove(hinata_timeline_t *timeline, const char *id)
+{
+    uint32_t entry;
+
+    if (!timeline || !id) {
+        return -EINVAL;
+    }
+    if (!timeline->slot_capacity) {
+        return -ENOENT;
+    }
+
+    entry = timeline->slots[hinata_timeline_slot(timeline, id)];
+    if (!entry || !timeline->entries[entry - 1].live) {
+        return -ENOENT;
+    }
+
+    timeline->version = hinata_next_version();
+    hinata_timeline_unlink(timeline, entry - 1);
+    hinata_timeline_prune(timeline, timeline->entries[entry - 1].timestamp);
+    timeline->entries[entry - 1].live = false;
+    timeline->live_count--;
+    return 0;
+}
+
+// ============================================================================
+// 查询
+// ============================================================================
+
+int hinata_timeline_range(const hinata_timeline_t *timeline, const hinata_date_range_t *range,
+                          hinata_sort_direction_t direction, uint32_t offset, uint32_t limit,
+                          uint32_t *out, uint32_t *count)
+{
+    const hinata_timeline_bucket_t *bucket;
+    uint32_t first, last, lo, hi, i, n = 0;
+
+    if (!timeline || !count || (limit && !out)) {
+        return -EINVAL;
+    }
+
+    hinata_timeline_bucket_span(timeline, range, &first, &last);
+    if (last < first) {
+        last = first;
+    }
+
+    for (i = 0; i < last - first && n < limit; i++) {
+        bucket = &timeline->buckets[direction == HINATA_SORT_DESC ? last - 1 - i : first + i];
+        hinata_timeline_span(timeline, bucket, range, &lo, &hi);
+
+        // 整桶跳过，不访问条目
+        if (offset >= hi - lo) {
+            offset -= hi - lo;
+            continue;
+        }
+
+        if (direction == HINATA_SORT_DESC) {
+            for (hi -= offset; hi > lo && n < limit; hi--) {
+                out[n++] = bucket->entries[hi - 1];
+            }
+        } else {
+            for (lo += offset; lo < hi && n < limit; lo++) {
+                out[n++] = bucket->entries[lo];
+            }
+        }
+        offset = 0;
+    }
+
+    *count = n;
+    return 0;
+}
+
+uint32_t hinata_timeline_count(const hinata_timeline_t *timeline, const hinata_date_range_t *range)
+{
+    uint32_t first, last, lo, hi, i, total = 0;
+
+    if (!timeline) {
+        return 0;
+    }
+    if (!range || (!range->has_start && !range->has_end)) {
+        return timeline->live_count;
+    }
+
+    hinata_timeline_bucket_span(timeline, range, &first, &last);
+    for (i = first; i < last; i++) {
+        hinata_timeline_span(timeline, &timeline->buckets[i], range, &lo, &hi);
+        total += hi - lo;
+    }
+
+    return total;
+}
+
+int hinata_timeline_summaries(const hinata_timeline_t *timeline, const hinata_date_range_t *range,
+                              hinata_timeline_summary_t *out, uint32_t max, uint32_t *count)
+{
+    const hinata_timeline_bucket_t *bucket;
+    hinata_timeline_summary_t *summary;
+    uint32_t first, last, lo, hi, i, j, n = 0;
+    uint8_t source;
+
+    if (!timeline || !count || (max && !out)) {
+        return -EINVAL;
+    }
+
+    hinata_timeline_bucket_span(timeline, range, &first, &last);
+    for (i = first; i < last; i++) {
+        bucket = &timeline->buckets[i];
+        hinata_timeline_span(timeline, bucket, range, &lo, &hi);
+        if (lo == hi) {
+            continue;
+        }
+        if (n >= max) {
+            n++;
+            continue;
+        }
+
+        summary = &out[n++];
+        summary->start = hinata_timeline_bucket_start(timeline, bucket->bucket);
+        summary->count = hi - lo;
+
+        // 完全落在范围内的桶直接使用摘要
+        if (hi - lo == bucket->count) {
+            memcpy(summary->sources, bucket->sources, sizeof(summary->sources));
+            continue;
+        }
+
+        memset(summary->sources, 0, sizeof(summary->sources));
+        for (j = lo; j < hi; j++) {
+            source = timeline->entries[bucket->entries[j]].source;
+            if (source < HINATA_TIMELINE_SOURCE_COUNT) {
+                summary->sources[source]++;
+            }
+        }
+    }
+
+    *count = n;
+    return 0;
+}
+
+const char *hinata_timeline_entry_uuid(const hinata_timeline_t *timeline, uint32_t entry)
+{
+    if (!timeline || entry >= timeline->entry_count || !timeline->entries[entry].live) {
+        return NULL;
+    }
+
+    return timeline->entries[entry].id;
+}
+
+hinata_timestamp_t hinata_timeline_entry_timestamp(const hinata_timeline_t *timeline,
+                                                   uint32_t entry)
+{
+    if (!timeline || entry >= timeline->entry_count) {
+        return 0;
+    }
+
+    return timeline->entries[entry].timestamp;
+}
+
+uint32_t hinata_timeline_size(const hinata_timeline_t *timeline)
+{
+    return timeline ? timeline->live_count : 0;
+}
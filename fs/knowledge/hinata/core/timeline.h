@@ -0,0 +1,150 @@
+/**
+ * HiNATA 捕获时间线索引 - C 语言定义
+ *
+ * "上周捕获了什么"之类的查询按 capture_timestamp / created_at 过滤并按时间排序。
+ * 过滤索引的时间桶是位图，只能给出集合；这里按固定宽度（天或周）分桶，
+ * 每个桶保存按时间排序的条目下标和摘要（条目数、各捕获源的数量）：
+ *
+ *   时间线分页   只访问与日期范围相交的桶，offset 按桶的条目数整桶跳过
+ *   计数/热力图  完全落在范围内的桶直接使用摘要，只有边界桶需要二分查找
+ *
+ * 桶的边界为 origin + k * bucket_width，origin 可用于按周一对齐或按时区偏移。
+ * 时间戳单位与 hinata_timestamp_t 的其他用法一致（毫秒）。
+ *
+ * 索引不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_TIMELINE_H
+#define _HINATA_TIMELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+
+#define HINATA_TIMELINE_DAY 86400000LL
+#define HINATA_TIMELINE_WEEK (7 * HINATA_TIMELINE_DAY)
+
+// 1970-01-05 是周一，作为 origin 时周桶从周一开始
+#define HINATA_TIMELINE_MONDAY (4 * HINATA_TIMELINE_DAY)
+
+// 捕获源数量；没有捕获源的条目（如知识块）只计入总数
+#define HINATA_TIMELINE_SOURCE_COUNT 7
+#define HINATA_TIMELINE_NO_SOURCE 0xFF
+
+// ============================================================================
+// 数据结构
+// ============================================================================
+
+/**
+ * 条目，下标即条目 ID；删除后保留记录，同一 ID 再次写入时复用
+ */
+typedef struct {
+    hinata_uuid_t id;
+    hinata_timestamp_t timestamp;
+    uint8_t source;             // HINATA_TIMELINE_NO_SOURCE 表示没有捕获源
+    bool live;
+} hinata_timeline_entry_t;
+
+/**
+ * 时间桶：时间戳落在 [start, start + bucket_width) 的条目
+ */
+typedef struct {
+    int64_t bucket;
+    uint32_t *entries;          // 按 (时间戳, 条目 ID) 升序
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t sources[HINATA_TIMELINE_SOURCE_COUNT];
+} hinata_timeline_bucket_t;
+
+/**
+ * 桶摘要，用于日历热力图等聚合展示
+ */
+typedef struct {
+    hinata_timestamp_t start;   // 桶的起始时间
+    uint32_t count;
+    uint32_t sources[HINATA_TIMELINE_SOURCE_COUNT];
+} hinata_timeline_summary_t;
+
+/**
+ * 时间线索引
+ */
+typedef struct {
+    hinata_timestamp_t bucket_width;
+    hinata_timestamp_t origin;
+    uint64_t version;           // 初始化和每次写入时取进程内递增的新值，查询缓存据此判断结果是否过期
+
+    // 条目，外部 ID -> 条目 ID + 1
+    hinata_timeline_entry_t *entries;
+    uint32_t entry_count;
+    uint32_t entry_capacity;
+    uint32_t *slots;
+    uint32_t slot_capacity;
+    uint32_t live_count;
+
+    // 非空桶，按 bucket 升序排列
+    hinata_timeline_bucket_t *buckets;
+    uint32_t bucket_count;
+    uint32_t bucket_capacity;
+} hinata_timeline_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放，bucket_width 为 0 时按天分桶
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+void hinata_timeline_init(hinata_timeline_t *timeline, hinata_timestamp_t bucket_width,
+                          hinata_timestamp_t origin);
+void hinata_timeline_free(hinata_timeline_t *timeline);
+
+/**
+ * 插入或更新条目，时间戳改变时移到新的位置
+ * source 为 hinata_capture_source_t 或 HINATA_TIMELINE_NO_SOURCE
+ */
+int hinata_timeline_upsert(hinata_timeline_t *timeline, const char *id,
+                           hinata_timestamp_t timestamp, uint8_t source);
+int hinata_timeline_add_packet(hinata_timeline_t *timeline, const hinata_data_packet_t *packet);
+int hinata_timeline_add_library_item(hinata_timeline_t *timeline,
+                                     const hinata_library_item_t *item);
+int hinata_timeline_add_compact_block(hinata_timeline_t *timeline,
+                                      const hinata_compact_block_t *block);
+
+/**
+ * 删除条目，不存在时返回 -ENOENT
+ */
+int hinata_timeline_remove(hinata_timeline_t *timeline, const char *id);
+
+/**
+ * 按时间顺序列出日期范围内的条目 ID：跳过前 offset 个，最多写入 limit 个，
+ * 实际数量写入 *count。range 为 NULL 时不限范围
+ */
+int hinata_timeline_range(const hinata_timeline_t *timeline, const hinata_date_range_t *range,
+                          hinata_sort_direction_t direction, uint32_t offset, uint32_t limit,
+                          uint32_t *out, uint32_t *count);
+
+/**
+ * 日期范围内的条目数
+ */
+uint32_t hinata_timeline_count(const hinata_timeline_t *timeline, const hinata_date_range_t *range);
+
+/**
+ * 日期范围内每个非空桶的摘要，按时间升序，边界桶只统计范围内的条目。
+ * 最多写入 max 个，*count 为范围内的非空桶总数（可能大于 max）
+ */
+int hinata_timeline_summaries(const hinata_timeline_t *timeline, const hinata_date_range_t *range,
+                              hinata_timeline_summary_t *out, uint32_t max, uint32_t *count);
+
+/**
+ * 条目 ID 对应的外部 ID 和时间戳；有效条目数
+ */
+const char *hinata_timeline_entry_uuid(const hinata_timeline_t *timeline, uint32_t entry);
+hinata_timestamp_t hinata_timeline_entry_timestamp(const hinata_timeline_t *timeline,
+                                                   uint32_t entry);
+uint32_t hinata_timeline_size(const hinata_timeline_t *timeline);
+
+#endif /* _HINATA_TIMELINE_H */
@@ -0,0 +1,260 @@
+/**
+ * HiNATA 向量距离内核 - C 语言实现
+ *
+ * SIMD 版本通过 target 属性单独编译，整个文件仍可用通用编译选项构建，
+ * 运行时再按 CPU 特性分派。
+ */
+
+#include "vector_distance.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HINATA_DISTANCE_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define HINATA_DISTANCE_NEON 1
+#endif
+
+// ============================================================================
+// 标量实现
+// ============================================================================
+
+static float hinata_l2_squared_scalar(const float *a, const float *b, uint32_t dim)
+{
+    float sum = 0.0f;
+    float diff;
+    uint32_t i;
+
+    for (i = 0; i < dim; i++) {
+        diff = a[i] - b[i];
+        sum += diff * diff;
+    }
+
+    return sum;
+}
+
+static float hinata_dot_scalar(const float *a, const float *b, uint32_t dim)
+{
+    float sum = 0.0f;
+    uint32_t i;
+
+    for (i = 0; i < dim; i++) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+static const hinata_distance_ops_t hinata_distance_scalar = {
+    .name = "scalar",
+    .l2_squared = hinata_l2_squared_scalar,
+    .dot = hinata_dot_scalar,
+};
+
+// ============================================================================
+// x86 实现
+// ============================================================================
+
+#ifdef HINATA_DISTANCE_X86
+
+__attribute__((target("avx2,fma")))
+static float hinata_hsum256(__m256 v)
+{
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 1));
+    return _mm_cvtss_f32(lo);
+}
+
+__attribute__((target("avx2,fma")))
+static float hinata_l2_squared_avx2(const float *a, const float *b, uint32_t dim)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 diff;
+    uint32_t i = 0;
+
+    for (; i + 16 <= dim; i += 16) {
+        diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(diff, diff, acc0);
+        diff = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc1 = _mm256_fmadd_ps(diff, diff, acc1);
+    }
+    for (; i + 8 <= dim; i += 8) {
+        diff = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(diff, diff, acc0);
+    }
+
+    return hinata_hsum256(_mm256_add_ps(acc0, acc1)) +
+           hinata_l2_squared_scalar(a + i, b + i, dim - i);
+}
+
+__attribute__((target("avx2,fma")))
+static float hinata_dot_avx2(const float *a, const float *b, uint32_t dim)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    uint32_t i = 0;
+
+    for (; i + 16 <= dim; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= dim; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+
+    return hinata_hsum256(_mm256_add_ps(acc0, acc1)) + hinata_dot_scalar(a + i, b + i, dim - i);
+}
+
+static const hinata_distance_ops_t hinata_distance_avx2 = {
+    .name = "avx2",
+    .l2_squared = hinata_l2_squared_avx2,
+    .dot = hinata_dot_avx2,
+};
+
+__attribute__((target("avx512f")))
+static float hinata_l2_squared_avx512(const float *a, const float *b, uint32_t dim)
+{
+    __m512 acc = _mm512_setzero_ps();
+    __m512 diff;
+    __mmask16 mask;
+    uint32_t i = 0;
+
+    for (; i + 16 <= dim; i += 16) {
+        diff = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        acc = _mm512_fmadd_ps(diff, diff, acc);
+    }
+    if (i < dim) {
+        // 尾部用掩码加载，避免再走标量循环
+        mask = (__mmask16)((1U << (dim - i)) - 1);
+        diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+        acc = _mm512_fmadd_ps(diff, diff, acc);
+    }
+
+    return _mm512_reduce_add_ps(acc);
+}
+
+__attribute__((target("avx512f")))
+static float hinata_dot_avx512(const float *a, const float *b, uint32_t dim)
+{
+    __m512 acc = _mm512_setzero_ps();
+    __mmask16 mask;
+    uint32_t i = 0;
+
+    for (; i + 16 <= dim; i += 16) {
+        acc = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), acc);
+    }
+    if (i < dim) {
+        mask = (__mmask16)((1U << (dim - i)) - 1);
+        acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i),
+                              _mm512_maskz_loadu_ps(mask, b + i), acc);
+    }
+
+    return _mm512_reduce_add_ps(acc);
+}
+
+static const hinata_distance_ops_t hinata_distance_avx512 = {
+    .name = "avx512",
+    .l2_squared = hinata_l2_squared_avx512,
+    .dot = hinata_dot_avx512,
+};
+
+#endif /* HINATA_DISTANCE_X86 */
+
+// ============================================================================
+// ARM 实现
+// ============================================================================
+
+#ifdef HINATA_DISTANCE_NEON
+
+static float hinata_l2_squared_neon(const float *a, const float *b, uint32_t dim)
+{
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t diff;
+    uint32_t i = 0;
+
+    for (; i + 8 <= dim; i += 8) {
+        diff = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        acc0 = vfmaq_f32(acc0, diff, diff);
+        diff = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc1 = vfmaq_f32(acc1, diff, diff);
+    }
+    for (; i + 4 <= dim; i += 4) {
+        diff = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        acc0 = vfmaq_f32(acc0, diff, diff);
+    }
+
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + hinata_l2_squared_scalar(a + i, b + i, dim - i);
+}
+
+static float hinata_dot_neon(const float *a, const float *b, uint32_t dim)
+{
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    uint32_t i = 0;
+
+    for (; i + 8 <= dim; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    for (; i + 4 <= dim; i += 4) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + hinata_dot_scalar(a + i, b + i, dim - i);
+}
+
+static const hinata_distance_ops_t hinata_distance_neon = {
+    .name = "neon",
+    .l2_squared = hinata_l2_squared_neon,
+    .dot = hinata_dot_neon,
+};
+
+#endif /* HINATA_DISTANCE_NEON */
+
+// ============================================================================
+// 运行时分派
+// ============================================================================
+
+static const hinata_distance_ops_t *hinata_distance_select(void)
+{
+#if defined(HINATA_DISTANCE_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return &hinata_distance_avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return &hinata_distance_avx2;
+    }
+#elif defined(HINATA_DISTANCE_NEON)
+    return &hinata_distance_neon;
+#endif
+    return &hinata_distance_scalar;
+}
+
+const hinata_distance_ops_t *hinata_distance_ops(void)
+{
+    // 并发首次调用各自选择出同一结果，原子发布保证读到完整的指针
+    static _Atomic(const hinata_distance_ops_t *) selected;
+    const hinata_distance_ops_t *ops = atomic_load_explicit(&selected, memory_order_acquire);
+
+    if (!ops) {
+        ops = hinata_distance_select();
+        atomic_store_explicit(&selected, ops, memory_order_release);
+    }
+
+    return ops;
+}
+
+const hinata_distance_ops_t *hinata_distance_ops_scalar(void)
+{
+    return &hinata_distance_scalar;
+}
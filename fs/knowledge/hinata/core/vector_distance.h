@@ -0,0 +1,37 @@
+/**
+ * HiNATA 向量距离内核 - C 语言定义
+ *
+ * 同一组内核提供 AVX-512、AVX2/FMA、NEON 和标量四种实现，
+ * 首次调用时根据 CPU 特性选择，之后直接复用。
+ */
+
+#ifndef _HINATA_VECTOR_DISTANCE_H
+#define _HINATA_VECTOR_DISTANCE_H
+
+#include <stdint.h>
+
+/**
+ * 距离内核函数
+ */
+typedef float (*hinata_distance_fn_t)(const float *a, const float *b, uint32_t dim);
+
+/**
+ * 一组距离内核
+ */
+typedef struct {
+    const char *name;
+    hinata_distance_fn_t l2_squared;   // 欧氏距离的平方
+    hinata_distance_fn_t dot;          // 内积
+} hinata_distance_ops_t;
+
+/**
+ * 当前 CPU 上最快的实现
+ */
+const hinata_distance_ops_t *hinata_distance_ops(void);
+
+/**
+ * 标量实现，用于对照和不支持 SIMD 的平台
+ */
+const hinata_distance_ops_t *hinata_distance_ops_scalar(void);
+
+#endif /* _HINATA_VECTOR_DISTANCE_H */
@@ -0,0 +1,1188 @@
+/**
+ * HiNATA 向量索引 - C 语言实现
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "vector_index.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HINATA_VECTOR_DEFAULT_M 16
+#define HINATA_VECTOR_DEFAULT_EF_CONSTRUCTION 200
+#define HINATA_VECTOR_DEFAULT_EF_SEARCH 64
+#define HINATA_VECTOR_DEFAULT_SEED 0x9E3779B97F4A7C15ULL
+#define HINATA_VECTOR_MAX_LEVEL 16
+#define HINATA_VECTOR_MIN_SLOTS 64
+#define HINATA_VECTOR_COMPACT_MIN 64
+
+#define HINATA_VECTOR_FILE_MAGIC "HNTVIDX1"
+#define HINATA_VECTOR_FILE_VERSION 1
+#define HINATA_VECTOR_FILE_ALIGN 64
+
+/**
+ * 索引文件头，其后依次为按 64 字节对齐的向量、第 0 层邻接、元数据、
+ * 上层邻接和 ID 哈希表，均为本机字节序
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dim;
+    uint32_t metric;
+    uint32_t m;
+    uint32_t ef_construction;
+    uint32_t ef_search;
+    uint32_t seed;
+    uint32_t count;
+    uint32_t deleted_count;
+    uint32_t upper_used;
+    uint32_t slot_capacity;
+    uint32_t entry_point;
+    int32_t max_level;
+    uint32_t reserved;
+    uint64_t rng_state;
+    uint64_t vectors_offset;
+    uint64_t links_offset;
+    uint64_t meta_offset;
+    uint64_t upper_offset;
+    uint64_t slots_offset;
+    uint64_t file_size;
+} hinata_vector_file_header_t;
+
+/**
+ * 检索候选
+ */
+typedef struct {
+    float distance;
+    uint32_t node;
+} hinata_vector_cand_t;
+
+/**
+ * 二叉堆：max 为 true 时堆顶为最远候选
+ */
+typedef struct {
+    hinata_vector_cand_t *items;
+    uint32_t count;
+    uint32_t capacity;
+    bool max;
+} hinata_vector_heap_t;
+
+// ============================================================================
+// 堆
+// ============================================================================
+
+static bool hinata_heap_before(const hinata_vector_heap_t *heap, uint32_t a, uint32_t b)
+{
+    return heap->max ? heap->items[a].distance > heap->items[b].distance :
+                       heap->items[a].distance < heap->items[b].distance;
+}
+
+static void hinata_heap_swap(hinata_vector_heap_t *heap, uint32_t a, uint32_t b)
+{
+    hinata_vector_cand_t tmp = heap->items[a];
+
+    heap->items[a] = heap->items[b];
+    heap->items[b] = tmp;
+}
+
+static int hinata_heap_push(hinata_vector_heap_t *heap, float distance, uint32_t node)
+{
+    uint32_t i, parent;
+    int ret;
+
+    ret = hinata_vec_reserve((void **)&heap->items, &heap->capacity, heap->count + 1,
+                             sizeof(*heap->items));
+    if (ret < 0) {
+        return ret;
+    }
+
+    i = heap->count++;
+    heap->items[i].distance = distance;
+    heap->items[i].node = node;
+
+    while (i > 0) {
+        parent = (i - 1) / 2;
+        if (!hinata_heap_before(heap, i, parent)) {
+            break;
+        }
+        hinata_heap_swap(heap, i, parent);
+        i = parent;
+    }
+
+    return 0;
+}
+
+static hinata_vector_cand_t hinata_heap_pop(hinata_vector_heap_t *heap)
+{
+    hinata_vector_cand_t top = heap->items[0];
+    uint32_t i = 0, child;
+
+    heap->items[0] = heap->items[--heap->count];
+
+    for (;;) {
+        child = 2 * i + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && hinata_heap_before(heap, child + 1, child)) {
+            child++;
+        }
+        if (!hinata_heap_before(heap, child, i)) {
+            break;
+        }
+        hinata_heap_swap(heap, i, child);
+        i = child;
+    }
+
+    return top;
+}
+
+// ============================================================================
+// 内部工具函数
+// ============================================================================
+
+static float hinata_vector_distance(const hinata_vector_index_t *index, const float *a,
+                                    const float *b)
+{
+    switch (index->params.metric) {
+    case HINATA_VECTOR_METRIC_COSINE:
+        return 1.0f - index->ops->dot(a, b, index->params.dim);
+    case HINATA_VECTOR_METRIC_INNER_PRODUCT:
+        return -index->ops->dot(a, b, index->params.dim);
+    default:
+        return index->ops->l2_squared(a, b, index->params.dim);
+    }
+}
+
+static const float *hinata_vector_at(const hinata_vector_index_t *index, uint32_t node)
+{
+    return index->vectors + (size_t)node * index->params.dim;
+}
+
+static void hinata_vector_normalize(float *vector, uint32_t dim)
+{
+    float norm = 0.0f;
+    uint32_t i;
+
+    for (i = 0; i < dim; i++) {
+        norm += vector[i] * vector[i];
+    }
+    if (norm <= 0.0f) {
+        return;
+    }
+
+    norm = 1.0f / sqrtf(norm);
+    for (i = 0; i < dim; i++) {
+        vector[i] *= norm;
+    }
+}
+
+/**
+ * 节点在某层的邻接表，首槽为邻居数
+ */
+static uint32_t *hinata_vector_links(const hinata_vector_index_t *index, uint32_t node,
+                                     uint32_t level)
+{
+    if (level == 0) {
+        return index->links + (size_t)node * (1 + index->m0);
+    }
+
+    return index->upper_links + index->meta[node].upper_offset +
+           (size_t)(level - 1) * (1 + index->params.m);
+}
+
+static uint32_t hinata_vector_max_links(const hinata_vector_index_t *index, uint32_t level)
+{
+    return level == 0 ? index->m0 : index->params.m;
+}
+
+/**
+ * 为新节点随机选择层数
+ */
+static uint32_t hinata_vector_random_level(hinata_vector_index_t *index)
+{
+    uint64_t x = index->rng_state;
+    double uniform;
+    uint32_t level;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    index->rng_state = x;
+
+    uniform = (double)(((x * 0x2545F4914F6CDD1DULL) >> 11) + 1) * (1.0 / 9007199254740992.0);
+    level = (uint32_t)(-log(uniform) * index->level_mult);
+    return level < HINATA_VECTOR_MAX_LEVEL ? level : HINATA_VECTOR_MAX_LEVEL;
+}
+
+/**
+ * 开始新一轮遍历
+ */
+static void hinata_vector_visit_begin(hinata_vector_index_t *index)
+{
+    if (++index->visit_epoch == 0) {
+        memset(index->visit_marks, 0, index->capacity * sizeof(*index->visit_marks));
+        index->visit_epoch = 1;
+    }
+}
+
+static bool hinata_vector_visit(hinata_vector_index_t *index, uint32_t node)
+{
+    if (index->visit_marks[node] == index->visit_epoch) {
+        return false;
+    }
+
+    index->visit_marks[node] = index->visit_epoch;
+    return true;
+}
+
+static bool hinata_vector_filter_match(const hinata_vector_index_t *index, uint32_t node,
+                                       const hinata_vector_filter_t *filter)
+{
+    const hinata_vector_meta_t *meta = &index->meta[node];
+
+    if (meta->deleted) {
+        return false;
+    }
+    if (!filter) {
+        return true;
+    }
+    if (!(filter->access_mask & HINATA_VECTOR_ACCESS_BIT(meta->access)) ||
+        !(filter->kind_mask & HINATA_VECTOR_KIND_BIT(meta->kind))) {
+        return false;
+    }
+    if (filter->user_id && strncmp(filter->user_id, meta->user_id, HINATA_UUID_LEN) != 0) {
+        return false;
+    }
+
+    return !filter->accept || filter->accept(filter->ctx, meta);
+}
+
+// ============================================================================
+// ID 哈希表
+// ============================================================================
+
+static uint32_t hinata_vector_hash(const char *id)
+{
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < HINATA_UUID_LEN - 1 && id[i]; i++) {
+        hash ^= (uint8_t)id[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static uint32_t hinata_vector_slot(const hinata_vector_index_t *index, const char *id)
+{
+    uint32_t mask = index->slot_capacity - 1;
+    uint32_t slot = hinata_vector_hash(id) & mask;
+    uint32_t entry;
+
+    while ((entry = index->slots[slot]) != 0) {
+        if (strncmp(index->meta[entry - 1].id, id, HINATA_UUID_LEN - 1) == 0) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return slot;
+}
+
+static int hinata_vector_rehash(hinata_vector_index_t *index, uint32_t slot_capacity)
+{
+    uint32_t *old_slots = index->slots;
+    uint32_t old_capacity = index->slot_capacity;
+    uint32_t i, entry;
+
+    index->slots = calloc(slot_capacity, sizeof(*index->slots));
+    if (!index->slots) {
+        index->slots = old_slots;
+        return -ENOMEM;
+    }
+
+    index->slot_capacity = slot_capacity;
+    for (i = 0; i < old_capacity; i++) {
+        entry = old_slots[i];
+        if (entry) {
+            index->slots[hinata_vector_slot(index, index->meta[entry - 1].id)] = entry;
+        }
+    }
+
+    free(old_slots);
+    return 0;
+}
+
+// ============================================================================
+// 存储管理
+// ============================================================================
+
+/**
+ * 把 mmap 映射的内容复制到堆上，之后才能修改
+ */
+static int hinata_vector_materialize(hinata_vector_index_t *index)
+{
+    hinata_vector_index_t copy;
+    size_t dim = index->params.dim;
+
+    if (!index->mapping) {
+        return 0;
+    }
+
+    copy = *index;
+    copy.vectors = malloc((index->count ? index->count : 1) * dim * sizeof(float));
+    copy.links = malloc((index->count ? index->count : 1) * (1 + (size_t)index->m0) *
+                        sizeof(uint32_t));
+    copy.meta = malloc((index->count ? index->count : 1) * sizeof(*copy.meta));
+    copy.upper_links = malloc((index->upper_used ? index->upper_used : 1) * sizeof(uint32_t));
+    copy.slots = malloc(index->slot_capacity * sizeof(uint32_t));
+    if (!copy.vectors || !copy.links || !copy.meta || !copy.upper_links || !copy.slots) {
+        free(copy.vectors);
+        free(copy.links);
+        free(copy.meta);
+        free(copy.upper_links);
+        free(copy.slots);
+        return -ENOMEM;
+    }
+
+    memcpy(copy.vectors, index->vectors, index->count * dim * sizeof(float));
+    memcpy(copy.links, index->links, index->count * (1 + (size_t)index->m0) * sizeof(uint32_t));
+    memcpy(copy.meta, index->meta, index->count * sizeof(*copy.meta));
+    memcpy(copy.upper_links, index->upper_links, index->upper_used * sizeof(uint32_t));
+    memcpy(copy.slots, index->slots, index->slot_capacity * sizeof(uint32_t));
+    copy.upper_capacity = index->upper_used ? index->upper_used : 1;
+
+    munmap(index->mapping, index->mapping_size);
+    copy.mapping = NULL;
+    copy.mapping_size = 0;
+    *index = copy;
+    return 0;
+}
+
+/**
+ * 保证还能再容纳一个节点
+ */
+static int hinata_vector_reserve(hinata_vector_index_t *index)
+{
+    uint32_t capacity;
+    size_t dim = index->params.dim;
+    float *vectors;
+    uint32_t *links;
+    uint32_t *marks;
+    hinata_vector_meta_t *meta;
+    int ret;
+
+    if ((index->count + 1) * 2 > index->slot_capacity) {
+        ret = hinata_vector_rehash(index, index->slot_capacity ? index->slot_capacity * 2 :
+                                   HINATA_VECTOR_MIN_SLOTS);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    if (index->count < index->capacity) {
+        return 0;
+    }
+    if (index->capacity > UINT32_MAX / 2) {
+        return -EOVERFLOW;
+    }
+
+    capacity = index->capacity ? index->capacity * 2 : 64;
+
+    // 逐个扩容，任一失败时已扩容的数组仍然有效
+    vectors = realloc(index->vectors, capacity * dim * sizeof(float));
+    if (!vectors) {
+        return -ENOMEM;
+    }
+    index->vectors = vectors;
+
+    links = realloc(index->links, capacity * (1 + (size_t)index->m0) * sizeof(uint32_t));
+    if (!links) {
+        return -ENOMEM;
+    }
+    index->links = links;
+
+    meta = realloc(index->meta, capacity * sizeof(*meta));
+    if (!meta) {
+        return -ENOMEM;
+    }
+    index->meta = meta;
+
+    marks = realloc(index->visit_marks, capacity * sizeof(*marks));
+    if (!marks) {
+        return -ENOMEM;
+    }
+    memset(marks + index->capacity, 0, (capacity - index->capacity) * sizeof(*marks));
+    index->visit_marks = marks;
+
+    index->capacity = capacity;
+    return 0;
+}
+
+// ============================================================================
+// 图遍历
+// ============================================================================
+
+/**
+ * 在单层上贪心下降到离 query 最近的节点
+ */
+static void hinata_vector_greedy(const hinata_vector_index_t *index, const float *query,
+                                 uint32_t level, uint32_t *node, float *distance)
+{
+    const uint32_t *links;
+    bool changed = true;
+    float d;
+    uint32_t i;
+
+    while (changed) {
+        changed = false;
+        links = hinata_vector_links(index, *node, level);
+        for (i = 1; i <= links[0]; i++) {
+            d = hinata_vector_distance(index, query, hinata_vector_at(index, links[i]));
+            if (d < *distance) {
+                *distance = d;
+                *node = links[i];
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * 单层 beam 搜索，results 为最多 ef 项的最大堆
+ * include_deleted 为 true 时忽略 filter，用于构图
+ */
+static int hinata_vector_search_layer(hinata_vector_index_t *index, const float *query,
+                                      uint32_t entry, float entry_distance, uint32_t ef,
+                                      uint32_t level, const hinata_vector_filter_t *filter,
+                                      bool include_deleted, hinata_vector_heap_t *results)
+{
+    hinata_vector_heap_t candidates = { .max = false };
+    hinata_vector_cand_t current;
+    const uint32_t *links;
+    uint32_t i, neighbor;
+    float d;
+    int ret;
+
+    results->count = 0;
+    hinata_vector_visit_begin(index);
+    hinata_vector_visit(index, entry);
+
+    ret = hinata_heap_push(&candidates, entry_distance, entry);
+    if (!ret && (include_deleted || hinata_vector_filter_match(index, entry, filter))) {
+        ret = hinata_heap_push(results, entry_distance, entry);
+    }
+
+    while (!ret && candidates.count > 0) {
+        current = hinata_heap_pop(&candidates);
+        if (results->count >= ef && current.distance > results->items[0].distance) {
+            break;
+        }
+
+        links = hinata_vector_links(index, current.node, level);
+        for (i = 1; !ret && i <= links[0]; i++) {
+            neighbor = links[i];
+            if (!hinata_vector_visit(index, neighbor)) {
+                continue;
+            }
+
+            d = hinata_vector_distance(index, query, hinata_vector_at(index, neighbor));
+            if (results->count >= ef && d >= results->items[0].distance) {
+                continue;
+            }
+
+            // 被过滤的节点仍作为路径参与遍历，只是不进入结果
+            ret = hinata_heap_push(&candidates, d, neighbor);
+            if (ret || !(include_deleted || hinata_vector_filter_match(index, neighbor, filter))) {
+                continue;
+            }
+
+            ret = hinata_heap_push(results, d, neighbor);
+            if (!ret && results->count > ef) {
+                hinata_heap_pop(results);
+            }
+        }
+    }
+
+    free(candidates.items);
+    return ret;
+}
+
+static int hinata_vector_cand_cmp(const void *a, const void *b)
+{
+    const hinata_vector_cand_t *x = a;
+    const hinata_vector_cand_t *y = b;
+
+    if (x->distance != y->distance) {
+        return x->distance < y->distance ? -1 : 1;
+    }
+    return x->node < y->node ? -1 : x->node > y->node;
+}
+
+/**
+ * 启发式邻居选择：候选按距离升序，只保留比已选邻居更靠近基准点的候选
+ * 返回写入 out 的个数
+ */
+static uint32_t hinata_vector_select(const hinata_vector_index_t *index,
+                                     const hinata_vector_cand_t *sorted, uint32_t count,
+                                     uint32_t max, uint32_t *out)
+{
+    uint32_t selected = 0;
+    uint32_t i, j;
+    bool keep;
+
+    for (i = 0; i < count && selected < max; i++) {
+        keep = true;
+        for (j = 0; j < selected; j++) {
+            if (hinata_vector_distance(index, hinata_vector_at(index, sorted[i].node),
+                                       hinata_vector_at(index, out[j])) < sorted[i].distance) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            out[selected++] = sorted[i].node;
+        }
+    }
+
+    return selected;
+}
+
+/**
+ * 把 node 加入 neighbor 在 level 层的邻接，满时重新选择
+ */
+static int hinata_vector_link_back(hinata_vector_index_t *index, uint32_t neighbor,
+                                   uint32_t node, uint32_t level)
+{
+    uint32_t *links = hinata_vector_links(index, neighbor, level);
+    uint32_t max = hinata_vector_max_links(index, level);
+    const float *base = hinata_vector_at(index, neighbor);
+    hinata_vector_cand_t *cands;
+    uint32_t i;
+
+    if (links[0] < max) {
+        links[++links[0]] = node;
+        return 0;
+    }
+
+    cands = malloc((max + 1) * sizeof(*cands));
+    if (!cands) {
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < max; i++) {
+        cands[i].node = links[i + 1];
+        cands[i].distance = hinata_vector_distance(index, base, hinata_vector_at(index, links[i + 1]));
+    }
+    cands[max].node = node;
+    cands[max].distance = hinata_vector_distance(index, base, hinata_vector_at(index, node));
+
+    qsort(cands, max + 1, sizeof(*cands), hinata_vector_cand_cmp);
+    links[0] = hinata_vector_select(index, cands, max + 1, max, links + 1);
+
+    free(cands);
+    return 0;
+}
+
+/**
+ * 把新节点接入 level 层：results 为该层的搜索结果
+ */
+static int hinata_vector_connect(hinata_vector_index_t *index, uint32_t node, uint32_t level,
+                                 hinata_vector_heap_t *results)
+{
+    uint32_t *links = hinata_vector_links(index, node, level);
+    uint32_t max = hinata_vector_max_links(index, level);
+    uint32_t i;
+    int ret = 0;
+
+    qsort(results->items, results->count, sizeof(*results->items), hinata_vector_cand_cmp);
+    links[0] = hinata_vector_select(index, results->items, results->count, max, links + 1);
+
+    for (i = 1; !ret && i <= links[0]; i++) {
+        ret = hinata_vector_link_back(index, links[i], node, level);
+    }
+
+    return ret;
+}
+
+// ============================================================================
+// 初始化与释放
+// ============================================================================
+
+int hinata_vector_index_init(hinata_vector_index_t *index, const hinata_vector_params_t *params)
+{
+    if (!index || !params || params->dim == 0 ||
+        (uint32_t)params->metric > HINATA_VECTOR_METRIC_INNER_PRODUCT) {
+        return -EINVAL;
+    }
+
+    memset(index, 0, sizeof(*index));
+    index->params = *params;
+    if (!index->params.m) {
+        index->params.m = HINATA_VECTOR_DEFAULT_M;
+    }
+    if (index->params.m < 2) {
+        index->params.m = 2;
+    }
+    if (!index->params.ef_construction) {
+        index->params.ef_construction = HINATA_VECTOR_DEFAULT_EF_CONSTRUCTION;
+    }
+    if (!index->params.ef_search) {
+        index->params.ef_search = HINATA_VECTOR_DEFAULT_EF_SEARCH;
+    }
+
+    index->m0 = 2 * index->params.m;
+    index->level_mult = 1.0 / log((double)index->params.m);
+    index->ops = hinata_distance_ops();
+    index->rng_state = index->params.seed ? index->params.seed : HINATA_VECTOR_DEFAULT_SEED;
+    index->max_level = -1;
+    return 0;
+}
+
+void hinata_vector_index_free(hinata_vector_index_t *index)
+{
+    if (!index) {
+        return;
+    }
+
+    if (index->mapping) {
+        munmap(index->mapping, index->mapping_size);
+    } else {
+        free(index->vectors);
+        free(index->links);
+        free(index->meta);
+        free(index->upper_links);
+        free(index->slots);
+    }
+    free(index->visit_marks);
+    memset(index, 0, sizeof(*index));
+}
+
+// ============================================================================
+// 插入与删除
+// ============================================================================
+
+/**
+ * 墓碑超过一半时重建；重建失败不影响本次修改，下次修改时再尝试
+ */
+static void hinata_vector_compact_if_needed(hinata_vector_index_t *index)
+{
+    if (index->count >= HINATA_VECTOR_COMPACT_MIN && index->deleted_count * 2 >= index->count) {
+        hinata_vector_index_compact(index);
+    }
+}
+
+int hinata_vector_index_insert(hinata_vector_index_t *index, const hinata_uuid_t id,
+                               const hinata_uuid_t user_id, hinata_vector_kind_t kind,
+                               hinata_access_level_t access, const float *vector)
+{
+    hinata_vector_heap_t results = { .max = true };
+    hinata_vector_meta_t *meta;
+    uint32_t level, l, node, slot, entry, upper;
+    uint32_t current;
+    float current_distance;
+    float *stored;
+    int ret;
+
+    if (!index || !id || !*id || !vector ||
+        (uint32_t)kind > HINATA_VECTOR_KIND_LIBRARY_ITEM ||
+        (uint32_t)access > HINATA_ACCESS_WEB3_PUBLISHED) {
+        return -EINVAL;
+    }
+
+    ret = hinata_vector_materialize(index);
+    if (!ret) {
+        ret = hinata_vector_reserve(index);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    level = hinata_vector_random_level(index);
+    upper = level * (1 + index->params.m);
+    ret = hinata_vec_reserve((void **)&index->upper_links, &index->upper_capacity,
+                             index->upper_used + upper, sizeof(*index->upper_links));
+    if (ret < 0) {
+        return ret;
+    }
+
+    node = index->count;
+    stored = index->vectors + (size_t)node * index->params.dim;
+    memcpy(stored, vector, index->params.dim * sizeof(float));
+    if (index->params.metric == HINATA_VECTOR_METRIC_COSINE) {
+        hinata_vector_normalize(stored, index->params.dim);
+    }
+
+    meta = &index->meta[node];
+    memset(meta, 0, sizeof(*meta));
+    hinata_uuid_assign(meta->id, id);
+    if (user_id) {
+        hinata_uuid_assign(meta->user_id, user_id);
+    }
+    meta->kind = kind;
+    meta->access = access;
+    meta->level = level;
+    meta->upper_offset = index->upper_used;
+
+    index->links[(size_t)node * (1 + index->m0)] = 0;
+    if (upper) {
+        memset(index->upper_links + index->upper_used, 0, upper * sizeof(*index->upper_links));
+        index->upper_used += upper;
+    }
+    index->count++;
+
+    // 同一 ID 再次插入时旧节点变为墓碑
+    slot = hinata_vector_slot(index, id);
+    entry = index->slots[slot];
+    if (entry && !index->meta[entry - 1].deleted) {
+        index->meta[entry - 1].deleted = 1;
+        index->deleted_count++;
+    }
+    index->slots[slot] = node + 1;
+
+    if (index->max_level < 0) {
+        index->entry_point = node;
+        index->max_level = level;
+        return 0;
+    }
+
+    current = index->entry_point;
+    current_distance = hinata_vector_distance(index, stored, hinata_vector_at(index, current));
+    for (l = index->max_level; l > level; l--) {
+        hinata_vector_greedy(index, stored, l, &current, &current_distance);
+    }
+
+    for (l = level < (uint32_t)index->max_level ? level : (uint32_t)index->max_level; ; l--) {
+        ret = hinata_vector_search_layer(index, stored, current, current_distance,
+                                         index->params.ef_construction, l, NULL, true, &results);
+        if (!ret) {
+            // 下一层从本层最近的节点出发
+            qsort(results.items, results.count, sizeof(*results.items), hinata_vector_cand_cmp);
+            current = results.items[0].node;
+            current_distance = results.items[0].distance;
+            ret = hinata_vector_connect(index, node, l, &results);
+        }
+        if (ret < 0 || l == 0) {
+            break;
+        }
+    }
+
+    free(results.items);
+
+    if ((int32_t)level > index->max_level) {
+        index->entry_point = node;
+        index->max_level = level;
+    }
+
+    if (!ret) {
+        hinata_vector_compact_if_needed(index);
+    }
+    return ret;
+}
+
+int hinata_vector_index_remove(hinata_vector_index_t *index, const hinata_uuid_t id)
+{
+    uint32_t entry = 0;
+    int ret;
+
+    if (!index || !id || !*id) {
+        return -EINVAL;
+    }
+
+    if (index->slot_capacity) {
+        entry = index->slots[hinata_vector_slot(index, id)];
+    }
+    if (!entry || index->meta[entry - 1].deleted) {
+        return -ENOENT;
+    }
+
+    ret = hinata_vector_materialize(index);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // 墓碑节点仍保留在图中作为路径，只是不再出现在结果里
+    index->meta[entry - 1].deleted = 1;
+    index->deleted_count++;
+    hinata_vector_compact_if_needed(index);
+    return 0;
+}
+
+int hinata_vector_index_compact(hinata_vector_index_t *index)
+{
+    hinata_vector_index_t compacted;
+    const hinata_vector_meta_t *meta;
+    uint32_t node;
+    int ret;
+
+    if (!index) {
+        return -EINVAL;
+    }
+    if (!index->deleted_count) {
+        return 0;
+    }
+
+    // 只把有效节点重新插入新图，失败时原索引保持不变
+    ret = hinata_vector_index_init(&compacted, &index->params);
+    if (ret < 0) {
+        return ret;
+    }
+    compacted.rng_state = index->rng_state;
+
+    for (node = 0; !ret && node < index->count; node++) {
+        meta = &index->meta[node];
+        if (!meta->deleted) {
+            ret = hinata_vector_index_insert(&compacted, meta->id, meta->user_id, meta->kind,
+                                             meta->access, hinata_vector_at(index, node));
+        }
+    }
+    if (ret < 0) {
+        hinata_vector_index_free(&compacted);
+        return ret;
+    }
+
+    hinata_vector_index_free(index);
+    *index = compacted;
+    return 0;
+}
+
+// ============================================================================
+// 检索
+// ============================================================================
+
+int hinata_vector_index_search(hinata_vector_index_t *index, const float *query, uint32_t k,
+                               const hinata_vector_filter_t *filter, uint32_t ef,
+                               hinata_vector_hit_t *hits, uint32_t *hit_count)
+{
+    hinata_vector_heap_t results = { .max = true };
+    hinata_vector_cand_t cand;
+    float *normalized = NULL;
+    uint32_t current, l, i;
+    float current_distance;
+    int ret;
+
+    if (!index || !query || !hits || !hit_count || k == 0) {
+        return -EINVAL;
+    }
+
+    *hit_count = 0;
+    if (index->max_level < 0) {
+        return 0;
+    }
+
+    if (index->params.metric == HINATA_VECTOR_METRIC_COSINE) {
+        normalized = malloc(index->params.dim * sizeof(float));
+        if (!normalized) {
+            return -ENOMEM;
+        }
+        memcpy(normalized, query, index->params.dim * sizeof(float));
+        hinata_vector_normalize(normalized, index->params.dim);
+        query = normalized;
+    }
+
+    if (!ef) {
+        ef = index->params.ef_search;
+    }
+    if (ef < k) {
+        ef = k;
+    }
+
+    current = index->entry_point;
+    current_distance = hinata_vector_distance(index, query, hinata_vector_at(index, current));
+    for (l = index->max_level; l > 0; l--) {
+        hinata_vector_greedy(index, query, l, &current, &current_distance);
+    }
+
+    ret = hinata_vector_search_layer(index, query, current, current_distance, ef, 0, filter,
+                                     false, &results);
+    if (!ret) {
+        while (results.count > k) {
+            hinata_heap_pop(&results);
+        }
+
+        // 最大堆依次弹出最远项，倒序写入即为升序
+        *hit_count = results.count;
+        for (i = results.count; i > 0; i--) {
+            cand = hinata_heap_pop(&results);
+            hinata_uuid_assign(hits[i - 1].id, index->meta[cand.node].id);
+            hits[i - 1].kind = index->meta[cand.node].kind;
+            hits[i - 1].distance = cand.distance;
+        }
+    }
+
+    free(results.items);
+    free(normalized);
+    return ret;
+}
+
+uint32_t hinata_vector_index_size(const hinata_vector_index_t *index)
+{
+    return index->count - index->deleted_count;
+}
+
+// ============================================================================
+// 持久化
+// ============================================================================
+
+static uint64_t hinata_vector_align(uint64_t offset)
+{
+    return (offset + HINATA_VECTOR_FILE_ALIGN - 1) & ~(uint64_t)(HINATA_VECTOR_FILE_ALIGN - 1);
+}
+
+/**
+ * 计算各段偏移
+ */
+static void hinata_vector_layout(hinata_vector_file_header_t *header)
+{
+    uint64_t offset = hinata_vector_align(sizeof(*header));
+
+    header->vectors_offset = offset;
+    offset = hinata_vector_align(offset + (uint64_t)header->count * header->dim * sizeof(float));
+    header->links_offset = offset;
+    offset = hinata_vector_align(offset + (uint64_t)header->count * (1 + 2 * header->m) *
+                                 sizeof(uint32_t));
+    header->meta_offset = offset;
+    offset = hinata_vector_align(offset + (uint64_t)header->count * sizeof(hinata_vector_meta_t));
+    header->upper_offset = offset;
+    offset = hinata_vector_align(offset + (uint64_t)header->upper_used * sizeof(uint32_t));
+    header->slots_offset = offset;
+    header->file_size = offset + (uint64_t)header->slot_capacity * sizeof(uint32_t);
+}
+
+static int hinata_vector_write_at(FILE *file, uint64_t offset, const void *data, size_t size)
+{
+    static const char zeros[HINATA_VECTOR_FILE_ALIGN];
+    long position = ftell(file);
+
+    while (position >= 0 && (uint64_t)position < offset) {
+        size_t pad = offset - position < sizeof(zeros) ? offset - position : sizeof(zeros);
+        if (fwrite(zeros, 1, pad, file) != pad) {
+            return -EIO;
+        }
+        position += pad;
+    }
+    if (position < 0) {
+        return -EIO;
+    }
+
+    return size && fwrite(data, 1, size, file) != size ? -EIO : 0;
+}
+
+int hinata_vector_index_save(const hinata_vector_index_t *index, const char *path)
+{
+    hinata_vector_file_header_t header;
+    FILE *file;
+    int ret;
+
+    if (!index || !path) {
+        return -EINVAL;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HINATA_VECTOR_FILE_MAGIC, sizeof(header.magic));
+    header.version = HINATA_VECTOR_FILE_VERSION;
+    header.dim = index->params.dim;
+    header.metric = index->params.metric;
+    header.m = index->params.m;
+    header.ef_construction = index->params.ef_construction;
+    header.ef_search = index->params.ef_search;
+    header.seed = index->params.seed;
+    header.count = index->count;
+    header.deleted_count = index->deleted_count;
+    header.upper_used = index->upper_used;
+    header.slot_capacity = index->slot_capacity;
+    header.entry_point = index->entry_point;
+    header.max_level = index->max_level;
+    header.rng_state = index->rng_state;
+    hinata_vector_layout(&header);
+
+    file = fopen(path, "wb");
+    if (!file) {
+        return -errno;
+    }
+
+    ret = hinata_vector_write_at(file, 0, &header, sizeof(header));
+    if (!ret) {
+        ret = hinata_vector_write_at(file, header.vectors_offset, index->vectors,
+                                     (size_t)index->count * index->params.dim * sizeof(float));
+    }
+    if (!ret) {
+        ret = hinata_vector_write_at(file, header.links_offset, index->links,
+                                     (size_t)index->count * (1 + index->m0) * sizeof(uint32_t));
+    }
+    if (!ret) {
+        ret = hinata_vector_write_at(file, header.meta_offset, index->meta,
+                                     (size_t)index->count * sizeof(*index->meta));
+    }
+    if (!ret) {
+        ret = hinata_vector_write_at(file, header.upper_offset, index->upper_links,
+                                     (size_t)index->upper_used * sizeof(uint32_t));
+    }
+    if (!ret) {
+        ret = hinata_vector_write_at(file, header.slots_offset, index->slots,
+                                     (size_t)index->slot_capacity * sizeof(uint32_t));
+    }
+
+    if (fclose(file) != 0 && !ret) {
+        ret = -EIO;
+    }
+    return ret;
+}
+
+/**
+ * 逐项校验加载的元数据、ID 哈希表和邻接
+ */
+static int hinata_vector_validate(const hinata_vector_index_t *index)
+{
+    const hinata_vector_meta_t *meta;
+    const uint32_t *links;
+    uint32_t node, level, i;
+    uint32_t deleted = 0;
+
+    if (index->count && index->meta[index->entry_point].level != index->max_level) {
+        return -EINVAL;
+    }
+
+    for (i = 0; i < index->slot_capacity; i++) {
+        if (index->slots[i] > index->count) {
+            return -EINVAL;
+        }
+    }
+
+    for (node = 0; node < index->count; node++) {
+        meta = &index->meta[node];
+        if (meta->kind > HINATA_VECTOR_KIND_LIBRARY_ITEM ||
+            meta->access > HINATA_ACCESS_WEB3_PUBLISHED || meta->deleted > 1 ||
+            (int32_t)meta->level > index->max_level ||
+            (uint64_t)meta->upper_offset + (uint64_t)meta->level * (1 + index->params.m) >
+                index->upper_used) {
+            return -EINVAL;
+        }
+        deleted += meta->deleted;
+
+        // 邻居在该层也必须存在，否则遍历会读到别的节点的上层邻接
+        for (level = 0; level <= meta->level; level++) {
+            links = hinata_vector_links(index, node, level);
+            if (links[0] > hinata_vector_max_links(index, level)) {
+                return -EINVAL;
+            }
+            for (i = 1; i <= links[0]; i++) {
+                if (links[i] >= index->count || index->meta[links[i]].level < level) {
+                    return -EINVAL;
+                }
+            }
+        }
+    }
+
+    return deleted == index->deleted_count ? 0 : -EINVAL;
+}
+
+int hinata_vector_index_load(hinata_vector_index_t *index, const char *path)
+{
+    const hinata_vector_file_header_t *header;
+    hinata_vector_file_header_t expected;
+    hinata_vector_params_t params;
+    struct stat st;
+    void *mapping;
+    char *base;
+    int fd;
+    int ret;
+
+    if (!index || !path) {
+        return -EINVAL;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -errno;
+    }
+    if (fstat(fd, &st) < 0) {
+        ret = -errno;
+        close(fd);
+        return ret;
+    }
+    if ((size_t)st.st_size < sizeof(*header)) {
+        close(fd);
+        return -EINVAL;
+    }
+
+    mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return -errno;
+    }
+
+    // 偏移由头部字段重新推导，不信任文件中记录的值
+    header = mapping;
+    expected = *header;
+    hinata_vector_layout(&expected);
+    if (memcmp(header->magic, HINATA_VECTOR_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != HINATA_VECTOR_FILE_VERSION ||
+        memcmp(header, &expected, sizeof(expected)) != 0 ||
+        expected.file_size > (uint64_t)st.st_size ||
+        header->slot_capacity == 0 || (header->slot_capacity & (header->slot_capacity - 1)) ||
+        header->slot_capacity < header->count * 2 || header->max_level > HINATA_VECTOR_MAX_LEVEL ||
+        header->deleted_count > header->count ||
+        (header->count ? header->entry_point >= header->count : header->max_level != -1)) {
+        munmap(mapping, st.st_size);
+        return -EINVAL;
+    }
+
+    memset(&params, 0, sizeof(params));
+    params.dim = header->dim;
+    params.metric = header->metric;
+    params.m = header->m;
+    params.ef_construction = header->ef_construction;
+    params.ef_search = header->ef_search;
+    params.seed = header->seed;
+
+    ret = hinata_vector_index_init(index, &params);
+    if (!ret && index->m0 != 2 * header->m) {
+        ret = -EINVAL;
+    }
+    if (!ret) {
+        index->visit_marks = calloc(header->count ? header->count : 1, sizeof(uint32_t));
+        if (!index->visit_marks) {
+            ret = -ENOMEM;
+        }
+    }
+    if (ret < 0) {
+        munmap(mapping, st.st_size);
+        return ret;
+    }
+
+    base = mapping;
+    index->vectors = (float *)(base + header->vectors_offset);
+    index->links = (uint32_t *)(base + header->links_offset);
+    index->meta = (hinata_vector_meta_t *)(base + header->meta_offset);
+    index->upper_links = (uint32_t *)(base + header->upper_offset);
+    index->slots = (uint32_t *)(base + header->slots_offset);
+    index->count = header->count;
+    index->capacity = header->count;
+    index->deleted_count = header->deleted_count;
+    index->upper_used = header->upper_used;
+    index->upper_capacity = header->upper_used;
+    index->slot_capacity = header->slot_capacity;
+    index->entry_point = header->entry_point;
+    index->max_level = header->max_level;
+    index->rng_state = header->rng_state;
+    index->mapping = mapping;
+    index->mapping_size = st.st_size;
+
+    // 映射内容之后直接用于遍历，越界的偏移或邻居下标在这里拒绝
+    ret = hinata_vector_validate(index);
+    if (ret < 0) {
+        hinata_vector_index_free(index);
+    }
+    return ret;
+}
@@ -0,0 +1,181 @@
+/**
+ * HiNATA 向量索引 - C 语言定义
+ *
+ * 基于 HNSW（分层可导航小世界图）的近似最近邻索引，为数据包和知识块的
+ * 嵌入向量提供语义检索。支持增量插入与删除（删除为墓碑标记，
+ * 墓碑超过一半时自动重建），检索时按 user_id、访问级别和对象类型过滤。
+ *
+ * 索引文件的布局与内存中的数组一致，加载时直接 mmap，无需重建；
+ * 第一次修改时才把映射内容复制到堆上。
+ *
+ * 索引不是线程安全的，并发访问由调用方加锁。
+ */
+
+#ifndef _HINATA_VECTOR_INDEX_H
+#define _HINATA_VECTOR_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "models.h"
+#include "compact_block.h"
+#include "vector_distance.h"
+
+// ============================================================================
+// 基础类型定义
+// ============================================================================
+
+/**
+ * 距离度量
+ */
+typedef enum {
+    HINATA_VECTOR_METRIC_L2 = 0,
+    HINATA_VECTOR_METRIC_COSINE = 1,     // 插入和查询时归一化，按 1 - 内积计算
+    HINATA_VECTOR_METRIC_INNER_PRODUCT = 2
+} hinata_vector_metric_t;
+
+/**
+ * 被索引的对象类型
+ */
+typedef enum {
+    HINATA_VECTOR_KIND_PACKET = 0,
+    HINATA_VECTOR_KIND_BLOCK = 1,
+    HINATA_VECTOR_KIND_LIBRARY_ITEM = 2
+} hinata_vector_kind_t;
+
+#define HINATA_VECTOR_KIND_BIT(kind) (1U << (kind))
+#define HINATA_VECTOR_ACCESS_BIT(access) (1U << (access))
+#define HINATA_VECTOR_MASK_ALL 0xFFFFFFFFU
+
+/**
+ * 索引参数，取 0 的字段使用默认值
+ */
+typedef struct {
+    uint32_t dim;
+    hinata_vector_metric_t metric;
+    uint16_t m;                 // 上层每个节点的邻居数，第 0 层为 2 * m
+    uint16_t ef_construction;
+    uint16_t ef_search;
+    uint32_t seed;
+} hinata_vector_params_t;
+
+/**
+ * 节点元数据
+ */
+typedef struct {
+    hinata_uuid_t id;
+    hinata_uuid_t user_id;
+    uint8_t kind;
+    uint8_t access;
+    uint8_t level;
+    uint8_t deleted;
+    uint32_t upper_offset;      // 上层邻接在 upper_links 中的起始位置
+} hinata_vector_meta_t;
+
+/**
+ * 检索过滤条件
+ * user_id 为 NULL 表示不限用户；accept 为可选的附加判断
+ */
+typedef struct {
+    const char *user_id;
+    uint32_t access_mask;
+    uint32_t kind_mask;
+    bool (*accept)(void *ctx, const hinata_vector_meta_t *meta);
+    void *ctx;
+} hinata_vector_filter_t;
+
+/**
+ * 检索结果
+ */
+typedef struct {
+    hinata_uuid_t id;
+    hinata_vector_kind_t kind;
+    float distance;
+} hinata_vector_hit_t;
+
+/**
+ * 向量索引
+ */
+typedef struct {
+    hinata_vector_params_t params;
+    uint32_t m0;
+    double level_mult;
+    const hinata_distance_ops_t *ops;
+
+    // 节点数据，下标即节点 ID
+    float *vectors;                 // count * dim
+    uint32_t *links;                // 第 0 层：每节点 1 + m0 个槽，首槽为邻居数
+    hinata_vector_meta_t *meta;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t deleted_count;
+
+    // 上层邻接：每层 1 + m 个槽
+    uint32_t *upper_links;
+    uint32_t upper_used;
+    uint32_t upper_capacity;
+
+    // 外部 ID -> 节点 ID，开放寻址，存放节点 ID + 1
+    uint32_t *slots;
+    uint32_t slot_capacity;
+
+    uint32_t entry_point;
+    int32_t max_level;
+    uint64_t rng_state;
+
+    // 遍历标记
+    uint32_t *visit_marks;
+    uint32_t visit_epoch;
+
+    // mmap 加载时的映射
+    void *mapping;
+    size_t mapping_size;
+} hinata_vector_index_t;
+
+// ============================================================================
+// 函数声明
+// ============================================================================
+
+/**
+ * 初始化与释放
+ * 所有返回 int 的函数成功返回 0，失败返回负的 errno
+ */
+int hinata_vector_index_init(hinata_vector_index_t *index, const hinata_vector_params_t *params);
+void hinata_vector_index_free(hinata_vector_index_t *index);
+
+/**
+ * 插入与删除
+ * 插入已存在的 ID 会替换旧向量；删除不存在的 ID 返回 -ENOENT
+ */
+int hinata_vector_index_insert(hinata_vector_index_t *index, const hinata_uuid_t id,
+                               const hinata_uuid_t user_id, hinata_vector_kind_t kind,
+                               hinata_access_level_t access, const float *vector);
+int hinata_vector_index_remove(hinata_vector_index_t *index, const hinata_uuid_t id);
+
+/**
+ * 去掉墓碑节点重建索引，失败时索引保持不变
+ */
+int hinata_vector_index_compact(hinata_vector_index_t *index);
+
+/**
+ * k 近邻检索，结果按距离升序写入 hits
+ * filter 可为 NULL；ef 为 0 时使用 params.ef_search
+ */
+int hinata_vector_index_search(hinata_vector_index_t *index, const float *query, uint32_t k,
+                               const hinata_vector_filter_t *filter, uint32_t ef,
+                               hinata_vector_hit_t *hits, uint32_t *hit_count);
+
+/**
+ * 有效（未删除）节点数
+ */
+uint32_t hinata_vector_index_size(const hinata_vector_index_t *index);
+
+/**
+ * 持久化
+ * load 以只读方式映射文件，index 不需要事先初始化
+ */
+int hinata_vector_index_save(const hinata_vector_index_t *index, const char *path);
+int hinata_vector_index_load(hinata_vector_index_t *index, const char *path);
+
+#endif /* _HINATA_VECTOR_INDEX_H */
@@ -0,0 +1,590 @@
+/*
+ * HiNATA Configuration Registry - Kernel Implementation
+ * Part of notcontrolOS Knowledge Management System
+ *
+ * This file implements the typed configuration registry. Readers load
+ * the current snapshot under rcu_read_lock(); writers serialize on a
+ * mutex, publish a modified copy with rcu_assign_pointer() and free the
+ * previous one after a grace period.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/mutex.h>
+#include <linux/rcupdate.h>
+#include <linux/notifier.h>
+#include <linux/stddef.h>
+
+#include "../hinata_types.h"
+#include "../hinata_core.h"
+#include "../storage/hinata_storage.h"
+#include "../kernel/hinata_syscalls.h"
+#include "hinata_health.h"
+#include "hinata_config.h"
+
+/**
+ * struct hinata_config_param - Registry entry
+ * @key: Parameter name
+ * @type: Parameter type
+ * @offset: Offset of the value in struct hinata_config
+ * @size: Size of the value in bytes
+ * @min: Minimum accepted value (integers only)
+ * @max: Maximum accepted value (integers only)
+ * @check: Additional validation of new values (strings only), may be NULL
+ */
+struct hinata_config_param {
+    const char *key;
+    enum hinata_config_type type;
+    size_t offset;
+    size_t size;
+    u32 min;
+    u32 max;
+    int (*check)(const char *value);
+};
+
+#define HINATA_CONFIG_PARAM(_key, _type, _field, _min, _max) {      \
+    .key = _key,                                                    \
+    .type = _type,                                                  \
+    .offset = offsetof(struct hinata_config, _field),               \
+    .size = sizeof_field(struct hinata_config, _field),             \
+    .min = _min,                                                    \
+    .max = _max,                                                    \
+}
+
+#define HINATA_CONFIG_STRING(_key, _field, _check) {               \
+    .key = _key,                                                    \
+    .type = HINATA_CONFIG_TYPE_STRING,                              \
+    .offset = offsetof(struct hinata_config, _field),               \
+    .size = sizeof_field(struct hinata_config, _field),             \
+    .check = _check,                                                \
+}
+
+/**
+ * hinata_config_check_snapshot_path - Confine snapshots to their directory
+ * @value: Proposed snapshot path
+ *
+ * Storage creates and truncates the snapshot file, and the path can be
+ * set through sysfs, so only plain file names directly inside
+ * HINATA_SNAPSHOT_DIR are accepted.
+ *
+ * Returns: 0 if @value is acceptable, -EINVAL otherwise
+ */
+static int hinata_config_check_snapshot_path(const char *value)
+{
+    return hinata_storage_check_path(value, HINATA_SNAPSHOT_DIR);
+}
+
+static const struct hinata_config_param hinata_config_params[] = {
+    HINATA_CONFIG_PARAM("core.workers", HINATA_CONFIG_TYPE_INT,
+                        worker_count, 1, HINATA_CORE_MAX_WORKERS),
+    HINATA_CONFIG_PARAM("core.heartbeat_interval_ms", HINATA_CONFIG_TYPE_INT,
+                        heartbeat_interval_ms, 100, 600000),
+    HINATA_CONFIG_PARAM("cache.max_entries", HINATA_CONFIG_TYPE_INT,
+                        cache_max_entries, 16, 1 << 20),
+    HINATA_CONFIG_PARAM("storage.sync_interval_ms", HINATA_CONFIG_TYPE_INT,
+                        sync_interval_ms, 100, 3600000),
+    HINATA_CONFIG_PARAM("storage.gc_interval_ms", HINATA_CONFIG_TYPE_INT,
+                        gc_interval_ms, 100, 3600000),
+    HINATA_CONFIG_PARAM("storage.warm_restart", HINATA_CONFIG_TYPE_BOOL,
+                        warm_restart, 0, 1),
+    HINATA_CONFIG_STRING("storage.snapshot_path", snapshot_path,
+                         hinata_config_check_snapshot_path),
+    HINATA_CONFIG_PARAM("syscall.rate_limit", HINATA_CONFIG_TYPE_INT,
+                        syscall_rate_limit, 1, 1000000),
+    HINATA_CONFIG_PARAM("syscall.max_concurrent", HINATA_CONFIG_TYPE_INT,
+                        syscall_max_concurrent, 1, 65536),
+    HINATA_CONFIG_PARAM("health.read_target_us", HINATA_CONFIG_TYPE_INT,
+                        health_read_target_us, 1, 60000000),
+    HINATA_CONFIG_PARAM("health.write_target_us", HINATA_CONFIG_TYPE_INT,
+                        health_write_target_us, 1, 60000000),
+};
+
+/* Built-in defaults; published until the first change and never freed */
+static struct hinata_config hinata_config_default = {
+    .generation = 0,
+    .worker_count = HINATA_CORE_MAX_WORKERS,
+    .heartbeat_interval_ms = HINATA_CORE_HEARTBEAT_INTERVAL_MS,
+    .cache_max_entries = HINATA_CACHE_MAX_ENTRIES,
+    .sync_interval_ms = HINATA_STORAGE_SYNC_INTERVAL,
+    .gc_interval_ms = HINATA_STORAGE_GC_INTERVAL,
+    .warm_restart = true,
+    .snapshot_path = HINATA_SNAPSHOT_DEFAULT_PATH,
+    .syscall_rate_limit = HINATA_SYSCALL_RATE_LIMIT,
+    .syscall_max_concurrent = HINATA_SYSCALL_MAX_CONCURRENT,
+    .health_read_target_us = HINATA_HEALTH_READ_TARGET_US,
+    .health_write_target_us = HINATA_HEALTH_WRITE_TARGET_US,
+};
+
+struct hinata_config __rcu *hinata_config_current =
+    RCU_INITIALIZER(&hinata_config_default);
+EXPORT_SYMBOL(hinata_config_current);
+
+static DEFINE_MUTEX(hinata_config_mutex);
+static BLOCKING_NOTIFIER_HEAD(hinata_config_chain);
+
+/**
+ * hinata_config_find - Look up a registry entry
+ * @key: Parameter name
+ *
+ * Returns: Registry entry, or NULL if @key is unknown
+ */
+static const struct hinata_config_param *hinata_config_find(const char *key)
+{
+    size_t i;
+
+    if (!key) {
+        return NULL;
+    }
+
+    for (i = 0; i < ARRAY_SIZE(hinata_config_params); i++) {
+        if (strcmp(hinata_config_params[i].key, key) == 0) {
+            return &hinata_config_params[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * hinata_config_lookup - Look up a registry entry of a given type
+ * @key: Parameter name
+ * @type: Expected type
+ * @param: Output registry entry
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_config_lookup(const char *key, enum hinata_config_type type,
+                                const struct hinata_config_param **param)
+{
+    *param = hinata_config_find(key);
+    if (!*param) {
+        return -ENOENT;
+    }
+
+    if ((*param)->type != type) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/**
+ * hinata_config_publish - Publish a snapshot with one parameter changed
+ * @param: Registry entry
+ * @value: New value, in the representation of @param->type
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_config_publish(const struct hinata_config_param *param,
+                                 const void *value)
+{
+    struct hinata_config_change change;
+    struct hinata_config *old, *new;
+    void *field;
+    u32 generation;
+
+    mutex_lock(&hinata_config_mutex);
+
+    old = rcu_dereference_protected(hinata_config_current,
+                                    lockdep_is_held(&hinata_config_mutex));
+
+    new = kmemdup(old, sizeof(*new), GFP_KERNEL);
+    if (!new) {
+        mutex_unlock(&hinata_config_mutex);
+        return -ENOMEM;
+    }
+
+    field = (u8 *)new + param->offset;
+
+    switch (param->type) {
+    case HINATA_CONFIG_TYPE_BOOL:
+        *(bool *)field = *(const bool *)value;
+        break;
+    case HINATA_CONFIG_TYPE_INT:
+        *(u32 *)field = *(const u32 *)value;
+        break;
+    case HINATA_CONFIG_TYPE_STRING:
+        strscpy(field, value, param->size);
+        break;
+    }
+
+    new->generation = old->generation + 1;
+    generation = new->generation;
+    rcu_assign_pointer(hinata_config_current, new);
+
+    /* Subscribers may still look at @old; it is freed after they return */
+    change.key = param->key;
+    change.old = old;
+    change.new = new;
+    blocking_notifier_call_chain(&hinata_config_chain, HINATA_CONFIG_CHANGED, &change);
+
+    mutex_unlock(&hinata_config_mutex);
+
+    if (old != &hinata_config_default) {
+        kfree_rcu(old, rcu);
+    }
+
+    /* @new may already be replaced and freed by another publisher */
+    pr_debug("HiNATA: Config '%s' updated (generation %u)\n",
+             param->key, generation);
+
+    return 0;
+}
+
+/**
+ * hinata_config_get_bool - Get a boolean parameter
+ * @key: Parameter name
+ * @value: Output value
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_get_bool(const char *key, bool *value)
+{
+    const struct hinata_config_param *param;
+    int ret;
+
+    if (!value) {
+        return -EINVAL;
+    }
+
+    ret = hinata_config_lookup(key, HINATA_CONFIG_TYPE_BOOL, &param);
+    if (ret < 0) {
+        return ret;
+    }
+
+    rcu_read_lock();
+    *value = *(bool *)((u8 *)rcu_dereference(hinata_config_current) + param->offset);
+    rcu_read_unlock();
+
+    return 0;
+}
+EXPORT_SYMBOL(hinata_config_get_bool);
+
+/**
+ * hinata_config_get_int - Get an integer parameter
+ * @key: Parameter name
+ * @value: Output value
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_get_int(const char *key, int *value)
+{
+    const struct hinata_config_param *param;
+    int ret;
+
+    if (!value) {
+        return -EINVAL;
+    }
+
+    ret = hinata_config_lookup(key, HINATA_CONFIG_TYPE_INT, &param);
+    if (ret < 0) {
+        return ret;
+    }
+
+    rcu_read_lock();
+    *value = *(u32 *)((u8 *)rcu_dereference(hinata_config_current) + param->offset);
+    rcu_read_unlock();
+
+    return 0;
+}
+EXPORT_SYMBOL(hinata_config_get_int);
+
+/**
+ * hinata_config_get_string - Get a string parameter
+ * @key: Parameter name
+ * @value: Output buffer
+ * @size: Size of @value
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_get_string(const char *key, char *value, size_t size)
+{
+    const struct hinata_config_param *param;
+    ssize_t len;
+    int ret;
+
+    if (!value || size == 0) {
+        return -EINVAL;
+    }
+
+    ret = hinata_config_lookup(key, HINATA_CONFIG_TYPE_STRING, &param);
+    if (ret < 0) {
+        return ret;
+    }
+
+    rcu_read_lock();
+    len = strscpy(value, (u8 *)rcu_dereference(hinata_config_current) + param->offset, size);
+    rcu_read_unlock();
+
+    return len < 0 ? len : 0;
+}
+EXPORT_SYMBOL(hinata_config_get_string);
+
+/**
+ * hinata_config_set_bool - Set a boolean parameter
+ * @key: Parameter name
+ * @value: New value
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_set_bool(const char *key, bool value)
+{
+    const struct hinata_config_param *param;
+    int ret;
+
+    ret = hinata_config_lookup(key, HINATA_CONFIG_TYPE_BOOL, &param);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return hinata_config_publish(param, &value);
+}
+EXPORT_SYMBOL(hinata_config_set_bool);
+
+/**
+ * hinata_config_set_int - Set an integer parameter
+ * @key: Parameter name
+ * @value: New value
+ *
+ * Returns: 0 on success, -ERANGE if @value is outside the parameter
+ * bounds, other negative error code on failure
+ */
+int hinata_config_set_int(const char *key, int value)
+{
+    const struct hinata_config_param *param;
+    u32 val;
+    int ret;
+
+    ret = hinata_config_lookup(key, HINATA_CONFIG_TYPE_INT, &param);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (value < 0 || (u32)value < param->min || (u32)value > param->max) {
+        return -ERANGE;
+    }
+
+    val = value;
+
+    return hinata_config_publish(param, &val);
+}
+EXPORT_SYMBOL(hinata_config_set_int);
+
+/**
+ * hinata_config_set_string - Set a string parameter
+ * @key: Parameter name
+ * @value: New value
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_set_string(const char *key, const char *value)
+{
+    const struct hinata_config_param *param;
+    int ret;
+
+    if (!value || !*value) {
+        return -EINVAL;
+    }
+
+    ret = hinata_config_lookup(key, HINATA_CONFIG_TYPE_STRING, &param);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (strlen(value) >= param->size) {
+        return -ENAMETOOLONG;
+    }
+
+    if (param->check) {
+        ret = param->check(value);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return hinata_config_publish(param, value);
+}
+EXPORT_SYMBOL(hinata_config_set_string);
+
+/**
+ * hinata_config_format - Format a parameter of a snapshot
+ * @config: Snapshot
+ * @param: Registry entry
+ * @buf: Output buffer
+ * @size: Size of @buf
+ *
+ * Returns: Number of characters written
+ */
+static int hinata_config_format(const struct hinata_config *config,
+                                const struct hinata_config_param *param,
+                                char *buf, size_t size)
+{
+    const void *field = (const u8 *)config + param->offset;
+
+    switch (param->type) {
+    case HINATA_CONFIG_TYPE_BOOL:
+        return scnprintf(buf, size, "%d", *(const bool *)field);
+    case HINATA_CONFIG_TYPE_INT:
+        return scnprintf(buf, size, "%u", *(const u32 *)field);
+    case HINATA_CONFIG_TYPE_STRING:
+        return scnprintf(buf, size, "%s", (const char *)field);
+    }
+
+    return 0;
+}
+
+/**
+ * hinata_config_get - Get a parameter as text
+ * @key: Parameter name
+ * @value: Output buffer
+ * @size: Size of @value
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_get(const char *key, char *value, size_t size)
+{
+    const struct hinata_config_param *param;
+
+    if (!value || size == 0) {
+        return -EINVAL;
+    }
+
+    param = hinata_config_find(key);
+    if (!param) {
+        return -ENOENT;
+    }
+
+    rcu_read_lock();
+    hinata_config_format(rcu_dereference(hinata_config_current), param, value, size);
+    rcu_read_unlock();
+
+    return 0;
+}
+EXPORT_SYMBOL(hinata_config_get);
+
+/**
+ * hinata_config_set - Set a parameter from text
+ * @key: Parameter name
+ * @value: New value as text
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_set(const char *key, const char *value)
+{
+    const struct hinata_config_param *param;
+    bool bval;
+    int ival;
+    int ret;
+
+    if (!value) {
+        return -EINVAL;
+    }
+
+    param = hinata_config_find(key);
+    if (!param) {
+        return -ENOENT;
+    }
+
+    switch (param->type) {
+    case HINATA_CONFIG_TYPE_BOOL:
+        ret = kstrtobool(value, &bval);
+        if (ret < 0) {
+            return ret;
+        }
+        return hinata_config_set_bool(key, bval);
+    case HINATA_CONFIG_TYPE_INT:
+        ret = kstrtoint(value, 0, &ival);
+        if (ret < 0) {
+            return ret;
+        }
+        return hinata_config_set_int(key, ival);
+    case HINATA_CONFIG_TYPE_STRING:
+        return hinata_config_set_string(key, value);
+    }
+
+    return -EINVAL;
+}
+EXPORT_SYMBOL(hinata_config_set);
+
+/**
+ * hinata_config_show - List all parameters as "key=value" lines
+ * @buf: Output buffer
+ * @size: Size of @buf
+ *
+ * All values come from the same snapshot.
+ *
+ * Returns: Number of characters written
+ */
+ssize_t hinata_config_show(char *buf, size_t size)
+{
+    const struct hinata_config *config;
+    ssize_t len = 0;
+    size_t i;
+
+    rcu_read_lock();
+    config = rcu_dereference(hinata_config_current);
+
+    for (i = 0; i < ARRAY_SIZE(hinata_config_params); i++) {
+        len += scnprintf(buf + len, size - len, "%s=", hinata_config_params[i].key);
+        len += hinata_config_format(config, &hinata_config_params[i], buf + len, size - len);
+        len += scnprintf(buf + len, size - len, "\n");
+    }
+
+    rcu_read_unlock();
+
+    return len;
+}
+EXPORT_SYMBOL(hinata_config_show);
+
+/**
+ * hinata_config_register_notifier - Subscribe to configuration changes
+ * @nb: Notifier block, called with HINATA_CONFIG_CHANGED and a
+ *      struct hinata_config_change in process context
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_register_notifier(struct notifier_block *nb)
+{
+    return blocking_notifier_chain_register(&hinata_config_chain, nb);
+}
+EXPORT_SYMBOL(hinata_config_register_notifier);
+
+/**
+ * hinata_config_unregister_notifier - Unsubscribe from configuration changes
+ * @nb: Notifier block
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_config_unregister_notifier(struct notifier_block *nb)
+{
+    return blocking_notifier_chain_unregister(&hinata_config_chain, nb);
+}
+EXPORT_SYMBOL(hinata_config_unregister_notifier);
+
+/**
+ * hinata_config_exit - Release the published snapshot
+ *
+ * Reverts to the built-in defaults and waits for pending frees.
+ */
+void hinata_config_exit(void)
+{
+    struct hinata_config *old;
+
+    mutex_lock(&hinata_config_mutex);
+    old = rcu_dereference_protected(hinata_config_current,
+                                    lockdep_is_held(&hinata_config_mutex));
+    rcu_assign_pointer(hinata_config_current, &hinata_config_default);
+    mutex_unlock(&hinata_config_mutex);
+
+    synchronize_rcu();
+
+    if (old != &hinata_config_default) {
+        kfree(old);
+    }
+
+    /* Flush kfree_rcu() callbacks queued by earlier updates */
+    rcu_barrier();
+}
+EXPORT_SYMBOL(hinata_config_exit);
@@ -0,0 +1,119 @@
+/*
+ * HiNATA Configuration Registry - Header File
+ * Part of notcontrolOS Knowledge Management System
+ *
+ * This header defines the runtime configuration snapshot. The current
+ * snapshot is immutable and published through RCU; writers copy it,
+ * apply a change and swap the pointer, then notify interested subsystems.
+ */
+
+#ifndef _HINATA_CONFIG_H
+#define _HINATA_CONFIG_H
+
+#include <linux/types.h>
+#include <linux/rcupdate.h>
+#include <linux/notifier.h>
+#include "../hinata_types.h"
+
+/* Registry limits */
+#define HINATA_CONFIG_KEY_MAX           48
+#define HINATA_CONFIG_VALUE_MAX         256
+
+/* Notifier actions */
+#define HINATA_CONFIG_CHANGED           1
+
+/**
+ * enum hinata_config_type - Type of a configuration parameter
+ * @HINATA_CONFIG_TYPE_BOOL: Boolean value
+ * @HINATA_CONFIG_TYPE_INT: Bounded non-negative integer
+ * @HINATA_CONFIG_TYPE_STRING: NUL-terminated string
+ */
+enum hinata_config_type {
+    HINATA_CONFIG_TYPE_BOOL = 0,
+    HINATA_CONFIG_TYPE_INT,
+    HINATA_CONFIG_TYPE_STRING
+};
+
+/**
+ * struct hinata_config - Immutable configuration snapshot
+ * @generation: Incremented on every published change
+ * @worker_count: Number of core worker threads
+ * @heartbeat_interval_ms: Core heartbeat interval
+ * @cache_max_entries: Storage cache capacity in entries
+ * @sync_interval_ms: Storage sync interval
+ * @gc_interval_ms: Storage garbage collection interval
+ * @warm_restart: Save and reload cache snapshots across restarts
+ * @snapshot_path: Warm-restart snapshot file, directly inside HINATA_SNAPSHOT_DIR
+ * @syscall_rate_limit: System calls admitted per second
+ * @syscall_max_concurrent: System calls allowed in flight
+ * @health_read_target_us: Read latency objective
+ * @health_write_target_us: Create, update and delete latency objective
+ * @rcu: RCU head for deferred freeing
+ */
+struct hinata_config {
+    u32 generation;
+
+    /* Core */
+    u32 worker_count;
+    u32 heartbeat_interval_ms;
+
+    /* Storage */
+    u32 cache_max_entries;
+    u32 sync_interval_ms;
+    u32 gc_interval_ms;
+    bool warm_restart;
+    char snapshot_path[HINATA_CONFIG_VALUE_MAX];
+
+    /* System calls */
+    u32 syscall_rate_limit;
+    u32 syscall_max_concurrent;
+
+    /* Health objectives */
+    u32 health_read_target_us;
+    u32 health_write_target_us;
+
+    struct rcu_head rcu;
+};
+
+/**
+ * struct hinata_config_change - Payload of HINATA_CONFIG_CHANGED
+ * @key: Parameter that changed
+ * @old: Previous snapshot, valid for the duration of the callback
+ * @new: Newly published snapshot
+ */
+struct hinata_config_change {
+    const char *key;
+    const struct hinata_config *old;
+    const struct hinata_config *new;
+};
+
+/* Current snapshot; never NULL */
+extern struct hinata_config __rcu *hinata_config_current;
+
+/**
+ * hinata_config_value - Read one scalar field of the current snapshot
+ * @field: Field of struct hinata_config
+ *
+ * Costs a single pointer load on the read side.
+ */
+#define hinata_config_value(field) ({                                   \
+    typeof(((struct hinata_config *)0)->field) __hinata_cfg_val;        \
+    rcu_read_lock();                                                    \
+    __hinata_cfg_val = rcu_dereference(hinata_config_current)->field;   \
+    rcu_read_unlock();                                                  \
+    __hinata_cfg_val;                                                   \
+})
+
+/* Subsystem cleanup */
+void hinata_config_exit(void);
+
+/* Textual access for sysfs and ioctl */
+int hinata_config_get(const char *key, char *value, size_t size);
+int hinata_config_set(const char *key, const char *value);
+ssize_t hinata_config_show(char *buf, size_t size);
+
+/* Change notification */
+int hinata_config_register_notifier(struct notifier_block *nb);
+int hinata_config_unregister_notifier(struct notifier_block *nb);
+
+#endif /* _HINATA_CONFIG_H */
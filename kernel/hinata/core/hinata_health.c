@@ -0,0 +1,692 @@
+/*
+ * HiNATA Health Monitoring - Kernel Implementation
+ * Part of notcontrolOS Knowledge Management System
+ *
+ * This file implements per-operation latency histograms and evaluates
+ * them against service level objectives to derive the system health.
+ * Operations are recorded lock-free; evaluation runs from the core
+ * heartbeat and only looks at the samples of the last window.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/string.h>
+#include <linux/atomic.h>
+#include <linux/mutex.h>
+#include <linux/spinlock.h>
+#include <linux/ktime.h>
+#include <linux/bitops.h>
+#include <linux/math64.h>
+#include <linux/notifier.h>
+
+#include "../hinata_types.h"
+#include "../hinata_core.h"
+#include "../kernel/hinata_interface.h"
+#include "hinata_config.h"
+#include "hinata_health.h"
+
+/**
+ * struct hinata_perf_histogram - Latency histogram for one operation type
+ * @buckets: Log2 latency buckets
+ * @count: Total operations recorded
+ * @errors: Total failed operations
+ * @total_time: Sum of operation latencies in nanoseconds
+ * @peak_time: Largest latency observed in nanoseconds
+ * @prev_buckets: Bucket values at the previous evaluation
+ * @prev_count: Operation count at the previous evaluation
+ * @prev_errors: Error count at the previous evaluation
+ */
+struct hinata_perf_histogram {
+    atomic64_t buckets[HINATA_HEALTH_HIST_BUCKETS];
+    atomic64_t count;
+    atomic64_t errors;
+    atomic64_t total_time;
+    atomic64_t peak_time;
+    u64 prev_buckets[HINATA_HEALTH_HIST_BUCKETS];
+    u64 prev_count;
+    u64 prev_errors;
+};
+
+/**
+ * struct hinata_health_issue - Issue reported by a component
+ * @component: Reporting component
+ * @issue: Issue description
+ * @timestamp: Time of the report
+ */
+struct hinata_health_issue {
+    char component[32];
+    char issue[HINATA_HEALTH_ISSUE_LENGTH];
+    u64 timestamp;
+};
+
+/* Default objectives, tuned for interactive use of the knowledge store */
+static struct hinata_slo health_slos[HINATA_OP_TYPE_MAX] = {
+    [HINATA_OP_CREATE]      = { 990, HINATA_US_TO_NS(HINATA_HEALTH_WRITE_TARGET_US), 100, 4 },
+    [HINATA_OP_READ]        = { 990, HINATA_US_TO_NS(HINATA_HEALTH_READ_TARGET_US),  100, 4 },
+    [HINATA_OP_UPDATE]      = { 990, HINATA_US_TO_NS(HINATA_HEALTH_WRITE_TARGET_US), 100, 4 },
+    [HINATA_OP_DELETE]      = { 990, HINATA_US_TO_NS(HINATA_HEALTH_WRITE_TARGET_US), 100, 4 },
+    [HINATA_OP_SEARCH]      = { 950, HINATA_MS_TO_NS(100),   100, 4 },
+    [HINATA_OP_VALIDATE]    = { 990, HINATA_MS_TO_NS(1),     100, 4 },
+    [HINATA_OP_SYNC]        = { 990, HINATA_MS_TO_NS(1000),  500, 4 },
+    [HINATA_OP_BACKUP]      = { 900, HINATA_MS_TO_NS(60000), 500, 2 },
+    [HINATA_OP_RESTORE]     = { 900, HINATA_MS_TO_NS(60000), 500, 2 },
+    [HINATA_OP_MAINTENANCE] = { 900, HINATA_MS_TO_NS(10000), 500, 2 },
+};
+
+/* Histograms and evaluation state */
+static struct hinata_perf_histogram health_hist[HINATA_OP_TYPE_MAX];
+static struct hinata_health_status health_status;
+static DEFINE_MUTEX(health_eval_mutex);
+static DEFINE_SPINLOCK(health_slo_lock);
+
+/* Issues reported through hinata_health_report_issue() */
+static struct hinata_health_issue health_issues[HINATA_HEALTH_MAX_ISSUES];
+static u32 health_issue_count;
+static DEFINE_SPINLOCK(health_issue_lock);
+
+static atomic_t health_level = ATOMIC_INIT(HINATA_HEALTH_OK);
+
+/**
+ * hinata_health_bucket - Map a latency to its histogram bucket
+ * @latency: Latency in nanoseconds
+ *
+ * Returns: Bucket index
+ */
+static inline u32 hinata_health_bucket(u64 latency)
+{
+    u64 units = latency >> HINATA_HEALTH_HIST_SHIFT;
+
+    if (!units) {
+        return 0;
+    }
+    return min_t(u32, fls64(units), HINATA_HEALTH_HIST_BUCKETS - 1);
+}
+
+/**
+ * hinata_health_bucket_limit - Upper latency bound of a bucket
+ * @bucket: Bucket index
+ *
+ * Returns: Upper bound in nanoseconds
+ */
+static inline u64 hinata_health_bucket_limit(u32 bucket)
+{
+    return (1ULL << bucket) << HINATA_HEALTH_HIST_SHIFT;
+}
+
+/**
+ * hinata_health_percentile - Estimate a percentile from bucket counts
+ * @buckets: Bucket counts
+ * @total: Sum of @buckets
+ * @percentile: Percentile in per-mille
+ *
+ * Returns: Upper bound of the bucket holding the percentile, 0 if empty
+ */
+static u64 hinata_health_percentile(const u64 *buckets, u64 total, u32 percentile)
+{
+    u64 rank, seen = 0;
+    u32 i;
+
+    if (!total) {
+        return 0;
+    }
+
+    rank = div_u64(total * percentile + 999, 1000);
+    for (i = 0; i < HINATA_HEALTH_HIST_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return hinata_health_bucket_limit(i);
+        }
+    }
+
+    return hinata_health_bucket_limit(HINATA_HEALTH_HIST_BUCKETS - 1);
+}
+
+/**
+ * hinata_perf_start_operation - Mark the start of a timed operation
+ * @ctx: Operation context
+ */
+void hinata_perf_start_operation(struct hinata_operation_context *ctx)
+{
+    if (!ctx) {
+        return;
+    }
+
+    ctx->start_time = ktime_get_ns();
+}
+EXPORT_SYMBOL(hinata_perf_start_operation);
+
+/**
+ * hinata_perf_end_operation - Record a completed operation
+ * @ctx: Operation context started with hinata_perf_start_operation()
+ *
+ * An operation counts against the error budget when it failed or ran
+ * past its own timeout.
+ */
+void hinata_perf_end_operation(struct hinata_operation_context *ctx)
+{
+    struct hinata_perf_histogram *hist;
+    u64 latency, peak;
+    bool failed;
+
+    if (!ctx || ctx->type >= HINATA_OP_TYPE_MAX || !ctx->start_time) {
+        return;
+    }
+
+    latency = ktime_get_ns() - ctx->start_time;
+    failed = ctx->result < 0 || ctx->error_code != HINATA_SUCCESS ||
+             (ctx->timeout && latency > HINATA_MS_TO_NS((u64)ctx->timeout));
+
+    hist = &health_hist[ctx->type];
+    atomic64_inc(&hist->buckets[hinata_health_bucket(latency)]);
+    atomic64_add(latency, &hist->total_time);
+    if (failed) {
+        atomic64_inc(&hist->errors);
+    }
+
+    peak = atomic64_read(&hist->peak_time);
+    while (latency > peak) {
+        u64 old = atomic64_cmpxchg(&hist->peak_time, peak, latency);
+
+        if (old == peak) {
+            break;
+        }
+        peak = old;
+    }
+
+    /* Count last so a sample is never visible without its bucket */
+    atomic64_inc(&hist->count);
+}
+EXPORT_SYMBOL(hinata_perf_end_operation);
+
+/**
+ * hinata_perf_get_average_time - Get average latency of an operation type
+ * @type: Operation type
+ *
+ * Returns: Average latency in nanoseconds since load
+ */
+u64 hinata_perf_get_average_time(enum hinata_operation_type type)
+{
+    u64 count;
+
+    if (type >= HINATA_OP_TYPE_MAX) {
+        return 0;
+    }
+
+    count = atomic64_read(&health_hist[type].count);
+    if (!count) {
+        return 0;
+    }
+
+    return div64_u64(atomic64_read(&health_hist[type].total_time), count);
+}
+EXPORT_SYMBOL(hinata_perf_get_average_time);
+
+/**
+ * hinata_perf_get_peak_time - Get peak latency of an operation type
+ * @type: Operation type
+ *
+ * Returns: Peak latency in nanoseconds since load
+ */
+u64 hinata_perf_get_peak_time(enum hinata_operation_type type)
+{
+    if (type >= HINATA_OP_TYPE_MAX) {
+        return 0;
+    }
+
+    return atomic64_read(&health_hist[type].peak_time);
+}
+EXPORT_SYMBOL(hinata_perf_get_peak_time);
+
+/**
+ * hinata_perf_get_operations_per_second - Get throughput of an operation type
+ * @type: Operation type
+ *
+ * Returns: Operations per second over the last evaluation window
+ */
+u32 hinata_perf_get_operations_per_second(enum hinata_operation_type type)
+{
+    u32 ops;
+
+    if (type >= HINATA_OP_TYPE_MAX) {
+        return 0;
+    }
+
+    mutex_lock(&health_eval_mutex);
+    ops = health_status.ops[type].ops_per_second;
+    mutex_unlock(&health_eval_mutex);
+
+    return ops;
+}
+EXPORT_SYMBOL(hinata_perf_get_operations_per_second);
+
+/**
+ * hinata_perf_get_percentile - Get lifetime latency percentile
+ * @type: Operation type
+ * @percentile: Percentile in per-mille (990 = p99)
+ *
+ * Returns: Latency upper bound in nanoseconds, 0 if no samples
+ */
+u64 hinata_perf_get_percentile(enum hinata_operation_type type, u32 percentile)
+{
+    u64 buckets[HINATA_HEALTH_HIST_BUCKETS];
+    u64 total = 0;
+    u32 i;
+
+    if (type >= HINATA_OP_TYPE_MAX || percentile > 1000) {
+        return 0;
+    }
+
+    for (i = 0; i < HINATA_HEALTH_HIST_BUCKETS; i++) {
+        buckets[i] = atomic64_read(&health_hist[type].buckets[i]);
+        total += buckets[i];
+    }
+
+    return hinata_health_percentile(buckets, total, percentile);
+}
+EXPORT_SYMBOL(hinata_perf_get_percentile);
+
+/**
+ * hinata_health_set_slo - Set the objective of an operation type
+ * @type: Operation type
+ * @slo: New objective
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_health_set_slo(enum hinata_operation_type type, const struct hinata_slo *slo)
+{
+    if (type >= HINATA_OP_TYPE_MAX || !slo) {
+        return -EINVAL;
+    }
+
+    if (!slo->percentile || slo->percentile > 1000 || !slo->latency_target ||
+        slo->error_budget > 10000 || slo->critical_factor < 1) {
+        return -EINVAL;
+    }
+
+    spin_lock(&health_slo_lock);
+    health_slos[type] = *slo;
+    spin_unlock(&health_slo_lock);
+
+    return 0;
+}
+EXPORT_SYMBOL(hinata_health_set_slo);
+
+/**
+ * hinata_health_get_slo - Get the objective of an operation type
+ * @type: Operation type
+ * @slo: Output objective
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_health_get_slo(enum hinata_operation_type type, struct hinata_slo *slo)
+{
+    if (type >= HINATA_OP_TYPE_MAX || !slo) {
+        return -EINVAL;
+    }
+
+    spin_lock(&health_slo_lock);
+    *slo = health_slos[type];
+    spin_unlock(&health_slo_lock);
+
+    return 0;
+}
+EXPORT_SYMBOL(hinata_health_get_slo);
+
+/**
+ * hinata_health_evaluate_op - Evaluate one operation type over the window
+ * @type: Operation type
+ * @elapsed: Window length in nanoseconds
+ *
+ * Caller must hold health_eval_mutex.
+ *
+ * Returns: Health level of the operation
+ */
+static enum hinata_health_level hinata_health_evaluate_op(enum hinata_operation_type type,
+                                                          u64 elapsed)
+{
+    struct hinata_perf_histogram *hist = &health_hist[type];
+    struct hinata_health_op_status *op = &health_status.ops[type];
+    u64 window[HINATA_HEALTH_HIST_BUCKETS];
+    u64 count, errors, samples = 0;
+    struct hinata_slo slo;
+    bool breach, severe;
+    u32 i;
+
+    hinata_health_get_slo(type, &slo);
+
+    /* Read the count first; buckets may only run ahead of it */
+    count = atomic64_read(&hist->count);
+    errors = atomic64_read(&hist->errors);
+    for (i = 0; i < HINATA_HEALTH_HIST_BUCKETS; i++) {
+        u64 now = atomic64_read(&hist->buckets[i]);
+
+        window[i] = now - hist->prev_buckets[i];
+        hist->prev_buckets[i] = now;
+        samples += window[i];
+    }
+
+    op->window_ops = count - hist->prev_count;
+    op->window_errors = min(errors - hist->prev_errors, op->window_ops);
+    hist->prev_count = count;
+    hist->prev_errors = errors;
+
+    op->ops_per_second = elapsed ?
+        (u32)div64_u64(op->window_ops * NSEC_PER_SEC, elapsed) : 0;
+
+    op->window_latency = hinata_health_percentile(window, samples, slo.percentile);
+
+    if (op->window_ops < HINATA_HEALTH_MIN_SAMPLES) {
+        /* Too little traffic to judge; keep the streak but report ok */
+        op->window_error_rate = 0;
+        op->level = HINATA_HEALTH_OK;
+        return op->level;
+    }
+
+    op->window_error_rate = (u32)div64_u64(op->window_errors * 10000, op->window_ops);
+
+    breach = op->window_latency > slo.latency_target ||
+             op->window_error_rate > slo.error_budget;
+    severe = op->window_latency > slo.latency_target * slo.critical_factor ||
+             op->window_error_rate > slo.error_budget * slo.critical_factor;
+
+    op->breach_streak = breach ? op->breach_streak + 1 : 0;
+
+    if (severe || op->breach_streak >= HINATA_HEALTH_CRITICAL_WINDOWS) {
+        op->level = HINATA_HEALTH_CRITICAL;
+    } else if (breach) {
+        op->level = HINATA_HEALTH_DEGRADED;
+    } else {
+        op->level = HINATA_HEALTH_OK;
+    }
+
+    return op->level;
+}
+
+/**
+ * hinata_health_evaluate - Evaluate all objectives over the last window
+ *
+ * Called periodically from the core heartbeat. A level change is logged
+ * and published as a HINATA_EVENT_TYPE_SYSTEM_HEALTH event.
+ *
+ * Returns: New health level
+ */
+enum hinata_health_level hinata_health_evaluate(void)
+{
+    enum hinata_health_level level = HINATA_HEALTH_OK;
+    enum hinata_health_level old_level;
+    struct hinata_health_event event;
+    u64 now = ktime_get_ns();
+    u64 elapsed;
+    u32 mask = 0;
+    u32 issues;
+    int type;
+
+    mutex_lock(&health_eval_mutex);
+
+    elapsed = health_status.last_evaluation ? now - health_status.last_evaluation : 0;
+
+    for (type = 0; type < HINATA_OP_TYPE_MAX; type++) {
+        enum hinata_health_level op_level = hinata_health_evaluate_op(type, elapsed);
+
+        if (op_level != HINATA_HEALTH_OK) {
+            mask |= BIT(type);
+        }
+        level = max(level, op_level);
+    }
+
+    spin_lock(&health_issue_lock);
+    issues = health_issue_count;
+    spin_unlock(&health_issue_lock);
+
+    if (issues && level == HINATA_HEALTH_OK) {
+        level = HINATA_HEALTH_DEGRADED;
+    }
+
+    old_level = health_status.level;
+    health_status.level = level;
+    health_status.breaching_mask = mask;
+    health_status.issue_count = issues;
+    health_status.last_evaluation = now;
+    if (level != old_level) {
+        health_status.last_transition = now;
+    }
+
+    mutex_unlock(&health_eval_mutex);
+
+    atomic_set(&health_level, level);
+
+    if (level != old_level) {
+        if (level == HINATA_HEALTH_OK) {
+            pr_info("HiNATA: Health recovered (was %s)\n",
+                   hinata_health_level_to_string(old_level));
+        } else {
+            pr_warn("HiNATA: Health %s (breaching 0x%x, %u issues)\n",
+                   hinata_health_level_to_string(level), mask, issues);
+        }
+
+        event.old_level = old_level;
+        event.new_level = level;
+        event.breaching_mask = mask;
+        event.issue_count = issues;
+        hinata_add_event(HINATA_EVENT_TYPE_SYSTEM_HEALTH, level, &event, sizeof(event));
+    }
+
+    return level;
+}
+EXPORT_SYMBOL(hinata_health_evaluate);
+
+/**
+ * hinata_health_get_level - Get the health level of the last evaluation
+ *
+ * Returns: Health level
+ */
+enum hinata_health_level hinata_health_get_level(void)
+{
+    return atomic_read(&health_level);
+}
+EXPORT_SYMBOL(hinata_health_get_level);
+
+/**
+ * hinata_health_get_report - Get the full result of the last evaluation
+ * @status: Output status
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_health_get_report(struct hinata_health_status *status)
+{
+    if (!status) {
+        return -EINVAL;
+    }
+
+    mutex_lock(&health_eval_mutex);
+    *status = health_status;
+    mutex_unlock(&health_eval_mutex);
+
+    return 0;
+}
+EXPORT_SYMBOL(hinata_health_get_report);
+
+/**
+ * hinata_health_check - Check whether the system meets its objectives
+ *
+ * Returns: true if healthy, false otherwise
+ */
+bool hinata_health_check(void)
+{
+    return hinata_health_get_level() == HINATA_HEALTH_OK;
+}
+EXPORT_SYMBOL(hinata_health_check);
+
+/**
+ * hinata_health_get_status - Get health status
+ *
+ * Returns: Current enum hinata_health_level value
+ */
+int hinata_health_get_status(void)
+{
+    return hinata_health_get_level();
+}
+EXPORT_SYMBOL(hinata_health_get_status);
+
+/**
+ * hinata_health_report_issue - Report an issue degrading system health
+ * @component: Reporting component
+ * @issue: Issue description
+ *
+ * The issue keeps the system at least degraded until it is cleared. When
+ * the issue table is full the oldest entry is replaced.
+ */
+void hinata_health_report_issue(const char *component, const char *issue)
+{
+    struct hinata_health_issue *entry;
+
+    if (!component || !issue) {
+        return;
+    }
+
+    spin_lock(&health_issue_lock);
+    if (health_issue_count < HINATA_HEALTH_MAX_ISSUES) {
+        entry = &health_issues[health_issue_count++];
+    } else {
+        memmove(&health_issues[0], &health_issues[1],
+                sizeof(health_issues[0]) * (HINATA_HEALTH_MAX_ISSUES - 1));
+        entry = &health_issues[HINATA_HEALTH_MAX_ISSUES - 1];
+    }
+    strscpy(entry->component, component, sizeof(entry->component));
+    strscpy(entry->issue, issue, sizeof(entry->issue));
+    entry->timestamp = ktime_get_ns();
+    spin_unlock(&health_issue_lock);
+
+    pr_warn("HiNATA: Health issue in %s: %s\n", component, issue);
+}
+EXPORT_SYMBOL(hinata_health_report_issue);
+
+/**
+ * hinata_health_clear_issues - Clear all reported issues
+ */
+void hinata_health_clear_issues(void)
+{
+    spin_lock(&health_issue_lock);
+    health_issue_count = 0;
+    memset(health_issues, 0, sizeof(health_issues));
+    spin_unlock(&health_issue_lock);
+}
+EXPORT_SYMBOL(hinata_health_clear_issues);
+
+/**
+ * hinata_health_set_latency_target - Replace the latency target of one SLO
+ * @type: Operation type
+ * @target_us: New latency target in microseconds
+ */
+static void hinata_health_set_latency_target(enum hinata_operation_type type, u32 target_us)
+{
+    struct hinata_slo slo;
+
+    hinata_health_get_slo(type, &slo);
+    slo.latency_target = HINATA_US_TO_NS((u64)target_us);
+    hinata_health_set_slo(type, &slo);
+}
+
+/**
+ * hinata_health_apply_config - Apply the latency objectives of a snapshot
+ * @config: Configuration snapshot
+ */
+static void hinata_health_apply_config(const struct hinata_config *config)
+{
+    hinata_health_set_latency_target(HINATA_OP_READ, config->health_read_target_us);
+    hinata_health_set_latency_target(HINATA_OP_CREATE, config->health_write_target_us);
+    hinata_health_set_latency_target(HINATA_OP_UPDATE, config->health_write_target_us);
+    hinata_health_set_latency_target(HINATA_OP_DELETE, config->health_write_target_us);
+}
+
+/**
+ * hinata_health_config_notifier_func - Configuration change notifier function
+ * @nb: Notifier block
+ * @action: HINATA_CONFIG_CHANGED
+ * @data: struct hinata_config_change
+ *
+ * Returns: NOTIFY_OK if an objective changed, NOTIFY_DONE otherwise
+ */
+static int hinata_health_config_notifier_func(struct notifier_block *nb,
+                                              unsigned long action, void *data)
+{
+    struct hinata_config_change *change = data;
+
+    if (action != HINATA_CONFIG_CHANGED) {
+        return NOTIFY_DONE;
+    }
+
+    if (change->new->health_read_target_us == change->old->health_read_target_us &&
+        change->new->health_write_target_us == change->old->health_write_target_us) {
+        return NOTIFY_DONE;
+    }
+
+    hinata_health_apply_config(change->new);
+    return NOTIFY_OK;
+}
+
+static struct notifier_block hinata_health_config_nb = {
+    .notifier_call = hinata_health_config_notifier_func,
+};
+
+/**
+ * hinata_health_init - Initialize health monitoring
+ *
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_health_init(void)
+{
+    int type, i;
+    int ret;
+
+    pr_info("HiNATA: Initializing health monitoring\n");
+
+    ret = hinata_config_register_notifier(&hinata_health_config_nb);
+    if (ret < 0) {
+        pr_err("HiNATA: Failed to register health config notifier: %d\n", ret);
+        return ret;
+    }
+
+    /* Objectives changed before registration are picked up here */
+    rcu_read_lock();
+    hinata_health_apply_config(rcu_dereference(hinata_config_current));
+    rcu_read_unlock();
+
+    mutex_lock(&health_eval_mutex);
+    for (type = 0; type < HINATA_OP_TYPE_MAX; type++) {
+        struct hinata_perf_histogram *hist = &health_hist[type];
+
+        for (i = 0; i < HINATA_HEALTH_HIST_BUCKETS; i++) {
+            atomic64_set(&hist->buckets[i], 0);
+            hist->prev_buckets[i] = 0;
+        }
+        atomic64_set(&hist->count, 0);
+        atomic64_set(&hist->errors, 0);
+        atomic64_set(&hist->total_time, 0);
+        atomic64_set(&hist->peak_time, 0);
+        hist->prev_count = 0;
+        hist->prev_errors = 0;
+    }
+    memset(&health_status, 0, sizeof(health_status));
+    health_status.last_evaluation = ktime_get_ns();
+    mutex_unlock(&health_eval_mutex);
+
+    hinata_health_clear_issues();
+    atomic_set(&health_level, HINATA_HEALTH_OK);
+
+    return 0;
+}
+EXPORT_SYMBOL(hinata_health_init);
+
+/**
+ * hinata_health_exit - Cleanup health monitoring
+ */
+void hinata_health_exit(void)
+{
+    pr_info("HiNATA: Cleaning up health monitoring\n");
+
+    hinata_config_unregister_notifier(&hinata_health_config_nb);
+    hinata_health_clear_issues();
+    atomic_set(&health_level, HINATA_HEALTH_OK);
+}
+EXPORT_SYMBOL(hinata_health_exit);
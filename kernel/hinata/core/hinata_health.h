@@ -0,0 +1,144 @@
+/*
+ * HiNATA Health Monitoring - Header File
+ * Part of notcontrolOS Knowledge Management System
+ *
+ * This header defines latency histograms, per-operation service level
+ * objectives (SLOs) and the health levels derived from them.
+ */
+
+#ifndef _HINATA_HEALTH_H
+#define _HINATA_HEALTH_H
+
+#include <linux/types.h>
+#include <linux/atomic.h>
+#include "../hinata_types.h"
+
+/* Histogram layout: bucket i holds samples in [2^(i-1), 2^i) microseconds */
+#define HINATA_HEALTH_HIST_BUCKETS      32
+#define HINATA_HEALTH_HIST_SHIFT        10      /* ns -> ~us */
+
+/* Evaluation policy */
+#define HINATA_HEALTH_MIN_SAMPLES       32      /* Smaller windows are not judged */
+#define HINATA_HEALTH_CRITICAL_WINDOWS  3       /* Consecutive breaches before critical */
+#define HINATA_HEALTH_MAX_ISSUES        16
+#define HINATA_HEALTH_ISSUE_LENGTH      128
+
+/* Default p99 latency targets, overridable through the config registry */
+#define HINATA_HEALTH_READ_TARGET_US    5000
+#define HINATA_HEALTH_WRITE_TARGET_US   10000
+
+/**
+ * enum hinata_health_level - Aggregated health level
+ * @HINATA_HEALTH_OK: All objectives met
+ * @HINATA_HEALTH_DEGRADED: At least one objective breached
+ * @HINATA_HEALTH_CRITICAL: Objective breached by a wide margin or persistently
+ */
+enum hinata_health_level {
+    HINATA_HEALTH_OK = 0,
+    HINATA_HEALTH_DEGRADED,
+    HINATA_HEALTH_CRITICAL
+};
+
+/**
+ * struct hinata_slo - Service level objective for one operation type
+ * @percentile: Latency percentile in per-mille (990 = p99)
+ * @latency_target: Latency target for @percentile in nanoseconds
+ * @error_budget: Tolerated error rate in basis points (100 = 1%)
+ * @critical_factor: Multiple of a target that escalates straight to critical
+ */
+struct hinata_slo {
+    u32 percentile;
+    u64 latency_target;
+    u32 error_budget;
+    u32 critical_factor;
+};
+
+/**
+ * struct hinata_health_op_status - Last evaluation window for one operation
+ * @level: Health level of this operation
+ * @window_ops: Operations completed in the window
+ * @window_errors: Failed operations in the window
+ * @window_latency: Observed latency at the SLO percentile in nanoseconds
+ * @window_error_rate: Observed error rate in basis points
+ * @ops_per_second: Throughput over the window
+ * @breach_streak: Consecutive windows breaching the SLO
+ */
+struct hinata_health_op_status {
+    enum hinata_health_level level;
+    u64 window_ops;
+    u64 window_errors;
+    u64 window_latency;
+    u32 window_error_rate;
+    u32 ops_per_second;
+    u32 breach_streak;
+};
+
+/**
+ * struct hinata_health_status - Health report
+ * @level: Aggregated health level
+ * @breaching_mask: Bit per operation type currently breaching its SLO
+ * @issue_count: Number of outstanding reported issues
+ * @last_evaluation: Timestamp of the last evaluation
+ * @last_transition: Timestamp of the last level change
+ * @ops: Per-operation window results
+ */
+struct hinata_health_status {
+    enum hinata_health_level level;
+    u32 breaching_mask;
+    u32 issue_count;
+    u64 last_evaluation;
+    u64 last_transition;
+    struct hinata_health_op_status ops[HINATA_OP_TYPE_MAX];
+};
+
+/**
+ * struct hinata_health_event - Payload of HINATA_EVENT_TYPE_SYSTEM_HEALTH
+ * @old_level: Level before the transition
+ * @new_level: Level after the transition
+ * @breaching_mask: Operation types breaching their SLO
+ * @issue_count: Outstanding reported issues
+ */
+struct hinata_health_event {
+    u32 old_level;
+    u32 new_level;
+    u32 breaching_mask;
+    u32 issue_count;
+};
+
+/* Subsystem initialization */
+int hinata_health_init(void);
+void hinata_health_exit(void);
+
+/* Evaluation */
+enum hinata_health_level hinata_health_evaluate(void);
+enum hinata_health_level hinata_health_get_level(void);
+int hinata_health_get_report(struct hinata_health_status *status);
+
+/* SLO configuration */
+int hinata_health_set_slo(enum hinata_operation_type type, const struct hinata_slo *slo);
+int hinata_health_get_slo(enum hinata_operation_type type, struct hinata_slo *slo);
+
+/* Histogram queries */
+u64 hinata_perf_get_percentile(enum hinata_operation_type type, u32 percentile);
+
+/**
+ * hinata_health_level_to_string - Convert health level to string
+ * @level: Health level
+ *
+ * Returns: String representation of health level
+ */
+static inline const char *hinata_health_level_to_string(enum hinata_health_level level)
+{
+    switch (level) {
+    case HINATA_HEALTH_OK:
+        return "ok";
+    case HINATA_HEALTH_DEGRADED:
+        return "degraded";
+    case HINATA_HEALTH_CRITICAL:
+        return "critical";
+    default:
+        return "unknown";
+    }
+}
+
+#endif /* _HINATA_HEALTH_H */
@@ -0,0 +1,362 @@
+/*
+ * HiNATA Structured Logging - Kernel Implementation
+ * Part of notcontrolOS Knowledge Management System
+ *
+ * This file implements the binary log ring and per-call-site rate
+ * limiting. Recording an event is lock-free and never formats text;
+ * formatting happens in printk for call sites within their budget and
+ * in debugfs when the ring is read.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/atomic.h>
+#include <linux/llist.h>
+#include <linux/jiffies.h>
+#include <linux/ktime.h>
+#include <linux/sched.h>
+#include <linux/smp.h>
+#include <linux/slab.h>
+#include <linux/seq_file.h>
+#include <linux/errname.h>
+
+#include "../hinata_types.h"
+#include "../hinata_core.h"
+#include "hinata_log.h"
+
+#define HINATA_LOG_RING_MASK        (HINATA_LOG_RING_SIZE - 1)
+#define HINATA_LOG_DUMP_RECORDS     64
+
+/**
+ * struct hinata_log_ring - Binary record ring
+ * @records: Record slots
+ * @head: Records ever reserved
+ * @printed: Records also sent to printk
+ * @suppressed: Records withheld from printk
+ */
+struct hinata_log_ring {
+    struct hinata_log_record records[HINATA_LOG_RING_SIZE];
+    atomic64_t head;
+    atomic64_t printed;
+    atomic64_t suppressed;
+};
+
+static struct hinata_log_ring hinata_log_ring;
+static LLIST_HEAD(hinata_log_sites);
+
+/**
+ * hinata_error_to_string - Convert error code to string
+ * @error: Error code
+ *
+ * Returns: String representation of error code
+ */
+const char *hinata_error_to_string(enum hinata_error_code error)
+{
+    switch (error) {
+    case HINATA_SUCCESS:
+        return "success";
+    case HINATA_ERROR_INVALID_PARAM:
+        return "invalid parameter";
+    case HINATA_ERROR_NO_MEMORY:
+        return "out of memory";
+    case HINATA_ERROR_NOT_FOUND:
+        return "not found";
+    case HINATA_ERROR_EXISTS:
+        return "already exists";
+    case HINATA_ERROR_PERMISSION:
+        return "permission denied";
+    case HINATA_ERROR_TIMEOUT:
+        return "timed out";
+    case HINATA_ERROR_IO:
+        return "I/O error";
+    case HINATA_ERROR_CORRUPTION:
+        return "data corruption";
+    case HINATA_ERROR_VERSION:
+        return "version mismatch";
+    case HINATA_ERROR_CAPACITY:
+        return "capacity exceeded";
+    case HINATA_ERROR_BUSY:
+        return "resource busy";
+    case HINATA_ERROR_INTERRUPTED:
+        return "interrupted";
+    case HINATA_ERROR_UNSUPPORTED:
+        return "not supported";
+    case HINATA_ERROR_INTERNAL:
+        return "internal error";
+    default:
+        return "unknown error";
+    }
+}
+EXPORT_SYMBOL(hinata_error_to_string);
+
+/**
+ * hinata_log_ring_push - Append a record to the ring
+ * @site: Call site
+ * @error: Error code
+ * @arg0: First value
+ * @arg1: Second value
+ */
+static void hinata_log_ring_push(const struct hinata_log_site *site, int error,
+                                 u64 arg0, u64 arg1)
+{
+    struct hinata_log_record *rec;
+    u64 seq;
+
+    seq = atomic64_inc_return(&hinata_log_ring.head) - 1;
+    rec = &hinata_log_ring.records[seq & HINATA_LOG_RING_MASK];
+
+    /* Readers discard the slot until the sequence is republished */
+    WRITE_ONCE(rec->seq, 0);
+    smp_wmb();
+
+    rec->timestamp = ktime_get_ns();
+    rec->site = site;
+    rec->error = error;
+    rec->cpu = raw_smp_processor_id();
+    rec->pid = current->pid;
+    rec->args[0] = arg0;
+    rec->args[1] = arg1;
+
+    smp_wmb();
+    WRITE_ONCE(rec->seq, seq + 1);
+}
+
+/**
+ * hinata_log_site_allow - Apply the call site printk budget
+ * @site: Call site
+ * @suppressed: Output, messages suppressed in the window that just ended
+ *
+ * Returns: true if the event may be printed, false otherwise
+ */
+static bool hinata_log_site_allow(struct hinata_log_site *site, int *suppressed)
+{
+    unsigned long start = READ_ONCE(site->window_start);
+    unsigned long now = jiffies;
+
+    *suppressed = 0;
+
+    if (!start || time_after(now, start + HINATA_LOG_INTERVAL)) {
+        if (cmpxchg(&site->window_start, start, now ? now : 1) == start) {
+            *suppressed = atomic_xchg(&site->suppressed, 0);
+            atomic_set(&site->printed, 0);
+        }
+    }
+
+    if (atomic_inc_return(&site->printed) > HINATA_LOG_BURST) {
+        atomic_inc(&site->suppressed);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * hinata_log_error_name - Name of an error code in the space of its call site
+ * @site: Call site
+ * @error: Error code
+ *
+ * Returns: Error name, empty if unknown
+ */
+static const char *hinata_log_error_name(const struct hinata_log_site *site, int error)
+{
+    const char *name;
+
+    if (site->errno_codes) {
+        name = error < 0 ? errname(error) : NULL;
+        return name ?: "";
+    }
+
+    return error <= HINATA_SUCCESS && error >= HINATA_ERROR_INTERNAL ?
+           hinata_error_to_string(error) : "";
+}
+
+/**
+ * hinata_log_print - Format an event for printk
+ * @site: Call site
+ * @error: Error code
+ * @arg0: First value
+ * @arg1: Second value
+ * @suppressed: Messages suppressed since the last printed one
+ */
+static void hinata_log_print(const struct hinata_log_site *site, int error,
+                             u64 arg0, u64 arg1, int suppressed)
+{
+    const char *err_str = error ? hinata_log_error_name(site, error) : "";
+
+    if (suppressed) {
+        pr_warn("HiNATA: %s: %d messages suppressed\n", site->func, suppressed);
+    }
+
+    switch (site->level) {
+    case HINATA_LOG_EMERGENCY:
+    case HINATA_LOG_ALERT:
+    case HINATA_LOG_CRITICAL:
+        pr_crit("HiNATA: %s: %s (%d %s) [%llu, %llu]\n", site->func,
+                site->context, error, err_str, arg0, arg1);
+        break;
+    case HINATA_LOG_ERROR:
+        pr_err("HiNATA: %s: %s (%d %s) [%llu, %llu]\n", site->func,
+               site->context, error, err_str, arg0, arg1);
+        break;
+    case HINATA_LOG_WARNING:
+    case HINATA_LOG_NOTICE:
+        pr_warn("HiNATA: %s: %s (%d %s) [%llu, %llu]\n", site->func,
+                site->context, error, err_str, arg0, arg1);
+        break;
+    default:
+        pr_info("HiNATA: %s: %s (%d %s) [%llu, %llu]\n", site->func,
+                site->context, error, err_str, arg0, arg1);
+        break;
+    }
+}
+
+/**
+ * hinata_log_emit - Record a log event
+ * @site: Call site, from hinata_log_error() and friends
+ * @error: Error code
+ * @arg0: First value
+ * @arg1: Second value
+ *
+ * Safe in any context. Debug events are dropped up front while the debug
+ * feature is disabled. Other records always reach the ring; printk only
+ * sees them while the call site is within HINATA_LOG_BURST messages per
+ * HINATA_LOG_INTERVAL.
+ */
+void hinata_log_emit(struct hinata_log_site *site, int error, u64 arg0, u64 arg1)
+{
+    int suppressed;
+
+    if (site->level == HINATA_LOG_DEBUG && !hinata_is_debug_enabled()) {
+        return;
+    }
+
+    if (!atomic_xchg(&site->registered, 1)) {
+        llist_add(&site->node, &hinata_log_sites);
+    }
+
+    atomic64_inc(&site->hits);
+    hinata_log_ring_push(site, error, arg0, arg1);
+
+    if (site->level <= HINATA_LOG_ERROR) {
+        hinata_increment_error_count();
+    } else if (site->level == HINATA_LOG_WARNING) {
+        hinata_increment_warning_count();
+    }
+
+    if (!hinata_log_site_allow(site, &suppressed)) {
+        atomic64_inc(&hinata_log_ring.suppressed);
+        return;
+    }
+
+    atomic64_inc(&hinata_log_ring.printed);
+    hinata_log_print(site, error, arg0, arg1, suppressed);
+}
+EXPORT_SYMBOL(hinata_log_emit);
+
+/**
+ * hinata_log_read - Copy the most recent records
+ * @records: Output array, oldest first
+ * @max: Capacity of @records
+ *
+ * Records overwritten or still being written during the copy are skipped.
+ *
+ * Returns: Number of records copied, negative error code on failure
+ */
+int hinata_log_read(struct hinata_log_record *records, u32 max)
+{
+    struct hinata_log_record *rec;
+    u64 head, first, seq;
+    int count = 0;
+
+    if (!records || max == 0) {
+        return -EINVAL;
+    }
+
+    head = atomic64_read(&hinata_log_ring.head);
+    max = min_t(u32, max, HINATA_LOG_RING_SIZE);
+    first = head > max ? head - max : 0;
+
+    for (seq = first; seq < head; seq++) {
+        rec = &hinata_log_ring.records[seq & HINATA_LOG_RING_MASK];
+
+        if (READ_ONCE(rec->seq) != seq + 1) {
+            continue;
+        }
+        smp_rmb();
+
+        records[count] = *rec;
+
+        smp_rmb();
+        if (READ_ONCE(rec->seq) != seq + 1) {
+            continue;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+EXPORT_SYMBOL(hinata_log_read);
+
+/**
+ * hinata_log_get_stats - Get log facility statistics
+ * @stats: Output statistics
+ */
+void hinata_log_get_stats(struct hinata_log_stats *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    stats->records = atomic64_read(&hinata_log_ring.head);
+    stats->printed = atomic64_read(&hinata_log_ring.printed);
+    stats->suppressed = atomic64_read(&hinata_log_ring.suppressed);
+    stats->overwritten = stats->records > HINATA_LOG_RING_SIZE ?
+                         stats->records - HINATA_LOG_RING_SIZE : 0;
+}
+EXPORT_SYMBOL(hinata_log_get_stats);
+
+/**
+ * hinata_log_dump - Format log statistics, call sites and recent records
+ * @m: Sequence file
+ */
+void hinata_log_dump(struct seq_file *m)
+{
+    struct hinata_log_record *records;
+    struct hinata_log_site *site;
+    struct hinata_log_stats stats;
+    int count, i;
+
+    hinata_log_get_stats(&stats);
+
+    seq_printf(m, "Records: %llu (overwritten %llu)\n", stats.records, stats.overwritten);
+    seq_printf(m, "Printed: %llu\n", stats.printed);
+    seq_printf(m, "Suppressed: %llu\n", stats.suppressed);
+
+    seq_puts(m, "\nCall sites:\n");
+    llist_for_each_entry(site, READ_ONCE(hinata_log_sites.first), node) {
+        seq_printf(m, "  %s:%u %-40s hits %llu, suppressed %d\n",
+                   site->func, site->line, site->context,
+                   atomic64_read(&site->hits), atomic_read(&site->suppressed));
+    }
+
+    records = kmalloc_array(HINATA_LOG_DUMP_RECORDS, sizeof(*records), GFP_KERNEL);
+    if (!records) {
+        return;
+    }
+
+    count = hinata_log_read(records, HINATA_LOG_DUMP_RECORDS);
+
+    seq_puts(m, "\nRecent records:\n");
+    for (i = 0; i < count; i++) {
+        seq_printf(m, "  [%llu] %llu cpu%u pid %d %s: %s (%d %s) [%llu, %llu]\n",
+                   records[i].seq - 1, records[i].timestamp, records[i].cpu,
+                   records[i].pid, records[i].site->func, records[i].site->context,
+                   records[i].error,
+                   records[i].error ? hinata_log_error_name(records[i].site, records[i].error) : "",
+                   records[i].args[0], records[i].args[1]);
+    }
+
+    kfree(records);
+}
+EXPORT_SYMBOL(hinata_log_dump);
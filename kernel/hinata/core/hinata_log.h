@@ -0,0 +1,144 @@
+/*
+ * HiNATA Structured Logging - Header File
+ * Part of notcontrolOS Knowledge Management System
+ *
+ * This header defines the structured log facility. Every call site owns a
+ * static descriptor with its own rate limit; each event is stored as a
+ * fixed-size binary record in a ring buffer and only formatted for printk
+ * while the call site is within its budget.
+ */
+
+#ifndef _HINATA_LOG_H
+#define _HINATA_LOG_H
+
+#include <linux/types.h>
+#include <linux/atomic.h>
+#include <linux/llist.h>
+#include <linux/jiffies.h>
+#include "../hinata_types.h"
+
+/* Ring buffer geometry */
+#define HINATA_LOG_RING_ORDER       10
+#define HINATA_LOG_RING_SIZE        (1U << HINATA_LOG_RING_ORDER)
+
+/* Per-site printk budget */
+#define HINATA_LOG_BURST            10
+#define HINATA_LOG_INTERVAL         (5 * HZ)
+
+/**
+ * struct hinata_log_site - Static descriptor of one log call site
+ * @context: Message text
+ * @func: Function containing the call site
+ * @line: Source line of the call site
+ * @level: Severity of the call site
+ * @errno_codes: Error codes are negative errno values, not enum hinata_error_code
+ * @window_start: Start of the current rate limit window, in jiffies
+ * @printed: Messages printed in the current window
+ * @suppressed: Messages suppressed in the current window
+ * @hits: Events recorded since load
+ * @registered: Site has been added to the site list
+ * @node: Site list linkage
+ */
+struct hinata_log_site {
+    const char *context;
+    const char *func;
+    u32 line;
+    enum hinata_log_level level;
+    bool errno_codes;
+    unsigned long window_start;
+    atomic_t printed;
+    atomic_t suppressed;
+    atomic64_t hits;
+    atomic_t registered;
+    struct llist_node node;
+};
+
+/**
+ * struct hinata_log_record - Binary log record
+ * @seq: Sequence number plus one, zero while the slot is being written
+ * @timestamp: Event time in nanoseconds
+ * @site: Call site that produced the record
+ * @error: HiNATA or errno error code, as given by @site->errno_codes
+ * @cpu: CPU the event was recorded on
+ * @pid: Current task
+ * @args: Call site specific values
+ */
+struct hinata_log_record {
+    u64 seq;
+    u64 timestamp;
+    const struct hinata_log_site *site;
+    s32 error;
+    u32 cpu;
+    pid_t pid;
+    u64 args[2];
+};
+
+/**
+ * struct hinata_log_stats - Log facility statistics
+ * @records: Records written to the ring
+ * @printed: Records also sent to printk
+ * @suppressed: Records withheld from printk by rate limiting
+ * @overwritten: Records lost to ring wrap-around
+ */
+struct hinata_log_stats {
+    u64 records;
+    u64 printed;
+    u64 suppressed;
+    u64 overwritten;
+};
+
+#define HINATA_LOG_SITE_INIT(_level, _errno, _context) {                \
+    .context = _context,                                                \
+    .func = __func__,                                                   \
+    .line = __LINE__,                                                   \
+    .level = _level,                                                    \
+    .errno_codes = _errno,                                              \
+}
+
+#define __hinata_log_site(_level, _errno, _error, _context, _a0, _a1, ...) ({ \
+    static struct hinata_log_site __hinata_site =                       \
+        HINATA_LOG_SITE_INIT(_level, _errno, _context);                 \
+    hinata_log_emit(&__hinata_site, (_error), (u64)(_a0), (u64)(_a1));  \
+})
+
+/**
+ * hinata_log_error - Record an error
+ * @error: Error code
+ * @context: Constant message text
+ * @...: Up to two integer values stored with the record
+ *
+ * This is the entry point of the log facility; hinata_log_warn() and
+ * hinata_log_debug() are the same call at a different severity.
+ * Debug records are only recorded while the debug feature is enabled.
+ * @error is an enum hinata_error_code; call sites passing a negative
+ * errno use the _errno variants so the two code spaces never mix.
+ */
+#define hinata_log_error(error, context, ...) \
+    __hinata_log_site(HINATA_LOG_ERROR, false, error, context, ##__VA_ARGS__, 0, 0)
+
+#define hinata_log_warn(error, context, ...) \
+    __hinata_log_site(HINATA_LOG_WARNING, false, error, context, ##__VA_ARGS__, 0, 0)
+
+#define hinata_log_debug(error, context, ...) \
+    __hinata_log_site(HINATA_LOG_DEBUG, false, error, context, ##__VA_ARGS__, 0, 0)
+
+#define hinata_log_error_errno(err, context, ...) \
+    __hinata_log_site(HINATA_LOG_ERROR, true, err, context, ##__VA_ARGS__, 0, 0)
+
+#define hinata_log_warn_errno(err, context, ...) \
+    __hinata_log_site(HINATA_LOG_WARNING, true, err, context, ##__VA_ARGS__, 0, 0)
+
+#define hinata_log_debug_errno(err, context, ...) \
+    __hinata_log_site(HINATA_LOG_DEBUG, true, err, context, ##__VA_ARGS__, 0, 0)
+
+/* Recording */
+void hinata_log_emit(struct hinata_log_site *site, int error, u64 arg0, u64 arg1);
+
+/* Inspection */
+int hinata_log_read(struct hinata_log_record *records, u32 max);
+void hinata_log_get_stats(struct hinata_log_stats *stats);
+
+struct seq_file;
+void hinata_log_dump(struct seq_file *m);
+
+#endif /* _HINATA_LOG_H */
@@ -196,6 +196,7 @@ struct hinata_packet_iterator {
 #define HINATA_PACKET_FLAG_DIRTY        (1 << 5)  /* Packet needs sync */
 #define HINATA_PACKET_FLAG_CACHED       (1 << 6)  /* Packet is cached */
 #define HINATA_PACKET_FLAG_PINNED       (1 << 7)  /* Packet is pinned in memory */
+#define HINATA_PACKET_FLAG_DELETED      (1 << 8)  /* Storage record marks a deletion */
 
 /* Function Declarations */
 
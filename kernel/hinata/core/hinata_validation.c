@@ -80,7 +80,7 @@ int hinata_validate_packet_full(const struct hinata_packet *packet, u32 flags)
     int ret;
     
     if (!packet) {
-        pr_err("HiNATA: Null packet for validation\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Null packet for validation");
         atomic64_inc(&validation_failure_count);
         return -EINVAL;
     }
@@ -103,7 +103,7 @@ int hinata_validate_packet_full(const struct hinata_packet *packet, u32 flags)
     /* Basic structure validation */
     ret = hinata_validate_packet_structure(packet);
     if (ret < 0) {
-        pr_err("HiNATA: Packet structure validation failed\n");
+        hinata_log_error_errno(ret, "Packet structure validation failed");
         goto validation_failed;
     }
     
@@ -111,7 +111,7 @@ int hinata_validate_packet_full(const struct hinata_packet *packet, u32 flags)
     if (flags & HINATA_VALIDATE_CONTENT) {
         ret = hinata_validate_packet_content(packet);
         if (ret < 0) {
-            pr_err("HiNATA: Packet content validation failed\n");
+            hinata_log_error_errno(ret, "Packet content validation failed");
             goto validation_failed;
         }
     }
@@ -120,7 +120,7 @@ int hinata_validate_packet_full(const struct hinata_packet *packet, u32 flags)
     if ((flags & HINATA_VALIDATE_METADATA) && packet->metadata) {
         ret = hinata_validate_packet_metadata(packet);
         if (ret < 0) {
-            pr_err("HiNATA: Packet metadata validation failed\n");
+            hinata_log_error_errno(ret, "Packet metadata validation failed");
             goto validation_failed;
         }
     }
@@ -129,7 +129,7 @@ int hinata_validate_packet_full(const struct hinata_packet *packet, u32 flags)
     if (flags & HINATA_VALIDATE_SECURITY) {
         ret = hinata_validate_packet_security(packet);
         if (ret < 0) {
-            pr_err("HiNATA: Packet security validation failed\n");
+            hinata_log_error_errno(ret, "Packet security validation failed");
             goto validation_failed;
         }
     }
@@ -138,7 +138,7 @@ int hinata_validate_packet_full(const struct hinata_packet *packet, u32 flags)
     if (flags & HINATA_VALIDATE_INTEGRITY) {
         ret = hinata_validate_packet_integrity(packet);
         if (ret < 0) {
-            pr_err("HiNATA: Packet integrity validation failed\n");
+            hinata_log_error_errno(ret, "Packet integrity validation failed");
             goto validation_failed;
         }
     }
@@ -147,7 +147,7 @@ int hinata_validate_packet_full(const struct hinata_packet *packet, u32 flags)
     hinata_validation_cache_add(packet->id, packet->content_hash, true);
     
     atomic64_inc(&validation_success_count);
-    pr_debug("HiNATA: Packet %s validation successful\n", packet->id);
+    hinata_log_debug(HINATA_SUCCESS, "Packet validation successful");
     return 0;
     
 validation_failed:
@@ -170,84 +170,90 @@ int hinata_validate_packet_structure(const struct hinata_packet *packet)
     
     /* Check magic number */
     if (packet->magic != HINATA_PACKET_MAGIC) {
-        pr_err("HiNATA: Invalid packet magic: 0x%x\n", packet->magic);
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid packet magic",
+                         packet->magic);
         return -EINVAL;
     }
     
     /* Check version */
     if (packet->version != HINATA_PACKET_VERSION) {
-        pr_err("HiNATA: Unsupported packet version: %u\n", packet->version);
+        hinata_log_error(HINATA_ERROR_VERSION, "Unsupported packet version",
+                         packet->version);
         return -EINVAL;
     }
     
     /* Validate UUID */
     if (!hinata_validate_uuid_format(packet->id)) {
-        pr_err("HiNATA: Invalid packet UUID format\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid packet UUID format");
         return -EINVAL;
     }
     
     /* Check packet type */
     if (!hinata_packet_is_valid_type(packet->type)) {
-        pr_err("HiNATA: Invalid packet type: %d\n", packet->type);
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid packet type", packet->type);
         return -EINVAL;
     }
     
     /* Check priority */
     if (!hinata_packet_is_valid_priority(packet->priority)) {
-        pr_err("HiNATA: Invalid packet priority: %d\n", packet->priority);
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid packet priority",
+                         packet->priority);
         return -EINVAL;
     }
     
     /* Check status */
     if (!hinata_packet_is_valid_status(packet->status)) {
-        pr_err("HiNATA: Invalid packet status: %d\n", packet->status);
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid packet status",
+                         packet->status);
         return -EINVAL;
     }
     
     /* Validate sizes */
     if (packet->content_size == 0 || packet->content_size > HINATA_MAX_CONTENT_SIZE) {
-        pr_err("HiNATA: Invalid content size: %zu\n", packet->content_size);
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid content size",
+                         packet->content_size);
         return -EINVAL;
     }
     
     if (packet->metadata_size > HINATA_MAX_METADATA_SIZE) {
-        pr_err("HiNATA: Invalid metadata size: %zu\n", packet->metadata_size);
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid metadata size",
+                         packet->metadata_size);
         return -EINVAL;
     }
     
     /* Validate pointers */
     if (!packet->content) {
-        pr_err("HiNATA: Null content pointer\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Null content pointer");
         return -EINVAL;
     }
     
     if (packet->metadata_size > 0 && !packet->metadata) {
-        pr_err("HiNATA: Null metadata pointer with non-zero size\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Null metadata pointer with non-zero size");
         return -EINVAL;
     }
     
     /* Validate source */
     if (!hinata_validate_source_format(packet->source)) {
-        pr_err("HiNATA: Invalid source format\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid source format");
         return -EINVAL;
     }
     
     /* Validate timestamps */
     if (!hinata_validate_timestamps(packet->created_at, packet->updated_at)) {
-        pr_err("HiNATA: Invalid timestamps\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid timestamps");
         return -EINVAL;
     }
     
     /* Validate tags */
     if (!hinata_validate_tags_format(packet->tags, packet->tag_count)) {
-        pr_err("HiNATA: Invalid tags format\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid tags format");
         return -EINVAL;
     }
     
     /* Validate reference count */
     if (atomic_read(&packet->ref_count) <= 0) {
-        pr_err("HiNATA: Invalid reference count: %d\n",
-               atomic_read(&packet->ref_count));
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid reference count",
+                         atomic_read(&packet->ref_count));
         return -EINVAL;
     }
     
@@ -272,7 +278,7 @@ int hinata_validate_packet_content(const struct hinata_packet *packet)
     if (!hinata_validate_content_integrity(packet->content,
                                          packet->content_size,
                                          packet->content_hash)) {
-        pr_err("HiNATA: Content integrity check failed\n");
+        hinata_log_error(HINATA_ERROR_CORRUPTION, "Content integrity check failed");
         return -EINVAL;
     }
     
@@ -282,7 +288,7 @@ int hinata_validate_packet_content(const struct hinata_packet *packet)
     case HINATA_PACKET_MARKDOWN:
         /* Validate text content */
         if (!hinata_is_printable_string(packet->content, packet->content_size)) {
-            pr_err("HiNATA: Invalid text content\n");
+            hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid text content");
             return -EINVAL;
         }
         break;
@@ -290,7 +296,7 @@ int hinata_validate_packet_content(const struct hinata_packet *packet)
     case HINATA_PACKET_CODE:
         /* Basic code validation - ensure it's text */
         if (!hinata_is_printable_string(packet->content, packet->content_size)) {
-            pr_err("HiNATA: Invalid code content\n");
+            hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid code content");
             return -EINVAL;
         }
         break;
@@ -298,7 +304,7 @@ int hinata_validate_packet_content(const struct hinata_packet *packet)
     case HINATA_PACKET_LINK:
         /* Validate URL format */
         if (packet->content_size > 2048) {
-            pr_err("HiNATA: Link too long\n");
+            hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Link too long");
             return -EINVAL;
         }
         break;
@@ -311,14 +317,14 @@ int hinata_validate_packet_content(const struct hinata_packet *packet)
     case HINATA_PACKET_ARCHIVE:
         /* Binary content - basic size check */
         if (packet->content_size > HINATA_MAX_CONTENT_SIZE) {
-            pr_err("HiNATA: Binary content too large\n");
+            hinata_log_error(HINATA_ERROR_CAPACITY, "Binary content too large");
             return -EINVAL;
         }
         break;
         
     default:
-        pr_warn("HiNATA: Unknown packet type for content validation: %d\n",
-                packet->type);
+        hinata_log_warn(HINATA_ERROR_UNSUPPORTED, "Unknown packet type for content validation",
+                        packet->type);
         break;
     }
     
@@ -341,7 +347,7 @@ int hinata_validate_packet_metadata(const struct hinata_packet *packet)
         return 0;  /* No metadata to validate */
     
     if (!packet->metadata) {
-        pr_err("HiNATA: Null metadata pointer with non-zero size\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Null metadata pointer with non-zero size");
         return -EINVAL;
     }
     
@@ -349,7 +355,7 @@ int hinata_validate_packet_metadata(const struct hinata_packet *packet)
     
     /* Validate metadata format */
     if (!hinata_validate_metadata_format(packet->metadata, packet->metadata_size)) {
-        pr_err("HiNATA: Invalid metadata format\n");
+        hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Invalid metadata format");
         return -EINVAL;
     }
     
@@ -377,7 +383,8 @@ int hinata_validate_packet_security(const struct hinata_packet *packet)
         for (i = 0; i < packet->content_size - 1; i++) {
             /* Check for null bytes in text content */
             if (content[i] == '\0') {
-                pr_warn("HiNATA: Null byte found in text content at position %zu\n", i);
+                hinata_log_warn(HINATA_ERROR_PERMISSION, "Null byte found in text content",
+                                i);
                 return -EINVAL;
             }
         }
@@ -385,7 +392,7 @@ int hinata_validate_packet_security(const struct hinata_packet *packet)
     
     /* Validate source for security */
     if (strstr(packet->source, "..") || strstr(packet->source, "/")) {
-        pr_err("HiNATA: Suspicious source path: %s\n", packet->source);
+        hinata_log_error(HINATA_ERROR_PERMISSION, "Suspicious source path");
         return -EINVAL;
     }
     
@@ -393,7 +400,7 @@ int hinata_validate_packet_security(const struct hinata_packet *packet)
     size_t i;
     for (i = 0; i < packet->tag_count; i++) {
         if (strlen(packet->tags[i]) >= HINATA_MAX_TAG_LENGTH) {
-            pr_err("HiNATA: Tag too long at index %zu\n", i);
+            hinata_log_error(HINATA_ERROR_INVALID_PARAM, "Tag too long", i);
             return -EINVAL;
         }
     }
@@ -418,8 +425,8 @@ int hinata_validate_packet_integrity(const struct hinata_packet *packet)
     /* Calculate and verify content hash */
     calculated_hash = crc32(0, packet->content, packet->content_size);
     if (calculated_hash != packet->content_hash) {
-        pr_err("HiNATA: Content hash mismatch: expected 0x%x, got 0x%x\n",
-               packet->content_hash, calculated_hash);
+        hinata_log_error(HINATA_ERROR_CORRUPTION, "Content hash mismatch",
+                         packet->content_hash, calculated_hash);
         return -EINVAL;
     }
     
@@ -429,8 +436,8 @@ int hinata_validate_packet_integrity(const struct hinata_packet *packet)
         expected_size += packet->metadata_size;
     
     if (packet->size != expected_size) {
-        pr_err("HiNATA: Size mismatch: expected %zu, got %zu\n",
-               expected_size, packet->size);
+        hinata_log_error(HINATA_ERROR_CORRUPTION, "Size mismatch",
+                         expected_size, packet->size);
         return -EINVAL;
     }
     
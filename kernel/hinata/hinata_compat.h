@@ -550,6 +550,15 @@ struct atomic_notifier_head {
 #define atomic_notifier_chain_unregister(nh, nb) 0
 #define atomic_notifier_call_chain(nh, val, v) 0
 
+struct blocking_notifier_head {
+    struct notifier_block *head;
+};
+
+#define BLOCKING_NOTIFIER_HEAD(name) struct blocking_notifier_head name = { .head = NULL }
+#define blocking_notifier_chain_register(nh, nb) 0
+#define blocking_notifier_chain_unregister(nh, nb) 0
+#define blocking_notifier_call_chain(nh, val, v) 0
+
 /* Reboot notifier */
 #define register_reboot_notifier(nb) 0
 #define unregister_reboot_notifier(nb) 0
@@ -732,6 +741,43 @@ enum hrtimer_restart {
 #define rcu_assign_pointer(p, v) ((p) = (v))
 #define synchronize_rcu() do { } while (0)
 #define call_rcu(head, func) do { (func)(head); } while (0)
+#define __rcu
+#define RCU_INITIALIZER(v) (v)
+#define rcu_dereference_protected(p, c) (p)
+#define lockdep_is_held(l) 1
+#define kfree_rcu(ptr, field) kfree(ptr)
+#define rcu_barrier() do { } while (0)
+
+/*
+ * Static keys. Userspace has no code patching, so keys are plain flags
+ * tested with a branch hint. Define HINATA_COMPAT_STATIC_KEYS_FIXED to
+ * fold every branch to the key's declared default instead, which lets the
+ * compiler drop disabled debug paths entirely in benchmark builds.
+ */
+struct static_key { int enabled; };
+struct static_key_true { struct static_key key; };
+struct static_key_false { struct static_key key; };
+
+#define DECLARE_STATIC_KEY_TRUE(name) extern struct static_key_true name
+#define DECLARE_STATIC_KEY_FALSE(name) extern struct static_key_false name
+#define DEFINE_STATIC_KEY_TRUE(name) struct static_key_true name = { { 1 } }
+#define DEFINE_STATIC_KEY_FALSE(name) struct static_key_false name = { { 0 } }
+
+#ifdef HINATA_COMPAT_STATIC_KEYS_FIXED
+#define __hinata_static_key_default(x) \
+    _Generic((x), struct static_key_true *: 1, default: 0)
+#define static_branch_likely(x) __builtin_expect(__hinata_static_key_default(x), 1)
+#define static_branch_unlikely(x) __builtin_expect(__hinata_static_key_default(x), 0)
+#define static_branch_enable(x) do { } while (0)
+#define static_branch_disable(x) do { } while (0)
+#define static_key_enabled(x) __hinata_static_key_default(x)
+#else
+#define static_branch_likely(x) __builtin_expect(!!(x)->key.enabled, 1)
+#define static_branch_unlikely(x) __builtin_expect(!!(x)->key.enabled, 0)
+#define static_branch_enable(x) do { (x)->key.enabled = 1; } while (0)
+#define static_branch_disable(x) do { (x)->key.enabled = 0; } while (0)
+#define static_key_enabled(x) (!!(x)->key.enabled)
+#endif
 
 /* Percpu operations */
 #define get_cpu() 0
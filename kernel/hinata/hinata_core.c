@@ -357,6 +357,8 @@
 #include "hinata_core.h"
 #include "core/hinata_packet.h"
 #include "core/hinata_validation.h"
+#include "core/hinata_health.h"
+#include "core/hinata_config.h"
 #include "storage/hinata_storage.h"
 #include "kernel/hinata_memory.h"
 #include "kernel/hinata_syscalls.h"
@@ -378,7 +380,6 @@ MODULE_LICENSE(HINATA_CORE_LICENSE);
 #define HINATA_CORE_MAX_SUBSYSTEMS          32
 #define HINATA_CORE_MAX_WORKERS             16
 #define HINATA_CORE_WORKER_STACK_SIZE       8192
-#define HINATA_CORE_HEARTBEAT_INTERVAL      (5 * HZ)  /* 5 seconds */
 #define HINATA_CORE_SHUTDOWN_TIMEOUT        30000     /* 30 seconds */
 #define HINATA_CORE_INIT_TIMEOUT            10000     /* 10 seconds */
 
@@ -430,6 +431,16 @@ struct hinata_system_stats hinata_global_stats = {
 };
 EXPORT_SYMBOL(hinata_global_stats);
 
+/* Hot-path feature switches, see hinata_system_set_flag() */
+#ifdef HINATA_DEBUG
+DEFINE_STATIC_KEY_TRUE(hinata_debug_key);
+#else
+DEFINE_STATIC_KEY_FALSE(hinata_debug_key);
+#endif
+EXPORT_SYMBOL(hinata_debug_key);
+DEFINE_STATIC_KEY_FALSE(hinata_validation_key);
+EXPORT_SYMBOL(hinata_validation_key);
+
 /* Subsystem registry */
 static struct hinata_subsystem *hinata_subsystems[HINATA_CORE_MAX_SUBSYSTEMS];
 static DEFINE_MUTEX(hinata_subsystem_mutex);
@@ -470,6 +481,10 @@ static int hinata_panic_notifier_func(struct notifier_block *nb,
                                      unsigned long action, void *data);
 static int hinata_reboot_notifier_func(struct notifier_block *nb,
                                       unsigned long action, void *data);
+static int hinata_pm_notifier_func(struct notifier_block *nb,
+                                  unsigned long action, void *data);
+static int hinata_config_notifier_func(struct notifier_block *nb,
+                                      unsigned long action, void *data);
 
 /* Notifier blocks */
 static struct notifier_block hinata_panic_nb = {
@@ -482,6 +497,26 @@ static struct notifier_block hinata_reboot_nb = {
     .priority = INT_MAX,
 };
 
+static struct notifier_block hinata_pm_nb = {
+    .notifier_call = hinata_pm_notifier_func,
+    .priority = 0,
+};
+
+static struct notifier_block hinata_config_nb = {
+    .notifier_call = hinata_config_notifier_func,
+    .priority = 0,
+};
+
+/**
+ * hinata_core_heartbeat_delay - Heartbeat period from the live configuration
+ * 
+ * Returns: Heartbeat period in jiffies
+ */
+static inline unsigned long hinata_core_heartbeat_delay(void)
+{
+    return msecs_to_jiffies(hinata_config_value(heartbeat_interval_ms));
+}
+
 /**
  * hinata_system_is_enabled - Check if HiNATA system is enabled
  * 
@@ -547,6 +582,145 @@ int hinata_set_system_state(enum hinata_system_state new_state)
 }
 EXPORT_SYMBOL(hinata_set_system_state);
 
+/**
+ * hinata_system_sync_feature_keys - Patch feature switches to match flags
+ * @flags: System flags
+ * 
+ * Must be called from process context; patching a static key sleeps.
+ */
+static void hinata_system_sync_feature_keys(u32 flags)
+{
+    if (flags & HINATA_SYSTEM_FLAG_DEBUG) {
+        static_branch_enable(&hinata_debug_key);
+    } else {
+        static_branch_disable(&hinata_debug_key);
+    }
+    
+    if (flags & HINATA_SYSTEM_FLAG_VALIDATION) {
+        static_branch_enable(&hinata_validation_key);
+    } else {
+        static_branch_disable(&hinata_validation_key);
+    }
+}
+
+/**
+ * hinata_system_get_flags - Get system flags
+ * 
+ * Returns: Current system flags
+ */
+u32 hinata_system_get_flags(void)
+{
+    return READ_ONCE(hinata_global_state.flags);
+}
+EXPORT_SYMBOL(hinata_system_get_flags);
+
+/**
+ * hinata_system_has_flag - Check a system flag
+ * @flag: Flag to check
+ * 
+ * Returns: true if set, false otherwise
+ */
+bool hinata_system_has_flag(u32 flag)
+{
+    return (hinata_system_get_flags() & flag) != 0;
+}
+EXPORT_SYMBOL(hinata_system_has_flag);
+
+/**
+ * hinata_system_update_flags - Set and clear system flags
+ * @set: Flags to set
+ * @clear: Flags to clear
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_system_update_flags(u32 set, u32 clear)
+{
+    unsigned long irqflags;
+    u32 flags;
+    
+    might_sleep();
+    
+    mutex_lock(&hinata_core_mutex);
+    
+    spin_lock_irqsave(&hinata_state_lock, irqflags);
+    flags = (hinata_global_state.flags | set) & ~clear;
+    WRITE_ONCE(hinata_global_state.flags, flags);
+    spin_unlock_irqrestore(&hinata_state_lock, irqflags);
+    
+    hinata_system_sync_feature_keys(flags);
+    
+    mutex_unlock(&hinata_core_mutex);
+    
+    return 0;
+}
+
+/**
+ * hinata_system_set_flag - Set a system flag
+ * @flag: Flag to set
+ * 
+ * Setting HINATA_SYSTEM_FLAG_DEBUG or HINATA_SYSTEM_FLAG_VALIDATION
+ * patches the corresponding feature switch in.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_system_set_flag(u32 flag)
+{
+    return hinata_system_update_flags(flag, 0);
+}
+EXPORT_SYMBOL(hinata_system_set_flag);
+
+/**
+ * hinata_system_clear_flag - Clear a system flag
+ * @flag: Flag to clear
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_system_clear_flag(u32 flag)
+{
+    return hinata_system_update_flags(0, flag);
+}
+EXPORT_SYMBOL(hinata_system_clear_flag);
+
+/**
+ * hinata_increment_error_count - Count an error
+ */
+void hinata_increment_error_count(void)
+{
+    atomic64_inc(&hinata_global_state.error_count);
+}
+EXPORT_SYMBOL(hinata_increment_error_count);
+
+/**
+ * hinata_increment_warning_count - Count a warning
+ */
+void hinata_increment_warning_count(void)
+{
+    atomic64_inc(&hinata_global_state.warning_count);
+}
+EXPORT_SYMBOL(hinata_increment_warning_count);
+
+/**
+ * hinata_get_error_count - Get total error count
+ * 
+ * Returns: Errors counted since load
+ */
+u64 hinata_get_error_count(void)
+{
+    return atomic64_read(&hinata_global_state.error_count);
+}
+EXPORT_SYMBOL(hinata_get_error_count);
+
+/**
+ * hinata_get_warning_count - Get total warning count
+ * 
+ * Returns: Warnings counted since load
+ */
+u64 hinata_get_warning_count(void)
+{
+    return atomic64_read(&hinata_global_state.warning_count);
+}
+EXPORT_SYMBOL(hinata_get_warning_count);
+
 /**
  * hinata_system_state_to_string - Convert state to string
  * @state: System state
@@ -847,13 +1021,15 @@ static void hinata_core_cleanup_subsystems(void)
  */
 static int hinata_core_start_workers(void)
 {
-    int i, ret;
+    int i, ret, count;
+    
+    count = min_t(int, hinata_config_value(worker_count), HINATA_CORE_MAX_WORKERS);
     
-    pr_info("HiNATA: Starting worker threads\n");
+    pr_info("HiNATA: Starting %d worker threads\n", count);
     
     mutex_lock(&hinata_worker_mutex);
     
-    for (i = 0; i < HINATA_CORE_MAX_WORKERS; i++) {
+    for (i = 0; i < count; i++) {
         struct hinata_worker *worker = &hinata_workers[i];
         
         if (worker->task) {
@@ -901,17 +1077,17 @@ static int hinata_core_start_workers(void)
 }
 
 /**
- * hinata_core_stop_workers - Stop worker threads
+ * hinata_core_stop_worker_range - Stop worker threads in a range
+ * @first: First worker to stop
+ * 
+ * Stops workers @first..HINATA_CORE_MAX_WORKERS-1. Caller holds
+ * hinata_worker_mutex.
  */
-static void hinata_core_stop_workers(void)
+static void hinata_core_stop_worker_range(int first)
 {
     int i;
     
-    pr_info("HiNATA: Stopping worker threads\n");
-    
-    mutex_lock(&hinata_worker_mutex);
-    
-    for (i = 0; i < HINATA_CORE_MAX_WORKERS; i++) {
+    for (i = first; i < HINATA_CORE_MAX_WORKERS; i++) {
         struct hinata_worker *worker = &hinata_workers[i];
         
         if (!worker->task) {
@@ -930,12 +1106,40 @@ static void hinata_core_stop_workers(void)
         
         pr_debug("HiNATA: Worker thread %d stopped\n", i);
     }
+}
+
+/**
+ * hinata_core_stop_workers - Stop worker threads
+ */
+static void hinata_core_stop_workers(void)
+{
+    pr_info("HiNATA: Stopping worker threads\n");
     
+    mutex_lock(&hinata_worker_mutex);
+    hinata_core_stop_worker_range(0);
     mutex_unlock(&hinata_worker_mutex);
     
     pr_info("HiNATA: All worker threads stopped\n");
 }
 
+/**
+ * hinata_core_resize_workers - Match running workers to the configuration
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_core_resize_workers(void)
+{
+    int count;
+    
+    count = min_t(int, hinata_config_value(worker_count), HINATA_CORE_MAX_WORKERS);
+    
+    mutex_lock(&hinata_worker_mutex);
+    hinata_core_stop_worker_range(count);
+    mutex_unlock(&hinata_worker_mutex);
+    
+    return hinata_core_start_workers();
+}
+
 /**
  * hinata_heartbeat_timer_func - Heartbeat timer function
  * @timer: Timer structure
@@ -946,7 +1150,7 @@ static void hinata_heartbeat_timer_func(struct timer_list *timer)
     queue_work(hinata_workqueue, &hinata_heartbeat_work);
     
     /* Reschedule timer */
-    mod_timer(&hinata_heartbeat_timer, jiffies + HINATA_CORE_HEARTBEAT_INTERVAL);
+    mod_timer(&hinata_heartbeat_timer, jiffies + hinata_core_heartbeat_delay());
 }
 
 /**
@@ -960,10 +1164,12 @@ static void hinata_heartbeat_work_func(struct work_struct *work)
     /* Update heartbeat timestamp */
     hinata_global_state.last_heartbeat = now;
     
-    /* Check system health */
+    /* Evaluate latency and error-rate objectives over the last window */
     if (hinata_system_is_running()) {
-        /* TODO: Implement health checks */
-        pr_debug("HiNATA: Heartbeat - system healthy\n");
+        enum hinata_health_level level = hinata_health_evaluate();
+
+        pr_debug("HiNATA: Heartbeat - health %s\n",
+                hinata_health_level_to_string(level));
     }
 }
 
@@ -1015,12 +1221,73 @@ static int hinata_reboot_notifier_func(struct notifier_block *nb,
 {
     pr_info("HiNATA: System reboot detected, stopping system\n");
     
+    /* Flush storage and persist the warm-restart snapshot */
+    hinata_storage_suspend();
+    
     /* Stop HiNATA system */
     hinata_system_stop();
     
     return NOTIFY_DONE;
 }
 
+/**
+ * hinata_pm_notifier_func - Power management notifier function
+ * @nb: Notifier block
+ * @action: PM event
+ * @data: Unused
+ * 
+ * Returns: NOTIFY_OK, or NOTIFY_BAD if the system cannot be suspended
+ */
+static int hinata_pm_notifier_func(struct notifier_block *nb,
+                                  unsigned long action, void *data)
+{
+    switch (action) {
+    case PM_HIBERNATION_PREPARE:
+    case PM_SUSPEND_PREPARE:
+        if (hinata_system_is_running()) {
+            return notifier_from_errno(hinata_system_suspend());
+        }
+        break;
+    case PM_POST_HIBERNATION:
+    case PM_POST_SUSPEND:
+    case PM_POST_RESTORE:
+        hinata_system_resume();
+        break;
+    default:
+        break;
+    }
+    
+    return NOTIFY_OK;
+}
+
+/**
+ * hinata_config_notifier_func - Configuration change notifier function
+ * @nb: Notifier block
+ * @action: HINATA_CONFIG_CHANGED
+ * @data: struct hinata_config_change
+ * 
+ * Returns: NOTIFY_OK, or an errno-encoded result if workers failed to start
+ */
+static int hinata_config_notifier_func(struct notifier_block *nb,
+                                      unsigned long action, void *data)
+{
+    struct hinata_config_change *change = data;
+    
+    if (action != HINATA_CONFIG_CHANGED || !hinata_system_is_running()) {
+        return NOTIFY_DONE;
+    }
+    
+    if (change->new->heartbeat_interval_ms != change->old->heartbeat_interval_ms) {
+        mod_timer(&hinata_heartbeat_timer, jiffies + hinata_core_heartbeat_delay());
+    }
+    
+    if (change->new->worker_count != change->old->worker_count) {
+        return notifier_from_errno(hinata_core_resize_workers());
+    }
+    
+    return NOTIFY_OK;
+}
+
 /**
  * hinata_system_init - Initialize HiNATA system
  * 
@@ -1041,6 +1308,11 @@ int hinata_system_init(void)
     /* Set initializing state */
     hinata_set_system_state(HINATA_STATE_INITIALIZING);
     
+    /* Reflect build-time feature defaults in the system flags */
+    if (static_key_enabled(&hinata_debug_key)) {
+        hinata_global_state.flags |= HINATA_SYSTEM_FLAG_DEBUG;
+    }
+    
     /* Initialize timestamps */
     hinata_global_state.init_time = ktime_get_ns();
     hinata_global_state.version.timestamp = hinata_global_state.init_time;
@@ -1060,6 +1332,13 @@ int hinata_system_init(void)
     /* Initialize heartbeat timer */
     timer_setup(&hinata_heartbeat_timer, hinata_heartbeat_timer_func, 0);
     
+    /* Initialize health monitoring before anything records operations */
+    ret = hinata_health_init();
+    if (ret < 0) {
+        pr_err("HiNATA: Failed to initialize health monitoring: %d\n", ret);
+        goto err_health;
+    }
+    
     /* Register notifiers */
     ret = atomic_notifier_chain_register(&panic_notifier_list, &hinata_panic_nb);
     if (ret < 0) {
@@ -1073,6 +1352,18 @@ int hinata_system_init(void)
         goto err_reboot_notifier;
     }
     
+    ret = register_pm_notifier(&hinata_pm_nb);
+    if (ret < 0) {
+        pr_err("HiNATA: Failed to register PM notifier: %d\n", ret);
+        goto err_pm_notifier;
+    }
+    
+    ret = hinata_config_register_notifier(&hinata_config_nb);
+    if (ret < 0) {
+        pr_err("HiNATA: Failed to register config notifier: %d\n", ret);
+        goto err_config_notifier;
+    }
+    
     /* Initialize subsystems */
     ret = hinata_core_init_subsystems();
     if (ret < 0) {
@@ -1091,10 +1382,16 @@ int hinata_system_init(void)
     return 0;
     
 err_subsystems:
+    hinata_config_unregister_notifier(&hinata_config_nb);
+err_config_notifier:
+    unregister_pm_notifier(&hinata_pm_nb);
+err_pm_notifier:
     unregister_reboot_notifier(&hinata_reboot_nb);
 err_reboot_notifier:
     atomic_notifier_chain_unregister(&panic_notifier_list, &hinata_panic_nb);
 err_panic_notifier:
+    hinata_health_exit();
+err_health:
     destroy_workqueue(hinata_workqueue);
 err_workqueue:
     hinata_set_system_state(HINATA_STATE_ERROR);
@@ -1130,7 +1427,7 @@ int hinata_system_start(void)
     }
     
     /* Start heartbeat timer */
-    mod_timer(&hinata_heartbeat_timer, jiffies + HINATA_CORE_HEARTBEAT_INTERVAL);
+    mod_timer(&hinata_heartbeat_timer, jiffies + hinata_core_heartbeat_delay());
     
     /* Start maintenance work */
     queue_delayed_work(hinata_workqueue, &hinata_maintenance_work, 60 * HZ);
@@ -1186,6 +1483,115 @@ int hinata_system_stop(void)
 }
 EXPORT_SYMBOL(hinata_system_stop);
 
+/**
+ * hinata_system_suspend - Suspend HiNATA system
+ * 
+ * Suspends subsystems in reverse registration order, then lets storage
+ * flush and persist its warm-restart snapshot.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_system_suspend(void)
+{
+    struct hinata_subsystem *subsystem;
+    int i, ret;
+    
+    if (hinata_global_state.state == HINATA_STATE_SUSPENDED) {
+        return 0;
+    }
+    
+    if (hinata_global_state.state != HINATA_STATE_RUNNING) {
+        pr_warn("HiNATA: System not running, cannot suspend\n");
+        return -EINVAL;
+    }
+    
+    pr_info("HiNATA: Suspending system\n");
+    
+    /* Stop periodic work first so nothing races the snapshot */
+    del_timer_sync(&hinata_heartbeat_timer);
+    cancel_work_sync(&hinata_heartbeat_work);
+    cancel_delayed_work_sync(&hinata_maintenance_work);
+    
+    down_write(&hinata_subsystem_rwsem);
+    for (i = HINATA_CORE_MAX_SUBSYSTEMS - 1; i >= 0; i--) {
+        subsystem = hinata_subsystems[i];
+        if (!subsystem || !subsystem->suspend ||
+            subsystem->state != HINATA_SUBSYSTEM_STATE_RUNNING) {
+            continue;
+        }
+        
+        ret = subsystem->suspend(subsystem);
+        if (ret < 0) {
+            pr_warn("HiNATA: Failed to suspend subsystem '%s': %d\n",
+                   subsystem->name, ret);
+            continue;
+        }
+        subsystem->state = HINATA_SUBSYSTEM_STATE_SUSPENDED;
+    }
+    up_write(&hinata_subsystem_rwsem);
+    
+    ret = hinata_storage_suspend();
+    if (ret < 0 && ret != -ENODEV) {
+        pr_warn("HiNATA: Failed to suspend storage: %d\n", ret);
+    }
+    
+    hinata_set_system_state(HINATA_STATE_SUSPENDED);
+    
+    return 0;
+}
+EXPORT_SYMBOL(hinata_system_suspend);
+
+/**
+ * hinata_system_resume - Resume HiNATA system
+ * 
+ * Storage resumes first and warms its cache in the background, so
+ * subsystems and callers are not held up by cold storage reads.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_system_resume(void)
+{
+    struct hinata_subsystem *subsystem;
+    int i, ret;
+    
+    if (hinata_global_state.state != HINATA_STATE_SUSPENDED) {
+        return 0;
+    }
+    
+    pr_info("HiNATA: Resuming system\n");
+    
+    ret = hinata_storage_resume();
+    if (ret < 0 && ret != -ENODEV) {
+        pr_warn("HiNATA: Failed to resume storage: %d\n", ret);
+    }
+    
+    down_write(&hinata_subsystem_rwsem);
+    for (i = 0; i < HINATA_CORE_MAX_SUBSYSTEMS; i++) {
+        subsystem = hinata_subsystems[i];
+        if (!subsystem || subsystem->state != HINATA_SUBSYSTEM_STATE_SUSPENDED) {
+            continue;
+        }
+        
+        ret = subsystem->resume ? subsystem->resume(subsystem) : 0;
+        if (ret < 0) {
+            pr_err("HiNATA: Failed to resume subsystem '%s': %d\n",
+                  subsystem->name, ret);
+            subsystem->state = HINATA_SUBSYSTEM_STATE_ERROR;
+            continue;
+        }
+        subsystem->state = HINATA_SUBSYSTEM_STATE_RUNNING;
+    }
+    up_write(&hinata_subsystem_rwsem);
+    
+    mod_timer(&hinata_heartbeat_timer, jiffies + hinata_core_heartbeat_delay());
+    queue_delayed_work(hinata_workqueue, &hinata_maintenance_work, 60 * HZ);
+    
+    hinata_set_system_state(HINATA_STATE_RUNNING);
+    
+    return 0;
+}
+EXPORT_SYMBOL(hinata_system_resume);
+
 /**
  * hinata_system_cleanup - Cleanup HiNATA system
  */
@@ -1201,7 +1607,12 @@ void hinata_system_cleanup(void)
     /* Cleanup subsystems */
     hinata_core_cleanup_subsystems();
     
+    /* Cleanup health monitoring */
+    hinata_health_exit();
+    
     /* Unregister notifiers */
+    hinata_config_unregister_notifier(&hinata_config_nb);
+    unregister_pm_notifier(&hinata_pm_nb);
     unregister_reboot_notifier(&hinata_reboot_nb);
     atomic_notifier_chain_unregister(&panic_notifier_list, &hinata_panic_nb);
     
@@ -1211,6 +1622,9 @@ void hinata_system_cleanup(void)
         hinata_workqueue = NULL;
     }
     
+    /* Drop runtime configuration changes */
+    hinata_config_exit();
+    
     /* Complete shutdown */
     complete(&hinata_shutdown_completion);
     
@@ -14,13 +14,16 @@
 #include <linux/mutex.h>
 #include <linux/spinlock.h>
 #include <linux/time.h>
+#include <linux/jump_label.h>
 #include "hinata_types.h"
+#include "core/hinata_log.h"
 
 /* Core system constants */
 #define HINATA_CORE_VERSION         "1.0.0"
 #define HINATA_CORE_BUILD_DATE      __DATE__ " " __TIME__
 #define HINATA_CORE_MAX_SUBSYSTEMS  16
 #define HINATA_CORE_MAX_WORKERS     8
+#define HINATA_CORE_HEARTBEAT_INTERVAL_MS   5000    /* Default */
 
 /* System state flags */
 #define HINATA_SYSTEM_FLAG_INITIALIZED      (1 << 0)
@@ -179,6 +182,18 @@ struct hinata_system_info {
 extern struct hinata_system_state hinata_system;
 extern struct hinata_system_stats hinata_stats;
 
+/*
+ * Feature switches for hot paths, kept in sync with HINATA_SYSTEM_FLAG_DEBUG
+ * and HINATA_SYSTEM_FLAG_VALIDATION by hinata_system_set_flag() and
+ * hinata_system_clear_flag(). Debug builds default the debug key to on.
+ */
+#ifdef HINATA_DEBUG
+DECLARE_STATIC_KEY_TRUE(hinata_debug_key);
+#else
+DECLARE_STATIC_KEY_FALSE(hinata_debug_key);
+#endif
+DECLARE_STATIC_KEY_FALSE(hinata_validation_key);
+
 /* Core system functions */
 int hinata_system_init(void);
 void hinata_system_cleanup(void);
@@ -252,7 +267,6 @@ int hinata_check_memory_limit(size_t additional_size);
 
 /* Error handling */
 const char *hinata_error_to_string(enum hinata_error_code error);
-void hinata_log_error(enum hinata_error_code error, const char *context);
 void hinata_increment_error_count(void);
 void hinata_increment_warning_count(void);
 u64 hinata_get_error_count(void);
@@ -377,7 +391,7 @@ static inline u64 hinata_get_system_uptime_ms(void)
  */
 static inline bool hinata_is_debug_enabled(void)
 {
-    return hinata_system_is_flag_set(HINATA_SYSTEM_FLAG_DEBUG);
+    return static_branch_unlikely(&hinata_debug_key);
 }
 
 /**
@@ -387,7 +401,7 @@ static inline bool hinata_is_debug_enabled(void)
  */
 static inline bool hinata_is_validation_enabled(void)
 {
-    return hinata_system_is_flag_set(HINATA_SYSTEM_FLAG_VALIDATION);
+    return static_branch_unlikely(&hinata_validation_key);
 }
 
 /**
@@ -0,0 +1,69 @@
+/*
+ * HiNATA Task Submission Interface
+ * Part of notcontrolOS Knowledge Management System
+ *
+ * This header defines the task types, task flags and submission entry
+ * points shared by the worker thread system and the subsystems that queue
+ * work on it. It carries no worker structures, so it can be included next
+ * to hinata_core.h.
+ */
+
+#ifndef _HINATA_TASK_H
+#define _HINATA_TASK_H
+
+#include <linux/types.h>
+
+/* Task types */
+enum hinata_task_type {
+    HINATA_TASK_TYPE_PACKET_PROCESS = 0,
+    HINATA_TASK_TYPE_STORAGE_SYNC,
+    HINATA_TASK_TYPE_MEMORY_GC,
+    HINATA_TASK_TYPE_VALIDATION,
+    HINATA_TASK_TYPE_MAINTENANCE,
+    HINATA_TASK_TYPE_BACKUP,
+    HINATA_TASK_TYPE_RESTORE,
+    HINATA_TASK_TYPE_CLEANUP,
+    HINATA_TASK_TYPE_EXPORT,
+    HINATA_TASK_TYPE_CUSTOM,
+    HINATA_TASK_TYPE_MAX,
+};
+
+/* Task flags */
+#define HINATA_TASK_FLAG_URGENT             0x0001
+#define HINATA_TASK_FLAG_BACKGROUND         0x0002
+#define HINATA_TASK_FLAG_PERSISTENT         0x0004
+#define HINATA_TASK_FLAG_EXCLUSIVE          0x0008
+#define HINATA_TASK_FLAG_CPU_INTENSIVE      0x0010
+#define HINATA_TASK_FLAG_IO_INTENSIVE       0x0020
+#define HINATA_TASK_FLAG_MEMORY_INTENSIVE   0x0040
+#define HINATA_TASK_FLAG_INTERRUPTIBLE      0x0080
+#define HINATA_TASK_FLAG_CANCELLABLE        0x0100
+#define HINATA_TASK_FLAG_RETRYABLE          0x0200
+#define HINATA_TASK_FLAG_LOGGED             0x0400
+#define HINATA_TASK_FLAG_TRACED             0x0800
+#define HINATA_TASK_FLAG_HIGH_PRIORITY      0x1000
+#define HINATA_TASK_FLAG_LOW_PRIORITY       0x2000
+#define HINATA_TASK_FLAG_REAL_TIME          0x4000
+#define HINATA_TASK_FLAG_BATCH              0x8000
+
+/* Task function type */
+typedef int (*hinata_task_func_t)(void *data);
+
+/*
+ * Task cancel callback type: called in process context, in place of the
+ * task function, when a queued task is dropped without running. @reason
+ * is a negative error code.
+ */
+typedef void (*hinata_task_cancel_t)(void *data, int reason);
+
+/*
+ * Task submission. Both return the task ID or a negative error code; when
+ * submission fails the task is not queued and @cancel is not called.
+ */
+int hinata_submit_task(enum hinata_task_type type, hinata_task_func_t func,
+                      void *data, size_t data_size, u32 flags);
+int hinata_submit_task_cancellable(enum hinata_task_type type, hinata_task_func_t func,
+                                   hinata_task_cancel_t cancel, void *data,
+                                   size_t data_size, u32 flags);
+
+#endif /* _HINATA_TASK_H */
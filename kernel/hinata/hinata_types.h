@@ -174,6 +174,7 @@ enum hinata_log_level {
  * @HINATA_OP_BACKUP: Backup operation
  * @HINATA_OP_RESTORE: Restore operation
  * @HINATA_OP_MAINTENANCE: Maintenance operation
+ * @HINATA_OP_TYPE_MAX: Number of operation types
  */
 enum hinata_operation_type {
     HINATA_OP_CREATE = 0,
@@ -185,7 +186,8 @@ enum hinata_operation_type {
     HINATA_OP_SYNC,
     HINATA_OP_BACKUP,
     HINATA_OP_RESTORE,
-    HINATA_OP_MAINTENANCE
+    HINATA_OP_MAINTENANCE,
+    HINATA_OP_TYPE_MAX
 };
 
 /**
@@ -192,6 +192,7 @@
 #include <linux/fault-inject.h>
 #include "hinata_types.h"
 #include "hinata_core.h"
+#include "hinata_task.h"
 #include "core/hinata_packet.h"
 #include "core/hinata_validation.h"
 #include "storage/hinata_storage.h"
@@ -219,34 +220,6 @@ MODULE_LICENSE(HINATA_WORKER_LICENSE);
 #define HINATA_WORKER_STACK_SIZE            8192
 #define HINATA_WORKER_PRIORITY_LEVELS       8
 
-/* Task types */
-enum hinata_task_type {
-    HINATA_TASK_TYPE_PACKET_PROCESS = 0,
-    HINATA_TASK_TYPE_STORAGE_SYNC,
-    HINATA_TASK_TYPE_MEMORY_GC,
-    HINATA_TASK_TYPE_VALIDATION,
-    HINATA_TASK_TYPE_MAINTENANCE,
-    HINATA_TASK_TYPE_BACKUP,
-    HINATA_TASK_TYPE_RESTORE,
-    HINATA_TASK_TYPE_CLEANUP,
-    HINATA_TASK_TYPE_CUSTOM,
-    HINATA_TASK_TYPE_MAX,
-};
-
-/* Task flags */
-#define HINATA_TASK_FLAG_URGENT             0x0001
-#define HINATA_TASK_FLAG_BACKGROUND         0x0002
-#define HINATA_TASK_FLAG_PERSISTENT         0x0004
-#define HINATA_TASK_FLAG_EXCLUSIVE          0x0008
-#define HINATA_TASK_FLAG_CPU_INTENSIVE      0x0010
-#define HINATA_TASK_FLAG_IO_INTENSIVE       0x0020
-#define HINATA_TASK_FLAG_MEMORY_INTENSIVE   0x0040
-#define HINATA_TASK_FLAG_INTERRUPTIBLE      0x0080
-#define HINATA_TASK_FLAG_CANCELLABLE        0x0100
-#define HINATA_TASK_FLAG_RETRYABLE          0x0200
-#define HINATA_TASK_FLAG_LOGGED             0x0400
-#define HINATA_TASK_FLAG_TRACED             0x0800
-
 /* Task states */
 enum hinata_task_state {
     HINATA_TASK_STATE_PENDING = 0,
@@ -271,6 +244,7 @@ struct hinata_task {
     
     /* Function and data */
     int (*func)(void *data);
+    hinata_task_cancel_t cancel;
     void *data;
     size_t data_size;
     
@@ -419,6 +393,8 @@ static const char *hinata_task_type_to_string(enum hinata_task_type type)
         return "restore";
     case HINATA_TASK_TYPE_CLEANUP:
         return "cleanup";
+    case HINATA_TASK_TYPE_EXPORT:
+        return "export";
     case HINATA_TASK_TYPE_CUSTOM:
         return "custom";
     default:
@@ -426,6 +402,29 @@ static const char *hinata_task_type_to_string(enum hinata_task_type type)
     }
 }
 
+/**
+ * hinata_task_operation_type - Health operation type a task is recorded as
+ * @type: Task type
+ *
+ * Storage syncs are timed by the storage layer itself, so only the
+ * queueing and scheduling of such tasks is recorded here as maintenance.
+ *
+ * Returns: Operation type for hinata_perf_end_operation()
+ */
+static enum hinata_operation_type hinata_task_operation_type(enum hinata_task_type type)
+{
+    switch (type) {
+    case HINATA_TASK_TYPE_VALIDATION:
+        return HINATA_OP_VALIDATE;
+    case HINATA_TASK_TYPE_BACKUP:
+        return HINATA_OP_BACKUP;
+    case HINATA_TASK_TYPE_RESTORE:
+        return HINATA_OP_RESTORE;
+    default:
+        return HINATA_OP_MAINTENANCE;
+    }
+}
+
 /**
  * hinata_task_state_to_string - Convert task state to string
  * @state: Task state
@@ -516,7 +515,7 @@ static struct hinata_task *hinata_task_alloc(enum hinata_task_type type,
     task->description = NULL;
     task->debug_data = NULL;
     
-    pr_debug("HiNATA: Allocated task %u (type=%s)\n", task->id, task->name);
+    hinata_log_debug(HINATA_SUCCESS, "Allocated task", task->id, type);
     
     return task;
 }
@@ -531,7 +530,7 @@ static void hinata_task_free(struct hinata_task *task)
         return;
     }
     
-    pr_debug("HiNATA: Freeing task %u (type=%s)\n", task->id, task->name);
+    hinata_log_debug(HINATA_SUCCESS, "Freeing task", task->id, task->type);
     
     /* Free result data if allocated */
     if (task->result_data) {
@@ -546,6 +545,27 @@ static void hinata_task_free(struct hinata_task *task)
     kfree(task);
 }
 
+/**
+ * hinata_task_drop - Finish a task that will never run
+ * @task: Task removed from the queue
+ * @reason: Negative error code passed to the cancel callback
+ * 
+ * Lets the submitter release what it handed to the task, then frees it.
+ * Must be called without the queue lock held.
+ */
+static void hinata_task_drop(struct hinata_task *task, int reason)
+{
+    task->state = reason == -ECANCELED ? HINATA_TASK_STATE_CANCELLED :
+                                         HINATA_TASK_STATE_FAILED;
+    task->result = reason;
+    if (task->cancel) {
+        task->cancel(task->data, reason);
+    }
+    complete(&task->completion);
+    wake_up_all(&task->wait_queue);
+    hinata_task_free(task);
+}
+
 /**
  * hinata_task_queue_init - Initialize task queue
  * @queue: Task queue to initialize
@@ -593,6 +613,7 @@ static void hinata_task_queue_cleanup(struct hinata_task_queue *queue)
 {
     struct hinata_task *task, *tmp;
     unsigned long flags;
+    LIST_HEAD(dropped);
     int i;
     
     if (!queue) {
@@ -601,15 +622,9 @@ static void hinata_task_queue_cleanup(struct hinata_task_queue *queue)
     
     spin_lock_irqsave(&queue->lock, flags);
     
-    /* Cancel all pending tasks */
+    /* Detach all pending tasks; cancel callbacks may sleep */
     for (i = 0; i < HINATA_WORKER_PRIORITY_LEVELS; i++) {
-        list_for_each_entry_safe(task, tmp, &queue->tasks[i], list) {
-            list_del(&task->list);
-            task->state = HINATA_TASK_STATE_CANCELLED;
-            complete(&task->completion);
-            wake_up_all(&task->wait_queue);
-            hinata_task_free(task);
-        }
+        list_splice_tail_init(&queue->tasks[i], &dropped);
     }
     
     atomic_set(&queue->count, 0);
@@ -617,6 +632,12 @@ static void hinata_task_queue_cleanup(struct hinata_task_queue *queue)
     
     spin_unlock_irqrestore(&queue->lock, flags);
     
+    list_for_each_entry_safe(task, tmp, &dropped, list) {
+        list_del(&task->list);
+        atomic64_inc(&queue->tasks_cancelled);
+        hinata_task_drop(task, -ECANCELED);
+    }
+    
     /* Wake up all waiters */
     wake_up_all(&queue->wait_queue);
 }
@@ -658,8 +679,7 @@ static int hinata_task_queue_add(struct hinata_task_queue *queue,
     /* Wake up workers */
     wake_up(&queue->wait_queue);
     
-    pr_debug("HiNATA: Added task %u to queue (priority=%u)\n", 
-            task->id, priority);
+    hinata_log_debug(HINATA_SUCCESS, "Added task to queue", task->id, priority);
     
     return 0;
 }
@@ -697,8 +717,8 @@ static struct hinata_task *hinata_task_queue_get(struct hinata_task_queue *queue
     spin_unlock_irqrestore(&queue->lock, flags);
     
     if (task) {
-        pr_debug("HiNATA: Got task %u from queue (priority=%u)\n", 
-                task->id, task->priority);
+        hinata_log_debug(HINATA_SUCCESS, "Got task from queue",
+                         task->id, task->priority);
     }
     
     return task;
@@ -729,7 +749,7 @@ static void hinata_task_queue_remove(struct hinata_task_queue *queue,
     
     spin_unlock_irqrestore(&queue->lock, flags);
     
-    pr_debug("HiNATA: Removed task %u from queue\n", task->id);
+    hinata_log_debug(HINATA_SUCCESS, "Removed task from queue", task->id);
 }
 
 /**
@@ -741,6 +761,7 @@ static void hinata_task_queue_remove(struct hinata_task_queue *queue,
 int hinata_worker_thread(void *data)
 {
     struct hinata_worker *worker = (struct hinata_worker *)data;
+    struct hinata_operation_context op;
     struct hinata_task *task;
     u64 start_time, end_time, wait_time, process_time;
     int ret;
@@ -788,11 +809,7 @@ int hinata_worker_thread(void *data)
         if (ret < 0) {
             pr_err("HiNATA: Failed to assign task %u to worker %d: %d\n",
                   task->id, worker->id, ret);
-            task->state = HINATA_TASK_STATE_FAILED;
-            task->result = ret;
-            complete(&task->completion);
-            wake_up_all(&task->wait_queue);
-            hinata_task_free(task);
+            hinata_task_drop(task, ret);
             continue;
         }
         
@@ -803,11 +820,18 @@ int hinata_worker_thread(void *data)
         
         wait_time = start_time - task->submit_time;
         
-        pr_debug("HiNATA: Worker %d executing task %u (type=%s)\n",
-                worker->id, task->id, task->name);
+        hinata_log_debug(HINATA_SUCCESS, "Worker executing task",
+                         worker->id, task->id);
         
         /* Call task function */
+        op = (struct hinata_operation_context) {
+            .type = hinata_task_operation_type(task->type),
+            .timeout = HINATA_WORKER_TASK_TIMEOUT,
+        };
+        hinata_perf_start_operation(&op);
         ret = task->func(task->data);
+        op.result = ret;
+        hinata_perf_end_operation(&op);
         
         end_time = ktime_get_ns();
         task->end_time = end_time;
@@ -846,8 +870,7 @@ int hinata_worker_thread(void *data)
         complete(&task->completion);
         wake_up_all(&task->wait_queue);
         
-        pr_debug("HiNATA: Worker %d completed task %u (result=%d, time=%llu ns)\n",
-                worker->id, task->id, ret, process_time);
+        hinata_log_debug_errno(ret, "Worker completed task", task->id, process_time);
         
         /* Free task if not persistent */
         if (!(task->flags & HINATA_TASK_FLAG_PERSISTENT)) {
@@ -896,17 +919,22 @@ static int hinata_worker_assign_task(struct hinata_worker *worker,
 }
 
 /**
- * hinata_submit_task - Submit task for execution
+ * hinata_submit_task_cancellable - Submit task with a cancel callback
  * @type: Task type
  * @func: Task function
+ * @cancel: Called instead of @func if the task is dropped without running
  * @data: Task data
  * @data_size: Size of task data
  * @flags: Task flags
  * 
+ * Exactly one of @func and @cancel is called for a queued task. Neither is
+ * called when submission fails.
+ * 
  * Returns: Task ID on success, negative error code on failure
  */
-int hinata_submit_task(enum hinata_task_type type, int (*func)(void *),
-                      void *data, size_t data_size, u32 flags)
+int hinata_submit_task_cancellable(enum hinata_task_type type, hinata_task_func_t func,
+                                   hinata_task_cancel_t cancel, void *data,
+                                   size_t data_size, u32 flags)
 {
     struct hinata_task *task;
     int ret;
@@ -925,6 +953,7 @@ int hinata_submit_task(enum hinata_task_type type, int (*func)(void *),
     if (!task) {
         return -ENOMEM;
     }
+    task->cancel = cancel;
     
     /* Add task to queue */
     ret = hinata_task_queue_add(&hinata_worker_pool.task_queue, task);
@@ -937,6 +966,23 @@ int hinata_submit_task(enum hinata_task_type type, int (*func)(void *),
     
     return task->id;
 }
+EXPORT_SYMBOL(hinata_submit_task_cancellable);
+
+/**
+ * hinata_submit_task - Submit task for execution
+ * @type: Task type
+ * @func: Task function
+ * @data: Task data
+ * @data_size: Size of task data
+ * @flags: Task flags
+ * 
+ * Returns: Task ID on success, negative error code on failure
+ */
+int hinata_submit_task(enum hinata_task_type type, hinata_task_func_t func,
+                      void *data, size_t data_size, u32 flags)
+{
+    return hinata_submit_task_cancellable(type, func, NULL, data, data_size, flags);
+}
 EXPORT_SYMBOL(hinata_submit_task);
 
 /**
@@ -23,6 +23,7 @@
 #include <linux/timer.h>
 #include <linux/rcu.h>
 #include "hinata_types.h"
+#include "hinata_task.h"
 
 /* Worker version information */
 #define HINATA_WORKER_VERSION_MAJOR     1
@@ -42,38 +43,6 @@
 #define HINATA_WORKER_IDLE_TIMEOUT      60000      /* 60 seconds */
 #define HINATA_WORKER_HEALTH_INTERVAL   10000      /* 10 seconds */
 
-/* Task types */
-enum hinata_task_type {
-    HINATA_TASK_TYPE_PACKET_PROCESS = 0,
-    HINATA_TASK_TYPE_STORAGE_SYNC,
-    HINATA_TASK_TYPE_MEMORY_GC,
-    HINATA_TASK_TYPE_VALIDATION,
-    HINATA_TASK_TYPE_MAINTENANCE,
-    HINATA_TASK_TYPE_BACKUP,
-    HINATA_TASK_TYPE_RESTORE,
-    HINATA_TASK_TYPE_CLEANUP,
-    HINATA_TASK_TYPE_CUSTOM,
-    HINATA_TASK_TYPE_MAX,
-};
-
-/* Task flags */
-#define HINATA_TASK_FLAG_URGENT             0x0001
-#define HINATA_TASK_FLAG_BACKGROUND         0x0002
-#define HINATA_TASK_FLAG_PERSISTENT         0x0004
-#define HINATA_TASK_FLAG_EXCLUSIVE          0x0008
-#define HINATA_TASK_FLAG_CPU_INTENSIVE      0x0010
-#define HINATA_TASK_FLAG_IO_INTENSIVE       0x0020
-#define HINATA_TASK_FLAG_MEMORY_INTENSIVE   0x0040
-#define HINATA_TASK_FLAG_INTERRUPTIBLE      0x0080
-#define HINATA_TASK_FLAG_CANCELLABLE        0x0100
-#define HINATA_TASK_FLAG_RETRYABLE          0x0200
-#define HINATA_TASK_FLAG_LOGGED             0x0400
-#define HINATA_TASK_FLAG_TRACED             0x0800
-#define HINATA_TASK_FLAG_HIGH_PRIORITY      0x1000
-#define HINATA_TASK_FLAG_LOW_PRIORITY       0x2000
-#define HINATA_TASK_FLAG_REAL_TIME          0x4000
-#define HINATA_TASK_FLAG_BATCH              0x8000
-
 /* Task states */
 enum hinata_task_state {
     HINATA_TASK_STATE_PENDING = 0,
@@ -150,9 +119,6 @@ struct hinata_worker_pool;
 struct hinata_task_context;
 struct hinata_worker_context;
 
-/* Task function type */
-typedef int (*hinata_task_func_t)(void *data);
-
 /* Task completion callback type */
 typedef void (*hinata_task_completion_t)(struct hinata_task *task, int result);
 
@@ -587,8 +553,6 @@ int hinata_worker_suspend(struct hinata_worker *worker);
 int hinata_worker_resume(struct hinata_worker *worker);
 
 /* Task management functions */
-int hinata_submit_task(enum hinata_task_type type, hinata_task_func_t func,
-                      void *data, size_t data_size, u32 flags);
 int hinata_submit_task_ex(const struct hinata_task_args *args);
 int hinata_wait_task(u32 task_id, u32 timeout_ms);
 int hinata_cancel_task(u32 task_id);
@@ -932,6 +932,8 @@
 #include "../hinata_core.h"
 #include "../core/hinata_packet.h"
 #include "../core/hinata_validation.h"
+#include "../core/hinata_health.h"
+#include "../core/hinata_config.h"
 #include "../storage/hinata_storage.h"
 #include "hinata_memory.h"
 #include "hinata_syscalls.h"
@@ -1219,6 +1221,38 @@ static ssize_t hinata_device_read(struct file *file, char __user *buffer, size_t
         }
         break;
         
+    case HINATA_IOCTL_GET_CONFIG_VALUE:
+        {
+            struct hinata_config_value_args args;
+            if (copy_from_user(&args, (void __user *)arg, sizeof(args))) {
+                ret = -EFAULT;
+                break;
+            }
+            args.key[sizeof(args.key) - 1] = '\0';
+            ret = hinata_config_get(args.key, args.value, sizeof(args.value));
+            if (ret == 0 && copy_to_user((void __user *)arg, &args, sizeof(args))) {
+                ret = -EFAULT;
+            }
+        }
+        break;
+        
+    case HINATA_IOCTL_SET_CONFIG_VALUE:
+        {
+            struct hinata_config_value_args args;
+            if (!capable(CAP_SYS_ADMIN)) {
+                ret = -EPERM;
+                break;
+            }
+            if (copy_from_user(&args, (void __user *)arg, sizeof(args))) {
+                ret = -EFAULT;
+                break;
+            }
+            args.key[sizeof(args.key) - 1] = '\0';
+            args.value[sizeof(args.value) - 1] = '\0';
+            ret = hinata_config_set(args.key, args.value);
+        }
+        break;
+        
     default:
         ret = -ENOTTY;
         break;
@@ -1676,9 +1710,24 @@ static ssize_t hinata_sysfs_state_show(struct kobject *kobj,
         return ret;
     }
     
+    /* A running system that misses its objectives reports the health level */
+    if (info.state == HINATA_STATE_RUNNING &&
+        hinata_health_get_level() != HINATA_HEALTH_OK) {
+        return sprintf(buf, "%s\n",
+                      hinata_health_level_to_string(hinata_health_get_level()));
+    }
+    
     return sprintf(buf, "%s\n", hinata_system_state_to_string(info.state));
 }
 
+static ssize_t hinata_sysfs_health_show(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       char *buf)
+{
+    return sprintf(buf, "%s\n",
+                  hinata_health_level_to_string(hinata_health_get_level()));
+}
+
 static ssize_t hinata_sysfs_events_show(struct kobject *kobj,
                                        struct kobj_attribute *attr,
                                        char *buf)
@@ -1686,17 +1735,165 @@ static ssize_t hinata_sysfs_events_show(struct kobject *kobj,
     return sprintf(buf, "%d\n", atomic_read(&hinata_event_count));
 }
 
+/* Runtime feature switches */
+static struct kobj_attribute hinata_debug_attr;
+static struct kobj_attribute hinata_validation_attr;
+static struct kobj_attribute hinata_memory_tracking_attr;
+static struct kobj_attribute hinata_memory_pooling_attr;
+static struct kobj_attribute hinata_memory_stats_attr;
+
+static u32 hinata_sysfs_attr_to_flag(struct kobj_attribute *attr)
+{
+    return attr == &hinata_debug_attr ? HINATA_SYSTEM_FLAG_DEBUG :
+                                        HINATA_SYSTEM_FLAG_VALIDATION;
+}
+
+static ssize_t hinata_sysfs_flag_show(struct kobject *kobj,
+                                     struct kobj_attribute *attr,
+                                     char *buf)
+{
+    return sprintf(buf, "%d\n",
+                  hinata_system_has_flag(hinata_sysfs_attr_to_flag(attr)));
+}
+
+static ssize_t hinata_sysfs_flag_store(struct kobject *kobj,
+                                      struct kobj_attribute *attr,
+                                      const char *buf, size_t count)
+{
+    u32 flag = hinata_sysfs_attr_to_flag(attr);
+    bool enable;
+    int ret;
+    
+    ret = kstrtobool(buf, &enable);
+    if (ret < 0) {
+        return ret;
+    }
+    
+    ret = enable ? hinata_system_set_flag(flag) : hinata_system_clear_flag(flag);
+    
+    return ret < 0 ? ret : count;
+}
+
+static bool *hinata_sysfs_memory_feature(struct hinata_memory_config *config,
+                                        struct kobj_attribute *attr)
+{
+    if (attr == &hinata_memory_tracking_attr) {
+        return &config->enable_tracking;
+    }
+    if (attr == &hinata_memory_pooling_attr) {
+        return &config->enable_pooling;
+    }
+    return &config->enable_stats;
+}
+
+static ssize_t hinata_sysfs_memory_feature_show(struct kobject *kobj,
+                                               struct kobj_attribute *attr,
+                                               char *buf)
+{
+    struct hinata_memory_config config;
+    int ret;
+    
+    ret = hinata_memory_get_config(&config);
+    if (ret < 0) {
+        return ret;
+    }
+    
+    return sprintf(buf, "%d\n", *hinata_sysfs_memory_feature(&config, attr));
+}
+
+static ssize_t hinata_sysfs_memory_feature_store(struct kobject *kobj,
+                                                struct kobj_attribute *attr,
+                                                const char *buf, size_t count)
+{
+    struct hinata_memory_config config;
+    bool enable;
+    int ret;
+    
+    ret = kstrtobool(buf, &enable);
+    if (ret < 0) {
+        return ret;
+    }
+    
+    ret = hinata_memory_get_config(&config);
+    if (ret < 0) {
+        return ret;
+    }
+    
+    *hinata_sysfs_memory_feature(&config, attr) = enable;
+    
+    ret = hinata_memory_set_config(&config);
+    
+    return ret < 0 ? ret : count;
+}
+
+static ssize_t hinata_sysfs_config_show(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       char *buf)
+{
+    return hinata_config_show(buf, PAGE_SIZE);
+}
+
+static ssize_t hinata_sysfs_config_store(struct kobject *kobj,
+                                        struct kobj_attribute *attr,
+                                        const char *buf, size_t count)
+{
+    char *line, *key, *value;
+    int ret;
+    
+    /* Accepts a single "key=value" assignment */
+    line = kstrndup(buf, count, GFP_KERNEL);
+    if (!line) {
+        return -ENOMEM;
+    }
+    
+    value = strim(line);
+    key = strsep(&value, "=");
+    if (!value) {
+        kfree(line);
+        return -EINVAL;
+    }
+    
+    ret = hinata_config_set(strim(key), strim(value));
+    kfree(line);
+    
+    return ret < 0 ? ret : count;
+}
+
 static struct kobj_attribute hinata_version_attr = 
     __ATTR(version, 0444, hinata_sysfs_version_show, NULL);
 static struct kobj_attribute hinata_state_attr = 
     __ATTR(state, 0444, hinata_sysfs_state_show, NULL);
 static struct kobj_attribute hinata_events_attr = 
     __ATTR(events, 0444, hinata_sysfs_events_show, NULL);
+static struct kobj_attribute hinata_health_attr = 
+    __ATTR(health, 0444, hinata_sysfs_health_show, NULL);
+static struct kobj_attribute hinata_debug_attr = 
+    __ATTR(debug, 0644, hinata_sysfs_flag_show, hinata_sysfs_flag_store);
+static struct kobj_attribute hinata_validation_attr = 
+    __ATTR(validation, 0644, hinata_sysfs_flag_show, hinata_sysfs_flag_store);
+static struct kobj_attribute hinata_memory_tracking_attr = 
+    __ATTR(memory_tracking, 0644, hinata_sysfs_memory_feature_show,
+           hinata_sysfs_memory_feature_store);
+static struct kobj_attribute hinata_memory_pooling_attr = 
+    __ATTR(memory_pooling, 0644, hinata_sysfs_memory_feature_show,
+           hinata_sysfs_memory_feature_store);
+static struct kobj_attribute hinata_memory_stats_attr = 
+    __ATTR(memory_stats, 0644, hinata_sysfs_memory_feature_show,
+           hinata_sysfs_memory_feature_store);
+static struct kobj_attribute hinata_config_attr = 
+    __ATTR(config, 0644, hinata_sysfs_config_show, hinata_sysfs_config_store);
 
 static struct attribute *hinata_sysfs_attrs[] = {
     &hinata_version_attr.attr,
     &hinata_state_attr.attr,
     &hinata_events_attr.attr,
+    &hinata_health_attr.attr,
+    &hinata_debug_attr.attr,
+    &hinata_validation_attr.attr,
+    &hinata_memory_tracking_attr.attr,
+    &hinata_memory_pooling_attr.attr,
+    &hinata_memory_stats_attr.attr,
+    &hinata_config_attr.attr,
     NULL,
 };
 
@@ -1708,6 +1905,8 @@ static struct attribute_group hinata_sysfs_attr_group = {
 static int hinata_debugfs_stats_show(struct seq_file *m, void *v)
 {
     struct hinata_system_stats stats;
+    struct hinata_health_status health;
+    int type;
     int ret;
     
     ret = hinata_get_system_stats(&stats);
@@ -1728,11 +1927,46 @@ static int hinata_debugfs_stats_show(struct seq_file *m, void *v)
     seq_printf(m, "Validation checks: %llu\n", stats.validation_checks);
     seq_printf(m, "Validation failures: %llu\n", stats.validation_failures);
     
+    ret = hinata_health_get_report(&health);
+    if (ret == 0) {
+        seq_printf(m, "Health: %s\n", hinata_health_level_to_string(health.level));
+        for (type = 0; type < HINATA_OP_TYPE_MAX; type++) {
+            struct hinata_health_op_status *op = &health.ops[type];
+            struct hinata_slo slo;
+            
+            hinata_health_get_slo(type, &slo);
+            seq_printf(m, "  %-12s %-8s p%u.%u %llu/%llu us, errors %u/%u bp, %u ops/s\n",
+                      hinata_operation_type_to_string(type),
+                      hinata_health_level_to_string(op->level),
+                      slo.percentile / 10, slo.percentile % 10,
+                      HINATA_NS_TO_US(op->window_latency),
+                      HINATA_NS_TO_US(slo.latency_target),
+                      op->window_error_rate, slo.error_budget,
+                      op->ops_per_second);
+        }
+    }
+    
     return 0;
 }
 
 DEFINE_SHOW_ATTRIBUTE(hinata_debugfs_stats);
 
+/**
+ * hinata_debugfs_log_show - Show structured log records
+ * @m: Sequence file
+ * @v: Unused
+ * 
+ * Returns: 0 on success
+ */
+static int hinata_debugfs_log_show(struct seq_file *m, void *v)
+{
+    hinata_log_dump(m);
+    
+    return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(hinata_debugfs_log);
+
 /**
  * hinata_interface_init - Initialize HiNATA interface
  * 
@@ -1821,6 +2055,8 @@ int hinata_interface_init(void)
     /* Create debugfs entries */
     debugfs_create_file("stats", 0444, hinata_debugfs_dir, NULL, 
                        &hinata_debugfs_stats_fops);
+    debugfs_create_file("log", 0444, hinata_debugfs_dir, NULL,
+                       &hinata_debugfs_log_fops);
     
     pr_info("HiNATA: Interface subsystem initialized successfully\n");
     
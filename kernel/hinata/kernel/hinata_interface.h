@@ -71,6 +71,7 @@
 #define HINATA_EVENT_TYPE_STORAGE_READ      0x0020
 #define HINATA_EVENT_TYPE_STORAGE_WRITE     0x0021
 #define HINATA_EVENT_TYPE_STORAGE_DELETE    0x0022
+#define HINATA_EVENT_TYPE_STORAGE_EXPORT    0x0023
 #define HINATA_EVENT_TYPE_MEMORY_ALLOC      0x0030
 #define HINATA_EVENT_TYPE_MEMORY_FREE       0x0031
 #define HINATA_EVENT_TYPE_MEMORY_LEAK       0x0032
@@ -79,6 +80,7 @@
 #define HINATA_EVENT_TYPE_SYSTEM_START      0x0050
 #define HINATA_EVENT_TYPE_SYSTEM_STOP       0x0051
 #define HINATA_EVENT_TYPE_SYSTEM_ERROR      0x0052
+#define HINATA_EVENT_TYPE_SYSTEM_HEALTH     0x0053
 #define HINATA_EVENT_TYPE_DEBUG_MESSAGE     0x0060
 #define HINATA_EVENT_TYPE_PERFORMANCE       0x0070
 #define HINATA_EVENT_TYPE_SECURITY          0x0080
@@ -121,6 +123,8 @@
 #define HINATA_IOCTL_GET_DEBUG_LEVEL        _IOR(HINATA_IOCTL_MAGIC, 0x41, u32)
 #define HINATA_IOCTL_DUMP_STATE             _IOW(HINATA_IOCTL_MAGIC, 0x42, struct hinata_debug_dump_args)
 #define HINATA_IOCTL_RESET_STATS            _IO(HINATA_IOCTL_MAGIC, 0x43)
+#define HINATA_IOCTL_GET_CONFIG_VALUE       _IOWR(HINATA_IOCTL_MAGIC, 0x44, struct hinata_config_value_args)
+#define HINATA_IOCTL_SET_CONFIG_VALUE       _IOW(HINATA_IOCTL_MAGIC, 0x45, struct hinata_config_value_args)
 #define HINATA_IOCTL_BENCHMARK              _IOWR(HINATA_IOCTL_MAGIC, 0x50, struct hinata_benchmark_args)
 #define HINATA_IOCTL_STRESS_TEST            _IOWR(HINATA_IOCTL_MAGIC, 0x51, struct hinata_stress_test_args)
 #define HINATA_IOCTL_PERFORMANCE_TEST       _IOWR(HINATA_IOCTL_MAGIC, 0x52, struct hinata_performance_test_args)
@@ -270,6 +274,11 @@ struct hinata_debug_dump_args {
     size_t *actual_size;  /* Output */
 };
 
+struct hinata_config_value_args {
+    char key[48];
+    char value[256];  /* Output for GET_CONFIG_VALUE */
+};
+
 struct hinata_benchmark_args {
     u32 benchmark_type;
     u32 iterations;
@@ -378,9 +387,31 @@ static ssize_t hinata_sysfs_state_show(struct kobject *kobj,
 static ssize_t hinata_sysfs_events_show(struct kobject *kobj,
                                        struct kobj_attribute *attr,
                                        char *buf);
+static ssize_t hinata_sysfs_health_show(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       char *buf);
+static ssize_t hinata_sysfs_flag_show(struct kobject *kobj,
+                                     struct kobj_attribute *attr,
+                                     char *buf);
+static ssize_t hinata_sysfs_flag_store(struct kobject *kobj,
+                                      struct kobj_attribute *attr,
+                                      const char *buf, size_t count);
+static ssize_t hinata_sysfs_memory_feature_show(struct kobject *kobj,
+                                               struct kobj_attribute *attr,
+                                               char *buf);
+static ssize_t hinata_sysfs_memory_feature_store(struct kobject *kobj,
+                                                struct kobj_attribute *attr,
+                                                const char *buf, size_t count);
+static ssize_t hinata_sysfs_config_show(struct kobject *kobj,
+                                       struct kobj_attribute *attr,
+                                       char *buf);
+static ssize_t hinata_sysfs_config_store(struct kobject *kobj,
+                                        struct kobj_attribute *attr,
+                                        const char *buf, size_t count);
 
 /* Debugfs interface */
 static int hinata_debugfs_stats_show(struct seq_file *m, void *v);
+static int hinata_debugfs_log_show(struct seq_file *m, void *v);
 static int hinata_debugfs_events_show(struct seq_file *m, void *v);
 static int hinata_debugfs_contexts_show(struct seq_file *m, void *v);
 
@@ -25,6 +25,8 @@
 #include <linux/proc_fs.h>
 #include <linux/seq_file.h>
 #include <linux/uaccess.h>
+#include <linux/jump_label.h>
+#include <linux/poison.h>
 #include "../hinata_core.h"
 #include "hinata_memory.h"
 
@@ -56,6 +58,25 @@ static const size_t memory_pool_sizes[HINATA_MEMORY_POOL_COUNT] = {
 #define HINATA_MEMORY_FLAG_DMA          (1 << 6)
 #define HINATA_MEMORY_FLAG_ATOMIC       (1 << 7)
 
+/**
+ * struct hinata_memory_header - Size header for untracked allocations
+ * @size: Size requested by the caller
+ * @magic: HINATA_MEMORY_HEADER_MAGIC while the allocation is live
+ *
+ * Allocations made while tracking is disabled have no tracking block, so
+ * they carry their size in front of the returned pointer instead. Free and
+ * realloc read it to keep the usage accounting balanced and to copy the
+ * old contents.
+ */
+struct hinata_memory_header {
+    size_t size;
+    u32 magic;
+};
+
+#define HINATA_MEMORY_HEADER_MAGIC      0x484d4844  /* "HMHD" */
+#define HINATA_MEMORY_HEADER_SIZE \
+    ALIGN(sizeof(struct hinata_memory_header), ARCH_KMALLOC_MINALIGN)
+
 /**
  * struct hinata_memory_block - Memory block tracking
  * @ptr: Pointer to allocated memory
@@ -154,6 +175,18 @@ struct hinata_memory_context {
 static struct hinata_memory_context memory_ctx;
 static bool memory_initialized = false;
 
+/*
+ * Hot-path feature switches. They mirror memory_ctx.config and are only
+ * flipped through hinata_memory_set_config(), so a disabled feature costs
+ * a patched-out jump instead of a load and branch per allocation.
+ */
+static DEFINE_STATIC_KEY_TRUE(memory_tracking_key);
+static DEFINE_STATIC_KEY_TRUE(memory_pooling_key);
+static DEFINE_STATIC_KEY_TRUE(memory_stats_key);
+
+/* Tracked blocks still outstanding, so frees stay correct after tracking is disabled */
+static atomic64_t memory_tracked_blocks = ATOMIC64_INIT(0);
+
 /* Proc filesystem entries */
 static struct proc_dir_entry *hinata_memory_proc_dir;
 static struct proc_dir_entry *hinata_memory_stats_proc;
@@ -164,6 +197,7 @@ static struct proc_dir_entry *hinata_memory_blocks_proc;
 static int hinata_memory_pool_init(struct hinata_memory_pool *pool, size_t size);
 static void hinata_memory_pool_cleanup(struct hinata_memory_pool *pool);
 static void *hinata_memory_pool_alloc(size_t size);
+static struct hinata_memory_header *hinata_memory_header_find(void *ptr);
 static void hinata_memory_pool_free(void *ptr, size_t size);
 static struct hinata_memory_block *hinata_memory_block_create(void *ptr, size_t size, u32 flags);
 static void hinata_memory_block_destroy(struct hinata_memory_block *block);
@@ -175,6 +209,7 @@ static void hinata_memory_stats_timer_func(struct timer_list *timer);
 static int hinata_memory_proc_stats_show(struct seq_file *m, void *v);
 static int hinata_memory_proc_pools_show(struct seq_file *m, void *v);
 static int hinata_memory_proc_blocks_show(struct seq_file *m, void *v);
+static void hinata_memory_apply_config(void);
 
 /**
  * hinata_memory_init - Initialize memory management subsystem
@@ -239,6 +274,7 @@ int hinata_memory_init(void)
     memory_ctx.config.gc_interval = HINATA_MEMORY_GC_INTERVAL;
     memory_ctx.config.stats_interval = HINATA_MEMORY_STATS_INTERVAL;
     memory_ctx.config.leak_threshold = HINATA_MEMORY_LEAK_THRESHOLD;
+    hinata_memory_apply_config();
 
     /* Initialize work queues */
     INIT_WORK(&memory_ctx.gc_work, hinata_memory_gc_work_func);
@@ -352,14 +388,25 @@ void hinata_memory_cleanup(void)
  */
 void *hinata_malloc(size_t size)
 {
-    void *ptr;
+    void *ptr, *base;
     struct hinata_memory_block *block;
+    struct hinata_memory_header *header;
     u64 current_usage, peak_usage;
+    u32 flags = HINATA_MEMORY_FLAG_TRACKED;
+    size_t alloc_size;
+    bool tracking;
 
     if (!memory_initialized || size == 0) {
         return NULL;
     }
 
+    /*
+     * Sample the tracking key once: pooled memory is only freed correctly
+     * when it is tracked, so both decisions below must see the same value
+     * even if hinata_memory_set_config() flips the key in between.
+     */
+    tracking = static_branch_likely(&memory_tracking_key);
+
     /* Check size limits */
     if (size > memory_ctx.limits.max_single_alloc) {
         atomic64_inc(&memory_ctx.oom_count);
@@ -373,33 +420,49 @@ void *hinata_malloc(size_t size)
         return NULL;
     }
 
-    /* Try pool allocation first */
-    if (memory_ctx.config.enable_pooling) {
+    /* Try pool allocation first; pooled memory must be tracked to be freed */
+    if (tracking && static_branch_likely(&memory_pooling_key)) {
         ptr = hinata_memory_pool_alloc(size);
         if (ptr) {
+            flags |= HINATA_MEMORY_FLAG_POOLED;
             goto track_allocation;
         }
     }
 
-    /* Fall back to regular allocation */
-    if (size <= PAGE_SIZE) {
-        ptr = kmalloc(size, GFP_KERNEL);
+    /* Fall back to regular allocation; untracked memory carries a size header */
+    alloc_size = tracking ? size : size + HINATA_MEMORY_HEADER_SIZE;
+    if (alloc_size <= PAGE_SIZE) {
+        base = kmalloc(alloc_size, GFP_KERNEL);
     } else {
-        ptr = vmalloc(size);
+        base = vmalloc(alloc_size);
     }
 
-    if (!ptr) {
+    if (!base) {
         atomic64_inc(&memory_ctx.oom_count);
         return NULL;
     }
 
+    if (tracking) {
+        ptr = base;
+    } else {
+        header = base;
+        header->size = size;
+        header->magic = HINATA_MEMORY_HEADER_MAGIC;
+        ptr = (u8 *)base + HINATA_MEMORY_HEADER_SIZE;
+    }
+
 track_allocation:
+    /* Poison fresh memory so reads of uninitialized data stand out */
+    if (hinata_is_validation_enabled()) {
+        memset(ptr, POISON_INUSE, size);
+    }
+
     /* Track allocation if enabled */
-    if (memory_ctx.config.enable_tracking) {
-        block = hinata_memory_block_create(ptr, size, HINATA_MEMORY_FLAG_TRACKED);
+    if (tracking) {
+        block = hinata_memory_block_create(ptr, size, flags);
         if (!block) {
             /* Free the allocated memory if tracking fails */
-            if (memory_ctx.config.enable_pooling) {
+            if (flags & HINATA_MEMORY_FLAG_POOLED) {
                 hinata_memory_pool_free(ptr, size);
             } else if (size <= PAGE_SIZE) {
                 kfree(ptr);
@@ -408,10 +471,17 @@ track_allocation:
             }
             return NULL;
         }
+        atomic64_inc(&memory_tracked_blocks);
     }
 
-    /* Update statistics */
+    /* Usage accounting backs the limits above and is always kept */
     atomic64_add(size, &memory_ctx.total_allocated);
+
+    if (!static_branch_likely(&memory_stats_key)) {
+        return ptr;
+    }
+
+    /* Update statistics */
     atomic64_inc(&memory_ctx.allocation_count);
 
     /* Update peak usage */
@@ -424,13 +494,12 @@ track_allocation:
     } while (atomic64_cmpxchg(&memory_ctx.peak_usage, peak_usage, current_usage) != peak_usage);
 
     /* Check warning thresholds */
-    if (current_usage > memory_ctx.limits.warning_threshold) {
-        pr_warn("HiNATA memory usage warning: %lld bytes (threshold: %lld)\n",
-                current_usage, memory_ctx.limits.warning_threshold);
-    }
     if (current_usage > memory_ctx.limits.critical_threshold) {
-        pr_err("HiNATA memory usage critical: %lld bytes (threshold: %lld)\n",
-               current_usage, memory_ctx.limits.critical_threshold);
+        hinata_log_error(HINATA_ERROR_CAPACITY, "Memory usage above critical threshold",
+                         current_usage, memory_ctx.limits.critical_threshold);
+    } else if (current_usage > memory_ctx.limits.warning_threshold) {
+        hinata_log_warn(HINATA_ERROR_CAPACITY, "Memory usage above warning threshold",
+                        current_usage, memory_ctx.limits.warning_threshold);
     }
 
     return ptr;
@@ -471,7 +540,8 @@ void *hinata_calloc(size_t nmemb, size_t size)
  */
 void *hinata_realloc(void *ptr, size_t size)
 {
-    struct hinata_memory_block *block;
+    struct hinata_memory_block *block = NULL;
+    struct hinata_memory_header *header;
     void *new_ptr;
     size_t old_size = 0;
 
@@ -485,12 +555,19 @@ void *hinata_realloc(void *ptr, size_t size)
     }
 
     /* Find existing block to get old size */
-    if (memory_ctx.config.enable_tracking) {
+    if (static_branch_likely(&memory_tracking_key) ||
+        atomic64_read(&memory_tracked_blocks)) {
         block = hinata_memory_block_find(ptr);
         if (block) {
             old_size = block->size;
         }
     }
+    if (!block) {
+        header = hinata_memory_header_find(ptr);
+        if (header) {
+            old_size = header->size;
+        }
+    }
 
     /* Allocate new memory */
     new_ptr = hinata_malloc(size);
@@ -516,39 +593,63 @@ void *hinata_realloc(void *ptr, size_t size)
 void hinata_free(void *ptr)
 {
     struct hinata_memory_block *block;
+    struct hinata_memory_header *header;
+    void *base = ptr;
     size_t size = 0;
+    u32 flags = 0;
     bool found = false;
 
     if (!memory_initialized || !ptr) {
         return;
     }
 
-    /* Find and remove tracking block */
-    if (memory_ctx.config.enable_tracking) {
+    /* Find and remove tracking block, including ones from before tracking was disabled */
+    if (static_branch_likely(&memory_tracking_key) ||
+        atomic64_read(&memory_tracked_blocks)) {
         block = hinata_memory_block_find(ptr);
         if (block) {
             size = block->size;
+            flags = block->flags;
             hinata_memory_block_destroy(block);
+            atomic64_dec(&memory_tracked_blocks);
+            found = true;
+        }
+    }
+
+    /* Otherwise it was allocated while tracking was disabled */
+    if (!found) {
+        header = hinata_memory_header_find(ptr);
+        if (header) {
+            size = header->size;
+            header->magic = 0;
+            base = header;
             found = true;
         }
     }
 
-    /* Free memory */
-    if (found && memory_ctx.config.enable_pooling) {
+    /* Poison freed memory so use after free stands out; needs the recorded size */
+    if (found && hinata_is_validation_enabled()) {
+        memset(ptr, POISON_FREE, size);
+    }
+
+    /* Free memory back to where it came from */
+    if (flags & HINATA_MEMORY_FLAG_POOLED) {
         hinata_memory_pool_free(ptr, size);
     } else {
         /* Try to determine if it's vmalloc or kmalloc */
-        if (is_vmalloc_addr(ptr)) {
-            vfree(ptr);
+        if (is_vmalloc_addr(base)) {
+            vfree(base);
         } else {
-            kfree(ptr);
+            kfree(base);
         }
     }
 
     /* Update statistics */
     if (found) {
         atomic64_add(size, &memory_ctx.total_freed);
-        atomic64_inc(&memory_ctx.free_count);
+        if (static_branch_likely(&memory_stats_key)) {
+            atomic64_inc(&memory_ctx.free_count);
+        }
     }
 }
 
@@ -611,6 +712,93 @@ int hinata_memory_get_stats(struct hinata_memory_stats *stats)
     return 0;
 }
 
+/**
+ * hinata_memory_apply_config - Sync feature switches with the configuration
+ * 
+ * Must be called from process context; patching a static key sleeps.
+ */
+static void hinata_memory_apply_config(void)
+{
+    if (memory_ctx.config.enable_tracking) {
+        static_branch_enable(&memory_tracking_key);
+    } else {
+        static_branch_disable(&memory_tracking_key);
+    }
+
+    if (memory_ctx.config.enable_pooling) {
+        static_branch_enable(&memory_pooling_key);
+    } else {
+        static_branch_disable(&memory_pooling_key);
+    }
+
+    if (memory_ctx.config.enable_stats) {
+        static_branch_enable(&memory_stats_key);
+    } else {
+        static_branch_disable(&memory_stats_key);
+    }
+}
+
+/**
+ * hinata_memory_get_config - Get memory configuration
+ * @config: Output configuration
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_memory_get_config(struct hinata_memory_config *config)
+{
+    if (!memory_initialized || !config) {
+        return -EINVAL;
+    }
+
+    mutex_lock(&memory_ctx.lock);
+    memcpy(config, &memory_ctx.config, sizeof(*config));
+    mutex_unlock(&memory_ctx.lock);
+
+    return 0;
+}
+
+/**
+ * hinata_memory_set_config - Set memory configuration
+ * @config: New configuration
+ * 
+ * Feature switches take effect immediately. Memory that was pooled or
+ * tracked before a switch is turned off is still released correctly.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_memory_set_config(const struct hinata_memory_config *config)
+{
+    bool gc_started, stats_started;
+
+    if (!memory_initialized || !config) {
+        return -EINVAL;
+    }
+
+    if (!config->gc_interval || !config->stats_interval) {
+        return -EINVAL;
+    }
+
+    mutex_lock(&memory_ctx.lock);
+
+    gc_started = !memory_ctx.config.enable_gc && config->enable_gc;
+    stats_started = !memory_ctx.config.enable_stats && config->enable_stats;
+
+    memcpy(&memory_ctx.config, config, sizeof(*config));
+    hinata_memory_apply_config();
+
+    mutex_unlock(&memory_ctx.lock);
+
+    /* Disabled timers stop re-arming themselves; re-enabled ones need a kick */
+    if (gc_started) {
+        mod_timer(&memory_ctx.gc_timer, jiffies + msecs_to_jiffies(config->gc_interval));
+    }
+    if (stats_started) {
+        mod_timer(&memory_ctx.stats_timer, jiffies + msecs_to_jiffies(config->stats_interval));
+    }
+
+    return 0;
+}
+
 /**
  * hinata_memory_reset_stats - Reset memory statistics
  */
@@ -747,6 +935,26 @@ static void hinata_memory_pool_free(void *ptr, size_t size)
     pool->stats.bytes_freed += pool->size;
 }
 
+/**
+ * hinata_memory_header_find - Find the size header of an untracked allocation
+ * @ptr: Pointer returned by hinata_malloc()
+ *
+ * Only valid for pointers that have no tracking block.
+ *
+ * Returns: Header in front of @ptr, NULL if it carries none
+ */
+static struct hinata_memory_header *hinata_memory_header_find(void *ptr)
+{
+    struct hinata_memory_header *header;
+
+    header = (struct hinata_memory_header *)((u8 *)ptr - HINATA_MEMORY_HEADER_SIZE);
+    if (header->magic != HINATA_MEMORY_HEADER_MAGIC) {
+        return NULL;
+    }
+
+    return header;
+}
+
 /* Memory block tracking functions */
 
 /**
@@ -875,7 +1083,7 @@ static void hinata_memory_stats_work_func(struct work_struct *work)
  */
 static void hinata_memory_gc_timer_func(struct timer_list *timer)
 {
-    if (memory_ctx.config.enable_gc) {
+    if (READ_ONCE(memory_ctx.config.enable_gc)) {
         schedule_work(&memory_ctx.gc_work);
         mod_timer(&memory_ctx.gc_timer, jiffies + msecs_to_jiffies(memory_ctx.config.gc_interval));
     }
@@ -887,7 +1095,7 @@ static void hinata_memory_gc_timer_func(struct timer_list *timer)
  */
 static void hinata_memory_stats_timer_func(struct timer_list *timer)
 {
-    if (memory_ctx.config.enable_stats) {
+    if (static_branch_likely(&memory_stats_key)) {
         schedule_work(&memory_ctx.stats_work);
         mod_timer(&memory_ctx.stats_timer, jiffies + msecs_to_jiffies(memory_ctx.config.stats_interval));
     }
@@ -1027,4 +1235,6 @@ EXPORT_SYMBOL(hinata_free);
 EXPORT_SYMBOL(hinata_get_allocated_memory);
 EXPORT_SYMBOL(hinata_check_memory_limit);
 EXPORT_SYMBOL(hinata_memory_get_stats);
+EXPORT_SYMBOL(hinata_memory_get_config);
+EXPORT_SYMBOL(hinata_memory_set_config);
 EXPORT_SYMBOL(hinata_memory_reset_stats);
\ No newline at end of file
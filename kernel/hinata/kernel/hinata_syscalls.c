@@ -116,6 +116,7 @@
 #include "../hinata_core.h"
 #include "../core/hinata_packet.h"
 #include "../core/hinata_validation.h"
+#include "../core/hinata_config.h"
 #include "../storage/hinata_storage.h"
 #include "hinata_memory.h"
 #include "hinata_syscalls.h"
@@ -256,7 +257,8 @@ ASMLINKAGE long sys_hinata_packet_create(u32 type,
     }
 
     /* Check concurrent calls limit */
-    if (atomic_inc_return(&hinata_syscall_concurrent) > HINATA_SYSCALL_MAX_CONCURRENT) {
+    if (atomic_inc_return(&hinata_syscall_concurrent) >
+        hinata_config_value(syscall_max_concurrent)) {
         atomic_dec(&hinata_syscall_concurrent);
         atomic64_inc(&syscall_stats.concurrent_calls);
         return -EBUSY;
@@ -420,7 +422,8 @@ ASMLINKAGE long sys_hinata_packet_store(const hinata_uuid_t __user *packet_id, u
     }
 
     /* Check concurrent calls limit */
-    if (atomic_inc_return(&hinata_syscall_concurrent) > HINATA_SYSCALL_MAX_CONCURRENT) {
+    if (atomic_inc_return(&hinata_syscall_concurrent) >
+        hinata_config_value(syscall_max_concurrent)) {
         atomic_dec(&hinata_syscall_concurrent);
         atomic64_inc(&syscall_stats.concurrent_calls);
         return -EBUSY;
@@ -520,7 +523,8 @@ ASMLINKAGE long sys_hinata_packet_load(const hinata_uuid_t __user *packet_id,
     }
 
     /* Check concurrent calls limit */
-    if (atomic_inc_return(&hinata_syscall_concurrent) > HINATA_SYSCALL_MAX_CONCURRENT) {
+    if (atomic_inc_return(&hinata_syscall_concurrent) >
+        hinata_config_value(syscall_max_concurrent)) {
         atomic_dec(&hinata_syscall_concurrent);
         atomic64_inc(&syscall_stats.concurrent_calls);
         return -EBUSY;
@@ -656,7 +660,8 @@ ASMLINKAGE long sys_hinata_system_info(struct hinata_system_info __user *info)
     }
 
     /* Check concurrent calls limit */
-    if (atomic_inc_return(&hinata_syscall_concurrent) > HINATA_SYSCALL_MAX_CONCURRENT) {
+    if (atomic_inc_return(&hinata_syscall_concurrent) >
+        hinata_config_value(syscall_max_concurrent)) {
         atomic_dec(&hinata_syscall_concurrent);
         atomic64_inc(&syscall_stats.concurrent_calls);
         return -EBUSY;
@@ -1027,6 +1032,47 @@ static const struct proc_ops hinata_syscall_proc_ops = {
 
 static struct proc_dir_entry *hinata_syscall_proc_entry;
 
+/**
+ * hinata_syscall_set_rate_limit - Resize the system call rate limit
+ * @burst: Calls admitted per second
+ */
+static void hinata_syscall_set_rate_limit(u32 burst)
+{
+    unsigned long flags;
+    
+    raw_spin_lock_irqsave(&hinata_syscall_ratelimit.lock, flags);
+    hinata_syscall_ratelimit.burst = burst;
+    raw_spin_unlock_irqrestore(&hinata_syscall_ratelimit.lock, flags);
+}
+
+/**
+ * hinata_syscall_config_notify - Apply configuration changes
+ * @nb: Notifier block
+ * @action: HINATA_CONFIG_CHANGED
+ * @data: struct hinata_config_change
+ * 
+ * Returns: NOTIFY_OK
+ */
+static int hinata_syscall_config_notify(struct notifier_block *nb,
+                                        unsigned long action, void *data)
+{
+    struct hinata_config_change *change = data;
+    
+    if (action != HINATA_CONFIG_CHANGED) {
+        return NOTIFY_DONE;
+    }
+    
+    if (change->new->syscall_rate_limit != change->old->syscall_rate_limit) {
+        hinata_syscall_set_rate_limit(change->new->syscall_rate_limit);
+    }
+    
+    return NOTIFY_OK;
+}
+
+static struct notifier_block hinata_syscall_config_nb = {
+    .notifier_call = hinata_syscall_config_notify,
+};
+
 /**
  * hinata_syscalls_init - Initialize HiNATA system calls
  * 
@@ -1041,10 +1087,15 @@ int hinata_syscalls_init(void)
     /* Initialize statistics */
     memset(&syscall_stats, 0, sizeof(syscall_stats));
     
+    /* Track the configured rate limit */
+    hinata_syscall_set_rate_limit(hinata_config_value(syscall_rate_limit));
+    hinata_config_register_notifier(&hinata_syscall_config_nb);
+    
     /* Create proc entry */
     hinata_syscall_proc_entry = proc_create("hinata_syscalls", 0444, NULL, &hinata_syscall_proc_ops);
     if (!hinata_syscall_proc_entry) {
         pr_err("HiNATA: Failed to create proc entry for syscalls\n");
+        hinata_config_unregister_notifier(&hinata_syscall_config_nb);
         ret = -ENOMEM;
         goto out;
     }
@@ -1062,6 +1113,8 @@ void hinata_syscalls_cleanup(void)
 {
     pr_info("HiNATA: Cleaning up system calls interface\n");
     
+    hinata_config_unregister_notifier(&hinata_syscall_config_nb);
+    
     /* Remove proc entry */
     if (hinata_syscall_proc_entry) {
         proc_remove(hinata_syscall_proc_entry);
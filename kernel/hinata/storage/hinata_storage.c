@@ -16,6 +16,7 @@
 #include <linux/mutex.h>
 #include <linux/spinlock.h>
 #include <linux/hash.h>
+#include <linux/jhash.h>
 #include <linux/list.h>
 #include <linux/rbtree.h>
 #include <linux/workqueue.h>
@@ -28,9 +29,16 @@
 #include <linux/buffer_head.h>
 #include <linux/bio.h>
 #include <linux/blkdev.h>
+#include <linux/kref.h>
+#include <linux/completion.h>
+#include <linux/math64.h>
+#include <linux/overflow.h>
 #include "../hinata_core.h"
 #include "../core/hinata_packet.h"
 #include "../core/hinata_validation.h"
+#include "../core/hinata_config.h"
+#include "../hinata_task.h"
+#include "../kernel/hinata_interface.h"
 #include "hinata_storage.h"
 
 /* Module information */
@@ -45,8 +53,6 @@
 #define HINATA_STORAGE_BLOCK_SIZE   4096
 #define HINATA_STORAGE_MAX_REGIONS  64
 #define HINATA_STORAGE_CACHE_SIZE   1024
-#define HINATA_STORAGE_SYNC_INTERVAL 30000  /* 30 seconds */
-#define HINATA_STORAGE_GC_INTERVAL  60000   /* 60 seconds */
 
 /* Storage flags */
 #define HINATA_STORAGE_FLAG_DIRTY       (1 << 0)
@@ -188,6 +194,9 @@ struct hinata_storage_region {
  * @gc_work: Garbage collection work
  * @sync_timer: Sync timer
  * @gc_timer: GC timer
+ * @warm_work: Background warm-restart snapshot load
+ * @snapshot_flags: Flags used when saving warm-restart snapshots
+ * @suspended: Storage is suspended
  * @stats: Global storage statistics
  * @lock: Global storage lock
  */
@@ -202,6 +211,9 @@ struct hinata_storage_context {
     struct work_struct gc_work;
     struct timer_list sync_timer;
     struct timer_list gc_timer;
+    struct work_struct warm_work;
+    u32 snapshot_flags;
+    bool suspended;
     struct hinata_storage_stats stats;
     struct mutex lock;
 };
@@ -219,6 +231,33 @@ static void hinata_storage_sync_work_func(struct work_struct *work);
 static void hinata_storage_gc_work_func(struct work_struct *work);
 static void hinata_storage_sync_timer_func(struct timer_list *timer);
 static void hinata_storage_gc_timer_func(struct timer_list *timer);
+static void hinata_storage_warm_work_func(struct work_struct *work);
+static int hinata_storage_config_notify(struct notifier_block *nb,
+                                        unsigned long action, void *data);
+
+static struct notifier_block hinata_storage_config_nb = {
+    .notifier_call = hinata_storage_config_notify,
+};
+
+/**
+ * hinata_storage_sync_delay - Sync period from the live configuration
+ * 
+ * Returns: Sync period in jiffies
+ */
+static inline unsigned long hinata_storage_sync_delay(void)
+{
+    return msecs_to_jiffies(hinata_config_value(sync_interval_ms));
+}
+
+/**
+ * hinata_storage_gc_delay - GC period from the live configuration
+ * 
+ * Returns: GC period in jiffies
+ */
+static inline unsigned long hinata_storage_gc_delay(void)
+{
+    return msecs_to_jiffies(hinata_config_value(gc_interval_ms));
+}
 
 /**
  * hinata_storage_init - Initialize storage subsystem
@@ -262,18 +301,25 @@ int hinata_storage_init(void)
     /* Initialize work queues */
     INIT_WORK(&storage_ctx.sync_work, hinata_storage_sync_work_func);
     INIT_WORK(&storage_ctx.gc_work, hinata_storage_gc_work_func);
+    INIT_WORK(&storage_ctx.warm_work, hinata_storage_warm_work_func);
+    storage_ctx.snapshot_flags = HINATA_SNAPSHOT_FLAG_CONTENTS;
 
     /* Initialize timers */
     timer_setup(&storage_ctx.sync_timer, hinata_storage_sync_timer_func, 0);
     timer_setup(&storage_ctx.gc_timer, hinata_storage_gc_timer_func, 0);
 
     /* Start timers */
-    mod_timer(&storage_ctx.sync_timer, jiffies + msecs_to_jiffies(HINATA_STORAGE_SYNC_INTERVAL));
-    mod_timer(&storage_ctx.gc_timer, jiffies + msecs_to_jiffies(HINATA_STORAGE_GC_INTERVAL));
+    mod_timer(&storage_ctx.sync_timer, jiffies + hinata_storage_sync_delay());
+    mod_timer(&storage_ctx.gc_timer, jiffies + hinata_storage_gc_delay());
+
+    hinata_config_register_notifier(&hinata_storage_config_nb);
 
     storage_initialized = true;
     pr_info("HiNATA storage subsystem initialized successfully\n");
 
+    /* Warm the cache from the last shutdown snapshot, if any */
+    hinata_storage_snapshot_load_async();
+
     return 0;
 }
 
@@ -290,6 +336,8 @@ void hinata_storage_cleanup(void)
 
     pr_info("Cleaning up HiNATA storage subsystem\n");
 
+    hinata_config_unregister_notifier(&hinata_storage_config_nb);
+
     /* Stop timers */
     del_timer_sync(&storage_ctx.sync_timer);
     del_timer_sync(&storage_ctx.gc_timer);
@@ -297,6 +345,12 @@ void hinata_storage_cleanup(void)
     /* Cancel work */
     cancel_work_sync(&storage_ctx.sync_work);
     cancel_work_sync(&storage_ctx.gc_work);
+    cancel_work_sync(&storage_ctx.warm_work);
+
+    /* Persist hot cache entries for the next start, unless suspend already did */
+    if (hinata_config_value(warm_restart) && !storage_ctx.suspended) {
+        hinata_storage_snapshot_save(NULL, storage_ctx.snapshot_flags);
+    }
 
     /* Cleanup regions */
     for (i = 0; i < storage_ctx.region_count; i++) {
@@ -409,13 +463,50 @@ int hinata_storage_destroy_region(u32 region_id)
 }
 
 /**
- * hinata_storage_store_packet - Store packet to storage
- * @packet: Packet to store
- * @region_id: Target region ID
- * 
- * Returns: 0 on success, negative error code on failure
+ * hinata_storage_packet_view - Rebind a serialized packet to its payload
+ * @data: Packet as serialized by hinata_storage_store_packet()
+ * @size: Size of @data
+ * @view: Output header whose content and metadata point into @data
+ *
+ * The serialized header still carries the pointers of the packet it was
+ * copied from, so they are replaced before anything dereferences them.
+ * Strings are terminated and the packet validated, as @data may have been
+ * read back from a snapshot file.
+ *
+ * Returns: 0 on success, -EINVAL if @data is not a valid packet
  */
-int hinata_storage_store_packet(const struct hinata_packet *packet, u32 region_id)
+static int hinata_storage_packet_view(const void *data, size_t size,
+                                      struct hinata_packet *view)
+{
+    size_t payload;
+    u32 i;
+
+    if (size < sizeof(*view)) {
+        return -EINVAL;
+    }
+
+    memcpy(view, data, sizeof(*view));
+    payload = size - sizeof(*view);
+    if (view->content_size > payload ||
+        view->metadata_size != payload - view->content_size) {
+        return -EINVAL;
+    }
+
+    view->content = view->content_size ? (void *)data + sizeof(*view) : NULL;
+    view->metadata = view->metadata_size ?
+        (void *)data + sizeof(*view) + view->content_size : NULL;
+    view->id[sizeof(view->id) - 1] = '\0';
+    view->source[sizeof(view->source) - 1] = '\0';
+    for (i = 0; i < HINATA_MAX_TAGS; i++) {
+        view->tags[i][sizeof(view->tags[i]) - 1] = '\0';
+    }
+    atomic_set(&view->ref_count, 1);
+
+    return hinata_packet_validate(view) < 0 ? -EINVAL : 0;
+}
+
+/* Serialize and append a packet; timed by hinata_storage_store_packet() */
+static int hinata_storage_do_store_packet(const struct hinata_packet *packet, u32 region_id)
 {
     struct hinata_storage_region *region;
     struct hinata_storage_block block;
@@ -512,20 +603,31 @@ int hinata_storage_store_packet(const struct hinata_packet *packet, u32 region_i
 }
 
 /**
- * hinata_storage_load_packet - Load packet from storage
- * @packet_id: Packet ID to load
- * @region_id: Source region ID
- * @packet: Output packet structure
+ * hinata_storage_store_packet - Store packet to storage
+ * @packet: Packet to store
+ * @region_id: Target region ID
  * 
  * Returns: 0 on success, negative error code on failure
  */
-int hinata_storage_load_packet(const char *packet_id, u32 region_id,
-                              struct hinata_packet **packet)
+int hinata_storage_store_packet(const struct hinata_packet *packet, u32 region_id)
+{
+    struct hinata_operation_context op = { .type = HINATA_OP_CREATE };
+
+    hinata_perf_start_operation(&op);
+    op.result = hinata_storage_do_store_packet(packet, region_id);
+    hinata_perf_end_operation(&op);
+
+    return op.result;
+}
+
+/* Look up a packet; timed by hinata_storage_load_packet() */
+static int hinata_storage_do_load_packet(const char *packet_id, u32 region_id,
+                                         struct hinata_packet **packet)
 {
     struct hinata_storage_region *region;
+    struct hinata_packet *view;
     void *data;
     size_t data_size;
-    struct hinata_packet *loaded_packet;
     int ret;
 
     if (!storage_initialized || !packet_id || !packet) {
@@ -539,10 +641,16 @@ int hinata_storage_load_packet(const char *packet_id, u32 region_id,
     /* Try cache first */
     data = hinata_storage_cache_get(packet_id, &data_size);
     if (data) {
-        loaded_packet = (struct hinata_packet *)data;
-        *packet = hinata_packet_clone(loaded_packet);
+        /* Packet headers are too large for the stack */
+        view = kmalloc(sizeof(*view), GFP_KERNEL);
+        ret = view ? hinata_storage_packet_view(data, data_size, view) : -ENOMEM;
+        *packet = ret ? NULL : hinata_packet_clone(view);
         hinata_storage_cache_put_ref(packet_id);
+        kfree(view);
         atomic64_inc(&storage_ctx.stats.cache_hits);
+        if (ret) {
+            return ret;
+        }
         return *packet ? 0 : -ENOMEM;
     }
 
@@ -572,18 +680,38 @@ int hinata_storage_load_packet(const char *packet_id, u32 region_id,
 }
 
 /**
- * hinata_storage_delete_packet - Delete packet from storage
- * @packet_id: Packet ID to delete
+ * hinata_storage_load_packet - Load packet from storage
+ * @packet_id: Packet ID to load
  * @region_id: Source region ID
+ * @packet: Output packet structure
  * 
  * Returns: 0 on success, negative error code on failure
  */
-int hinata_storage_delete_packet(const char *packet_id, u32 region_id)
+int hinata_storage_load_packet(const char *packet_id, u32 region_id,
+                              struct hinata_packet **packet)
+{
+    struct hinata_operation_context op = { .type = HINATA_OP_READ };
+    int ret;
+
+    hinata_perf_start_operation(&op);
+    ret = hinata_storage_do_load_packet(packet_id, region_id, packet);
+    /* A miss is a valid answer, not a failed read */
+    op.result = ret == -ENOENT ? 0 : ret;
+    hinata_perf_end_operation(&op);
+
+    return ret;
+}
+
+/* Delete a packet; timed by hinata_storage_delete_packet() */
+static int hinata_storage_do_delete_packet(const char *packet_id, u32 region_id)
 {
     struct hinata_storage_region *region;
+    struct hinata_packet *marker;
+    loff_t offset;
+    ssize_t written;
     int ret;
 
-    if (!storage_initialized || !packet_id) {
+    if (!storage_initialized || !packet_id || !*packet_id) {
         return -EINVAL;
     }
 
@@ -596,22 +724,43 @@ int hinata_storage_delete_packet(const char *packet_id, u32 region_id)
         return -ENOENT;
     }
 
+    /* Packet headers are too large for the stack */
+    marker = kzalloc(sizeof(*marker), GFP_KERNEL);
+    if (!marker) {
+        return -ENOMEM;
+    }
+
+    marker->magic = HINATA_PACKET_MAGIC;
+    marker->version = HINATA_PACKET_VERSION;
+    strscpy(marker->id, packet_id, sizeof(marker->id));
+    marker->updated_at = hinata_get_timestamp();
+    marker->flags = HINATA_PACKET_FLAG_DELETED;
+
     mutex_lock(&region->lock);
 
     /* Remove from cache */
     hinata_storage_cache_remove(packet_id);
 
-    /* TODO: Implement storage deletion logic */
-    /* This would involve:
-     * 1. Find packet in storage blocks
-     * 2. Mark block as free
-     * 3. Update region statistics
-     * 4. Schedule garbage collection
+    /*
+     * Regions are append-only: a header-only deletion record hides every
+     * earlier record of the packet from readers such as the exporter.
      */
-
-    ret = 0; /* Placeholder */
+    offset = region->used_size;
+    written = kernel_write(region->file, marker, sizeof(*marker), &offset);
+    if (written == sizeof(*marker)) {
+        region->used_size += sizeof(*marker);
+        atomic64_add(sizeof(*marker), &storage_ctx.stats.bytes_written);
+        ret = 0;
+    } else {
+        ret = written < 0 ? written : -EIO;
+    }
 
     mutex_unlock(&region->lock);
+    kfree(marker);
+
+    if (ret < 0) {
+        return ret;
+    }
 
     /* Update global statistics */
     atomic64_inc(&storage_ctx.stats.packets_deleted);
@@ -619,6 +768,24 @@ int hinata_storage_delete_packet(const char *packet_id, u32 region_id)
     return ret;
 }
 
+/**
+ * hinata_storage_delete_packet - Delete packet from storage
+ * @packet_id: Packet ID to delete
+ * @region_id: Source region ID
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_storage_delete_packet(const char *packet_id, u32 region_id)
+{
+    struct hinata_operation_context op = { .type = HINATA_OP_DELETE };
+
+    hinata_perf_start_operation(&op);
+    op.result = hinata_storage_do_delete_packet(packet_id, region_id);
+    hinata_perf_end_operation(&op);
+
+    return op.result;
+}
+
 /**
  * hinata_storage_get_stats - Get storage statistics
  * @stats: Output statistics structure
@@ -635,13 +802,8 @@ int hinata_storage_get_stats(struct hinata_storage_stats *stats)
     return 0;
 }
 
-/**
- * hinata_storage_sync - Synchronize storage to disk
- * @region_id: Region ID to sync (HINATA_STORAGE_ALL_REGIONS for all)
- * 
- * Returns: 0 on success, negative error code on failure
- */
-int hinata_storage_sync(u32 region_id)
+/* Flush regions to disk; timed by hinata_storage_sync() */
+static int hinata_storage_do_sync(u32 region_id)
 {
     struct hinata_storage_region *region;
     u32 i, start, end;
@@ -679,6 +841,23 @@ int hinata_storage_sync(u32 region_id)
     return ret;
 }
 
+/**
+ * hinata_storage_sync - Synchronize storage to disk
+ * @region_id: Region ID to sync (HINATA_STORAGE_ALL_REGIONS for all)
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_storage_sync(u32 region_id)
+{
+    struct hinata_operation_context op = { .type = HINATA_OP_SYNC };
+
+    hinata_perf_start_operation(&op);
+    op.result = hinata_storage_do_sync(region_id);
+    hinata_perf_end_operation(&op);
+
+    return op.result;
+}
+
 /* Cache management functions */
 
 /**
@@ -763,6 +942,47 @@ void *hinata_storage_cache_get(const char *key, size_t *size)
     return data;
 }
 
+/**
+ * hinata_storage_cache_trim - Evict least recently used entries
+ * @max_entries: Number of entries to keep
+ * 
+ * Entries still referenced by a reader are skipped. Victims are freed
+ * after the cache lock is dropped.
+ */
+static void hinata_storage_cache_trim(u32 max_entries)
+{
+    struct hinata_storage_cache_entry *entry, *tmp;
+    LIST_HEAD(victims);
+
+    if (atomic_read(&storage_ctx.cache_size) <= max_entries) {
+        return;
+    }
+
+    spin_lock(&storage_ctx.cache_lock);
+
+    list_for_each_entry_safe_reverse(entry, tmp, &storage_ctx.cache_lru, lru_node) {
+        if (atomic_read(&storage_ctx.cache_size) <= max_entries) {
+            break;
+        }
+
+        if (atomic_read(&entry->ref_count) > 1) {
+            continue;  /* In use */
+        }
+
+        hlist_del(&entry->hash_node);
+        list_move(&entry->lru_node, &victims);
+        atomic_dec(&storage_ctx.cache_size);
+        atomic64_inc(&storage_ctx.stats.cache_evictions);
+    }
+
+    spin_unlock(&storage_ctx.cache_lock);
+
+    list_for_each_entry_safe(entry, tmp, &victims, lru_node) {
+        hinata_free(entry->data);
+        hinata_free(entry);
+    }
+}
+
 /**
  * hinata_storage_cache_put - Put data into cache
  * @key: Cache key
@@ -819,6 +1039,8 @@ int hinata_storage_cache_put(const char *key, const void *data, size_t size)
 
     spin_unlock(&storage_ctx.cache_lock);
 
+    hinata_storage_cache_trim(hinata_config_value(cache_max_entries));
+
     return 0;
 }
 
@@ -888,47 +1110,1347 @@ void hinata_storage_cache_put_ref(const char *key)
     spin_unlock(&storage_ctx.cache_lock);
 }
 
-/* Work functions */
-
 /**
- * hinata_storage_sync_work_func - Sync work function
- * @work: Work structure
+ * hinata_storage_cache_contains - Check whether a key is cached
+ * @key: Cache key
+ * 
+ * Returns: true if cached, false otherwise
  */
-static void hinata_storage_sync_work_func(struct work_struct *work)
+static bool hinata_storage_cache_contains(const char *key)
 {
-    hinata_storage_sync(HINATA_STORAGE_ALL_REGIONS);
+    struct hinata_storage_cache_entry *entry;
+    u32 hash_val;
+    bool found = false;
+
+    hash_val = hash_str(key, HINATA_STORAGE_CACHE_SIZE);
+
+    spin_lock(&storage_ctx.cache_lock);
+    hlist_for_each_entry(entry, &storage_ctx.cache[hash_val], hash_node) {
+        if (strcmp(entry->key, key) == 0) {
+            found = true;
+            break;
+        }
+    }
+    spin_unlock(&storage_ctx.cache_lock);
+
+    return found;
 }
 
+/* Warm-restart snapshots */
+
 /**
- * hinata_storage_gc_work_func - Garbage collection work function
- * @work: Work structure
+ * hinata_storage_cache_copy - Copy one cache entry out of the cache
+ * @key: Cache key
+ * @buffer: Destination
+ * @space: Bytes available at @buffer
+ * 
+ * The cache lock is held for a single entry only.
+ * 
+ * Returns: Bytes copied, 0 if the key is no longer cached, -ENOSPC if the
+ * entry does not fit in @space
  */
-static void hinata_storage_gc_work_func(struct work_struct *work)
+static ssize_t hinata_storage_cache_copy(const char *key, void *buffer, size_t space)
 {
-    /* TODO: Implement garbage collection logic */
-    pr_debug("HiNATA storage garbage collection triggered\n");
-}
+    struct hinata_storage_cache_entry *entry;
+    ssize_t copied = 0;
+    u32 hash_val;
 
-/* Timer functions */
+    hash_val = hash_str(key, HINATA_STORAGE_CACHE_SIZE);
+
+    spin_lock(&storage_ctx.cache_lock);
+    hlist_for_each_entry(entry, &storage_ctx.cache[hash_val], hash_node) {
+        if (strcmp(entry->key, key) == 0) {
+            if (entry->size > space) {
+                copied = -ENOSPC;
+            } else if (entry->data) {
+                memcpy(buffer, entry->data, entry->size);
+                copied = entry->size;
+            }
+            break;
+        }
+    }
+    spin_unlock(&storage_ctx.cache_lock);
+
+    return copied;
+}
 
 /**
- * hinata_storage_sync_timer_func - Sync timer function
- * @timer: Timer structure
+ * hinata_storage_snapshot_discard - Invalidate a consumed snapshot
+ * @path: Snapshot file
+ * 
+ * A snapshot describes the cache at the moment it was written. Once it
+ * has been loaded, or found corrupted, it is truncated so that a later
+ * start does not warm the cache with stale packets.
  */
-static void hinata_storage_sync_timer_func(struct timer_list *timer)
+static void hinata_storage_snapshot_discard(const char *path)
 {
-    schedule_work(&storage_ctx.sync_work);
-    mod_timer(&storage_ctx.sync_timer, jiffies + msecs_to_jiffies(HINATA_STORAGE_SYNC_INTERVAL));
+    struct file *file;
+
+    file = filp_open(path, O_WRONLY | O_TRUNC | O_NOFOLLOW, 0);
+    if (IS_ERR(file)) {
+        pr_warn("Failed to discard snapshot file '%s': %ld\n", path, PTR_ERR(file));
+        return;
+    }
+
+    vfs_fsync(file, 0);
+    filp_close(file, NULL);
 }
 
 /**
- * hinata_storage_gc_timer_func - GC timer function
- * @timer: Timer structure
+ * hinata_storage_snapshot_save - Persist hot cache entries for a warm restart
+ * @path: Snapshot file, NULL for the configured storage.snapshot_path
+ * @flags: HINATA_SNAPSHOT_FLAG_* flags, must include HINATA_SNAPSHOT_FLAG_CONTENTS
+ * 
+ * Walks the cache LRU from the hottest entry and records up to
+ * HINATA_SNAPSHOT_MAX_ENTRIES serialized packets, stopping once the byte
+ * budget is spent. Only the keys are collected while the LRU is walked;
+ * each entry is then copied out on its own, so the cache lock is never
+ * held for more than one entry. Entries evicted in between are skipped.
+ * 
+ * Key-only snapshots are not supported: regions cannot be searched by
+ * key yet, so such records could never be loaded.
+ * 
+ * Returns: Number of entries saved, negative error code on failure
  */
-static void hinata_storage_gc_timer_func(struct timer_list *timer)
+int hinata_storage_snapshot_save(const char *path, u32 flags)
 {
-    schedule_work(&storage_ctx.gc_work);
-    mod_timer(&storage_ctx.gc_timer, jiffies + msecs_to_jiffies(HINATA_STORAGE_GC_INTERVAL));
+    struct hinata_storage_snapshot_header header;
+    struct hinata_storage_snapshot_record *records;
+    struct hinata_storage_snapshot_record *record;
+    struct hinata_storage_cache_entry *entry;
+    struct file *file;
+    loff_t pos = 0;
+    ssize_t written;
+    size_t used = 0;
+    u32 key_count = 0;
+    u32 count = 0;
+    void *buffer;
+    char default_path[HINATA_CONFIG_VALUE_MAX];
+    int ret = 0;
+    u32 i;
+
+    if (!storage_initialized) {
+        return -ENODEV;
+    }
+
+    if (!(flags & HINATA_SNAPSHOT_FLAG_CONTENTS)) {
+        return -EOPNOTSUPP;
+    }
+
+    if (!path) {
+        ret = hinata_config_get_string("storage.snapshot_path",
+                                       default_path, sizeof(default_path));
+        if (ret < 0) {
+            return ret;
+        }
+        path = default_path;
+    }
+
+    buffer = vmalloc(HINATA_SNAPSHOT_MAX_BYTES);
+    records = vmalloc(array_size(HINATA_SNAPSHOT_MAX_ENTRIES, sizeof(*records)));
+    if (!buffer || !records) {
+        ret = -ENOMEM;
+        goto out_free;
+    }
+
+    /* Collect keys hottest first; entries are copied outside the lock */
+    spin_lock(&storage_ctx.cache_lock);
+    list_for_each_entry(entry, &storage_ctx.cache_lru, lru_node) {
+        if (key_count >= HINATA_SNAPSHOT_MAX_ENTRIES) {
+            break;
+        }
+
+        record = &records[key_count++];
+        memcpy(record->key, entry->key, sizeof(record->key));
+        record->access_count = atomic_read(&entry->access_count);
+        record->size = 0;
+    }
+    spin_unlock(&storage_ctx.cache_lock);
+
+    for (i = 0; i < key_count; i++) {
+        ssize_t copied;
+
+        if (used + sizeof(*record) >= HINATA_SNAPSHOT_MAX_BYTES) {
+            break;
+        }
+
+        record = buffer + used;
+        copied = hinata_storage_cache_copy(records[i].key, record + 1,
+                                           HINATA_SNAPSHOT_MAX_BYTES - used - sizeof(*record));
+        if (copied <= 0) {
+            continue;  /* Evicted since, or too large for the remaining budget */
+        }
+
+        *record = records[i];
+        record->size = copied;
+        used += sizeof(*record) + copied;
+        count++;
+
+        cond_resched();
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = HINATA_SNAPSHOT_MAGIC;
+    header.version = HINATA_SNAPSHOT_VERSION;
+    header.flags = flags;
+    header.entry_count = count;
+    header.payload_size = used;
+    header.created_time = hinata_get_timestamp();
+    header.checksum = crc32(0, buffer, used);
+
+    file = filp_open(path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW, 0600);
+    if (IS_ERR(file)) {
+        ret = PTR_ERR(file);
+        pr_err("Failed to open snapshot file '%s': %d\n", path, ret);
+        goto out_free;
+    }
+
+    written = kernel_write(file, &header, sizeof(header), &pos);
+    if (written == sizeof(header) && used) {
+        written = kernel_write(file, buffer, used, &pos);
+        if (written != used) {
+            written = -EIO;
+        }
+    } else if (written != sizeof(header)) {
+        written = -EIO;
+    }
+
+    if (written < 0) {
+        ret = written;
+        pr_err("Failed to write snapshot file '%s': %d\n", path, ret);
+    } else {
+        ret = vfs_fsync(file, 0);
+    }
+
+    filp_close(file, NULL);
+
+    if (ret == 0) {
+        ret = count;
+        pr_info("HiNATA storage saved warm-restart snapshot (%u entries, %zu bytes)\n",
+                count, used);
+    }
+
+out_free:
+    vfree(records);
+    vfree(buffer);
+    return ret;
+}
+
+/**
+ * hinata_storage_snapshot_load - Warm the cache from a snapshot
+ * @path: Snapshot file, NULL for the configured storage.snapshot_path
+ * 
+ * Records are inserted coldest first so the LRU order of the snapshot is
+ * preserved. Every record must hold a valid serialized packet; others are
+ * dropped. Keys that are already cached are left untouched, as they are
+ * at least as fresh. The snapshot is discarded once read, so it is never
+ * loaded twice.
+ * 
+ * Returns: Number of entries warmed, -ENOENT if there is no snapshot,
+ * other negative error code on failure
+ */
+int hinata_storage_snapshot_load(const char *path)
+{
+    struct hinata_storage_snapshot_header header;
+    struct hinata_storage_snapshot_record *record;
+    struct hinata_packet *view = NULL;
+    struct file *file;
+    loff_t pos = 0;
+    ssize_t nread;
+    size_t offset = 0;
+    u32 *offsets = NULL;
+    void *buffer = NULL;
+    char default_path[HINATA_CONFIG_VALUE_MAX];
+    int loaded = 0;
+    int ret;
+    u32 i;
+
+    if (!storage_initialized) {
+        return -ENODEV;
+    }
+
+    if (!path) {
+        ret = hinata_config_get_string("storage.snapshot_path",
+                                       default_path, sizeof(default_path));
+        if (ret < 0) {
+            return ret;
+        }
+        path = default_path;
+    }
+
+    file = filp_open(path, O_RDONLY | O_NOFOLLOW, 0);
+    if (IS_ERR(file)) {
+        return PTR_ERR(file);
+    }
+
+    nread = kernel_read(file, &header, sizeof(header), &pos);
+    if (nread == 0) {
+        /* Already consumed */
+        filp_close(file, NULL);
+        return -ENOENT;
+    }
+
+    if (nread != sizeof(header) ||
+        header.magic != HINATA_SNAPSHOT_MAGIC ||
+        header.version != HINATA_SNAPSHOT_VERSION ||
+        !(header.flags & HINATA_SNAPSHOT_FLAG_CONTENTS) ||
+        header.payload_size > HINATA_SNAPSHOT_MAX_BYTES ||
+        header.entry_count > HINATA_SNAPSHOT_MAX_ENTRIES) {
+        ret = -EINVAL;
+        goto out_close;
+    }
+
+    if (!header.entry_count) {
+        ret = 0;
+        goto out_close;
+    }
+
+    buffer = vmalloc(header.payload_size);
+    offsets = kmalloc_array(header.entry_count, sizeof(*offsets), GFP_KERNEL);
+    view = kmalloc(sizeof(*view), GFP_KERNEL);
+    if (!buffer || !offsets || !view) {
+        ret = -ENOMEM;
+        goto out_free;
+    }
+
+    nread = kernel_read(file, buffer, header.payload_size, &pos);
+    if (nread != header.payload_size ||
+        crc32(0, buffer, header.payload_size) != header.checksum) {
+        pr_warn("HiNATA storage snapshot '%s' is corrupted, ignoring\n", path);
+        ret = -EIO;
+        goto out_free;
+    }
+
+    /* Index the variable-length records, validating them on the way */
+    for (i = 0; i < header.entry_count; i++) {
+        if (offset + sizeof(*record) > header.payload_size) {
+            break;
+        }
+        record = buffer + offset;
+        if (record->size > header.payload_size - offset - sizeof(*record)) {
+            break;
+        }
+        record->key[sizeof(record->key) - 1] = '\0';
+        offsets[i] = offset;
+        offset += sizeof(*record) + record->size;
+    }
+    header.entry_count = i;
+
+    /* Insert coldest first so the hottest key ends up at the LRU head */
+    for (i = header.entry_count; i-- > 0; ) {
+        record = buffer + offsets[i];
+
+        if (hinata_storage_packet_view(record + 1, record->size, view) ||
+            strcmp(view->id, record->key) != 0) {
+            continue;
+        }
+
+        if (hinata_storage_cache_contains(record->key)) {
+            continue;
+        }
+
+        if (hinata_storage_cache_put(record->key, record + 1, record->size) == 0) {
+            loaded++;
+        }
+    }
+    ret = loaded;
+
+    pr_info("HiNATA storage warmed %d of %u entries from snapshot\n",
+            loaded, header.entry_count);
+
+out_free:
+    kfree(view);
+    kfree(offsets);
+    vfree(buffer);
+out_close:
+    filp_close(file, NULL);
+    if (ret != -ENOMEM) {
+        hinata_storage_snapshot_discard(path);
+    }
+    return ret;
+}
+
+/**
+ * hinata_storage_snapshot_load_async - Warm the cache in the background
+ */
+void hinata_storage_snapshot_load_async(void)
+{
+    if (!storage_initialized || !hinata_config_value(warm_restart)) {
+        return;
+    }
+
+    schedule_work(&storage_ctx.warm_work);
+}
+
+/**
+ * struct hinata_export_segment - One slot of the export pipeline
+ * @ref: Held by the exporter and by a queued formatting task
+ * @format: Output format
+ * @input: Live packet records read from the region
+ * @input_size: Bytes of records in @input
+ * @input_capacity: Allocated size of @input
+ * @span: Region bytes covered by @input, including skipped records
+ * @output: Formatted records
+ * @output_size: Bytes of formatted output
+ * @output_capacity: Allocated size of @output
+ * @items: Number of records in @input
+ * @header: Aligned copy of the record header being decoded
+ * @result: Formatting result
+ * @done: Completed once @output is ready
+ *
+ * Records are stored back to back, so their headers are copied into
+ * @header before any field is read.
+ *
+ * Segments are reused round-robin. The exporter only touches a segment
+ * after @done, and a formatting task holds its own reference, so a task
+ * that outlives an aborted export still finds its buffers.
+ */
+struct hinata_export_segment {
+    struct kref ref;
+    enum hinata_export_format format;
+    void *input;
+    size_t input_size;
+    size_t input_capacity;
+    size_t span;
+    char *output;
+    size_t output_size;
+    size_t output_capacity;
+    u32 items;
+    struct hinata_packet header;
+    int result;
+    struct completion done;
+};
+
+/**
+ * struct hinata_export_live - Last record of one packet in the region
+ * @id: Packet ID, empty for a free slot
+ * @offset: Region offset of the packet's last record
+ */
+struct hinata_export_live {
+    char id[HINATA_UUID_LENGTH];
+    loff_t offset;
+};
+
+/**
+ * struct hinata_export_index - Open-addressing table of packet IDs
+ * @slots: Table, size is a power of two
+ * @capacity: Number of slots
+ * @count: Number of used slots
+ *
+ * Only the last record of a packet is exported, and not at all when that
+ * record is a deletion marker; earlier records were superseded.
+ */
+struct hinata_export_index {
+    struct hinata_export_live *slots;
+    size_t capacity;
+    size_t count;
+};
+
+static const char hinata_export_csv_header[] =
+    "id,type,priority,status,created_at,updated_at,source,tags,content\n";
+
+/**
+ * hinata_export_format_to_string - Convert export format to string
+ * @format: Export format
+ * 
+ * Returns: String representation of the format
+ */
+const char *hinata_export_format_to_string(enum hinata_export_format format)
+{
+    switch (format) {
+    case HINATA_EXPORT_FORMAT_JSONL:
+        return "jsonl";
+    case HINATA_EXPORT_FORMAT_CSV:
+        return "csv";
+    default:
+        return "unknown";
+    }
+}
+
+static void hinata_export_segment_release(struct kref *ref)
+{
+    struct hinata_export_segment *seg =
+        container_of(ref, struct hinata_export_segment, ref);
+
+    vfree(seg->input);
+    vfree(seg->output);
+    kfree(seg);
+}
+
+static struct hinata_export_segment *hinata_export_segment_alloc(enum hinata_export_format format)
+{
+    struct hinata_export_segment *seg;
+
+    seg = kzalloc(sizeof(*seg), GFP_KERNEL);
+    if (!seg) {
+        return NULL;
+    }
+
+    seg->input = vmalloc(HINATA_EXPORT_SEGMENT_SIZE);
+    if (!seg->input) {
+        kfree(seg);
+        return NULL;
+    }
+
+    kref_init(&seg->ref);
+    seg->format = format;
+    seg->input_capacity = HINATA_EXPORT_SEGMENT_SIZE;
+    init_completion(&seg->done);
+    return seg;
+}
+
+/**
+ * hinata_export_record_size - Decode the header of the record at @offset
+ * @seg: Segment holding the record
+ * @offset: Record offset in the input buffer
+ * @avail: Bytes available in the input buffer
+ * @size: Output record size
+ * 
+ * Returns: 0 on success, -EAGAIN if the record header is incomplete,
+ *          -EUCLEAN if the record is not a packet
+ */
+static int hinata_export_record_size(struct hinata_export_segment *seg, size_t offset,
+                                     size_t avail, size_t *size)
+{
+    struct hinata_packet *packet = &seg->header;
+
+    if (avail - offset < sizeof(*packet)) {
+        return -EAGAIN;
+    }
+
+    memcpy(packet, seg->input + offset, sizeof(*packet));
+    if (packet->magic != HINATA_PACKET_MAGIC ||
+        packet->content_size > HINATA_STORAGE_MAX_SIZE ||
+        packet->metadata_size > HINATA_STORAGE_MAX_SIZE) {
+        return -EUCLEAN;
+    }
+
+    *size = sizeof(*packet) + packet->content_size + packet->metadata_size;
+    return 0;
+}
+
+static struct hinata_export_live *hinata_export_index_slot(struct hinata_export_index *index,
+                                                           const char *id)
+{
+    size_t mask = index->capacity - 1;
+    size_t slot = jhash(id, strnlen(id, HINATA_UUID_LENGTH), 0) & mask;
+
+    while (index->slots[slot].id[0] &&
+           strncmp(index->slots[slot].id, id, HINATA_UUID_LENGTH) != 0) {
+        slot = (slot + 1) & mask;
+    }
+
+    return &index->slots[slot];
+}
+
+/**
+ * hinata_export_index_note - Record @offset as the latest record of @id
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_export_index_note(struct hinata_export_index *index, const char *id,
+                                    loff_t offset)
+{
+    struct hinata_export_live *old = index->slots, *live;
+    size_t old_capacity = index->capacity, i;
+
+    if (!id[0]) {
+        return 0;
+    }
+
+    if ((index->count + 1) * 2 > index->capacity) {
+        index->capacity = old_capacity ? old_capacity * 2 : 1024;
+        index->slots = kvcalloc(index->capacity, sizeof(*index->slots), GFP_KERNEL);
+        if (!index->slots) {
+            index->slots = old;
+            index->capacity = old_capacity;
+            return -ENOMEM;
+        }
+
+        for (i = 0; i < old_capacity; i++) {
+            if (old[i].id[0]) {
+                *hinata_export_index_slot(index, old[i].id) = old[i];
+            }
+        }
+        kvfree(old);
+    }
+
+    live = hinata_export_index_slot(index, id);
+    if (!live->id[0]) {
+        memcpy(live->id, id, sizeof(live->id));
+        live->id[sizeof(live->id) - 1] = '\0';
+        index->count++;
+    }
+    live->offset = offset;
+    return 0;
+}
+
+static bool hinata_export_index_live(struct hinata_export_index *index,
+                                     const struct hinata_packet *packet, loff_t offset)
+{
+    return !(packet->flags & HINATA_PACKET_FLAG_DELETED) && index->capacity &&
+           hinata_export_index_slot(index, packet->id)->offset == offset;
+}
+
+/**
+ * hinata_export_read_segment - Read the next run of whole records
+ * @file: Region file
+ * @seg: Segment to fill
+ * @pos: Region offset, advanced past the records read
+ * @end: Region offset to stop at
+ * @index: Latest record of each packet, or NULL to keep every record
+ * 
+ * Reads at most one segment worth of data and trims it to the last whole
+ * record, so no record straddles two segments. The buffer grows when a
+ * single record is larger than a segment. With @index, superseded records
+ * and deletion markers are dropped and the rest moved to the front.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_export_read_segment(struct file *file, struct hinata_export_segment *seg,
+                                      loff_t *pos, loff_t end,
+                                      struct hinata_export_index *index)
+{
+    size_t avail, offset, size, kept;
+    loff_t read_pos;
+    ssize_t nread;
+    void *buffer;
+    int ret;
+
+    for (;;) {
+        avail = min_t(u64, seg->input_capacity, end - *pos);
+        read_pos = *pos;
+        nread = kernel_read(file, seg->input, avail, &read_pos);
+        if (nread != avail) {
+            return nread < 0 ? nread : -EIO;
+        }
+
+        offset = 0;
+        seg->items = 0;
+        while ((ret = hinata_export_record_size(seg, offset, avail, &size)) == 0 &&
+               size <= avail - offset) {
+            offset += size;
+            seg->items++;
+        }
+
+        if (ret == -EUCLEAN) {
+            return ret;
+        }
+
+        if (offset > 0) {
+            break;
+        }
+
+        /* The first record does not fit: truncated region or oversized record */
+        if (ret == -EAGAIN || size > end - *pos) {
+            return -EUCLEAN;
+        }
+
+        buffer = vmalloc(size);
+        if (!buffer) {
+            return -ENOMEM;
+        }
+        vfree(seg->input);
+        seg->input = buffer;
+        seg->input_capacity = size;
+    }
+
+    seg->input_size = offset;
+    seg->span = offset;
+
+    if (index) {
+        kept = 0;
+        seg->items = 0;
+        for (offset = 0; offset < seg->span; offset += size) {
+            hinata_export_record_size(seg, offset, seg->span, &size);
+            if (!hinata_export_index_live(index, &seg->header, *pos + offset)) {
+                continue;
+            }
+            memmove(seg->input + kept, seg->input + offset, size);
+            kept += size;
+            seg->items++;
+        }
+        seg->input_size = kept;
+    }
+
+    *pos += seg->span;
+    return 0;
+}
+
+/**
+ * hinata_export_index_build - Find the latest record of every packet
+ * @file: Region file
+ * @seg: Scratch segment
+ * @pos: First record offset
+ * @end: Region offset to stop at
+ * @index: Table to fill
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_export_index_build(struct file *file, struct hinata_export_segment *seg,
+                                     loff_t pos, loff_t end, struct hinata_export_index *index)
+{
+    size_t offset, size;
+    loff_t base;
+    int ret;
+
+    while (pos < end) {
+        base = pos;
+        ret = hinata_export_read_segment(file, seg, &pos, end, NULL);
+        if (ret < 0) {
+            return ret;
+        }
+
+        for (offset = 0; offset < seg->span; offset += size) {
+            hinata_export_record_size(seg, offset, seg->span, &size);
+            ret = hinata_export_index_note(index, seg->header.id, base + offset);
+            if (ret < 0) {
+                return ret;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static size_t hinata_export_field_len(const char *field, size_t size)
+{
+    return strnlen(field, size);
+}
+
+/**
+ * hinata_export_record_bound - Upper bound of a formatted record
+ * @packet: Packet record
+ * 
+ * JSON escapes a byte into at most six characters and CSV into two, so
+ * six times the text plus the fixed fields is enough for both formats.
+ */
+static size_t hinata_export_record_bound(const struct hinata_packet *packet)
+{
+    size_t text = packet->content_size;
+    size_t i, tags = min_t(size_t, packet->tag_count, HINATA_MAX_TAGS);
+
+    text += hinata_export_field_len(packet->id, sizeof(packet->id));
+    text += hinata_export_field_len(packet->source, sizeof(packet->source));
+    for (i = 0; i < tags; i++) {
+        text += hinata_export_field_len(packet->tags[i], sizeof(packet->tags[i])) + 1;
+    }
+
+    return 256 + text * 6;
+}
+
+static char *hinata_export_put_json(char *out, const char *s, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t i;
+
+    *out++ = '"';
+    for (i = 0; i < len; i++) {
+        u8 c = s[i];
+
+        switch (c) {
+        case '"':
+        case '\\':
+            *out++ = '\\';
+            *out++ = c;
+            break;
+        case '\n':
+            *out++ = '\\';
+            *out++ = 'n';
+            break;
+        case '\r':
+            *out++ = '\\';
+            *out++ = 'r';
+            break;
+        case '\t':
+            *out++ = '\\';
+            *out++ = 't';
+            break;
+        default:
+            if (c < 0x20 || c == 0x7f) {
+                memcpy(out, "\\u00", 4);
+                out[4] = hex[c >> 4];
+                out[5] = hex[c & 0xf];
+                out += 6;
+            } else {
+                *out++ = c;
+            }
+            break;
+        }
+    }
+    *out++ = '"';
+    return out;
+}
+
+static char *hinata_export_put_csv_text(char *out, const char *s, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (s[i] == '\0') {
+            continue;
+        }
+        if (s[i] == '"') {
+            *out++ = '"';
+        }
+        *out++ = s[i];
+    }
+    return out;
+}
+
+static char *hinata_export_put_csv(char *out, const char *s, size_t len)
+{
+    *out++ = '"';
+    out = hinata_export_put_csv_text(out, s, len);
+    *out++ = '"';
+    return out;
+}
+
+static char *hinata_export_format_jsonl(char *out, char *end,
+                                        const struct hinata_packet *packet,
+                                        const char *content)
+{
+    size_t i, tags = min_t(size_t, packet->tag_count, HINATA_MAX_TAGS);
+
+    out += scnprintf(out, end - out, "{\"id\":");
+    out = hinata_export_put_json(out, packet->id,
+                                 hinata_export_field_len(packet->id, sizeof(packet->id)));
+    out += scnprintf(out, end - out,
+                     ",\"type\":%u,\"priority\":%u,\"status\":%u,"
+                     "\"created_at\":%llu,\"updated_at\":%llu,\"source\":",
+                     packet->type, packet->priority, packet->status,
+                     packet->created_at, packet->updated_at);
+    out = hinata_export_put_json(out, packet->source,
+                                 hinata_export_field_len(packet->source,
+                                                         sizeof(packet->source)));
+
+    out += scnprintf(out, end - out, ",\"tags\":[");
+    for (i = 0; i < tags; i++) {
+        if (i) {
+            *out++ = ',';
+        }
+        out = hinata_export_put_json(out, packet->tags[i],
+                                     hinata_export_field_len(packet->tags[i],
+                                                             sizeof(packet->tags[i])));
+    }
+
+    out += scnprintf(out, end - out, "],\"content\":");
+    out = hinata_export_put_json(out, content, packet->content_size);
+    out += scnprintf(out, end - out, "}\n");
+    return out;
+}
+
+static char *hinata_export_format_csv(char *out, char *end,
+                                      const struct hinata_packet *packet,
+                                      const char *content)
+{
+    size_t i, tags = min_t(size_t, packet->tag_count, HINATA_MAX_TAGS);
+
+    out = hinata_export_put_csv(out, packet->id,
+                                hinata_export_field_len(packet->id, sizeof(packet->id)));
+    out += scnprintf(out, end - out, ",%u,%u,%u,%llu,%llu,",
+                     packet->type, packet->priority, packet->status,
+                     packet->created_at, packet->updated_at);
+    out = hinata_export_put_csv(out, packet->source,
+                                hinata_export_field_len(packet->source,
+                                                        sizeof(packet->source)));
+
+    /* Tags are joined with ';' inside one quoted field */
+    *out++ = ',';
+    *out++ = '"';
+    for (i = 0; i < tags; i++) {
+        if (i) {
+            *out++ = ';';
+        }
+        out = hinata_export_put_csv_text(out, packet->tags[i],
+                                         hinata_export_field_len(packet->tags[i],
+                                                                 sizeof(packet->tags[i])));
+    }
+    *out++ = '"';
+
+    *out++ = ',';
+    out = hinata_export_put_csv(out, content, packet->content_size);
+    *out++ = '\n';
+    return out;
+}
+
+/**
+ * hinata_export_format_segment - Format all records of a segment
+ * @seg: Segment with whole records in its input buffer
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_export_format_segment(struct hinata_export_segment *seg)
+{
+    const struct hinata_packet *packet = &seg->header;
+    size_t offset, size, bound = 0;
+    char *out, *end;
+
+    for (offset = 0; offset < seg->input_size; offset += size) {
+        hinata_export_record_size(seg, offset, seg->input_size, &size);
+        bound += hinata_export_record_bound(packet);
+    }
+
+    if (bound > seg->output_capacity) {
+        vfree(seg->output);
+        seg->output = vmalloc(bound);
+        seg->output_capacity = seg->output ? bound : 0;
+        if (!seg->output) {
+            return -ENOMEM;
+        }
+    }
+
+    out = seg->output;
+    end = seg->output + seg->output_capacity;
+    for (offset = 0; offset < seg->input_size; offset += size) {
+        const char *content = seg->input + offset + sizeof(*packet);
+
+        hinata_export_record_size(seg, offset, seg->input_size, &size);
+        if (seg->format == HINATA_EXPORT_FORMAT_CSV) {
+            out = hinata_export_format_csv(out, end, packet, content);
+        } else {
+            out = hinata_export_format_jsonl(out, end, packet, content);
+        }
+    }
+
+    seg->output_size = out - seg->output;
+    return 0;
+}
+
+/**
+ * hinata_export_format_task - Worker pool entry point for one segment
+ * @data: Segment, with a reference taken for this task
+ */
+static int hinata_export_format_task(void *data)
+{
+    struct hinata_export_segment *seg = data;
+    int ret;
+
+    ret = hinata_export_format_segment(seg);
+    seg->result = ret;
+    complete(&seg->done);
+    kref_put(&seg->ref, hinata_export_segment_release);
+    return ret;
+}
+
+/**
+ * hinata_export_cancel_task - Worker pool dropped a queued segment
+ * @data: Segment, with a reference taken for this task
+ * @reason: Why the task did not run
+ */
+static void hinata_export_cancel_task(void *data, int reason)
+{
+    struct hinata_export_segment *seg = data;
+
+    seg->result = reason;
+    complete(&seg->done);
+    kref_put(&seg->ref, hinata_export_segment_release);
+}
+
+static void hinata_export_submit(struct hinata_export_segment *seg)
+{
+    reinit_completion(&seg->done);
+    kref_get(&seg->ref);
+
+    if (hinata_submit_task_cancellable(HINATA_TASK_TYPE_EXPORT, hinata_export_format_task,
+                                       hinata_export_cancel_task, seg, 0,
+                                       HINATA_TASK_FLAG_CPU_INTENSIVE |
+                                       HINATA_TASK_FLAG_BACKGROUND) < 0) {
+        /* Pool stopped or queue full, format in the caller */
+        hinata_export_format_task(seg);
+    }
+}
+
+static void hinata_export_report(struct hinata_export_progress *state)
+{
+    hinata_add_event(HINATA_EVENT_TYPE_STORAGE_EXPORT, 0, state, sizeof(*state));
+}
+
+/**
+ * hinata_export_write_segment - Write a formatted segment to the output
+ * @seg: Segment submitted for formatting
+ * @file: Output file
+ * @pos: Output offset
+ * @state: Export progress
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+static int hinata_export_write_segment(struct hinata_export_segment *seg, struct file *file,
+                                       loff_t *pos, struct hinata_export_progress *state)
+{
+    ssize_t written;
+
+    if (!wait_for_completion_timeout(&seg->done,
+                                     msecs_to_jiffies(HINATA_EXPORT_TASK_TIMEOUT))) {
+        return -ETIMEDOUT;
+    }
+
+    if (seg->result < 0) {
+        return seg->result;
+    }
+
+    written = kernel_write(file, seg->output, seg->output_size, pos);
+    if (written != seg->output_size) {
+        return written < 0 ? written : -EIO;
+    }
+
+    state->bytes_read += seg->span;
+    state->items_exported += seg->items;
+    state->bytes_written = *pos;
+    return 0;
+}
+
+/**
+ * hinata_storage_check_path - Confine a created file to a directory
+ * @path: Proposed file path
+ * @dir: Directory the file must be in, without a trailing slash
+ *
+ * Storage creates and truncates snapshot and export files with kernel
+ * credentials, so only plain file names directly inside @dir are accepted.
+ *
+ * Returns: 0 if @path is acceptable, -EINVAL otherwise
+ */
+int hinata_storage_check_path(const char *path, const char *dir)
+{
+    size_t dir_len = strlen(dir);
+    const char *name;
+
+    if (strncmp(path, dir, dir_len) != 0 || path[dir_len] != '/') {
+        return -EINVAL;
+    }
+
+    name = path + dir_len + 1;
+    if (!*name || strchr(name, '/') || !strcmp(name, ".") || !strcmp(name, "..")) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+/**
+ * hinata_storage_export - Stream all packets of a region to a file
+ * @region_id: Region to export
+ * @path: Output file directly inside HINATA_EXPORT_DIR, created or truncated
+ * @format: Output format
+ * @progress: Optional final progress
+ * 
+ * The region is read sequentially, one segment of whole records at a time,
+ * up to its size when the export starts. A first pass finds the latest
+ * record of every packet; superseded records and deleted packets are not
+ * exported. Segments are formatted on the
+ * worker pool while the next ones are read and are written to @path in
+ * region order, so at most HINATA_EXPORT_MAX_INFLIGHT segments are held in
+ * memory. Progress is reported as HINATA_EVENT_TYPE_STORAGE_EXPORT events
+ * at every percent and once more when the export ends.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_storage_export(u32 region_id, const char *path,
+                          enum hinata_export_format format,
+                          struct hinata_export_progress *progress)
+{
+    struct hinata_export_segment *slots[HINATA_EXPORT_MAX_INFLIGHT] = { NULL };
+    struct hinata_export_index index = { NULL, 0, 0 };
+    struct hinata_storage_region *region;
+    struct hinata_export_progress state;
+    struct file *input, *output;
+    loff_t pos, end, out_pos = 0;
+    u64 submitted = 0, written = 0;
+    u64 percent, last_percent = 0;
+    ssize_t nwritten;
+    int i, ret = 0;
+
+    if (!storage_initialized) {
+        return -ENODEV;
+    }
+
+    if (!path || region_id >= HINATA_STORAGE_MAX_REGIONS ||
+        format >= HINATA_EXPORT_FORMAT_MAX) {
+        return -EINVAL;
+    }
+
+    ret = hinata_storage_check_path(path, HINATA_EXPORT_DIR);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* Pin the region file and fix the end; later appends are not exported */
+    region = &storage_ctx.regions[region_id];
+    mutex_lock(&region->lock);
+    input = region->file ? get_file(region->file) : NULL;
+    end = region->used_size;
+    mutex_unlock(&region->lock);
+
+    if (!input) {
+        return -ENOENT;
+    }
+
+    pos = sizeof(struct hinata_storage_header);
+    if (end < pos) {
+        end = pos;
+    }
+
+    memset(&state, 0, sizeof(state));
+    state.region_id = region_id;
+    state.format = format;
+    state.bytes_total = end - pos;
+
+    output = filp_open(path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW, 0600);
+    if (IS_ERR(output)) {
+        ret = PTR_ERR(output);
+        pr_err("Failed to open export file '%s': %d\n", path, ret);
+        goto out_input;
+    }
+
+    for (i = 0; i < HINATA_EXPORT_MAX_INFLIGHT; i++) {
+        slots[i] = hinata_export_segment_alloc(format);
+        if (!slots[i]) {
+            ret = -ENOMEM;
+            goto out_slots;
+        }
+    }
+
+    ret = hinata_export_index_build(input, slots[0], pos, end, &index);
+    if (ret < 0) {
+        goto out_slots;
+    }
+
+    if (format == HINATA_EXPORT_FORMAT_CSV) {
+        nwritten = kernel_write(output, hinata_export_csv_header,
+                                sizeof(hinata_export_csv_header) - 1, &out_pos);
+        if (nwritten != sizeof(hinata_export_csv_header) - 1) {
+            ret = nwritten < 0 ? nwritten : -EIO;
+            goto out_slots;
+        }
+    }
+
+    while (pos < end || written < submitted) {
+        /* Read ahead until the pipeline is full, then retire the oldest */
+        if (pos < end && submitted - written < HINATA_EXPORT_MAX_INFLIGHT) {
+            struct hinata_export_segment *seg =
+                slots[submitted % HINATA_EXPORT_MAX_INFLIGHT];
+
+            ret = hinata_export_read_segment(input, seg, &pos, end, &index);
+            if (ret < 0) {
+                break;
+            }
+
+            hinata_export_submit(seg);
+            submitted++;
+            continue;
+        }
+
+        ret = hinata_export_write_segment(slots[written % HINATA_EXPORT_MAX_INFLIGHT],
+                                          output, &out_pos, &state);
+        if (ret < 0) {
+            break;
+        }
+        written++;
+
+        /* The final event covers 100% */
+        percent = div64_u64(state.bytes_read * 100, state.bytes_total);
+        if (percent != last_percent && percent < 100) {
+            last_percent = percent;
+            hinata_export_report(&state);
+        }
+    }
+
+    if (ret == 0) {
+        ret = vfs_fsync(output, 0);
+    }
+
+out_slots:
+    /* Segments still being formatted are freed by their task */
+    for (i = 0; i < HINATA_EXPORT_MAX_INFLIGHT; i++) {
+        if (slots[i]) {
+            kref_put(&slots[i]->ref, hinata_export_segment_release);
+        }
+    }
+    kvfree(index.slots);
+    filp_close(output, NULL);
+
+out_input:
+    fput(input);
+
+    atomic64_add(pos - sizeof(struct hinata_storage_header), &storage_ctx.stats.bytes_read);
+
+    state.status = ret;
+    state.done = 1;
+    hinata_export_report(&state);
+    if (progress) {
+        *progress = state;
+    }
+
+    if (ret == 0) {
+        pr_info("HiNATA storage exported region %u as %s (%llu items, %llu bytes)\n",
+                region_id, hinata_export_format_to_string(format),
+                state.items_exported, state.bytes_written);
+    } else {
+        pr_err("Failed to export region %u to '%s': %d\n", region_id, path, ret);
+    }
+
+    return ret;
+}
+
+/**
+ * hinata_storage_suspend - Suspend storage subsystem
+ * 
+ * Stops periodic work, flushes all regions and persists a warm-restart
+ * snapshot of the hot cache entries.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_storage_suspend(void)
+{
+    int ret;
+
+    if (!storage_initialized) {
+        return -ENODEV;
+    }
+
+    if (storage_ctx.suspended) {
+        return 0;
+    }
+
+    del_timer_sync(&storage_ctx.sync_timer);
+    del_timer_sync(&storage_ctx.gc_timer);
+    cancel_work_sync(&storage_ctx.sync_work);
+    cancel_work_sync(&storage_ctx.gc_work);
+    cancel_work_sync(&storage_ctx.warm_work);
+
+    ret = hinata_storage_sync(HINATA_STORAGE_ALL_REGIONS);
+    if (ret) {
+        pr_warn("HiNATA storage sync on suspend failed: %d\n", ret);
+    }
+
+    if (hinata_config_value(warm_restart)) {
+        ret = hinata_storage_snapshot_save(NULL, storage_ctx.snapshot_flags);
+        if (ret < 0) {
+            pr_warn("HiNATA storage snapshot on suspend failed: %d\n", ret);
+        }
+    }
+
+    storage_ctx.suspended = true;
+
+    return 0;
+}
+
+/**
+ * hinata_storage_resume - Resume storage subsystem
+ * 
+ * Restarts periodic work and warms the cache from the suspend snapshot
+ * in the background, so resume itself does not wait on storage reads.
+ * 
+ * Returns: 0 on success, negative error code on failure
+ */
+int hinata_storage_resume(void)
+{
+    if (!storage_initialized) {
+        return -ENODEV;
+    }
+
+    if (!storage_ctx.suspended) {
+        return 0;
+    }
+
+    storage_ctx.suspended = false;
+
+    mod_timer(&storage_ctx.sync_timer, jiffies + hinata_storage_sync_delay());
+    mod_timer(&storage_ctx.gc_timer, jiffies + hinata_storage_gc_delay());
+
+    hinata_storage_snapshot_load_async();
+
+    return 0;
+}
+
+/* Work functions */
+
+/**
+ * hinata_storage_sync_work_func - Sync work function
+ * @work: Work structure
+ */
+static void hinata_storage_sync_work_func(struct work_struct *work)
+{
+    hinata_storage_sync(HINATA_STORAGE_ALL_REGIONS);
+}
+
+/**
+ * hinata_storage_gc_work_func - Garbage collection work function
+ * @work: Work structure
+ */
+static void hinata_storage_gc_work_func(struct work_struct *work)
+{
+    /* TODO: Implement garbage collection logic */
+    pr_debug("HiNATA storage garbage collection triggered\n");
+}
+
+/**
+ * hinata_storage_warm_work_func - Warm-restart snapshot load work function
+ * @work: Work structure
+ */
+static void hinata_storage_warm_work_func(struct work_struct *work)
+{
+    int ret;
+
+    ret = hinata_storage_snapshot_load(NULL);
+    if (ret < 0 && ret != -ENOENT) {
+        pr_warn("HiNATA storage warm restart failed: %d\n", ret);
+    }
+}
+
+/* Timer functions */
+
+/**
+ * hinata_storage_sync_timer_func - Sync timer function
+ * @timer: Timer structure
+ */
+static void hinata_storage_sync_timer_func(struct timer_list *timer)
+{
+    schedule_work(&storage_ctx.sync_work);
+    mod_timer(&storage_ctx.sync_timer, jiffies + hinata_storage_sync_delay());
+}
+
+/**
+ * hinata_storage_gc_timer_func - GC timer function
+ * @timer: Timer structure
+ */
+static void hinata_storage_gc_timer_func(struct timer_list *timer)
+{
+    schedule_work(&storage_ctx.gc_work);
+    mod_timer(&storage_ctx.gc_timer, jiffies + hinata_storage_gc_delay());
+}
+
+/**
+ * hinata_storage_config_notify - Apply configuration changes
+ * @nb: Notifier block
+ * @action: HINATA_CONFIG_CHANGED
+ * @data: struct hinata_config_change
+ * 
+ * Returns: NOTIFY_OK
+ */
+static int hinata_storage_config_notify(struct notifier_block *nb,
+                                        unsigned long action, void *data)
+{
+    struct hinata_config_change *change = data;
+
+    if (action != HINATA_CONFIG_CHANGED || !storage_initialized ||
+        storage_ctx.suspended) {
+        return NOTIFY_DONE;
+    }
+
+    if (change->new->sync_interval_ms != change->old->sync_interval_ms) {
+        mod_timer(&storage_ctx.sync_timer, jiffies + hinata_storage_sync_delay());
+    }
+
+    if (change->new->gc_interval_ms != change->old->gc_interval_ms) {
+        mod_timer(&storage_ctx.gc_timer, jiffies + hinata_storage_gc_delay());
+    }
+
+    if (change->new->cache_max_entries < change->old->cache_max_entries) {
+        hinata_storage_cache_trim(change->new->cache_max_entries);
+    }
+
+    return NOTIFY_OK;
 }
 
 /* Region management functions */
@@ -1041,4 +2563,10 @@ EXPORT_SYMBOL(hinata_storage_sync);
 EXPORT_SYMBOL(hinata_storage_cache_get);
 EXPORT_SYMBOL(hinata_storage_cache_put);
 EXPORT_SYMBOL(hinata_storage_cache_remove);
+EXPORT_SYMBOL(hinata_storage_snapshot_save);
+EXPORT_SYMBOL(hinata_storage_snapshot_load);
+EXPORT_SYMBOL(hinata_storage_snapshot_load_async);
+EXPORT_SYMBOL(hinata_storage_check_path);
+EXPORT_SYMBOL(hinata_storage_suspend);
+EXPORT_SYMBOL(hinata_storage_resume);
 EXPORT_SYMBOL(hinata_storage_cache_put_ref);
\ No newline at end of file
@@ -29,6 +29,8 @@
 #define HINATA_STORAGE_MAX_SIZE         (1024ULL * 1024 * 1024 * 1024)  /* 1TB */
 #define HINATA_STORAGE_BLOCK_SIZE       4096
 #define HINATA_STORAGE_CACHE_SIZE       1024
+#define HINATA_STORAGE_SYNC_INTERVAL    30000   /* Default, 30 seconds */
+#define HINATA_STORAGE_GC_INTERVAL      60000   /* Default, 60 seconds */
 #define HINATA_STORAGE_ALL_REGIONS      0xFFFFFFFF
 
 /* Storage type definitions */
@@ -126,6 +128,32 @@ enum hinata_storage_operation {
 #define HINATA_CACHE_EVICTION_THRESHOLD     0.8                   /* 80% */
 #define HINATA_CACHE_CLEANUP_INTERVAL       30000                 /* 30 seconds */
 
+/* Warm-restart snapshot constants */
+#define HINATA_SNAPSHOT_MAGIC               0x48575253            /* "HWRS" */
+#define HINATA_SNAPSHOT_VERSION             1
+#define HINATA_SNAPSHOT_DIR                 "/var/lib/hinata"     /* Configured snapshots live here */
+#define HINATA_SNAPSHOT_DEFAULT_PATH        HINATA_SNAPSHOT_DIR "/warm.snap"
+#define HINATA_SNAPSHOT_MAX_ENTRIES         HINATA_CACHE_MAX_ENTRIES
+#define HINATA_SNAPSHOT_MAX_BYTES           (16 * 1024 * 1024)    /* 16MB */
+
+/* Export constants */
+#define HINATA_EXPORT_DIR                   HINATA_SNAPSHOT_DIR "/export" /* Exports are written here */
+
+/* Snapshot flags */
+#define HINATA_SNAPSHOT_FLAG_CONTENTS       (1 << 0)  /* Records carry cached data; required */
+
+/* Streaming export constants */
+#define HINATA_EXPORT_SEGMENT_SIZE          (256 * 1024)          /* Bytes read per segment */
+#define HINATA_EXPORT_MAX_INFLIGHT          4                     /* Segments being formatted */
+#define HINATA_EXPORT_TASK_TIMEOUT          30000                 /* 30 seconds per segment */
+
+/* Export output formats */
+enum hinata_export_format {
+    HINATA_EXPORT_FORMAT_JSONL = 0,
+    HINATA_EXPORT_FORMAT_CSV,
+    HINATA_EXPORT_FORMAT_MAX
+};
+
 /* Forward declarations */
 struct hinata_packet;
 struct hinata_knowledge_block;
@@ -327,6 +355,64 @@ struct hinata_storage_transaction {
     struct mutex lock;
 };
 
+/**
+ * struct hinata_storage_snapshot_header - Warm-restart snapshot file header
+ * @magic: HINATA_SNAPSHOT_MAGIC
+ * @version: HINATA_SNAPSHOT_VERSION
+ * @flags: Snapshot flags
+ * @entry_count: Number of records following the header
+ * @payload_size: Size of all records in bytes
+ * @created_time: Snapshot creation timestamp
+ * @checksum: CRC32 of the payload
+ *
+ * Records are a struct hinata_storage_snapshot_record each, hottest first,
+ * followed by @size bytes of cached data, a serialized packet.
+ */
+struct hinata_storage_snapshot_header {
+    u32 magic;
+    u32 version;
+    u32 flags;
+    u32 entry_count;
+    u64 payload_size;
+    u64 created_time;
+    u32 checksum;
+    u32 reserved;
+} __packed;
+
+/**
+ * struct hinata_storage_snapshot_record - One hot cache entry in a snapshot
+ * @key: Cache key
+ * @access_count: Access count at snapshot time
+ * @size: Size of the data that follows
+ */
+struct hinata_storage_snapshot_record {
+    char key[HINATA_UUID_STRING_LENGTH];
+    u32 access_count;
+    u32 size;
+} __packed;
+
+/**
+ * struct hinata_export_progress - Payload of HINATA_EVENT_TYPE_STORAGE_EXPORT
+ * @region_id: Region being exported
+ * @format: Output format
+ * @status: 0 while running or on success, negative error code on failure
+ * @done: Set on the final event of an export
+ * @bytes_read: Region bytes whose records have been written
+ * @bytes_total: Region bytes to export, fixed when the export starts
+ * @items_exported: Records written to the output so far
+ * @bytes_written: Output bytes written so far
+ */
+struct hinata_export_progress {
+    u32 region_id;
+    u32 format;
+    s32 status;
+    u32 done;
+    u64 bytes_read;
+    u64 bytes_total;
+    u64 items_exported;
+    u64 bytes_written;
+};
+
 /**
  * struct hinata_storage_backup - Storage backup information
  * @id: Backup ID
@@ -420,6 +506,20 @@ int hinata_storage_cache_unpin(const char *key);
 int hinata_storage_cache_prefetch(char **keys, u32 count);
 int hinata_storage_cache_get_stats(struct hinata_storage_stats *stats);
 
+/* Warm-restart snapshots */
+int hinata_storage_snapshot_save(const char *path, u32 flags);
+int hinata_storage_snapshot_load(const char *path);
+void hinata_storage_snapshot_load_async(void);
+
+/* Paths of files the storage layer creates */
+int hinata_storage_check_path(const char *path, const char *dir);
+
+/* Streaming export */
+int hinata_storage_export(u32 region_id, const char *path,
+                          enum hinata_export_format format,
+                          struct hinata_export_progress *progress);
+const char *hinata_export_format_to_string(enum hinata_export_format format);
+
 /* Synchronization and persistence */
 int hinata_storage_sync(u32 region_id);
 int hinata_storage_sync_all(void);